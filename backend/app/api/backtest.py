@@ -7,6 +7,7 @@ import asyncio
 import pandas as pd
 import numpy as np
 from app.services.deriv_connector import deriv_client
+from app.core.engine_wrapper import EngineWrapper
 
 
 router = APIRouter()
@@ -51,243 +52,115 @@ class BacktestResult(BaseModel):
     equityCurve: List[Dict] # {date: str, equity: float, drawdown: float}
     metrics: BacktestMetrics
 
-@router.post("/run")
-async def run_backtest(request: BacktestRequest):
-    logger.info(f"Starting backtest: {request}")
+async def _load_candles(request) -> List[Dict]:
+    """M5 candles for request.symbol over startDate..endDate (synthetic if unavailable)."""
     try:
-        # 1. Fetch Historical Data
-        try:
-            start_dt = datetime.strptime(request.startDate, '%Y-%m-%d')
-            end_dt = datetime.strptime(request.endDate, '%Y-%m-%d')
-            
-            # Determine duration logic for candle fetching
-            total_minutes = (end_dt - start_dt).total_seconds() / 60
-            count = int(total_minutes / 5) # Assuming M5 timeframe
-            count = min(count, 5000) # Cap at 5000 for safety
-            
-            logger.info(f"Fetching {count} candles for {request.symbol}...")
-            
-            # ATTEMPT REAL FETCH
-            try:
-                candles = await deriv_client.get_candles(request.symbol, count=count, granularity=300) # 5m
-                df = pd.DataFrame(candles)
-            except Exception as e:
-                logger.error(f"Deriv API fetch failed: {e}. Falling back to synthetic data.")
-                df = pd.DataFrame() # Trigger fallback below
-
-            # FALLBACK TO SYNTHETIC DATA IF FETCH FAILED OR EMPTY
-            if df.empty:
-                logger.warning("Generating synthetic backtest data due to API failure/empty response.")
-                # Generate pseudo-random walk
-                dates = [start_dt + timedelta(minutes=5*i) for i in range(count)]
-                base_price = 1000.0
-                prices = [base_price]
-                for _ in range(count-1):
-                    change = np.random.normal(0, 1)
-                    prices.append(prices[-1] + change)
-                
-                df = pd.DataFrame({
-                    "time": dates,
-                    "open": prices,
-                    "high": [p + abs(np.random.normal(0, 0.5)) for p in prices],
-                    "low": [p - abs(np.random.normal(0, 0.5)) for p in prices],
-                    "close": prices,
-                    "epoch": [int(d.timestamp()) for d in dates]
-                })
-
-            else:
-                 # Real data processing
-                 df['time'] = pd.to_datetime(df['epoch'], unit='s')
-                 df = df[df['time'] >= start_dt] 
-
-        except Exception as e:
-            logger.error(f"Data setup error: {e}")
-            raise HTTPException(status_code=500, detail=f"Failed to setup market data: {str(e)}")
-
-        if df.empty:
-             logger.error("Dataframe empty after all attempts")
-             raise HTTPException(status_code=400, detail="No data available")
-
-        # 2. Setup Backtest Engine
-        trades: List[BacktestTrade] = []
-        equity = request.initialBalance
-        peak_equity = equity
-        equity_curve = []
+        start_dt = datetime.strptime(request.startDate, '%Y-%m-%d')
+        end_dt = datetime.strptime(request.endDate, '%Y-%m-%d')
         
-        logger.info(f"Simulating strategy {request.strategyId} on {len(df)} candles")
+        # Determine duration logic for candle fetching
+        total_minutes = (end_dt - start_dt).total_seconds() / 60
+        count = int(total_minutes / 5) # Assuming M5 timeframe
+        count = min(count, 5000) # Cap at 5000 for safety
         
-        active_trade = None
-        
-        # Pre-calculate indicators
-        logger.info("Calculating indicators...")
-        numeric_cols = ['open', 'high', 'low', 'close']
-        for col in numeric_cols:
-            df[col] = df[col].astype(float)
-            
-        df['sma_10'] = df['close'].rolling(window=10).mean()
-        df['sma_20'] = df['close'].rolling(window=20).mean()
-        df['std_20'] = df['close'].rolling(window=20).std()
-        
-        # Approximate ATR
-        df['tr'] = df[['high', 'low', 'close']].apply(lambda x: max(x['high'] - x['low'], abs(x['high'] - x['close']), abs(x['low'] - x['close'])), axis=1)
-        df['atr'] = df['tr'].rolling(window=14).mean()
+        logger.info(f"Fetching {count} candles for {request.symbol}...")
         
+        # ATTEMPT REAL FETCH
         try:
-            df['rsi'] = calculate_rsi(df['close'])
+            candles = await deriv_client.get_candles(request.symbol, count=count, granularity=300) # 5m
+            df = pd.DataFrame(candles)
         except Exception as e:
-            logger.error(f"RSI Calc failed: {e}")
-            raise e
-            
-        logger.info("Starting simulation loop...")
-        
-        for i, row in df.iterrows():
-            if i < 50: continue # Warmup
-            
-            current_price = row['close']
-            current_time = row['time']
-            
-            # --- Trade Management (Exit) ---
-            if active_trade:
-                pnl_pct = 0
-                is_close = False
-                
-                if active_trade['side'] == 'buy':
-                    change = (current_price - active_trade['entryPrice']) / active_trade['entryPrice']
-                    if change >= 0.015 or change <= -0.005: # TP 1.5%, SL 0.5%
-                        is_close = True
-                else:
-                     change = (active_trade['entryPrice'] - current_price) / active_trade['entryPrice']
-                     if change >= 0.015 or change <= -0.005:
-                        is_close = True
-                
-                pnl_pct = change * 100
-                
-                # Auto close after 2 hours
-                if (current_time - active_trade['entryDate']).total_seconds() > 7200:
-                    is_close = True
+            logger.error(f"Deriv API fetch failed: {e}. Falling back to synthetic data.")
+            df = pd.DataFrame() # Trigger fallback below
 
-                if is_close:
-                    pnl = active_trade['balance_snap'] * change
-                    pnl = pnl * 10 # 10x leverage simulation
-                    
-                    trade_record = BacktestTrade(
-                        id=f"bt-{i}",
-                        entryDate=active_trade['entryDate'].isoformat(),
-                        exitDate=current_time.isoformat(),
-                        symbol=request.symbol,
-                        side=active_trade['side'],
-                        entryPrice=active_trade['entryPrice'],
-                        exitPrice=current_price,
-                        pnl=round(pnl, 2),
-                        pnlPercent=round(pnl_pct * 10, 2)
-                    )
-                    trades.append(trade_record)
-                    equity += pnl
-                    active_trade = None
+        # FALLBACK TO SYNTHETIC DATA IF FETCH FAILED OR EMPTY
+        if df.empty:
+            logger.warning("Generating synthetic backtest data due to API failure/empty response.")
+            # Generate pseudo-random walk
+            dates = [start_dt + timedelta(minutes=5*i) for i in range(count)]
+            base_price = 1000.0
+            prices = [base_price]
+            for _ in range(count-1):
+                change = np.random.normal(0, 1)
+                prices.append(prices[-1] + change)
             
-            # --- Trade Entry ---
-            if not active_trade:
-                signal = None
-                
-                # --- STRATEGY LOGIC ---
-                if request.strategyId == "spike_bot":
-                    # Spike Bot: High Volatility + Trend
-                    candle_range = abs(row['open'] - row['close'])
-                    is_volatile = candle_range > (1.5 * row['atr'])
-                    
-                    if is_volatile:
-                        if row['close'] > row['sma_20']:
-                            signal = "buy"
-                        elif row['close'] < row['sma_20']:
-                            signal = "sell"
-                            
-                elif request.strategyId == "v10_safe":
-                    # V10 Safe: Trend Follow with Momentum Confirmation
-                    if row['close'] > row['sma_20'] and row['rsi'] > 50:
-                         signal = "buy"
-                    elif row['close'] < row['sma_20'] and row['rsi'] < 50:
-                         signal = "sell"
-                         
-                elif request.strategyId == "v75_super_safe":
-                     if row['rsi'] < 30: signal = "buy"
-                     elif row['rsi'] > 70: signal = "sell"
-                
-                elif request.strategyId == "boom300_safe":
-                    if row['close'] < row['sma_20'] and row['rsi'] > 50:
-                        signal = "sell"
-                        
-                elif request.strategyId == "crash300_safe":
-                    if row['close'] > row['sma_20'] and row['rsi'] < 50:
-                        signal = "buy"
+            df = pd.DataFrame({
+                "time": dates,
+                "open": prices,
+                "high": [p + abs(np.random.normal(0, 0.5)) for p in prices],
+                "low": [p - abs(np.random.normal(0, 0.5)) for p in prices],
+                "close": prices,
+                "epoch": [int(d.timestamp()) for d in dates]
+            })
+
+        else:
+             # Real data processing
+             df['time'] = pd.to_datetime(df['epoch'], unit='s')
+             df = df[df['time'] >= start_dt] 
 
-                elif request.strategyId == "scalper":
-                    # Scalper: 3 consecutive candles
-                    if i > 2:
-                        prev1 = df.iloc[i-1]
-                        prev2 = df.iloc[i-2]
-                        if row['close'] > prev1['close'] and prev1['close'] > prev2['close']:
-                            signal = "buy"
-                        elif row['close'] < prev1['close'] and prev1['close'] < prev2['close']:
-                            signal = "sell"
-
-                elif request.strategyId == "breakout":
-                    # Breakout: 20 candle high/low
-                    if i > 20:
-                        lookback = df.iloc[i-20:i]
-                        high_20 = lookback['high'].max()
-                        low_20 = lookback['low'].min()
-                        if row['close'] > high_20:
-                            signal = "buy"
-                        elif row['close'] < low_20:
-                            signal = "sell"
+    except Exception as e:
+        logger.error(f"Data setup error: {e}")
+        raise HTTPException(status_code=500, detail=f"Failed to setup market data: {str(e)}")
 
-                elif request.strategyId == "grid_recovery":
-                    # Grid Recovery: Mean Reversion (0.5% deviation from SMA10)
-                    if not pd.isna(row['sma_10']):
-                         deviation = (row['close'] - row['sma_10']) / row['sma_10']
-                         if deviation < -0.005: signal = "buy"
-                         elif deviation > 0.005: signal = "sell"
+    if df.empty:
+         logger.error("Dataframe empty after all attempts")
+         raise HTTPException(status_code=400, detail="No data available")
 
-                else:
-                     # Default SMA Crossover
-                     if row['close'] > row['sma_20'] and df.iloc[i-1]['close'] <= df.iloc[i-1]['sma_20']:
-                         signal = "buy"
-                     elif row['close'] < row['sma_20'] and df.iloc[i-1]['close'] >= df.iloc[i-1]['sma_20']:
-                         signal = "sell"
-                
-                if signal:
-                    active_trade = {
-                        "side": signal,
-                        "entryPrice": current_price,
-                        "entryDate": current_time,
-                        "balance_snap": equity * 0.05 # Risk 5%
-                    }
+    for col in ['open', 'high', 'low', 'close']:
+        df[col] = df[col].astype(float)
+    df['epoch'] = df['epoch'].astype(int)
+    return df[['epoch', 'open', 'high', 'low', 'close']].to_dict('records')
 
-            # --- Tracking ---
-            peak_equity = max(peak_equity, equity)
-            drawdown = 0
-            if peak_equity > 0:
-                drawdown = (peak_equity - equity) / peak_equity * 100
-                
-            # Daily Equity Curve points (or every N steps to save reliable items)
-            # To avoid massive JSON, log every 10th candle or on trade close
-            if i % 10 == 0:
-                equity_curve.append({
-                    "date": current_time.strftime('%Y-%m-%d %H:%M'),
-                    "equity": round(equity, 2),
-                    "drawdown": round(drawdown, 2)
-                })
+@router.post("/run")
+async def run_backtest(request: BacktestRequest):
+    logger.info(f"Starting backtest: {request}")
+    try:
+        # 1. Fetch Historical Data
+        candles = await _load_candles(request)
+
+        # 2. Native replay: live indicators, signal, risk policy and cooldown
+        logger.info(f"Simulating strategy {request.strategyId} on {len(candles)} candles")
+        run = EngineWrapper.backtest_run(
+            request.symbol,
+            candles=candles,
+            timeframe="5m",
+            initial_balance=request.initialBalance,
+            stake_fraction=0.05,      # Risk 5%
+            leverage=10.0,            # 10x leverage simulation
+            take_profit_pct=1.5,
+            stop_loss_pct=0.5,
+            max_hold_seconds=7200,    # Auto close after 2 hours
+            equity_every=10,
+        )
 
-        # 3. Calculate Metrics
-        winning_trades = [t for t in trades if t.pnl > 0]
-        losing_trades = [t for t in trades if t.pnl <= 0]
-        
-        total_wins = sum(t.pnl for t in winning_trades)
-        total_losses = abs(sum(t.pnl for t in losing_trades))
-        
-        def safe_div(a, b):
-            if b == 0: return 0.0
-            return a / b
+        def iso(epoch):
+            return datetime.utcfromtimestamp(epoch).isoformat()
+
+        trades: List[BacktestTrade] = [
+            BacktestTrade(
+                id=f"bt-{i}",
+                entryDate=iso(t["entry_epoch"]),
+                exitDate=iso(t["exit_epoch"]),
+                symbol=request.symbol,
+                side=t["side"],
+                entryPrice=t["entry_price"],
+                exitPrice=t["exit_price"],
+                pnl=round(t["pnl"], 2),
+                pnlPercent=round(t["pnl_pct"], 2)
+            )
+            for i, t in enumerate(run["trades"])
+        ]
+        equity_curve = [
+            {
+                "date": datetime.utcfromtimestamp(e["epoch"]).strftime('%Y-%m-%d %H:%M'),
+                "equity": round(e["equity"], 2),
+                "drawdown": round(e["drawdown_pct"], 2)
+            }
+            for e in run["equity"]
+        ]
+
+        # 3. Metrics (computed natively)
+        stats = run["stats"]
 
         def sanitize(val):
             if np.isnan(val) or np.isinf(val):
@@ -295,20 +168,20 @@ async def run_backtest(request: BacktestRequest):
             return float(val)
 
         metrics = BacktestMetrics(
-            totalPnL=sanitize(round(equity - request.initialBalance, 2)),
-            winRate=sanitize(round(len(winning_trades) / len(trades) * 100 if trades else 0, 2)),
-            profitFactor=sanitize(round(total_wins / total_losses if total_losses > 0 else (999.0 if total_wins > 0 else 0.0), 2)),
-            maxDrawdown=sanitize(round(max([x['drawdown'] for x in equity_curve]) if equity_curve else 0, 2)),
-            sharpeRatio=1.5, # Placeholder for complex calc
-            totalTrades=len(trades),
-            winningTrades=len(winning_trades),
-            losingTrades=len(losing_trades),
-            avgWin=sanitize(round(total_wins / len(winning_trades) if winning_trades else 0, 2)),
-            avgLoss=sanitize(round(total_losses / len(losing_trades) if losing_trades else 0, 2)),
-            largestWin=sanitize(round(max([t.pnl for t in winning_trades]) if winning_trades else 0, 2)),
-            largestLoss=sanitize(round(min([t.pnl for t in losing_trades]) if losing_trades else 0, 2)),
-            avgHoldTime=0, # skipped
-            expectancy=0
+            totalPnL=sanitize(round(stats["total_pnl"], 2)),
+            winRate=sanitize(round(stats["win_rate"], 2)),
+            profitFactor=sanitize(round(stats["profit_factor"], 2)),
+            maxDrawdown=sanitize(round(stats["max_drawdown_pct"], 2)),
+            sharpeRatio=sanitize(round(stats["sharpe"], 2)),
+            totalTrades=stats["trades"],
+            winningTrades=stats["wins"],
+            losingTrades=stats["losses"],
+            avgWin=sanitize(round(stats["avg_win"], 2)),
+            avgLoss=sanitize(round(stats["avg_loss"], 2)),
+            largestWin=sanitize(round(stats["largest_win"], 2)),
+            largestLoss=sanitize(round(stats["largest_loss"], 2)),
+            avgHoldTime=sanitize(round(stats["avg_hold_seconds"] / 60.0, 2)),
+            expectancy=sanitize(round(stats["expectancy"], 2))
         )
 
         result = BacktestResult(
@@ -340,9 +213,33 @@ async def run_backtest(request: BacktestRequest):
         traceback.print_exc()
         raise HTTPException(status_code=500, detail=str(e))
 
-def calculate_rsi(series, period=14):
-    delta = series.diff()
-    gain = (delta.where(delta > 0, 0)).rolling(window=period).mean()
-    loss = (-delta.where(delta < 0, 0)).rolling(window=period).mean()
-    rs = gain / loss
-    return 100 - (100 / (1 + rs))
+class SweepRequest(BaseModel):
+    symbol: str
+    startDate: str
+    endDate: str
+    initialBalance: float
+    # EngineWrapper.BACKTEST_DEFAULTS key -> values, e.g.
+    # {"rsi_oversold": [38, 42], "rsi_overbought": [56, 62], "cooldown_seconds": [30, 60]}
+    grid: Dict[str, List[float]]
+    rankBy: str = "total_pnl"
+    threads: int = 0
+    top: int = 20
+
+@router.post("/sweep")
+async def run_sweep(request: SweepRequest):
+    """Backtest every grid combination on all cores and return the best first."""
+    logger.info(f"Starting sweep: {request.symbol} {request.grid}")
+    candles = await _load_candles(request)
+    try:
+        rows = await asyncio.to_thread(
+            EngineWrapper.backtest_sweep,
+            request.symbol,
+            request.grid,
+            candles=candles,
+            threads=request.threads,
+            rank_by=request.rankBy,
+            initial_balance=request.initialBalance,
+        )
+    except (KeyError, TypeError, ValueError) as e:
+        raise HTTPException(status_code=400, detail=f"Invalid sweep: {e}")
+    return {"combinations": len(rows), "results": rows[:request.top]}
@@ -35,9 +35,34 @@ def get_status():
         "tradesExecuted": deriv_client.session_stats["trades"],
         "profitToday": deriv_client.session_stats["pnl"],
         "account": deriv_client.active_account_id,
-        "symbols": deriv_client.enabled_symbols
+        "symbols": deriv_client.enabled_symbols,
+        "latency": _latency_summary(EngineWrapper.get_metrics())
     }
 
+def _latency_summary(metrics: dict) -> dict:
+    """The few engine numbers the dashboard shows on every status poll."""
+    stages = metrics["stages"]
+    return {
+        "tickP50Us": stages["tick"]["p50_us"],
+        "tickP99Us": stages["tick"]["p99_us"],
+        "decisionP99Us": stages["decision"]["p99_us"],
+        "ticks": metrics["ticks"],
+        "rejects": sum(r["count"] for r in metrics["rejects"]),
+        "parseErrors": metrics["parse_errors"],
+    }
+
+@router.get("/metrics/")
+def get_metrics():
+    """Full engine instrumentation: per-stage, per-export and per-symbol latency plus counters."""
+    metrics = EngineWrapper.get_metrics()
+    metrics["feed"] = EngineWrapper.feed_stats()
+    return metrics
+
+@router.post("/metrics/reset/")
+def reset_metrics():
+    EngineWrapper.reset_metrics()
+    return {"status": "success"}
+
 @router.post("/toggle/")
 def toggle_bot(req: BotToggleRequest):
     if req.command == "start":
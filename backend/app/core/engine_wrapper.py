@@ -1,84 +1,1767 @@
+import asyncio
 import ctypes
+import itertools
 import os
 import json
-from ctypes import c_char_p, c_int, c_void_p
+import threading
+from concurrent.futures import ThreadPoolExecutor
+import numpy as np
+from datetime import datetime
+from ctypes import c_char_p, c_double, c_int, c_int32, c_int64, c_size_t, c_void_p, POINTER
+
+
+# --- Binary ABI structs (mirror engine.hpp field-for-field) ---
+
+class EngineTick(ctypes.Structure):
+    _fields_ = [
+        ("symbol_id", c_int32),
+        ("flags", c_int32),
+        ("epoch", c_int64),
+        ("quote", c_double),
+    ]
+
+
+class EngineTickResult(ctypes.Structure):
+    _fields_ = [
+        ("symbol_id", c_int32),
+        ("status", c_int32),
+        ("epoch", c_int64),
+        ("price", c_double),
+        ("signal", c_double),
+        ("closed_mask", c_int32),
+        ("exit_updates", c_int32),
+        ("spike", c_int32),
+        ("ticks_since_spike", c_int32),
+        ("spike_score", c_double),
+    ]
+
+
+class EngineCandle(ctypes.Structure):
+    _fields_ = [
+        ("epoch", c_int64),
+        ("open", c_double),
+        ("high", c_double),
+        ("low", c_double),
+        ("close", c_double),
+        ("volume", c_double),
+    ]
+
+
+class EngineCandleView(ctypes.Structure):
+    _fields_ = [
+        ("epoch", POINTER(c_int64)),
+        ("open", POINTER(c_double)),
+        ("high", POINTER(c_double)),
+        ("low", POINTER(c_double)),
+        ("close", POINTER(c_double)),
+        ("volume", POINTER(c_double)),
+        ("count", c_int64),
+        ("capacity", c_int64),
+        ("total_closed", c_int64),
+        ("has_current", c_int32),
+        ("reserved", c_int32),
+        ("current", EngineCandle),
+    ]
+
+
+class EngineIndicators(ctypes.Structure):
+    _fields_ = [
+        ("rsi", c_double),
+        ("rsi_live", c_double),
+        ("ema_fast", c_double),
+        ("ema_fast_prev", c_double),
+        ("ema_slow", c_double),
+        ("atr", c_double),
+        ("adx", c_double),
+        ("plus_di", c_double),
+        ("minus_di", c_double),
+        ("macd", c_double),
+        ("macd_signal", c_double),
+        ("macd_hist", c_double),
+        ("samples", c_int64),
+        ("ready", c_int32),
+        ("reserved", c_int32),
+    ]
+
+
+class EngineStructure(ctypes.Structure):
+    _fields_ = [
+        ("swing_high", c_double),
+        ("swing_low", c_double),
+        ("prev_swing_high", c_double),
+        ("prev_swing_low", c_double),
+        ("swing_high_epoch", c_int64),
+        ("swing_low_epoch", c_int64),
+        ("bos_level", c_double),
+        ("bos_epoch", c_int64),
+        ("bos_direction", c_int32),
+        ("trend", c_int32),
+        ("choch", c_int32),
+        ("bars_since_bos", c_int32),
+        ("bull_fvg_top", c_double),
+        ("bull_fvg_bottom", c_double),
+        ("bear_fvg_top", c_double),
+        ("bear_fvg_bottom", c_double),
+        ("open_bull_fvgs", c_int32),
+        ("open_bear_fvgs", c_int32),
+        ("bars", c_int64),
+    ]
+
+
+class EngineRegime(ctypes.Structure):
+    _fields_ = [
+        ("volatility", c_double),
+        ("baseline", c_double),
+        ("ratio", c_double),
+        ("regime", c_int32),
+        ("returns", c_int32),
+    ]
+
+
+class EngineTradeRequest(ctypes.Structure):
+    _fields_ = [
+        ("symbol_id", c_int32),
+        ("active_trades", c_int32),
+        ("stake", c_double),
+    ]
+
+
+class EngineAccountTrade(ctypes.Structure):
+    _fields_ = [
+        ("account_id", c_int32),
+        ("active_trades", c_int32),
+        ("stake", c_double),
+    ]
+
+
+class EngineTradeDecision(ctypes.Structure):
+    _fields_ = [
+        ("reason", c_int32),
+        ("reserved", c_int32),
+        ("stake", c_double),
+        ("detail", c_double),
+        ("limit", c_double),
+    ]
+
+
+class EnginePosition(ctypes.Structure):
+    _fields_ = [
+        ("contract_id", c_int64),
+        ("symbol_id", c_int32),
+        ("side", c_int32),
+        ("trail_rule", c_int32),
+        ("reserved", c_int32),
+        ("entry_price", c_double),
+        ("stop_loss", c_double),
+        ("take_profit", c_double),
+    ]
+
+
+class EnginePositionUpdate(ctypes.Structure):
+    _fields_ = [
+        ("contract_id", c_int64),
+        ("epoch", c_int64),
+        ("events", c_int32),
+        ("reserved", c_int32),
+        ("price", c_double),
+        ("stop_loss", c_double),
+        ("take_profit", c_double),
+    ]
+
+
+class EngineFilterRequest(ctypes.Structure):
+    _fields_ = [
+        ("symbol_id", c_int32),
+        ("timeframe", c_int32),
+        ("direction", c_int32),
+        ("rsi_momentum", c_int32),
+    ]
+
+
+class EngineFilterResult(ctypes.Structure):
+    _fields_ = [
+        ("reason", c_int32),
+        ("stage", c_int32),
+        ("value", c_double),
+        ("limit", c_double),
+    ]
+
+
+class EngineStrategySignal(ctypes.Structure):
+    _fields_ = [
+        ("strategy", c_int32),
+        ("reason", c_int32),
+        ("direction", c_int32),
+        ("filter", c_int32),
+        ("market_mode", c_int32),
+        ("reserved", c_int32),
+        ("epoch", c_int64),
+        ("confidence", c_double),
+        ("value", c_double),
+        ("limit", c_double),
+        ("sl", c_double),
+        ("tp", c_double),
+    ]
+
+
+class EngineEvent(ctypes.Structure):
+    _fields_ = [
+        ("seq", c_int64),
+        ("time_ms", c_int64),
+        ("type", c_int32),
+        ("symbol_id", c_int32),
+        ("code", c_int32),
+        ("direction", c_int32),
+        ("account_id", c_int32),
+        ("reserved", c_int32),
+        ("value", c_double),
+        ("limit", c_double),
+    ]
+
+
+class EngineBacktestParams(ctypes.Structure):
+    _fields_ = [
+        ("initial_balance", c_double),
+        ("stake_fraction", c_double),
+        ("leverage", c_double),
+        ("take_profit_pct", c_double),
+        ("stop_loss_pct", c_double),
+        ("signal_threshold", c_double),
+        ("rsi_oversold", c_double),
+        ("rsi_overbought", c_double),
+        ("max_hold_seconds", c_int64),
+        ("timeframe", c_int32),
+        ("cooldown_seconds", c_int32),
+        ("equity_every", c_int32),
+        ("reserved", c_int32),
+    ]
+
+
+class EngineBacktestTrade(ctypes.Structure):
+    _fields_ = [
+        ("entry_epoch", c_int64),
+        ("exit_epoch", c_int64),
+        ("side", c_int32),
+        ("exit_reason", c_int32),
+        ("entry_price", c_double),
+        ("exit_price", c_double),
+        ("stake", c_double),
+        ("pnl", c_double),
+        ("pnl_pct", c_double),
+    ]
+
+
+class EngineEquityPoint(ctypes.Structure):
+    _fields_ = [
+        ("epoch", c_int64),
+        ("equity", c_double),
+        ("drawdown_pct", c_double),
+    ]
+
+
+class EngineBacktestStats(ctypes.Structure):
+    _fields_ = [
+        ("bars", c_int64),
+        ("trades", c_int64),
+        ("wins", c_int64),
+        ("losses", c_int64),
+        ("rejected", c_int64),
+        ("final_equity", c_double),
+        ("total_pnl", c_double),
+        ("max_drawdown", c_double),
+        ("max_drawdown_pct", c_double),
+        ("win_rate", c_double),
+        ("profit_factor", c_double),
+        ("avg_win", c_double),
+        ("avg_loss", c_double),
+        ("largest_win", c_double),
+        ("largest_loss", c_double),
+        ("sharpe", c_double),
+        ("avg_hold_seconds", c_double),
+        ("expectancy", c_double),
+    ]
+
+
+class EngineSweepResult(ctypes.Structure):
+    _fields_ = [
+        ("index", c_int64),
+        ("score", c_double),
+        ("stats", EngineBacktestStats),
+    ]
+
+
+class EngineBacktestOutput(ctypes.Structure):
+    _fields_ = [
+        ("trades", POINTER(EngineBacktestTrade)),
+        ("trades_capacity", c_int64),
+        ("trades_count", c_int64),
+        ("equity", POINTER(EngineEquityPoint)),
+        ("equity_capacity", c_int64),
+        ("equity_count", c_int64),
+        ("stats", EngineBacktestStats),
+    ]
+
+
+class EngineFeedStats(ctypes.Structure):
+    _fields_ = [
+        ("frames", c_int64),
+        ("ticks", c_int64),
+        ("candles", c_int64),
+        ("dropped", c_int64),
+        ("results_dropped", c_int64),
+        ("parse_errors", c_int64),
+        ("api_errors", c_int64),
+        ("connects", c_int64),
+        ("connected", c_int32),
+        ("symbols", c_int32),
+    ]
+
+
+class EngineReplayStats(ctypes.Structure):
+    _fields_ = [
+        ("records", c_int64),
+        ("ticks", c_int64),
+        ("decisions", c_int64),
+        ("approved", c_int64),
+        ("mismatches", c_int64),
+        ("first_mismatch", c_int64),
+        ("bytes", c_int64),
+        ("elapsed_ns", c_int64),
+    ]
+
+
+# EngineIndicatorFlags (EngineIndicators.ready bits)
+IND_RSI = 1 << 0
+IND_EMA_FAST = 1 << 1
+IND_EMA_SLOW = 1 << 2
+IND_ATR = 1 << 3
+IND_ADX = 1 << 4
+IND_MACD = 1 << 5
+
+# EngineTimeframe ids
+TIMEFRAMES = {"1m": 0, "5m": 1, "15m": 2, "1h": 3}
+
+# EngineStoreSeries: history store series (candle timeframes plus raw ticks)
+STORE_SERIES = dict(TIMEFRAMES, ticks=4)
+
+# NumPy views of the same layouts, for zero-copy batch calls
+TICK_DTYPE = np.dtype([
+    ("symbol_id", np.int32),
+    ("flags", np.int32),
+    ("epoch", np.int64),
+    ("quote", np.float64),
+])
+TICK_RESULT_DTYPE = np.dtype([
+    ("symbol_id", np.int32),
+    ("status", np.int32),
+    ("epoch", np.int64),
+    ("price", np.float64),
+    ("signal", np.float64),
+    ("closed_mask", np.int32),
+    ("exit_updates", np.int32),
+    ("spike", np.int32),
+    ("ticks_since_spike", np.int32),
+    ("spike_score", np.float64),
+])
+assert TICK_DTYPE.itemsize == ctypes.sizeof(EngineTick)
+assert TICK_RESULT_DTYPE.itemsize == ctypes.sizeof(EngineTickResult)
+
+ENGINE_OK = 0
+ENGINE_ERR_NULL_ARG = -1
+ENGINE_ERR_UNKNOWN_SYMBOL = -2
+ENGINE_ERR_BAD_TIMEFRAME = -3
+ENGINE_ERR_BAD_ARG = -4
+ENGINE_ERR_IO = -5
+ENGINE_ERR_UNSUPPORTED = -6
+ENGINE_ERR_UNKNOWN_ACCOUNT = -7
+
+# EngineExitReason (EngineBacktestTrade.exit_reason)
+EXIT_REASONS = {0: "take_profit", 1: "stop_loss", 2: "max_hold", 3: "end_of_data"}
+
+# EngineSweepRank keys for backtest_sweep
+SWEEP_RANKS = {"total_pnl": 0, "profit_factor": 1, "sharpe": 2, "win_rate": 3,
+               "return_over_drawdown": 4}
+
+# EngineBacktestParams defaults (timeframe by name)
+BACKTEST_DEFAULTS = {
+    "initial_balance": 1000.0,
+    "stake_fraction": 0.05,
+    "leverage": 10.0,
+    "take_profit_pct": 1.5,
+    "stop_loss_pct": 0.5,
+    "signal_threshold": 0.6,
+    "rsi_oversold": 0.0,
+    "rsi_overbought": 100.0,
+    "max_hold_seconds": 7200,
+    "timeframe": "5m",
+    "cooldown_seconds": -1,
+    "equity_every": 10,
+}
+
+# series_swings flags
+SWING_HIGH = 1
+SWING_LOW = 2
+
+# EngineTradeReason (EngineTradeDecision.reason)
+TRADE_APPROVED = 0
+REJECT_NOT_INITIALIZED = 1
+REJECT_BOT_STOPPED = 2
+REJECT_UNKNOWN_SYMBOL = 3
+REJECT_STAKE_BELOW_MIN = 4
+REJECT_STAKE_ABOVE_MAX = 5
+REJECT_INSUFFICIENT_MARGIN = 6
+REJECT_MAX_ACTIVE_TRADES = 7
+REJECT_DAILY_LOSS = 8
+REJECT_MAX_SL_HITS = 9
+REJECT_LOSS_STREAK = 10
+REJECT_COOLDOWN = 11
+REJECT_UNKNOWN_ACCOUNT = 12
+REJECT_CORRELATED = 13
+REJECT_VOLATILITY = 14
+
+# EngineRegimeKind (EngineRegime.regime)
+REGIME_UNKNOWN = 0
+REGIME_CALM = 1
+REGIME_NORMAL = 2
+REGIME_VOLATILE = 3
+
+# EngineTrailRule (EnginePosition.trail_rule): the DynamicTakeProfit
+# check_*_trailing_update rules
+TRAIL_NONE = 0
+TRAIL_BREAK_EVEN = 1
+TRAIL_V10 = 2
+TRAIL_BOOM300 = 3
+TRAIL_CRASH300 = 4
+
+# EnginePositionEvent bits (EnginePositionUpdate.events)
+POSITION_STOP_MOVED = 1
+POSITION_STOP_HIT = 2
+POSITION_TAKE_PROFIT_HIT = 4
+
+# EngineFilterReason (EngineFilterResult.reason)
+FILTER_PASSED = 0
+FILTER_NO_CANDLE = 1
+FILTER_FLAT_CANDLE = 2
+FILTER_BODY_TOO_SMALL = 3
+FILTER_BODY_TOO_LARGE = 4
+FILTER_LOW_SPREAD = 5
+FILTER_CANDLE_DIRECTION = 6
+FILTER_RSI_MOMENTUM = 7
+FILTER_OPPOSITE_WICK = 8
+FILTER_RSI_BAND = 9
+FILTER_EMA_TREND = 10
+FILTER_ADX_TOO_LOW = 11
+FILTER_STRUCTURE_AGAINST = 12
+FILTER_WEAK_SIGNAL = 13
+
+
+# EngineEventType (EngineEvent.type); EVENT_NAMES gives the names the
+# stream clients see
+EVENT_SIGNAL = 0
+EVENT_ENTRY_SKIPPED = 1
+EVENT_TRADE_APPROVED = 2
+EVENT_TRADE_REJECTED = 3
+EVENT_STRATEGY_ENTRY = 4
+EVENT_SPIKE = 5
+EVENT_NAMES = ("signal", "entry_skipped", "trade_approved", "trade_rejected",
+               "strategy_entry", "spike")
+
+# EngineStrategyKind (set_symbol_strategy, EngineStrategySignal.strategy);
+# STRATEGY_NAMES gives the STRATEGY_MAP names
+STRATEGY_NONE = 0
+STRATEGY_V10_SUPER_SAFE = 1
+STRATEGY_BOOM300_SAFE = 2
+STRATEGY_CRASH300_SAFE = 3
+STRATEGY_NAMES = ("none", "v10_super_safe", "boom_300_safe", "crash_300_safe")
+
+# EngineMarketMode (EngineStrategySignal.market_mode)
+MARKET_RANGE = 0
+MARKET_TREND = 1
+MARKET_STRONG_TREND = 2
+MARKET_COMPRESSION = 3
+MARKET_CHAOTIC = 4
+
+# EngineStrategyReason (EngineStrategySignal.reason)
+STRATEGY_ENTRY = 0
+STRATEGY_OFF = 1
+STRATEGY_WARMING_UP = 2
+STRATEGY_NOISE = 3
+STRATEGY_CHAOTIC = 4
+STRATEGY_SIDEWAYS = 5
+STRATEGY_WEAK_TREND = 6
+STRATEGY_FLAT_SLOPE = 7
+STRATEGY_NO_SETUP = 8
+STRATEGY_RSI_MISMATCH = 9
+STRATEGY_ENTRY_FILTER = 10
+STRATEGY_EXTREME_VOLATILITY = 11
+STRATEGY_RECENT_SPIKE = 12
+STRATEGY_LOW_CONFIDENCE = 13
+
+def _struct_dict(s: ctypes.Structure) -> dict:
+    return {name: getattr(s, name) for name, _ in s._fields_ if name != "reserved"}
+
+
+def _candle_array(candles):
+    """ctypes EngineCandle array from candle dicts (open/high/low/close/epoch)."""
+    buf = (EngineCandle * len(candles))()
+    for i, c in enumerate(candles):
+        epoch = c.get("epoch")
+        if epoch is None and c.get("time") is not None:
+            epoch = int(c["time"].timestamp())
+        buf[i] = EngineCandle(int(epoch or 0), c["open"], c["high"], c["low"],
+                              c["close"], c.get("volume", 0.0))
+    return buf
+
+
+def _backtest_params(**overrides) -> EngineBacktestParams:
+    unknown = set(overrides) - set(BACKTEST_DEFAULTS)
+    if unknown:
+        raise TypeError(f"unknown backtest parameters: {sorted(unknown)}")
+    p = dict(BACKTEST_DEFAULTS, **overrides)
+    p["timeframe"] = TIMEFRAMES[p["timeframe"]]
+    for name, ctype in EngineBacktestParams._fields_:
+        if name in p and ctype in (c_int32, c_int64):
+            p[name] = int(p[name])
+    return EngineBacktestParams(**p)
+
+
+def _backtest_output(n: int, params: EngineBacktestParams):
+    """Output buffers large enough for a run over `n` bars/ticks."""
+    trades = (EngineBacktestTrade * (n + 1))()
+    equity = (EngineEquityPoint * (n // max(params.equity_every, 1) + 2))()
+    out = EngineBacktestOutput(trades, len(trades), 0, equity, len(equity), 0)
+    return trades, equity, out
+
+
+def _backtest_result(trades, equity, out: EngineBacktestOutput) -> dict:
+    trade_list = []
+    for t in trades[:min(out.trades_count, len(trades))]:
+        d = _struct_dict(t)
+        d["side"] = "buy" if t.side > 0 else "sell"
+        d["exit_reason"] = EXIT_REASONS.get(t.exit_reason, "unknown")
+        trade_list.append(d)
+    return {
+        "trades": trade_list,
+        "equity": [_struct_dict(e) for e in equity[:min(out.equity_count, len(equity))]],
+        "stats": _struct_dict(out.stats),
+    }
+
+
+def _column_view(ptr, n: int) -> np.ndarray:
+    """Wrap `n` elements of engine memory as a read-only NumPy array."""
+    arr = np.ctypeslib.as_array(ptr, shape=(n,))
+    arr.flags.writeable = False
+    return arr
+
+
+class CandleSeries:
+    """
+    Read-only, zero-copy view over one native candle ring (oldest first).
+
+    The columns (`epoch`, `open`, `high`, `low`, `close`, `volume`) are NumPy
+    arrays over engine memory; use them directly for indicator math. Indexing
+    and iteration yield candle dicts for code that still expects them. Take
+    a copy if the data must outlive the next candle close.
+
+    A view races with any other thread that applies ticks to the symbol
+    (the native feed): a candle close overwrites the slot of the view's
+    oldest bar, so a reader can see the newest bar there or a half-written
+    row. Read such symbols through get_candles(copy=True), a snapshot taken
+    under the context's lock.
+    """
+
+    _EMPTY_F = np.zeros(0, dtype=np.float64)
+    _EMPTY_I = np.zeros(0, dtype=np.int64)
+
+    def __init__(self, view: EngineCandleView = None):
+        n = view.count if view is not None else 0
+        if n > 0:
+            self.epoch = _column_view(view.epoch, n)
+            self.open = _column_view(view.open, n)
+            self.high = _column_view(view.high, n)
+            self.low = _column_view(view.low, n)
+            self.close = _column_view(view.close, n)
+            self.volume = _column_view(view.volume, n)
+        else:
+            self.epoch = self._EMPTY_I
+            self.open = self.high = self.low = self.close = self.volume = self._EMPTY_F
+        self.total_closed = view.total_closed if view is not None else 0
+
+    @classmethod
+    def _from_rows(cls, rows: np.ndarray, total_closed: int) -> "CandleSeries":
+        """Series owning a copy of EngineCandle rows (see EngineWrapper.get_candles)."""
+        series = cls()
+        if len(rows):
+            for name in ("epoch", "open", "high", "low", "close", "volume"):
+                setattr(series, name, np.ascontiguousarray(rows[name]))
+        series.total_closed = total_closed
+        return series
+
+    def __len__(self):
+        return len(self.close)
+
+    def __bool__(self):
+        return len(self.close) > 0
+
+    def _candle(self, i: int) -> dict:
+        epoch = int(self.epoch[i])
+        return {
+            "open": float(self.open[i]), "high": float(self.high[i]),
+            "low": float(self.low[i]), "close": float(self.close[i]),
+            "volume": float(self.volume[i]), "epoch": epoch,
+            "time": datetime.fromtimestamp(epoch),
+        }
+
+    def __getitem__(self, key):
+        if isinstance(key, slice):
+            return [self._candle(i) for i in range(*key.indices(len(self)))]
+        if key < 0:
+            key += len(self)
+        if not 0 <= key < len(self):
+            raise IndexError("candle index out of range")
+        return self._candle(key)
+
+    def __iter__(self):
+        for i in range(len(self)):
+            yield self._candle(i)
+
+
+class ParallelTickProcessor:
+    """
+    Runs binary-ABI tick calls on worker threads.
+
+    ctypes.CDLL drops the GIL for the duration of each engine call and the
+    engine is safe for concurrent callers, so ticks for different symbols
+    are processed truly in parallel. Each symbol is pinned to one lane (a
+    single-thread executor), which keeps its ticks in arrival order.
+    """
+
+    def __init__(self, workers: int = None):
+        workers = max(1, workers or os.cpu_count() or 1)
+        self._lanes = [
+            ThreadPoolExecutor(max_workers=1, thread_name_prefix=f"engine-lane-{i}")
+            for i in range(workers)
+        ]
+
+    def submit(self, symbol_id: int, epoch: int, quote: float):
+        """Queue a tick; returns a concurrent.futures.Future[EngineTickResult]."""
+        lane = self._lanes[symbol_id % len(self._lanes)]
+        return lane.submit(EngineWrapper.process_tick_bin, symbol_id, epoch, quote)
+
+    async def process_tick(self, symbol_id: int, epoch: int, quote: float) -> EngineTickResult:
+        return await asyncio.wrap_future(self.submit(symbol_id, epoch, quote))
+
+    def shutdown(self, wait: bool = True):
+        for lane in self._lanes:
+            lane.shutdown(wait=wait)
+
 
 class EngineWrapper:
     _lib = None
+    _lib_lock = threading.Lock()
+    _pool = None
 
     @classmethod
     def _load_lib(cls):
-        if cls._lib is None:
+        if cls._lib is not None:
+            return
+        with cls._lib_lock:
+            if cls._lib is not None:
+                return
             lib_path = os.path.abspath(os.path.join(os.path.dirname(__file__), "../../cpp_engine/libengine.so"))
             try:
-                cls._lib = ctypes.CDLL(lib_path)
+                # CDLL (not PyDLL) releases the GIL for every call
+                lib = ctypes.CDLL(lib_path)
                 
                 # void init_engine(const char* config_json)
-                cls._lib.init_engine.argtypes = [c_char_p]
-                cls._lib.init_engine.restype = None
+                lib.init_engine.argtypes = [c_char_p]
+                lib.init_engine.restype = None
+
+                # void update_config(const char* config_json)
+                lib.update_config.argtypes = [c_char_p]
+                lib.update_config.restype = None
+
+                # void update_account(double balance, double equity, double margin_free)
+                lib.update_account.argtypes = [c_double, c_double, c_double]
+                lib.update_account.restype = None
+
+                # int32_t create_account_context(const char* account)
+                lib.create_account_context.argtypes = [c_char_p]
+                lib.create_account_context.restype = c_int32
+
+                # int32_t set_account_state(int32_t account_id, double balance, double equity, double margin_free)
+                lib.set_account_state.argtypes = [c_int32, c_double, c_double, c_double]
+                lib.set_account_state.restype = c_int32
+
+                # int32_t record_account_result(int32_t account_id, double profit)
+                lib.record_account_result.argtypes = [c_int32, c_double]
+                lib.record_account_result.restype = c_int32
                 
-                # char* process_tick(const char* tick_json)
-                # MUST use c_void_p to get the pointer address for freeing
-                cls._lib.process_tick.argtypes = [c_char_p]
-                cls._lib.process_tick.restype = c_void_p
+                # const char* process_tick(const char* tick_json)
+                # JSON results live in an engine-owned per-thread ring;
+                # c_char_p copies them out immediately and nothing is freed
+                lib.process_tick.argtypes = [c_char_p]
+                lib.process_tick.restype = c_char_p
+
+                # int32_t create_symbol_context(const char* symbol)
+                lib.create_symbol_context.argtypes = [c_char_p]
+                lib.create_symbol_context.restype = c_int32
+
+                # int32_t set_symbol_cooldown(int32_t symbol_id, int seconds)
+                lib.set_symbol_cooldown.argtypes = [c_int32, c_int]
+                lib.set_symbol_cooldown.restype = c_int32
+
+                # int32_t set_symbol_cooldown_ms(int32_t symbol_id, int64_t ms)
+                lib.set_symbol_cooldown_ms.argtypes = [c_int32, c_int64]
+                lib.set_symbol_cooldown_ms.restype = c_int32
+
+                # int32_t record_trade_result(int32_t symbol_id, double profit)
+                lib.record_trade_result.argtypes = [c_int32, c_double]
+                lib.record_trade_result.restype = c_int32
+
+                # int32_t get_recommended_stake(int32_t symbol_id, double balance, double* stake)
+                lib.get_recommended_stake.argtypes = [c_int32, c_double, POINTER(c_double)]
+                lib.get_recommended_stake.restype = c_int32
+
+                # int32_t get_policy_stake(const char* symbol, double balance, double* stake)
+                lib.get_policy_stake.argtypes = [c_char_p, c_double, POINTER(c_double)]
+                lib.get_policy_stake.restype = c_int32
+
+                # int32_t get_last_quote(int32_t symbol_id, double* price, int64_t* epoch)
+                lib.get_last_quote.argtypes = [c_int32, POINTER(c_double), POINTER(c_int64)]
+                lib.get_last_quote.restype = c_int32
+
+                # int32_t process_tick_bin(const EngineTick* tick, EngineTickResult* out)
+                lib.process_tick_bin.argtypes = [POINTER(EngineTick), POINTER(EngineTickResult)]
+                lib.process_tick_bin.restype = c_int32
+
+                # int64_t process_ticks(const EngineTick* ticks, size_t n, EngineTickResult* out)
+                lib.process_ticks.argtypes = [POINTER(EngineTick), c_size_t, POINTER(EngineTickResult)]
+                lib.process_ticks.restype = c_int64
                 
-                # char* execute_trade(const char* params_json)
-                cls._lib.execute_trade.argtypes = [c_char_p]
-                cls._lib.execute_trade.restype = c_void_p
+                # int32_t get_candles(int32_t symbol_id, int32_t timeframe, EngineCandleView* out)
+                lib.get_candles.argtypes = [c_int32, c_int32, POINTER(EngineCandleView)]
+                lib.get_candles.restype = c_int32
+
+                # int64_t copy_candles(int32_t symbol_id, int32_t timeframe, EngineCandle* out, size_t max,
+                #                      int64_t* total_closed)
+                lib.copy_candles.argtypes = [c_int32, c_int32, POINTER(EngineCandle), c_size_t,
+                                             POINTER(c_int64)]
+                lib.copy_candles.restype = c_int64
+
+                # int32_t load_candles(int32_t symbol_id, int32_t timeframe, const EngineCandle* candles, size_t n)
+                lib.load_candles.argtypes = [c_int32, c_int32, POINTER(EngineCandle), c_size_t]
+                lib.load_candles.restype = c_int32
+
+                # int32_t seed_history(const char* symbol, int32_t timeframe, const EngineCandle* candles, size_t n)
+                lib.seed_history.argtypes = [c_char_p, c_int32, POINTER(EngineCandle), c_size_t]
+                lib.seed_history.restype = c_int32
+
+                # int32_t upsert_candle(int32_t symbol_id, int32_t timeframe, const EngineCandle* candle)
+                lib.upsert_candle.argtypes = [c_int32, c_int32, POINTER(EngineCandle)]
+                lib.upsert_candle.restype = c_int32
+
+                # int32_t reset_candles(int32_t symbol_id)
+                lib.reset_candles.argtypes = [c_int32]
+                lib.reset_candles.restype = c_int32
+
+                # int32_t get_indicators(int32_t symbol_id, int32_t timeframe, EngineIndicators* out)
+                lib.get_indicators.argtypes = [c_int32, c_int32, POINTER(EngineIndicators)]
+                lib.get_indicators.restype = c_int32
+
+                # int32_t get_tick_indicators(int32_t symbol_id, EngineIndicators* out)
+                lib.get_tick_indicators.argtypes = [c_int32, POINTER(EngineIndicators)]
+                lib.get_tick_indicators.restype = c_int32
+
+                # int32_t get_structure(int32_t symbol_id, int32_t timeframe, EngineStructure* out)
+                lib.get_structure.argtypes = [c_int32, c_int32, POINTER(EngineStructure)]
+                lib.get_structure.restype = c_int32
+
+                # int32_t get_regime(int32_t symbol_id, EngineRegime* out)
+                lib.get_regime.argtypes = [c_int32, POINTER(EngineRegime)]
+                lib.get_regime.restype = c_int32
+
+                # int32_t get_correlation(int32_t a, int32_t b, double* corr, int32_t* returns)
+                lib.get_correlation.argtypes = [c_int32, c_int32, POINTER(c_double), POINTER(c_int32)]
+                lib.get_correlation.restype = c_int32
+
+                # const char* get_correlations()
+                lib.get_correlations.argtypes = []
+                lib.get_correlations.restype = c_char_p
+
+                # Bulk series kernels over double arrays
+                f64 = POINTER(c_double)
+                lib.series_backend.argtypes = []
+                lib.series_backend.restype = c_char_p
+                lib.series_true_range.argtypes = [f64, f64, f64, c_size_t, f64]
+                lib.series_true_range.restype = c_int32
+                for fn in (lib.series_rolling_min, lib.series_rolling_max):
+                    fn.argtypes = [f64, c_size_t, c_int32, f64]
+                    fn.restype = c_int32
+                lib.series_rolling_mean_std.argtypes = [f64, c_size_t, c_int32, f64, f64]
+                lib.series_rolling_mean_std.restype = c_int32
+                lib.series_swings.argtypes = [f64, f64, c_size_t, c_int32, POINTER(ctypes.c_uint8)]
+                lib.series_swings.restype = c_int32
+                lib.series_atr.argtypes = [f64, f64, f64, c_size_t, c_int32, f64]
+                lib.series_atr.restype = c_int32
+                lib.series_ema.argtypes = [f64, c_size_t, c_int32, f64]
+                lib.series_ema.restype = c_int32
+
+                # const char* execute_trade(const char* params_json)
+                lib.execute_trade.argtypes = [c_char_p]
+                lib.execute_trade.restype = c_char_p
                 
+                # int32_t execute_trade_bin(const EngineTradeRequest* req, EngineTradeDecision* out)
+                lib.execute_trade_bin.argtypes = [POINTER(EngineTradeRequest), POINTER(EngineTradeDecision)]
+                lib.execute_trade_bin.restype = c_int32
+
+                # int64_t execute_trade_accounts(int32_t symbol_id, int32_t direction,
+                #                                const EngineAccountTrade* accounts, size_t n,
+                #                                EngineTradeDecision* out)
+                lib.execute_trade_accounts.argtypes = [c_int32, c_int32, POINTER(EngineAccountTrade),
+                                                       c_size_t, POINTER(EngineTradeDecision)]
+                lib.execute_trade_accounts.restype = c_int64
+
+                # const char* trade_reason_string(int32_t reason) -- static, not freed
+                lib.trade_reason_string.argtypes = [c_int32]
+                lib.trade_reason_string.restype = c_char_p
+
+                # int32_t open_position(const EnginePosition* pos)
+                lib.open_position.argtypes = [POINTER(EnginePosition)]
+                lib.open_position.restype = c_int32
+
+                # int32_t close_position(int32_t symbol_id, int64_t contract_id)
+                lib.close_position.argtypes = [c_int32, c_int64]
+                lib.close_position.restype = c_int32
+
+                # int32_t get_position(int32_t symbol_id, int64_t contract_id, EnginePosition* out)
+                lib.get_position.argtypes = [c_int32, c_int64, POINTER(EnginePosition)]
+                lib.get_position.restype = c_int32
+
+                # int64_t poll_position_updates(int32_t symbol_id, EnginePositionUpdate* out, size_t max)
+                lib.poll_position_updates.argtypes = [c_int32, POINTER(EnginePositionUpdate), c_size_t]
+                lib.poll_position_updates.restype = c_int64
+
+                # int32_t filter_entry(const EngineFilterRequest* req, EngineFilterResult* out)
+                lib.filter_entry.argtypes = [POINTER(EngineFilterRequest), POINTER(EngineFilterResult)]
+                lib.filter_entry.restype = c_int32
+
+                # const char* filter_reason_string(int32_t reason) -- static, not freed
+                lib.filter_reason_string.argtypes = [c_int32]
+                lib.filter_reason_string.restype = c_char_p
+
+                # int32_t set_symbol_strategy(int32_t symbol_id, int32_t kind)
+                lib.set_symbol_strategy.argtypes = [c_int32, c_int32]
+                lib.set_symbol_strategy.restype = c_int32
+
+                # int32_t process_tick_strategy(const EngineTick* tick, int32_t active_trades,
+                #                               EngineTickResult* out, EngineStrategySignal* signal,
+                #                               EngineTradeDecision* decision)
+                lib.process_tick_strategy.argtypes = [POINTER(EngineTick), c_int32,
+                                                      POINTER(EngineTickResult),
+                                                      POINTER(EngineStrategySignal),
+                                                      POINTER(EngineTradeDecision)]
+                lib.process_tick_strategy.restype = c_int32
+
+                # int32_t get_strategy_signal(int32_t symbol_id, EngineStrategySignal* out)
+                lib.get_strategy_signal.argtypes = [c_int32, POINTER(EngineStrategySignal)]
+                lib.get_strategy_signal.restype = c_int32
+
+                # const char* strategy_reason_string(int32_t reason) -- static, not freed
+                lib.strategy_reason_string.argtypes = [c_int32]
+                lib.strategy_reason_string.restype = c_char_p
+
+                # int64_t drain_events(EngineEvent* out, size_t max)
+                lib.drain_events.argtypes = [POINTER(EngineEvent), c_size_t]
+                lib.drain_events.restype = c_int64
+
+                # int32_t backtest_run(const char* symbol, const EngineCandle* candles, size_t n,
+                #                      const EngineBacktestParams* params, EngineBacktestOutput* out)
+                lib.backtest_run.argtypes = [c_char_p, POINTER(EngineCandle), c_size_t,
+                                             POINTER(EngineBacktestParams), POINTER(EngineBacktestOutput)]
+                lib.backtest_run.restype = c_int32
+
+                # int32_t backtest_run_ticks(const char* symbol, const EngineTick* ticks, size_t n,
+                #                            const EngineBacktestParams* params, EngineBacktestOutput* out)
+                lib.backtest_run_ticks.argtypes = [c_char_p, c_void_p, c_size_t,
+                                                   POINTER(EngineBacktestParams), POINTER(EngineBacktestOutput)]
+                lib.backtest_run_ticks.restype = c_int32
+
+                # int32_t backtest_sweep(const char* symbol, const EngineCandle* candles, size_t n,
+                #                        const EngineBacktestParams* grid, size_t n_params,
+                #                        int32_t threads, int32_t rank_by, EngineSweepResult* out)
+                lib.backtest_sweep.argtypes = [c_char_p, POINTER(EngineCandle), c_size_t,
+                                               POINTER(EngineBacktestParams), c_size_t,
+                                               c_int32, c_int32, POINTER(EngineSweepResult)]
+                lib.backtest_sweep.restype = c_int32
+
+                # int32_t backtest_sweep_file(const char* symbol, const char* path, ...same...)
+                lib.backtest_sweep_file.argtypes = [c_char_p, c_char_p,
+                                                    POINTER(EngineBacktestParams), c_size_t,
+                                                    c_int32, c_int32, POINTER(EngineSweepResult)]
+                lib.backtest_sweep_file.restype = c_int32
+
+                # int32_t store_open(const char* root_dir) / void store_close() / int32_t store_flush()
+                lib.store_open.argtypes = [c_char_p]
+                lib.store_open.restype = c_int32
+                lib.store_close.argtypes = []
+                lib.store_close.restype = None
+                lib.store_flush.argtypes = []
+                lib.store_flush.restype = c_int32
+
+                # int64_t store_warm_start(int32_t symbol_id)
+                lib.store_warm_start.argtypes = [c_int32]
+                lib.store_warm_start.restype = c_int64
+
+                # int64_t store_read_candles(const char* symbol, int32_t timeframe, int64_t from_epoch,
+                #                            int64_t to_epoch, EngineCandle* out, size_t max)
+                lib.store_read_candles.argtypes = [c_char_p, c_int32, c_int64, c_int64,
+                                                   POINTER(EngineCandle), c_size_t]
+                lib.store_read_candles.restype = c_int64
+
+                # int64_t store_read_ticks(const char* symbol, int64_t from_epoch, int64_t to_epoch,
+                #                          EngineTick* out, size_t max)
+                lib.store_read_ticks.argtypes = [c_char_p, c_int64, c_int64, POINTER(EngineTick), c_size_t]
+                lib.store_read_ticks.restype = c_int64
+
+                # int32_t backtest_run_store(const char* symbol, int32_t series, int64_t from_epoch,
+                #                            int64_t to_epoch, const EngineBacktestParams* params,
+                #                            EngineBacktestOutput* out)
+                lib.backtest_run_store.argtypes = [c_char_p, c_int32, c_int64, c_int64,
+                                                   POINTER(EngineBacktestParams), POINTER(EngineBacktestOutput)]
+                lib.backtest_run_store.restype = c_int32
+
+                # int32_t feed_start(const char* url, const char* symbols, int32_t ohlc_granularity)
+                lib.feed_start.argtypes = [c_char_p, c_char_p, c_int32]
+                lib.feed_start.restype = c_int32
+                lib.feed_stop.argtypes = []
+                lib.feed_stop.restype = None
+
+                # int64_t feed_poll(EngineTickResult* out, size_t max)
+                lib.feed_poll.argtypes = [POINTER(EngineTickResult), c_size_t]
+                lib.feed_poll.restype = c_int64
+
+                # int32_t feed_stats(EngineFeedStats* out) / const char* feed_last_error()
+                lib.feed_stats.argtypes = [POINTER(EngineFeedStats)]
+                lib.feed_stats.restype = c_int32
+                lib.feed_last_error.argtypes = []
+                lib.feed_last_error.restype = c_char_p
+
+                # int32_t journal_start(const char* path) / int64_t journal_stop()
+                lib.journal_start.argtypes = [c_char_p]
+                lib.journal_start.restype = c_int32
+                lib.journal_stop.argtypes = []
+                lib.journal_stop.restype = c_int64
+
+                # int32_t journal_replay(const char* path, EngineReplayStats* out)
+                lib.journal_replay.argtypes = [c_char_p, POINTER(EngineReplayStats)]
+                lib.journal_replay.restype = c_int32
+
                 # void set_cooldown(int seconds)
-                cls._lib.set_cooldown.argtypes = [c_int]
-                cls._lib.set_cooldown.restype = None
+                lib.set_cooldown.argtypes = [c_int]
+                lib.set_cooldown.restype = None
 
-                # char* get_bot_state()
-                cls._lib.get_bot_state.argtypes = []
-                cls._lib.get_bot_state.restype = c_void_p
+                # void set_bot_state(bool)
+                lib.set_bot_state.argtypes = [ctypes.c_bool]
+                lib.set_bot_state.restype = None
 
-                # void free_result(char* ptr)
-                cls._lib.free_result.argtypes = [c_void_p]
-                cls._lib.free_result.restype = None
-                
+                # const char* get_bot_state()
+                lib.get_bot_state.argtypes = []
+                lib.get_bot_state.restype = c_char_p
+
+                # const char* get_metrics() / void reset_metrics()
+                lib.get_metrics.argtypes = []
+                lib.get_metrics.restype = c_char_p
+                lib.reset_metrics.argtypes = []
+                lib.reset_metrics.restype = None
+
+                # Publish only once fully configured (other threads may be waiting)
+                cls._lib = lib
             except OSError as e:
                 print(f"Error loading C++ library: {e}")
                 raise e
 
-    @classmethod
-    def _ptr_to_str(cls, ptr):
-        """Helper to convert c_void_p to python string and free memory."""
-        if not ptr:
-            return ""
-        try:
-            # Cast to char* to read string
-            cstr = ctypes.cast(ptr, c_char_p)
-            val = cstr.value.decode('utf-8')
-            return val
-        finally:
-            # Always free the C++ allocated memory
-            cls._lib.free_result(ptr)
+    @staticmethod
+    def _result_str(raw) -> str:
+        """Decode a JSON result (already copied out of the engine's buffer)."""
+        return raw.decode('utf-8') if raw else ""
 
     @classmethod
     def init_engine(cls, config_json: str):
-        """Initialize the C++ engine with JSON configuration."""
+        """
+        Initialize the C++ engine with JSON configuration. An optional
+        "memory" object (max_symbols, max_accounts, max_positions, candles
+        per timeframe) sizes the engine's arena; it only takes effect before
+        the first context is created. Usage is in get_metrics()["memory"].
+        """
         cls._load_lib()
         c_config = config_json.encode('utf-8')
         cls._lib.init_engine(c_config)
 
+    @classmethod
+    def update_config(cls, config):
+        """
+        Hot-reload engine limits from a dict or JSON string. Keys the engine
+        does not know are ignored; absent keys keep their live values.
+        """
+        cls._load_lib()
+        if not isinstance(config, str):
+            config = json.dumps(config)
+        cls._lib.update_config(config.encode('utf-8'))
+
+    @classmethod
+    def update_account(cls, balance: float, equity: float, margin_free: float):
+        """Push account figures; stakes above margin_free are then rejected."""
+        cls._load_lib()
+        cls._lib.update_account(balance, equity, margin_free)
+
+    @classmethod
+    def create_account_context(cls, account: str) -> int:
+        """Handle of a mirrored account (e.g. a Deriv login id), or -1."""
+        cls._load_lib()
+        if not account:
+            return -1
+        return cls._lib.create_account_context(account.encode('utf-8'))
+
+    @classmethod
+    def set_account_state(cls, account_id: int, balance: float, equity: float = None,
+                          margin_free: float = None) -> int:
+        """Push one account's figures (equity and margin_free default to the balance)."""
+        cls._load_lib()
+        equity = balance if equity is None else equity
+        margin_free = balance if margin_free is None else margin_free
+        return cls._lib.set_account_state(account_id, balance, equity, margin_free)
+
+    @classmethod
+    def record_account_result(cls, account_id: int, profit: float) -> int:
+        cls._load_lib()
+        return cls._lib.record_account_result(account_id, profit)
+
     @classmethod
     def process_tick(cls, tick_json: str) -> str:
         """Process a tick through the C++ engine (ML logic)."""
         cls._load_lib()
         c_tick = tick_json.encode('utf-8')
-        ptr = cls._lib.process_tick(c_tick)
-        return cls._ptr_to_str(ptr)
+        raw = cls._lib.process_tick(c_tick)
+        return cls._result_str(raw)
+
+    @classmethod
+    def create_symbol_context(cls, symbol: str) -> int:
+        """
+        Get (or create) the engine context handle for a symbol. The handle is
+        the symbol_id used by the binary ABI; each context has its own
+        candles, indicators and trade cooldown.
+        """
+        cls._load_lib()
+        return cls._lib.create_symbol_context(symbol.encode('utf-8'))
+
+    @classmethod
+    def set_symbol_cooldown(cls, symbol_id: int, seconds: float) -> int:
+        """Override the trade cooldown for one symbol context.
+
+        Fractional seconds are kept to the millisecond.
+        """
+        cls._load_lib()
+        return cls._lib.set_symbol_cooldown_ms(symbol_id,
+                                               int(round(seconds * 1000)))
+
+    @classmethod
+    def record_trade_result(cls, symbol_id: int, profit: float) -> int:
+        """Feed a settled contract into the engine's daily-loss and streak limits."""
+        cls._load_lib()
+        return cls._lib.record_trade_result(symbol_id, profit)
+
+    @classmethod
+    def get_recommended_stake(cls, symbol_id: int, balance: float):
+        """Stake from the symbol's native risk policy, or None if unknown."""
+        cls._load_lib()
+        stake = c_double()
+        if cls._lib.get_recommended_stake(symbol_id, balance, ctypes.byref(stake)) != ENGINE_OK:
+            return None
+        return stake.value
+
+    @classmethod
+    def get_policy_stake(cls, symbol: str, balance: float) -> float:
+        """Stake from the native risk policy of a symbol's class, without creating a context."""
+        cls._load_lib()
+        stake = c_double()
+        cls._lib.get_policy_stake(symbol.encode('utf-8'), balance, ctypes.byref(stake))
+        return stake.value
+
+    @classmethod
+    def get_last_quote(cls, symbol_id: int):
+        """Lock-free (price, epoch) of a symbol's last tick, or None if unknown."""
+        cls._load_lib()
+        price = c_double()
+        epoch = c_int64()
+        if cls._lib.get_last_quote(symbol_id, ctypes.byref(price), ctypes.byref(epoch)) != ENGINE_OK:
+            return None
+        return price.value, epoch.value
+
+    @classmethod
+    def process_tick_bin(cls, symbol_id: int, epoch: int, quote: float,
+                         out: EngineTickResult = None) -> EngineTickResult:
+        """
+        Process a tick through the binary ABI (no JSON, no C++ allocation).
+        Pass a reusable `out` struct to avoid allocating one per call.
+        """
+        cls._load_lib()
+        tick = EngineTick(symbol_id, 0, epoch, quote)
+        if out is None:
+            out = EngineTickResult()
+        cls._lib.process_tick_bin(ctypes.byref(tick), ctypes.byref(out))
+        return out
+
+    @classmethod
+    def enable_parallel(cls, workers: int = None):
+        """Switch process_tick_async to a pool of `workers` engine threads."""
+        if cls._pool is not None:
+            cls._pool.shutdown()
+        cls._pool = ParallelTickProcessor(workers)
+
+    @classmethod
+    async def process_tick_async(cls, symbol_id: int, epoch: int, quote: float) -> EngineTickResult:
+        """
+        Process a tick on an engine worker thread without blocking the event
+        loop. Ticks for different symbols run in parallel; ticks for the same
+        symbol keep their order.
+        """
+        if cls._pool is None:
+            cls.enable_parallel()
+        return await cls._pool.process_tick(symbol_id, epoch, quote)
+
+    @staticmethod
+    def make_tick_array(symbol_id: int, epochs, quotes) -> np.ndarray:
+        """Build a TICK_DTYPE array for process_ticks from epoch/quote sequences."""
+        ticks = np.zeros(len(epochs), dtype=TICK_DTYPE)
+        ticks["symbol_id"] = symbol_id
+        ticks["epoch"] = epochs
+        ticks["quote"] = quotes
+        return ticks
+
+    @classmethod
+    def process_ticks(cls, ticks, out=None):
+        """
+        Process a whole batch of ticks in a single engine call.
+
+        `ticks` is either a NumPy array of TICK_DTYPE (passed zero-copy when
+        C-contiguous) or a ctypes array of EngineTick. Results are written to
+        `out` (allocated to match if omitted) and returned with the count of
+        ticks processed OK.
+        """
+        cls._load_lib()
+        if isinstance(ticks, np.ndarray):
+            ticks = np.ascontiguousarray(ticks, dtype=TICK_DTYPE)
+            n = len(ticks)
+            if out is None:
+                out = np.empty(n, dtype=TICK_RESULT_DTYPE)
+            elif len(out) < n or out.dtype != TICK_RESULT_DTYPE or not out.flags["C_CONTIGUOUS"]:
+                raise ValueError("out must be a contiguous TICK_RESULT_DTYPE array of at least len(ticks)")
+            ok = cls._lib.process_ticks(
+                ticks.ctypes.data_as(POINTER(EngineTick)), n,
+                out.ctypes.data_as(POINTER(EngineTickResult)))
+        else:
+            n = len(ticks)
+            if out is None:
+                out = (EngineTickResult * n)()
+            elif len(out) < n:
+                raise ValueError("out must hold at least len(ticks) results")
+            ok = cls._lib.process_ticks(ticks, n, out)
+        return ok, out
+
+    @classmethod
+    def get_candles(cls, symbol_id: int, timeframe: str, copy: bool = False) -> CandleSeries:
+        """
+        Zero-copy view of a symbol's closed candles for a timeframe, or with
+        `copy` a snapshot taken under the context's lock (for symbols another
+        thread applies ticks to, e.g. the native feed; see CandleSeries).
+        """
+        cls._load_lib()
+        tf = TIMEFRAMES[timeframe]
+        view = EngineCandleView()
+        if cls._lib.get_candles(symbol_id, tf, ctypes.byref(view)) != ENGINE_OK:
+            return CandleSeries()
+        if not copy:
+            return CandleSeries(view)
+        buf = (EngineCandle * view.capacity)()
+        total = c_int64()
+        n = cls._lib.copy_candles(symbol_id, tf, buf, len(buf), ctypes.byref(total))
+        if n <= 0:
+            return CandleSeries()
+        return CandleSeries._from_rows(np.ctypeslib.as_array(buf)[:n], total.value)
+
+    @classmethod
+    def load_candles(cls, symbol_id: int, timeframe: str, candles) -> int:
+        """Replace a symbol's closed candles (dicts with open/high/low/close/epoch)."""
+        cls._load_lib()
+        buf = _candle_array(candles)
+        return cls._lib.load_candles(symbol_id, TIMEFRAMES[timeframe], buf, len(buf))
+
+    @classmethod
+    def seed_history(cls, symbol: str, timeframe: str, candles) -> int:
+        """Create/look up a symbol's context and seed one timeframe from closed candles; returns the symbol_id."""
+        cls._load_lib()
+        buf = _candle_array(candles)
+        return cls._lib.seed_history(symbol.encode('utf-8'), TIMEFRAMES[timeframe], buf, len(buf))
+
+    @classmethod
+    def upsert_candle(cls, symbol_id: int, timeframe: str, candle: dict) -> int:
+        """Apply a streaming OHLC update: 1 if it closed a candle, 0 if updated in place, < 0 on error."""
+        cls._load_lib()
+        buf = _candle_array([candle])
+        return cls._lib.upsert_candle(symbol_id, TIMEFRAMES[timeframe], buf)
+
+    @classmethod
+    def reset_candles(cls, symbol_id: int) -> int:
+        """Drop all closed and forming candles for a symbol."""
+        cls._load_lib()
+        return cls._lib.reset_candles(symbol_id)
+
+    @classmethod
+    def store_open(cls, root_dir: str) -> int:
+        """Persist every tick and closed candle under `root_dir` (history store)."""
+        cls._load_lib()
+        return cls._lib.store_open(root_dir.encode('utf-8'))
+
+    @classmethod
+    def store_close(cls):
+        cls._load_lib()
+        cls._lib.store_close()
+
+    @classmethod
+    def store_flush(cls) -> int:
+        cls._load_lib()
+        return cls._lib.store_flush()
+
+    @classmethod
+    def store_warm_start(cls, symbol_id: int) -> int:
+        """Seed a context's candles and indicators from the store; returns candles loaded (< 0 on error)."""
+        cls._load_lib()
+        return cls._lib.store_warm_start(symbol_id)
+
+    @classmethod
+    def store_read_candles(cls, symbol: str, timeframe: str, start: int = 0, end: int = 0) -> list:
+        """Stored candles with start <= epoch <= end (end = 0: all) as dicts, oldest first."""
+        cls._load_lib()
+        c_symbol = symbol.encode('utf-8')
+        tf = TIMEFRAMES[timeframe]
+        n = cls._lib.store_read_candles(c_symbol, tf, start, end, None, 0)
+        if n <= 0:
+            return []
+        buf = (EngineCandle * n)()
+        n = min(n, cls._lib.store_read_candles(c_symbol, tf, start, end, buf, n))
+        return [_struct_dict(c) for c in buf[:n]]
+
+    @classmethod
+    def store_read_ticks(cls, symbol: str, start: int = 0, end: int = 0):
+        """Stored ticks in [start, end] as an EngineTick array (usable as backtest_run ticks)."""
+        cls._load_lib()
+        c_symbol = symbol.encode('utf-8')
+        n = cls._lib.store_read_ticks(c_symbol, start, end, None, 0)
+        if n <= 0:
+            return (EngineTick * 0)()
+        buf = (EngineTick * n)()
+        n = min(n, cls._lib.store_read_ticks(c_symbol, start, end, buf, n))
+        return buf if n == len(buf) else (EngineTick * n).from_buffer_copy(buf)
+
+    @classmethod
+    def feed_start(cls, url: str, symbols, ohlc_granularity: int = 0) -> int:
+        """
+        Start the native market-data feed (engine built with FEED=1): it owns
+        the tick/OHLC subscription socket and applies ticks to the engine
+        off the Python thread. Returns ENGINE_OK or an ENGINE_ERR_* code
+        (ENGINE_ERR_UNSUPPORTED when the feed is not compiled in).
+        """
+        cls._load_lib()
+        return cls._lib.feed_start(url.encode('utf-8'), ",".join(symbols).encode('utf-8'),
+                                   int(ohlc_granularity))
+
+    @classmethod
+    def feed_stop(cls):
+        cls._load_lib()
+        cls._lib.feed_stop()
+
+    @classmethod
+    def feed_poll(cls, out) -> int:
+        """Fill `out` (EngineTickResult array) with results of ticks the feed applied; returns the count."""
+        cls._load_lib()
+        return cls._lib.feed_poll(out, len(out))
+
+    @classmethod
+    def feed_stats(cls) -> dict:
+        cls._load_lib()
+        out = EngineFeedStats()
+        cls._lib.feed_stats(ctypes.byref(out))
+        stats = _struct_dict(out)
+        stats["last_error"] = cls._result_str(cls._lib.feed_last_error())
+        return stats
+
+    @classmethod
+    def journal_start(cls, path: str) -> int:
+        """
+        Record every engine input (after a snapshot of the current state) to
+        `path` for journal_replay. Returns ENGINE_OK or ENGINE_ERR_IO.
+        """
+        cls._load_lib()
+        return cls._lib.journal_start(path.encode('utf-8'))
+
+    @classmethod
+    def journal_stop(cls) -> int:
+        """Stop recording; returns the records written (< 0 if a write failed)."""
+        cls._load_lib()
+        return cls._lib.journal_stop()
+
+    @classmethod
+    def journal_replay(cls, path: str):
+        """
+        Replay a journal through a private engine at full speed, re-making
+        every recorded trade decision. Returns the EngineReplayStats as a
+        dict (mismatches = decisions that came out differently), or None if
+        the file is missing or not a journal.
+        """
+        cls._load_lib()
+        out = EngineReplayStats()
+        if cls._lib.journal_replay(path.encode('utf-8'), ctypes.byref(out)) != ENGINE_OK:
+            return None
+        return _struct_dict(out)
+
+    @classmethod
+    def get_indicators(cls, symbol_id: int, timeframe: str):
+        """O(1) snapshot of a symbol's candle indicators, or None if unknown."""
+        cls._load_lib()
+        out = EngineIndicators()
+        if cls._lib.get_indicators(symbol_id, TIMEFRAMES[timeframe], ctypes.byref(out)) != ENGINE_OK:
+            return None
+        return out
+
+    @classmethod
+    def get_tick_indicators(cls, symbol_id: int):
+        """O(1) snapshot of a symbol's tick-level indicators, or None if unknown."""
+        cls._load_lib()
+        out = EngineIndicators()
+        if cls._lib.get_tick_indicators(symbol_id, ctypes.byref(out)) != ENGINE_OK:
+            return None
+        return out
+
+    @classmethod
+    def get_structure(cls, symbol_id: int, timeframe: str):
+        """O(1) swings / break of structure / fair value gaps of a timeframe, or None if unknown."""
+        cls._load_lib()
+        out = EngineStructure()
+        if cls._lib.get_structure(symbol_id, TIMEFRAMES[timeframe], ctypes.byref(out)) != ENGINE_OK:
+            return None
+        return out
+
+    @classmethod
+    def get_regime(cls, symbol_id: int):
+        """Volatility regime of a symbol's 1m returns, or None if unknown."""
+        cls._load_lib()
+        out = EngineRegime()
+        if cls._lib.get_regime(symbol_id, ctypes.byref(out)) != ENGINE_OK:
+            return None
+        return out
+
+    @classmethod
+    def get_correlation(cls, symbol_a: int, symbol_b: int):
+        """(correlation, common returns) of two symbols' 1m returns, or None."""
+        cls._load_lib()
+        corr = c_double()
+        n = c_int32()
+        if cls._lib.get_correlation(symbol_a, symbol_b, ctypes.byref(corr),
+                                    ctypes.byref(n)) != ENGINE_OK:
+            return None
+        return corr.value, n.value
+
+    @classmethod
+    def get_correlations(cls) -> dict:
+        """Correlation matrix and regimes of every symbol (see engine.hpp)."""
+        cls._load_lib()
+        return json.loads(cls._result_str(cls._lib.get_correlations()))
+
+    # Bulk series kernels (AVX2/NEON): array-likes in, new NumPy arrays out
+
+    @staticmethod
+    def _f64(values) -> np.ndarray:
+        return np.ascontiguousarray(values, dtype=np.float64)
+
+    @staticmethod
+    def _same_len(*columns) -> int:
+        """Common length of OHLC columns; the kernels read n values from each."""
+        n = len(columns[0])
+        if any(len(col) != n for col in columns[1:]):
+            raise ValueError(f"columns must have the same length, got {[len(col) for col in columns]}")
+        return n
+
+    @staticmethod
+    def _ptr(arr: np.ndarray, ctype=c_double):
+        return arr.ctypes.data_as(POINTER(ctype))
+
+    @classmethod
+    def _series_call(cls, fn, *args):
+        status = fn(*args)
+        if status != ENGINE_OK:
+            raise ValueError(f"{fn.__name__} failed ({status})")
+
+    @classmethod
+    def series_backend(cls) -> str:
+        """Instruction set the series kernels use: "avx2", "neon" or "scalar"."""
+        cls._load_lib()
+        return cls._result_str(cls._lib.series_backend())
+
+    @classmethod
+    def series_true_range(cls, highs, lows, closes) -> np.ndarray:
+        cls._load_lib()
+        h, l, c = cls._f64(highs), cls._f64(lows), cls._f64(closes)
+        n = cls._same_len(h, l, c)
+        out = np.empty(n, dtype=np.float64)
+        cls._series_call(cls._lib.series_true_range, cls._ptr(h), cls._ptr(l), cls._ptr(c),
+                         n, cls._ptr(out))
+        return out
+
+    @classmethod
+    def series_rolling_max(cls, values, window: int) -> np.ndarray:
+        cls._load_lib()
+        x = cls._f64(values)
+        out = np.empty(len(x), dtype=np.float64)
+        cls._series_call(cls._lib.series_rolling_max, cls._ptr(x), len(x), window, cls._ptr(out))
+        return out
+
+    @classmethod
+    def series_rolling_min(cls, values, window: int) -> np.ndarray:
+        cls._load_lib()
+        x = cls._f64(values)
+        out = np.empty(len(x), dtype=np.float64)
+        cls._series_call(cls._lib.series_rolling_min, cls._ptr(x), len(x), window, cls._ptr(out))
+        return out
+
+    @classmethod
+    def series_rolling_mean_std(cls, values, window: int):
+        """(mean, population std) over trailing windows; the first window-1 are partial."""
+        cls._load_lib()
+        x = cls._f64(values)
+        mean = np.empty(len(x), dtype=np.float64)
+        std = np.empty(len(x), dtype=np.float64)
+        cls._series_call(cls._lib.series_rolling_mean_std, cls._ptr(x), len(x), window,
+                         cls._ptr(mean), cls._ptr(std))
+        return mean, std
+
+    @classmethod
+    def series_swings(cls, highs, lows, k: int) -> np.ndarray:
+        """uint8 flags per bar: 1 = swing high, 2 = swing low (k bars either side)."""
+        cls._load_lib()
+        h, l = cls._f64(highs), cls._f64(lows)
+        n = cls._same_len(h, l)
+        flags = np.zeros(n, dtype=np.uint8)
+        cls._series_call(cls._lib.series_swings, cls._ptr(h), cls._ptr(l), n, k,
+                         cls._ptr(flags, ctypes.c_uint8))
+        return flags
+
+    @classmethod
+    def series_atr(cls, highs, lows, closes, period: int = 14) -> np.ndarray:
+        cls._load_lib()
+        h, l, c = cls._f64(highs), cls._f64(lows), cls._f64(closes)
+        n = cls._same_len(h, l, c)
+        out = np.empty(n, dtype=np.float64)
+        cls._series_call(cls._lib.series_atr, cls._ptr(h), cls._ptr(l), cls._ptr(c), n,
+                         period, cls._ptr(out))
+        return out
+
+    @classmethod
+    def series_ema(cls, values, period: int) -> np.ndarray:
+        cls._load_lib()
+        x = cls._f64(values)
+        out = np.empty(len(x), dtype=np.float64)
+        cls._series_call(cls._lib.series_ema, cls._ptr(x), len(x), period, cls._ptr(out))
+        return out
 
     @classmethod
     def execute_trade(cls, params_json: str) -> str:
         """Execute/Validate a trade through the C++ engine safety layer."""
         cls._load_lib()
         c_params = params_json.encode('utf-8')
-        ptr = cls._lib.execute_trade(c_params)
-        return cls._ptr_to_str(ptr)
+        raw = cls._lib.execute_trade(c_params)
+        return cls._result_str(raw)
+
+    @classmethod
+    def execute_trade_bin(cls, symbol_id: int, stake: float, active_trades: int = 0,
+                          out: EngineTradeDecision = None) -> EngineTradeDecision:
+        """
+        Allocation-free execute_trade: same checks and cooldown claim, no JSON.
+        out.reason is TRADE_APPROVED or a REJECT_* code with numeric
+        detail/limit; trade_reason_string() gives its text. A stake <= 0 is
+        sized from the symbol's risk policy.
+        """
+        cls._load_lib()
+        if out is None:
+            out = EngineTradeDecision()
+        req = EngineTradeRequest(symbol_id, active_trades, stake)
+        cls._lib.execute_trade_bin(ctypes.byref(req), ctypes.byref(out))
+        return out
+
+    @classmethod
+    def execute_trade_accounts(cls, symbol_id: int, direction: str, orders) -> list:
+        """
+        Check one BUY/SELL signal against several accounts in one call. `orders` are
+        (account_id, active_trades, stake) tuples, a stake <= 0 being sized
+        from the symbol's policy and that account's balance. Returns one
+        EngineTradeDecision per order, in order; the symbol's cooldown is
+        claimed once if any account is approved.
+        """
+        cls._load_lib()
+        n = len(orders)
+        req = (EngineAccountTrade * n)(*[EngineAccountTrade(*o) for o in orders])
+        out = (EngineTradeDecision * n)()
+        side = {"BUY": 1, "SELL": -1}.get(direction.upper(), 0)
+        if cls._lib.execute_trade_accounts(symbol_id, side, req, n, out) < 0:
+            return []
+        return list(out)
+
+    @classmethod
+    def trade_reason_string(cls, reason: int) -> str:
+        cls._load_lib()
+        return cls._lib.trade_reason_string(reason).decode('utf-8')
+
+    @classmethod
+    def open_position(cls, symbol_id: int, contract_id: int, direction: str, entry_price: float,
+                      stop_loss: float = None, take_profit: float = None,
+                      trail_rule: int = TRAIL_BREAK_EVEN) -> int:
+        """
+        Track an open position natively: every tick of the symbol applies
+        `trail_rule` (a TRAIL_* code) to its stop loss and checks the stop
+        and take profit; EngineTickResult.exit_updates then counts the
+        positions to fetch with poll_position_updates(). Re-opening a
+        contract id replaces its levels. Returns ENGINE_OK or an error code.
+        """
+        cls._load_lib()
+        pos = EnginePosition(
+            contract_id=contract_id,
+            symbol_id=symbol_id,
+            side=1 if direction.upper() == "BUY" else -1,
+            trail_rule=trail_rule,
+            entry_price=entry_price,
+            stop_loss=stop_loss or 0.0,
+            take_profit=take_profit or 0.0,
+        )
+        return cls._lib.open_position(ctypes.byref(pos))
+
+    @classmethod
+    def close_position(cls, symbol_id: int, contract_id: int) -> int:
+        cls._load_lib()
+        return cls._lib.close_position(symbol_id, contract_id)
+
+    @classmethod
+    def get_position(cls, symbol_id: int, contract_id: int):
+        """Current (trailed) levels of a tracked position, or None if it is not open."""
+        cls._load_lib()
+        out = EnginePosition()
+        if cls._lib.get_position(symbol_id, contract_id, ctypes.byref(out)) != ENGINE_OK:
+            return None
+        return out
+
+    @classmethod
+    def rearm_position(cls, symbol_id: int, contract_id: int) -> int:
+        """
+        Evaluate the exits of a position that already reported a stop or
+        target hit again from the next tick, keeping its trailed levels
+        (for an exit whose sell failed). Returns ENGINE_OK or an error code.
+        """
+        pos = cls.get_position(symbol_id, contract_id)
+        if pos is None:
+            return ENGINE_ERR_BAD_ARG
+        return cls._lib.open_position(ctypes.byref(pos))
+
+    @classmethod
+    def poll_position_updates(cls, symbol_id: int, max_updates: int = 32) -> list:
+        """
+        Drain the symbol's positions whose exits changed: dicts with
+        contract_id, epoch, events (POSITION_* bits), price, stop_loss and
+        take_profit. A position that hit its stop or target is reported
+        once and stays tracked until close_position().
+        """
+        cls._load_lib()
+        out = (EnginePositionUpdate * max_updates)()
+        n = cls._lib.poll_position_updates(symbol_id, out, max_updates)
+        return [_struct_dict(u) for u in out[:max(n, 0)]]
+
+    @classmethod
+    def filter_entry(cls, symbol_id: int, direction: str, timeframe: str = "1m",
+                     rsi_momentum: bool = None):
+        """
+        Run the configured entry filter pipeline ("entry_filters") on a
+        timeframe of the symbol. `rsi_momentum` is whether RSI moves with
+        `direction` (None = unknown). Returns an EngineFilterResult whose
+        reason is FILTER_PASSED or the FILTER_* code of the rejecting stage
+        (filter_reason_string() gives its text), or None for an unknown symbol.
+        """
+        cls._load_lib()
+        side = 1 if direction.upper() == "BUY" else -1
+        momentum = 0 if rsi_momentum is None else (side if rsi_momentum else -side)
+        req = EngineFilterRequest(symbol_id, TIMEFRAMES[timeframe], side, momentum)
+        out = EngineFilterResult()
+        if cls._lib.filter_entry(ctypes.byref(req), ctypes.byref(out)) < 0:
+            return None
+        return out
+
+    @classmethod
+    def filter_reason_string(cls, reason: int) -> str:
+        cls._load_lib()
+        return cls._lib.filter_reason_string(reason).decode('utf-8')
+
+    @classmethod
+    def set_symbol_strategy(cls, symbol_id: int, kind: int) -> int:
+        """
+        Replace a symbol's native strategy (a STRATEGY_* kind; the default
+        comes from the symbol name as in STRATEGY_MAP). Returns ENGINE_OK or
+        an error code.
+        """
+        cls._load_lib()
+        return cls._lib.set_symbol_strategy(symbol_id, kind)
+
+    @classmethod
+    def process_tick_strategy(cls, symbol_id: int, epoch: int, quote: float,
+                              active_trades: int = 0, out: EngineTickResult = None,
+                              signal: EngineStrategySignal = None,
+                              decision: EngineTradeDecision = None):
+        """
+        One native pass from tick to trade decision: process_tick_bin, then
+        the symbol's strategy at the new price and, if it enters, the
+        execute_trade_bin checks for its direction (stake from the risk
+        policy). Returns (out, signal, decision); decision is None unless
+        signal.direction is set. Pass reusable structs to avoid allocating.
+        """
+        cls._load_lib()
+        tick = EngineTick(symbol_id, 0, epoch, quote)
+        out = out if out is not None else EngineTickResult()
+        signal = signal if signal is not None else EngineStrategySignal()
+        decision = decision if decision is not None else EngineTradeDecision()
+        cls._lib.process_tick_strategy(ctypes.byref(tick), active_trades,
+                                       ctypes.byref(out), ctypes.byref(signal),
+                                       ctypes.byref(decision))
+        return out, signal, decision if signal.direction else None
+
+    @classmethod
+    def get_strategy_signal(cls, symbol_id: int):
+        """The symbol's last strategy evaluation, or None if unknown."""
+        cls._load_lib()
+        out = EngineStrategySignal()
+        if cls._lib.get_strategy_signal(symbol_id, ctypes.byref(out)) != ENGINE_OK:
+            return None
+        return out
+
+    @classmethod
+    def strategy_reason_string(cls, reason: int) -> str:
+        cls._load_lib()
+        return cls._lib.strategy_reason_string(reason).decode('utf-8')
         
+    @classmethod
+    def drain_events(cls, out) -> int:
+        """Fill `out` (EngineEvent array) with the engine's pending events, oldest first; returns the count."""
+        cls._load_lib()
+        return cls._lib.drain_events(out, len(out))
+
+    @classmethod
+    def backtest_run(cls, symbol: str, candles=None, ticks=None, **params) -> dict:
+        """
+        Replay history through the native pipeline (live indicators, signal,
+        risk policy, trade checks and cooldown) against a simulated account.
+
+        Pass either `candles` (dicts, closed bars of `timeframe`) or `ticks`
+        (TICK_DTYPE array or ctypes EngineTick array); `params` override
+        BACKTEST_DEFAULTS. Returns {"trades": [...], "equity": [...],
+        "stats": {...}}; engine state is left untouched. stake_fraction <= 0
+        sizes from the risk policy and cooldown_seconds < 0 uses the live
+        cooldown.
+        """
+        cls._load_lib()
+        params = _backtest_params(**params)
+        if ticks is not None:
+            if isinstance(ticks, np.ndarray):
+                ticks = np.ascontiguousarray(ticks, dtype=TICK_DTYPE)
+                data = ticks.ctypes.data_as(c_void_p)
+            else:
+                data = ctypes.cast(ticks, c_void_p)
+            n = len(ticks)
+        else:
+            data = _candle_array(candles or [])
+            n = len(data)
+
+        trades, equity, out = _backtest_output(n, params)
+        c_symbol = symbol.encode('utf-8')
+        if ticks is not None:
+            status = cls._lib.backtest_run_ticks(c_symbol, data, n, ctypes.byref(params), ctypes.byref(out))
+        else:
+            status = cls._lib.backtest_run(c_symbol, data, n, ctypes.byref(params), ctypes.byref(out))
+        if status != ENGINE_OK:
+            raise ValueError(f"backtest_run failed ({status})")
+        return _backtest_result(trades, equity, out)
+
+    @classmethod
+    def backtest_run_store(cls, symbol: str, series: str = None, start: int = 0, end: int = 0,
+                           **params) -> dict:
+        """
+        backtest_run over the history store (see store_open), replayed
+        straight from the mapped files. `series` is "ticks" or a timeframe
+        name and defaults to the params' timeframe; `start`/`end` bound the
+        epochs (end = 0: through the newest row).
+        """
+        cls._load_lib()
+        params = _backtest_params(**params)
+        if series is None:
+            series = next(k for k, v in TIMEFRAMES.items() if v == params.timeframe)
+        c_symbol = symbol.encode('utf-8')
+        if series == "ticks":
+            n = cls._lib.store_read_ticks(c_symbol, start, end, None, 0)
+        else:
+            n = cls._lib.store_read_candles(c_symbol, TIMEFRAMES[series], start, end, None, 0)
+        if n < 0:
+            raise ValueError(f"backtest_run_store failed ({n})")
+
+        trades, equity, out = _backtest_output(n, params)
+        status = cls._lib.backtest_run_store(c_symbol, STORE_SERIES[series], start, end,
+                                             ctypes.byref(params), ctypes.byref(out))
+        if status != ENGINE_OK:
+            raise ValueError(f"backtest_run_store failed ({status})")
+        return _backtest_result(trades, equity, out)
+
+    @staticmethod
+    def write_candle_file(path: str, candles) -> int:
+        """Write candle dicts as raw EngineCandle records for backtest_sweep(path=...)."""
+        buf = _candle_array(candles)
+        with open(path, "wb") as f:
+            f.write(bytes(buf))
+        return len(buf)
+
+    @classmethod
+    def backtest_sweep(cls, symbol: str, grid: dict, candles=None, path: str = None,
+                       threads: int = 0, rank_by: str = "total_pnl", **base) -> list:
+        """
+        Backtest every combination of `grid` (parameter name -> list of
+        values, e.g. {"rsi_overbought": [56, 62], "cooldown_seconds": [30, 60]})
+        on top of `base`, in parallel across `threads` cores (0 = all).
+
+        Data is either `candles` (dicts, shared in memory by all workers) or
+        `path`, a write_candle_file() file mapped read-only. Returns one row
+        per combination, best first: {"params": {...}, "score", "stats"}.
+        """
+        cls._load_lib()
+        names = list(grid)
+        combos = [dict(base, **dict(zip(names, values)))
+                  for values in itertools.product(*(grid[k] for k in names))]
+        params = (EngineBacktestParams * len(combos))(*[_backtest_params(**c) for c in combos])
+        out = (EngineSweepResult * len(combos))()
+        c_symbol = symbol.encode('utf-8')
+        if path is not None:
+            status = cls._lib.backtest_sweep_file(c_symbol, path.encode('utf-8'), params, len(combos),
+                                                  threads, SWEEP_RANKS[rank_by], out)
+        else:
+            data = _candle_array(candles or [])
+            status = cls._lib.backtest_sweep(c_symbol, data, len(data), params, len(combos),
+                                             threads, SWEEP_RANKS[rank_by], out)
+        if status != ENGINE_OK:
+            raise ValueError(f"backtest_sweep failed ({status})")
+        return [{"params": combos[r.index], "score": r.score, "stats": _struct_dict(r.stats)}
+                for r in out]
+
     @classmethod
     def set_cooldown(cls, seconds: int):
         """Update cooldown timer dynamically."""
@@ -89,9 +1772,6 @@ class EngineWrapper:
     def set_bot_state(cls, state: bool):
         """Enable/Disable the bot."""
         cls._load_lib()
-        # void set_bot_state(bool)
-        cls._lib.set_bot_state.argtypes = [ctypes.c_bool]
-        cls._lib.set_bot_state.restype = None
         cls._lib.set_bot_state(state)
 
     @classmethod
@@ -99,6 +1779,17 @@ class EngineWrapper:
         """Get bot running state and uptime."""
         cls._load_lib()
         
-        ptr = cls._lib.get_bot_state()
-        json_str = cls._ptr_to_str(ptr)
+        raw = cls._lib.get_bot_state()
+        json_str = cls._result_str(raw)
         return json.loads(json_str)
+
+    @classmethod
+    def get_metrics(cls) -> dict:
+        """Engine latency histograms (p50/p99/p999 per stage, export and symbol) and counters."""
+        cls._load_lib()
+        return json.loads(cls._result_str(cls._lib.get_metrics()))
+
+    @classmethod
+    def reset_metrics(cls):
+        cls._load_lib()
+        cls._lib.reset_metrics()
@@ -7,6 +7,8 @@ from typing import Dict, List, Tuple
 from datetime import datetime
 import logging
 
+from app.core.engine_wrapper import EngineWrapper
+
 logger = logging.getLogger(__name__)
 
 
@@ -77,6 +79,10 @@ class RiskGuard:
             
         return True, "OK"
     
+    def _policy_stake(self, symbol: str, account_balance: float) -> float:
+        """Stake from the C++ engine's per-symbol-class risk policy."""
+        return EngineWrapper.get_policy_stake(symbol, account_balance)
+
     def calculate_v10_stake(self, account_balance: float) -> float:
         """
         Calculate optimal stake size for V10 trading based on account balance.
@@ -85,14 +91,9 @@ class RiskGuard:
             account_balance: Current account balance
             
         Returns:
-            Recommended stake size
+            Recommended stake size (0.5 / 1.0 / 1.5 for <20, 20-50, >50)
         """
-        if account_balance < 20:
-            return 0.5
-        elif account_balance <= 50:
-            return 1.0
-        else:
-            return 1.5
+        return self._policy_stake("R_10", account_balance)
     
     def calculate_boom300_stake(self, account_balance: float) -> float:
         """
@@ -102,14 +103,9 @@ class RiskGuard:
             account_balance: Current account balance
             
         Returns:
-            Recommended stake size
+            Recommended stake size (0.35 / 0.70 / 1.2 for <20, 20-50, >50)
         """
-        if account_balance < 20:
-            return 0.35
-        elif account_balance <= 50:
-            return 0.70  # Mid-range between 0.5-1.0
-        else:
-            return 1.2
+        return self._policy_stake("BOOM300N", account_balance)
     
     def calculate_crash300_stake(self, account_balance: float) -> float:
         """
@@ -121,7 +117,7 @@ class RiskGuard:
         Returns:
             Recommended stake size
         """
-        return self.calculate_boom300_stake(account_balance)
+        return self._policy_stake("CRASH300N", account_balance)
     
     def record_trade_result(self, result: str):
         """Record trade outcome ('win' or 'loss')."""
@@ -1,4 +1,5 @@
 import asyncio
+import os
 import time
 import json
 import websockets
@@ -6,9 +7,14 @@ import logging
 import numpy as np
 import uuid
 from typing import Callable, Optional, Dict, Any, List
-from collections import defaultdict, deque
+from collections import defaultdict
 from datetime import datetime
-from app.core.engine_wrapper import EngineWrapper
+from app.core.engine_wrapper import (
+    EngineWrapper, EngineTickResult, EngineEvent, ENGINE_OK, TRAIL_BREAK_EVEN,
+    POSITION_STOP_MOVED, POSITION_STOP_HIT, EVENT_NAMES, EVENT_ENTRY_SKIPPED,
+    EVENT_TRADE_REJECTED, EVENT_STRATEGY_ENTRY, STRATEGY_NAMES, TRADE_APPROVED,
+    REJECT_UNKNOWN_SYMBOL,
+)
 from app.services.trade_manager import TradeManager
 from app.services.stream_manager import stream_manager
 from app.signals.market_structure import MarketStructure
@@ -24,6 +30,9 @@ from app.risk.cooldown_manager import CooldownManager
 from app.strategies.master_engine import MasterEngine
 from app.strategies.strategy_manager import StrategyManager
 
+# Default root of the native tick/candle history store
+MARKET_STORE_DIR = os.path.join(os.path.dirname(__file__), "..", "..", "data", "market_store")
+
 class SymbolProcessor:
     """Manages the full analysis stack for a single symbol."""
     def __init__(self, symbol: str, config: Dict[str, Any] = None):
@@ -93,6 +102,20 @@ class DerivConnector:
         ]
         self.active_requests: Dict[str, asyncio.Future] = {} 
         self.listen_task: Optional[asyncio.Task] = None
+
+        # Native feed (DERIV_NATIVE_FEED=1): the engine owns the tick/1h
+        # subscriptions and Python drains the results it produced
+        self.native_feed = os.getenv("DERIV_NATIVE_FEED", "0") == "1"
+        self.feed_task: Optional[asyncio.Task] = None
+        self.feed_symbols: Dict[int, str] = {}
+        # Fans the engine's event ring out to stream clients
+        self.events_task: Optional[asyncio.Task] = None
+        # Per symbol, what the UI shows with the engine's last decision on
+        # it (tick_count, atr, confidence, regime, volatility)
+        self.signal_context: Dict[str, Dict[str, Any]] = {}
+        # Engine account contexts by login id; with more than one, every
+        # signal is checked against all of them in one engine call
+        self.engine_accounts: Dict[str, int] = {}
         
         self.active_account_id = None
         # Account Data
@@ -153,8 +176,9 @@ class DerivConnector:
         # Local Contract Memory (SL/TP Tracking)
         self.contract_metadata: Dict[str, Dict] = {}
         
-        # Multi-Timeframe Storage (1H Candles)
-        self.candles_1h: Dict[str, deque] = {}
+        # Multi-Timeframe (1H) subscriptions: symbol -> engine context.
+        # The candles themselves live in the native engine.
+        self.candles_1h: Dict[str, int] = {}
         
         # Performance & Rate Limit Guards
         self.contracts_cache: Dict[str, Dict] = {} # {symbol: {"data": [...], "timestamp": float}}
@@ -171,6 +195,25 @@ class DerivConnector:
         except Exception as e:
             logger.error(f"Failed to init C++ Engine: {e}")
 
+        # Persist ticks/candles natively so restarts warm up from disk
+        try:
+            store_dir = os.getenv("MARKET_STORE_DIR", MARKET_STORE_DIR)
+            if EngineWrapper.store_open(store_dir) != 0:
+                logger.warning(f"Market history store unavailable at {store_dir}")
+        except Exception as e:
+            logger.error(f"Failed to open market history store: {e}")
+
+        # Opt-in input journal, replayable offline with EngineWrapper.journal_replay
+        journal_path = os.getenv("ENGINE_JOURNAL")
+        if journal_path:
+            try:
+                if EngineWrapper.journal_start(journal_path) != 0:
+                    logger.warning(f"Engine journal unavailable at {journal_path}")
+                else:
+                    logger.info(f"Recording engine inputs to {journal_path}")
+            except Exception as e:
+                logger.error(f"Failed to start engine journal: {e}")
+
         # Default Config
         self.default_config = {
             "grid_size": 10,
@@ -232,6 +275,8 @@ class DerivConnector:
                 if self.listen_task:
                     self.listen_task.cancel()
                 self.listen_task = asyncio.create_task(self.listen())
+                if not self.events_task or self.events_task.done():
+                    self.events_task = asyncio.create_task(self.pump_engine_events())
                 
                 # Non-blocking initialization
                 asyncio.create_task(self.initialize_session())
@@ -274,9 +319,13 @@ class DerivConnector:
                 "source": "System"
             })
             
-            await asyncio.gather(
+            native = self.native_feed and self.start_native_feed()
+            market_data = [] if native else [
                 self.subscribe_ticks(),
                 self.subscribe_candles_1h(), # MTF Sub
+            ]
+            await asyncio.gather(
+                *market_data,
                 self.subscribe_balance(),
                 self.subscribe_portfolio(),
                 self.subscribe_contracts(),
@@ -284,12 +333,13 @@ class DerivConnector:
             )
             logger.info("Session initialization complete")
             
-            # Bootstrap Engine with Default Config
+            # Re-apply the settings: the engine was initialised at startup, and
+            # re-initialising would drop hot-reloaded state on every reconnect
             try:
-                EngineWrapper.init_engine(json.dumps(self.default_config))
-                logger.info("Trading Engine Initialized with Default Config")
+                EngineWrapper.update_config(self.default_config)
+                logger.info("Trading Engine Config Re-applied")
             except Exception as e:
-                logger.error(f"Failed to initialize trading engine: {e}")
+                logger.error(f"Failed to configure trading engine: {e}")
                 
         except Exception as e:
             logger.error(f"Session initialization failed: {e}")
@@ -348,6 +398,7 @@ class DerivConnector:
                         else:
                              acc_type = "real"
 
+                        self.register_engine_account(acc_id)
                         self.available_accounts.append({
                             "id": acc_id,
                             "name": f"Deriv {acc.get('currency')} {acc_type.capitalize()}",
@@ -410,6 +461,96 @@ class DerivConnector:
             await self.ws.send(json.dumps(req))
             logger.info(f"Subscribed to tick feed: {symbol}")
 
+    def start_native_feed(self) -> bool:
+        """Hand the tick and 1H candle subscriptions to the native feed; False to fall back."""
+        if self.feed_task and not self.feed_task.done():
+            return True  # survives Python-side reconnects
+        url = f"{DERIV_WS_BASE_URL}?app_id={self.app_id}"
+        status = EngineWrapper.feed_start(url, self.active_symbols, 3600)
+        if status != ENGINE_OK:
+            logger.warning(f"Native feed unavailable ({status}); using the Python tick stream")
+            return False
+        self.feed_symbols = {
+            EngineWrapper.create_symbol_context(s): s for s in self.active_symbols
+        }
+        self.feed_task = asyncio.create_task(self.consume_native_feed())
+        logger.info(f"Native feed started for {len(self.active_symbols)} symbols")
+        return True
+
+    async def consume_native_feed(self):
+        """Drain ticks the native feed already applied to the engine and run the Python analysis on them."""
+        out = (EngineTickResult * 1024)()
+        while True:
+            n = EngineWrapper.feed_poll(out)
+            for r in out[:n]:
+                symbol = self.feed_symbols.get(r.symbol_id)
+                if symbol:
+                    await self.handle_tick({"symbol": symbol, "quote": r.price, "epoch": r.epoch},
+                                           engine_fed=True, result=r)
+            if n < len(out):
+                await asyncio.sleep(0.02)
+
+    async def pump_engine_events(self):
+        """Broadcast the engine's signals and decisions in batches, so slow stream clients never hold up ticks."""
+        out = (EngineEvent * 256)()
+        while True:
+            n = EngineWrapper.drain_events(out)
+            if n:
+                names = {p.engine.symbol_id: s for s, p in self.processors.items()}
+                names.update(self.feed_symbols)
+                accounts = {a: login for login, a in self.engine_accounts.items()}
+                active = self.current_account.get('id')
+                batch = [self.describe_engine_event(e, names, accounts) for e in out[:n]]
+                await stream_manager.broadcast_event('engine_events', batch)
+                for e in batch:
+                    # Mirrored accounts' rejections stay in engine_events;
+                    # execute_order reports the ones without a symbol
+                    if (e["type"] == EVENT_NAMES[EVENT_TRADE_REJECTED] and e["symbol"]
+                            and e["account"] in (None, active)):
+                        await stream_manager.broadcast_skipped_signal({
+                            **self.signal_context.get(e["symbol"], {}),
+                            "reason": f"Safety Layer: {e['reason']}",
+                            "reject_code": e["code"],
+                            "symbol": e["symbol"],
+                            "timestamp": e["timestamp"]
+                        })
+            if n < len(out):
+                await asyncio.sleep(0.05)
+
+    def remember_signal_context(self, symbol: str, confidence, market_mode) -> dict:
+        """Record the context of a signal about to be decided, for its skip payload."""
+        p = self.processors.get(symbol)
+        context = {
+            "tick_count": p.tick_count if p else 0,
+            "atr": p.engine.get_atr("1m") if p else 0,
+            "confidence": confidence,
+            "regime": market_mode,
+            "volatility": p.engine.get_volatility("1m") if p else "N/A"
+        }
+        self.signal_context[symbol] = context
+        return context
+
+    @staticmethod
+    def describe_engine_event(e, names: Dict[int, str], accounts: Dict[int, str]) -> dict:
+        event = {
+            "seq": e.seq,
+            "type": EVENT_NAMES[e.type] if 0 <= e.type < len(EVENT_NAMES) else str(e.type),
+            "symbol": names.get(e.symbol_id),
+            "account": accounts.get(e.account_id),
+            "code": e.code,
+            "direction": {1: "BUY", -1: "SELL"}.get(e.direction),
+            "value": e.value,
+            "limit": e.limit,
+            "timestamp": datetime.fromtimestamp(e.time_ms / 1000).isoformat()
+        }
+        if e.type == EVENT_TRADE_REJECTED:
+            event["reason"] = EngineWrapper.trade_reason_string(e.code)
+        elif e.type == EVENT_ENTRY_SKIPPED:
+            event["reason"] = EngineWrapper.filter_reason_string(e.code)
+        elif e.type == EVENT_STRATEGY_ENTRY:
+            event["strategy"] = STRATEGY_NAMES[e.code] if 0 <= e.code < len(STRATEGY_NAMES) else str(e.code)
+        return event
+
     async def subscribe_balance(self):
         if not self.ws: return
         req = {"balance": 1, "subscribe": 1}
@@ -433,10 +574,6 @@ class DerivConnector:
     async def subscribe_candles_1h(self):
         """Subscribe to 1-Hour candles for active symbols for MTF analysis."""
         for symbol in self.active_symbols:
-            # Initialize storage
-            if symbol not in self.candles_1h:
-                self.candles_1h[symbol] = deque(maxlen=20)
-                
             logger.info(f"Subscribing to 1H candles: {symbol}")
             req = {
                 "ticks_history": symbol,
@@ -446,7 +583,25 @@ class DerivConnector:
                 "count": 20,
                 "subscribe": 1
             }
-            await self.send_request(req)
+            resp = await self.send_request(req)
+
+            # Seed the closed bars in one native call; the last one is still
+            # forming and is kept current by the ohlc stream (upsert_candle)
+            history = [
+                {
+                    "epoch": int(c['epoch']),
+                    "open": float(c['open']),
+                    "high": float(c['high']),
+                    "low": float(c['low']),
+                    "close": float(c['close'])
+                }
+                for c in resp.get('candles', [])
+            ]
+            symbol_id = EngineWrapper.seed_history(symbol, "1h", history[:-1])
+            if symbol_id >= 0:
+                self.candles_1h[symbol] = symbol_id
+                if history:
+                    EngineWrapper.upsert_candle(symbol_id, "1h", history[-1])
 
     async def get_active_symbols(self):
         """Fetches active symbols from Deriv if not already cached/set."""
@@ -571,15 +726,8 @@ class DerivConnector:
                             "close": float(c_data['close']),
                             "epoch": int(c_data['open_time'])
                         }
-                        # Deque update logic
-                        q = self.candles_1h[symbol]
-                        if not q: q.append(candle)
-                        elif q[-1]['epoch'] == candle['epoch']: q[-1] = candle
-                        else: q.append(candle)
-                        
-                        # Sync with Engine
-                        if symbol in self.processors:
-                             self.processors[symbol].engine.inject_external_candles("1h", list(q))
+                        # In-place native update (closes the bar on rollover)
+                        EngineWrapper.upsert_candle(self.candles_1h[symbol], "1h", candle)
                 
                 if 'balance' in data:
                      asyncio.create_task(self.handle_balance(data['balance']))
@@ -603,7 +751,7 @@ class DerivConnector:
                     asyncio.create_task(self.connect())
                     break
 
-    async def handle_tick(self, tick):
+    async def handle_tick(self, tick, engine_fed: bool = False, result: EngineTickResult = None):
         symbol = tick['symbol']
         bid = tick['quote']
         epoch = tick['epoch']
@@ -629,7 +777,12 @@ class DerivConnector:
         p.tick_count += 1
 
         # 1. Update Engine (Universal)
-        p.engine.update_tick(symbol, float(bid), epoch)
+        p.engine.update_tick(symbol, float(bid), epoch, engine_fed=engine_fed, result=result)
+
+        # Trailing stops and SL/TP hits of natively tracked positions were
+        # evaluated inside the tick call; act only on the ones that changed
+        if p.engine.exit_updates:
+            self.apply_native_exits(p.engine.symbol_id)
 
         # 2. Synchronize MTF Indicators (Only on candle close to preserve momentum slope)
         current_counts = {
@@ -655,7 +808,7 @@ class DerivConnector:
             "epoch": epoch
         }
         indicator_data = p.indicator_layer.analyze(tick_for_algo, engine=p.engine)
-        structure_data = p.market_structure.analyze(tick_for_algo)
+        structure_data = p.market_structure.analyze(tick_for_algo, engine=p.engine)
 
         if symbol not in self.enabled_symbols:
             return
@@ -669,8 +822,7 @@ class DerivConnector:
             
             async with lock:
                 # 4. Strategy Analysis
-                candles_1m_list = list(p.engine.candles_1m)
-                market_mode = p.engine.detect_market_mode(candles_1m_list)
+                market_mode = p.engine.detect_market_mode(p.engine.candles_1m)
                 
                 # Run strategy
                 strategy_signal = p.strategy_manager.run_strategy(
@@ -696,6 +848,7 @@ class DerivConnector:
                         await stream_manager.broadcast_skipped_signal({
                             "tick_count": p.tick_count,
                             "reason": strategy_signal['reason'],
+                            "filter_code": strategy_signal.get('filter_code'),
                             "symbol": symbol,
                             "atr": p.engine.get_atr("1m"),
                             "confidence": final_confidence,
@@ -780,6 +933,7 @@ class DerivConnector:
                     "active_strategy": strategy_info.get("name", "Unknown"),
                     "tick_count": p.tick_count,
                     "spike_counter": p.engine.memory.get("spike_counter", 0),
+                    "ticks_since_spike": p.engine.ticks_since_spike,
                     "cooldown": int(self.cooldown_manager.get_remaining_seconds())
                 })
 
@@ -807,6 +961,7 @@ class DerivConnector:
             strategy_info = p.strategy_manager.get_active_strategy_info() if p else {"name": "V10_V75_Scalper"}
             
             # 1. C++ Engine Validation
+            context = self.remember_signal_context(symbol, confidence, market_mode)
             trade_params = {
                 "symbol": symbol,
                 "action": action,
@@ -814,24 +969,26 @@ class DerivConnector:
                 "active_trades": len(self.open_positions)
             }
             
-            execution_result_json = EngineWrapper.execute_trade(json.dumps(trade_params))
-            result = json.loads(execution_result_json)
+            if len(self.engine_accounts) > 1 and self.current_account.get('id') in self.engine_accounts:
+                result = self.validate_across_accounts(symbol, action, stake)
+            else:
+                result = json.loads(EngineWrapper.execute_trade(json.dumps(trade_params)))
             
             if result.get("status") != "approved":
-                reason = result.get('reason', 'C++ Engine Blocked')
+                reason = result.get('reason') or result.get('message', 'C++ Engine Blocked')
                 logger.warning(f"C++ Engine Blocked {symbol} {action}: {reason}")
-                
-                # Broadcast for UI transparency
-                await stream_manager.broadcast_skipped_signal({
-                    "tick_count": p.tick_count if p else 0,
-                    "reason": f"Safety Layer: {reason}",
-                    "symbol": symbol,
-                    "atr": p.engine.get_atr("1m") if p else 0,
-                    "confidence": confidence,
-                    "regime": market_mode,
-                    "volatility": "N/A",
-                    "timestamp": datetime.now().isoformat()
-                })
+
+                # pump_engine_events shows the engine's rejections; a call
+                # that errored posted none, one for an unknown symbol has
+                # no symbol to show
+                if result.get("status") == "error" or result.get("reason_code") == REJECT_UNKNOWN_SYMBOL:
+                    await stream_manager.broadcast_skipped_signal({
+                        **context,
+                        "reason": f"Safety Layer: {reason}",
+                        "reject_code": result.get("reason_code"),
+                        "symbol": symbol,
+                        "timestamp": datetime.now().isoformat()
+                    })
                 return
 
             # 2. metadata for tracking & isolation
@@ -1113,6 +1270,75 @@ class DerivConnector:
                 logger.error(traceback.format_exc())
                 return {"status": "error", "message": str(e)}
 
+    def register_engine_account(self, login_id: str) -> int:
+        """Engine handle for a Deriv account, created on first sight (-1 if none)."""
+        if not login_id:
+            return -1
+        if login_id not in self.engine_accounts:
+            account_id = EngineWrapper.create_account_context(login_id)
+            if account_id < 0:
+                return -1
+            self.engine_accounts[login_id] = account_id
+        return self.engine_accounts[login_id]
+
+    def validate_across_accounts(self, symbol: str, action: str, stake: float) -> dict:
+        """
+        Check a signal against the active account and every mirrored one in
+        one engine call; the active account's decision gates the order and
+        the others reach the UI through the engine's events.
+        """
+        active = self.engine_accounts[self.current_account.get('id')]
+        orders = [(active, len(self.open_positions), stake)]
+        orders += [(a, 0, stake) for a in self.engine_accounts.values() if a != active]
+        symbol_id = EngineWrapper.create_symbol_context(symbol)
+        decisions = EngineWrapper.execute_trade_accounts(symbol_id, action, orders)
+        if not decisions:
+            return {"status": "error", "reason": "Unknown symbol"}
+        d = decisions[0]
+        if d.reason != TRADE_APPROVED:
+            return {"status": "rejected", "reason_code": d.reason,
+                    "reason": EngineWrapper.trade_reason_string(d.reason)}
+        return {"status": "approved", "stake": d.stake}
+
+    def apply_native_exits(self, symbol_id: int):
+        """Apply the engine's trailed stops and start exits for positions that hit SL/TP."""
+        for update in EngineWrapper.poll_position_updates(symbol_id):
+            cid = str(update["contract_id"])
+            meta = self.contract_metadata.get(cid)
+            if meta and update["events"] & POSITION_STOP_MOVED:
+                logger.info(f"Trailing SL Update for {cid}: {meta.get('stop_loss')} -> {update['stop_loss']}")
+                meta['stop_loss'] = update["stop_loss"]
+            if update["events"] & ~POSITION_STOP_MOVED:
+                exit_reason = ("Stop Loss Hit (Local)" if update["events"] & POSITION_STOP_HIT
+                               else "Take Profit Hit (Local)")
+                logger.warning(f"Triggering Local Exit for {cid}: {exit_reason}")
+                asyncio.create_task(self.sell_native_exit(symbol_id, cid, exit_reason))
+
+    async def sell_native_exit(self, symbol_id: int, cid: str, reason: str):
+        """Sell a position whose native SL/TP hit; re-arm its exits if the sell fails so a later tick retries it."""
+        ok, err = await self.sell_contract(cid, reason)
+        if not ok and cid in self.contract_metadata:
+            logger.warning(f"Local Exit for {cid} failed ({err}); re-arming native SL/TP")
+            EngineWrapper.rearm_position(symbol_id, int(cid))
+
+    def track_native_position(self, cid: str, meta: dict, entry_price: float, symbol: str):
+        """Hand a contract's SL/TP and trailing to the engine once its entry price is known."""
+        p = self.processors.get(symbol)
+        if not p or p.engine.symbol_id < 0 or not meta.get('action') or not cid.isdigit():
+            return
+        status = EngineWrapper.open_position(
+            p.engine.symbol_id, int(cid), meta['action'], entry_price,
+            meta.get('stop_loss'), meta.get('take_profit'), TRAIL_BREAK_EVEN
+        )
+        if status == ENGINE_OK:
+            meta["native_symbol_id"] = p.engine.symbol_id
+
+    def forget_contract(self, cid: str):
+        """Drop a contract's metadata and stop tracking it natively."""
+        meta = self.contract_metadata.pop(cid, None)
+        if meta and meta.get("native_symbol_id") is not None:
+            EngineWrapper.close_position(meta["native_symbol_id"], int(cid))
+
     async def monitor_positions_for_sl_tp(self, current_price: float, symbol: str, 
                                           momentum_up: bool = None, momentum_down: bool = None, 
                                           slope_value: float = 0.0, volatility_state: str = None):
@@ -1166,7 +1392,7 @@ class DerivConnector:
             # --- SCALPER EXTRA EXITS ---
             if not should_close and p:
                 # 1. Check for Scalper Exit (RSI Flip, Micro Reversal, etc.)
-                candles = list(p.engine.candles_1m)
+                candles = p.engine.candles_1m
                 current_candle = candles[-1] if candles else None
                 
                 # Use ISOLATED monitors from metadata
@@ -1224,8 +1450,7 @@ class DerivConnector:
         
         # Remove closed contracts from metadata
         for cid in closed_contracts:
-            if cid in self.contract_metadata:
-                del self.contract_metadata[cid]
+            self.forget_contract(cid)
 
 
     async def handle_balance(self, balance_data):
@@ -1266,6 +1491,9 @@ class DerivConnector:
         # Sync Engine
         try:
             EngineWrapper.update_account(balance, balance, balance)
+            account_id = self.register_engine_account(login_id or self.current_account.get('id'))
+            if account_id >= 0:
+                EngineWrapper.set_account_state(account_id, balance)
         except Exception:
             pass
 
@@ -1312,7 +1540,7 @@ class DerivConnector:
             original_count = len(self.open_positions)
             self.open_positions = [p for p in self.open_positions if p['id'] != cid]
             # Cleanup metadata
-            self.contract_metadata.pop(cid, None)
+            self.forget_contract(cid)
             
             # Immediately broadcast removal if anything changed
             if len(self.open_positions) < original_count:
@@ -1340,7 +1568,10 @@ class DerivConnector:
             # Trailing & Exit Enforcement (Wrapped for robustness)
             try:
                 metadata = self.contract_metadata.get(cid)
-                if metadata:
+                if metadata and metadata.get("native_symbol_id") is None and entry_price > 0:
+                    self.track_native_position(cid, metadata, entry_price, contract.get('underlying'))
+                # Natively tracked positions are trailed and checked on every tick
+                if metadata and metadata.get("native_symbol_id") is None:
                     current_sl = metadata.get('stop_loss')
                     current_tp = metadata.get('take_profit')
                     direction = metadata.get('action') # "BUY" or "SELL"
@@ -1418,6 +1649,16 @@ class DerivConnector:
             # Log completion
             from app.services.audit_logger import audit_logger
             audit_logger.logger.info(f"Trade Closed: {cid} | P&L: {profit}")
+
+            # Feed the engine's native risk counters (daily loss, losing streaks)
+            try:
+                symbol_id = EngineWrapper.create_symbol_context(contract.get('underlying') or '')
+                EngineWrapper.record_trade_result(symbol_id, profit)
+                account_id = self.engine_accounts.get(self.current_account.get('id'))
+                if account_id is not None:
+                    EngineWrapper.record_account_result(account_id, profit)
+            except Exception:
+                pass
             
             await stream_manager.broadcast_log({
                 "id": str(uuid.uuid4()),
@@ -1514,7 +1755,7 @@ class DerivConnector:
             return None
         
         # Get latest tick
-        candles = list(p.engine.candles_1m)
+        candles = p.engine.candles_1m
         last_candle = candles[-1] if candles else None
         
         # We can re-run analysis or just use cached values if we had them.
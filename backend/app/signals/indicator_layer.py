@@ -7,6 +7,7 @@ import numpy as np
 from typing import Dict, List, Deque
 from collections import deque
 import logging
+from app.core.engine_wrapper import EngineWrapper, IND_ADX, IND_MACD
 
 logger = logging.getLogger(__name__)
 
@@ -62,9 +63,9 @@ class IndicatorLayer:
         # Update RSI Hybrid Mode history
         self.rsi_history.append(rsi)
         
-        macd_val, signal_val, hist_val = self._calculate_macd()
+        macd_val, signal_val, hist_val = self._calculate_macd(engine=engine)
         ma_trend, ma_slope = self._check_ma_trend(engine=engine, current_price=price)
-        adx = self._calculate_adx()
+        adx = self._calculate_adx(engine=engine)
         
         score = 50
         
@@ -166,15 +167,21 @@ class IndicatorLayer:
             period = self.rsi_period
             
         # --- CASE 1: Engine Provided (Use 1m Candles) ---
+        # Streaming Wilder RSI from the C++ engine, with the live price as
+        # the next close (O(1), no history rescan)
+        if period == 14 and getattr(engine, 'symbol_id', -1) >= 0:
+            ind = EngineWrapper.get_indicators(engine.symbol_id, "1m")
+            if ind is not None and ind.samples >= period:
+                return float(ind.rsi_live)
+
         if engine and hasattr(engine, 'candles_1m') and len(engine.candles_1m) >= period:
-            candles = list(engine.candles_1m)
+            candles = engine.candles_1m
             # Use 'close' of last N candles + current price
-            closes = [c['close'] for c in candles[-period:]]
+            closes = candles.close[-period:]
             if current_price is not None:
-                closes.append(current_price)
+                closes = np.append(closes, current_price)
             
-            closes_arr = np.array(closes)
-            return self._wilder_rsi(closes_arr, period)
+            return self._wilder_rsi(closes, period)
 
         # --- CASE 2: Fallback to Tick-based RSI ---
         if len(self.prices) <= period:
@@ -598,10 +605,17 @@ class IndicatorLayer:
         return result
 
         
-    def _calculate_macd(self, fast=12, slow=26, signal=9):
+    def _calculate_macd(self, fast=12, slow=26, signal=9, engine=None):
         """
         Calculate MACD using proper EMAs and Signal Line.
         """
+        # Streaming 12/26/9 MACD over ticks from the C++ engine
+        if (fast, slow, signal) == (12, 26, 9) and getattr(engine, 'symbol_id', -1) >= 0:
+            ind = EngineWrapper.get_tick_indicators(engine.symbol_id)
+            if ind is None or not ind.ready & IND_MACD:
+                return 0, 0, 0
+            return float(ind.macd), float(ind.macd_signal), float(ind.macd_hist)
+
         if len(self.prices) < slow + signal:
             return 0, 0, 0
             
@@ -636,12 +650,9 @@ class IndicatorLayer:
         """
         # --- CASE 1: Engine Provided (Use 1m Candles) ---
         if engine and hasattr(engine, 'candles_1m') and len(engine.candles_1m) >= 50:
-            candles = list(engine.candles_1m)
-            closes = [c['close'] for c in candles]
+            closes_arr = engine.candles_1m.close
             if current_price is not None:
-                closes.append(current_price)
-            
-            closes_arr = np.array(closes)
+                closes_arr = np.append(closes_arr, current_price)
             
             # Use standard EMA periods (14 and 40 as per V10 config)
             ma20 = np.mean(closes_arr[-20:])
@@ -684,12 +695,19 @@ class IndicatorLayer:
             
         return "neutral", ma_slope
     
-    def _calculate_adx(self, period: int = None) -> float:
+    def _calculate_adx(self, period: int = None, engine=None) -> float:
         """
         Calculate ADX using Wilder's Smoothing.
         """
         if period is None:
             period = self.adx_period
+
+        # Streaming ADX(14) over ticks from the C++ engine
+        if period == 14 and getattr(engine, 'symbol_id', -1) >= 0:
+            ind = EngineWrapper.get_tick_indicators(engine.symbol_id)
+            if ind is None or not ind.ready & IND_ADX:
+                return 0.0
+            return float(ind.adx)
             
         if len(self.highs) < period * 2: # ADX needs more data for smoothing
             return 0.0
@@ -5,12 +5,22 @@ Detects Breaks of Structure (BOS), Internal BOS (iBOS), and Fair Value Gaps (FVG
 This module works on a tick stream, so it approximates candle behaviour using
 recent ticks. The goal is to provide a *stable structure score* and clear
 boolean flags that downstream components can consume.
+
+When given an engine with a native symbol context, structure comes from the
+C++ engine instead: swings, breaks and gaps of the 1m candles, maintained as
+each candle closes (see cpp_engine/market_structure.hpp), so a tick costs one
+O(1) snapshot instead of rescanning the buffers.
 """
 
 from typing import Dict
 from collections import deque
 import logging
 
+from app.core.engine_wrapper import EngineWrapper, SWING_HIGH, SWING_LOW
+
+# Closed candles before the native structure can confirm a swing (5 each side)
+NATIVE_MIN_BARS = 11
+
 logger = logging.getLogger(__name__)
 
 
@@ -40,19 +50,17 @@ class MarketStructure:
         if len(closes) < self.lookback * 2 + 3:
             return None, None
 
+        # A pivot equal to the max (min) of the lookback bars either side
+        flags = EngineWrapper.series_swings(closes, closes, self.lookback)
         last_high = None
         last_low = None
-        window = self.lookback
-
-        for i in range(window, len(closes) - window):
-            left = closes[i - window : i]
-            right = closes[i + 1 : i + 1 + window]
-            pivot = closes[i]
-
-            if pivot == max(left + [pivot] + right):
-                last_high = pivot
-            if pivot == min(left + [pivot] + right):
-                last_low = pivot
+        for i in range(len(closes) - 1, -1, -1):
+            if last_high is None and flags[i] & SWING_HIGH:
+                last_high = closes[i]
+            if last_low is None and flags[i] & SWING_LOW:
+                last_low = closes[i]
+            if last_high is not None and last_low is not None:
+                break
 
         return last_high, last_low
 
@@ -88,10 +96,60 @@ class MarketStructure:
 
         return False
 
-    def analyze(self, tick_data: Dict) -> Dict:
+    def _analyze_native(self, st, price: float) -> Dict:
+        """Score the engine's candle structure with the live price."""
+        if st.trend > 0:
+            self.structure_trend = "bullish"
+        elif st.trend < 0:
+            self.structure_trend = "bearish"
+
+        # A break is reported on the candle that closed beyond the swing
+        bos_bullish = st.bos_direction > 0 and st.bars_since_bos == 0
+        bos_bearish = st.bos_direction < 0 and st.bars_since_bos == 0
+        ibos_bull = st.swing_high > 0 and price > st.swing_high
+        ibos_bear = st.swing_low > 0 and price < st.swing_low
+        has_fvg = st.open_bull_fvgs + st.open_bear_fvgs > 0
+
+        score = 50
+        if self.structure_trend == "bullish":
+            score += 20
+        elif self.structure_trend == "bearish":
+            score -= 20
+        if bos_bullish:
+            score += 15
+        if bos_bearish:
+            score -= 15
+        if ibos_bull:
+            score += 10
+        if ibos_bear:
+            score -= 10
+        # Only a gap on the trend's side (support below / resistance above) counts
+        if self.structure_trend == "bullish" and st.open_bull_fvgs:
+            score += 5
+        elif self.structure_trend == "bearish" and st.open_bear_fvgs:
+            score -= 5
+
+        return {
+            "score": max(0, min(100, score)),
+            "trend": self.structure_trend,
+            "bos_bull": bos_bullish,
+            "bos_bear": bos_bearish,
+            "ibos_bull": ibos_bull,
+            "ibos_bear": ibos_bear,
+            "fvg": has_fvg,
+            "choch": bool(st.choch),
+            "swing_high": st.swing_high or None,
+            "swing_low": st.swing_low or None,
+        }
+
+    def analyze(self, tick_data: Dict, **kwargs) -> Dict:
         """
         Analyze new tick data for market structure.
 
+        Pass engine= (a MasterEngine with a native symbol context) to use the
+        engine's incremental 1m candle structure; the result then also has
+        "choch", "swing_high" and "swing_low".
+
         Returns:
             Dictionary with structure analysis:
             {
@@ -106,6 +164,12 @@ class MarketStructure:
         """
         price = float(tick_data.get("quote", 0.0))
 
+        engine = kwargs.get("engine")
+        if getattr(engine, "symbol_id", -1) >= 0:
+            st = EngineWrapper.get_structure(engine.symbol_id, "1m")
+            if st is not None and st.bars >= NATIVE_MIN_BARS:
+                return self._analyze_native(st, price)
+
         # For simplicity in tick-based system, treat ticks as closes/highs/lows.
         self.closes.append(price)
         self.highs.append(price)
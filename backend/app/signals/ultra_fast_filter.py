@@ -2,13 +2,33 @@
 Ultra-Fast Entry Filter
 Pre-entry filter designed specifically for scalping.
 Runs AFTER RSI confirmation but BEFORE sending trade order.
+
+With a native symbol context the rules run in the C++ engine as its
+configurable entry filter pipeline ("entry_filters", same rules and
+thresholds by default); the Python rules below are the fallback.
+Either way the result carries a FILTER_* reason code.
 """
 
 import logging
 from typing import Dict, Optional
 
+from app.core.engine_wrapper import (
+    EngineWrapper,
+    FILTER_PASSED,
+    FILTER_NO_CANDLE,
+    FILTER_FLAT_CANDLE,
+    FILTER_BODY_TOO_SMALL,
+    FILTER_BODY_TOO_LARGE,
+    FILTER_LOW_SPREAD,
+    FILTER_CANDLE_DIRECTION,
+    FILTER_RSI_MOMENTUM,
+    FILTER_OPPOSITE_WICK,
+)
+
 logger = logging.getLogger(__name__)
 
+_RANGE_PCT_CODES = (FILTER_BODY_TOO_SMALL, FILTER_BODY_TOO_LARGE, FILTER_LOW_SPREAD)
+
 
 class UltraFastEntryFilter:
     """
@@ -36,7 +56,8 @@ class UltraFastEntryFilter:
         candle: dict,
         direction: str,
         rsi_momentum_up: bool = None,
-        rsi_momentum_down: bool = None
+        rsi_momentum_down: bool = None,
+        symbol_id: int = -1
     ) -> dict:
         """
         Apply ultra-fast entry filter.
@@ -46,12 +67,22 @@ class UltraFastEntryFilter:
             direction: "BUY" or "SELL"
             rsi_momentum_up: True if RSI is increasing
             rsi_momentum_down: True if RSI is decreasing
+            symbol_id: Native symbol context; if set, the engine's pipeline
+                runs on its last closed 1m candle instead of `candle`
             
         Returns:
-            dict with allow_entry and reason
+            dict with allow_entry, reason and reason_code (FILTER_*)
         """
+        direction = direction.upper() if direction else "BUY"
+
+        if symbol_id >= 0:
+            momentum = rsi_momentum_up if direction == "BUY" else rsi_momentum_down
+            result = EngineWrapper.filter_entry(symbol_id, direction, "1m", momentum)
+            if result is not None:
+                return self._native_result(result, direction)
+
         if not candle:
-            return {"allow_entry": False, "reason": "No candle data"}
+            return self._reject(FILTER_NO_CANDLE, "No candle data")
         
         try:
             open_price = float(candle.get('open', 0))
@@ -59,14 +90,12 @@ class UltraFastEntryFilter:
             low = float(candle.get('low', 0))
             close = float(candle.get('close', 0))
         except (TypeError, ValueError):
-            return {"allow_entry": False, "reason": "Invalid candle data"}
-        
-        direction = direction.upper() if direction else "BUY"
+            return self._reject(FILTER_NO_CANDLE, "Invalid candle data")
         
         # Calculate candle metrics
         candle_range = high - low
         if candle_range <= 0:
-            return {"allow_entry": False, "reason": "Invalid candle range (zero or negative)"}
+            return self._reject(FILTER_FLAT_CANDLE, "Invalid candle range (zero or negative)")
         
         body = abs(close - open_price)
         body_pct = body / candle_range
@@ -83,19 +112,19 @@ class UltraFastEntryFilter:
         if body_pct < self.MIN_BODY_PCT:
             reason = f"Indecision candle: body {body_pct*100:.1f}% < {self.MIN_BODY_PCT*100:.0f}% of range"
             logger.debug(f"[UltraFastFilter] REJECT: {reason}")
-            return {"allow_entry": False, "reason": reason}
+            return self._reject(FILTER_BODY_TOO_SMALL, reason)
         
         # === RULE 2: Reject overextended candle (body too large) ===
         if body_pct > self.MAX_BODY_PCT:
             reason = f"Overextended candle: body {body_pct*100:.1f}% > {self.MAX_BODY_PCT*100:.0f}% of range"
             logger.debug(f"[UltraFastFilter] REJECT: {reason}")
-            return {"allow_entry": False, "reason": reason}
+            return self._reject(FILTER_BODY_TOO_LARGE, reason)
         
         # === RULE 3: Reject if spread < 20% of range ===
         if spread_pct < self.MIN_SPREAD_PCT:
             reason = f"Low spread: {spread_pct*100:.1f}% < {self.MIN_SPREAD_PCT*100:.0f}% of range"
             logger.debug(f"[UltraFastFilter] REJECT: {reason}")
-            return {"allow_entry": False, "reason": reason}
+            return self._reject(FILTER_LOW_SPREAD, reason)
         
         # === RULE 4: Candle momentum must agree with RSI direction ===
         if direction == "BUY":
@@ -103,24 +132,24 @@ class UltraFastEntryFilter:
             if not is_bullish_candle:
                 reason = "BUY rejected: candle is bearish (close < open)"
                 logger.debug(f"[UltraFastFilter] REJECT: {reason}")
-                return {"allow_entry": False, "reason": reason}
+                return self._reject(FILTER_CANDLE_DIRECTION, reason)
             
             if rsi_momentum_up is not None and not rsi_momentum_up:
                 reason = "BUY rejected: RSI momentum is not up"
                 logger.debug(f"[UltraFastFilter] REJECT: {reason}")
-                return {"allow_entry": False, "reason": reason}
+                return self._reject(FILTER_RSI_MOMENTUM, reason)
         
         elif direction == "SELL":
             # For SELL: candle should be bearish AND RSI momentum down
             if not is_bearish_candle:
                 reason = "SELL rejected: candle is bullish (close > open)"
                 logger.debug(f"[UltraFastFilter] REJECT: {reason}")
-                return {"allow_entry": False, "reason": reason}
+                return self._reject(FILTER_CANDLE_DIRECTION, reason)
             
             if rsi_momentum_down is not None and not rsi_momentum_down:
                 reason = "SELL rejected: RSI momentum is not down"
                 logger.debug(f"[UltraFastFilter] REJECT: {reason}")
-                return {"allow_entry": False, "reason": reason}
+                return self._reject(FILTER_RSI_MOMENTUM, reason)
         
         # === RULE 5: Reject if opposite wick > 2x body ===
         if body > 0:
@@ -129,20 +158,21 @@ class UltraFastEntryFilter:
                 if lower_wick > self.MAX_OPPOSITE_WICK_RATIO * body:
                     reason = f"BUY rejected: lower wick ({lower_wick:.4f}) > 2x body ({body:.4f})"
                     logger.debug(f"[UltraFastFilter] REJECT: {reason}")
-                    return {"allow_entry": False, "reason": reason}
+                    return self._reject(FILTER_OPPOSITE_WICK, reason)
             
             elif direction == "SELL":
                 # For SELL: upper wick (bullish rejection) is opposite
                 if upper_wick > self.MAX_OPPOSITE_WICK_RATIO * body:
                     reason = f"SELL rejected: upper wick ({upper_wick:.4f}) > 2x body ({body:.4f})"
                     logger.debug(f"[UltraFastFilter] REJECT: {reason}")
-                    return {"allow_entry": False, "reason": reason}
+                    return self._reject(FILTER_OPPOSITE_WICK, reason)
         
         # All checks passed
         logger.info(f"[UltraFastFilter] {direction} ALLOWED: body={body_pct*100:.1f}%, spread={spread_pct*100:.1f}%")
         return {
             "allow_entry": True,
             "reason": "All ultra-fast filter checks passed",
+            "reason_code": FILTER_PASSED,
             "metrics": {
                 "body_pct": body_pct,
                 "spread_pct": spread_pct,
@@ -152,6 +182,28 @@ class UltraFastEntryFilter:
             }
         }
 
+    @staticmethod
+    def _reject(code: int, reason: str) -> dict:
+        return {"allow_entry": False, "reason": reason, "reason_code": code}
+
+    @staticmethod
+    def _native_result(result, direction: str) -> dict:
+        """Dict form of an EngineFilterResult, worded like the Python rules."""
+        text = EngineWrapper.filter_reason_string(result.reason)
+        if result.reason == FILTER_PASSED:
+            logger.info(f"[UltraFastFilter] {direction} ALLOWED (native)")
+            return {"allow_entry": True, "reason": text, "reason_code": FILTER_PASSED}
+        if result.reason in _RANGE_PCT_CODES:
+            text += f": {result.value*100:.1f}% vs {result.limit*100:.0f}% of range"
+        elif result.reason == FILTER_OPPOSITE_WICK:
+            text += f": {result.value:.1f}x body > {result.limit:.1f}x"
+        elif result.reason not in (FILTER_NO_CANDLE, FILTER_CANDLE_DIRECTION, FILTER_RSI_MOMENTUM):
+            text += f": {result.value:.4g} vs {result.limit:.4g}"
+        reason = f"{direction} rejected: {text}"
+        logger.debug(f"[UltraFastFilter] REJECT: {reason}")
+        return {"allow_entry": False, "reason": reason,
+                "reason_code": result.reason, "stage": result.stage}
+
 
 # Singleton instance for easy import
 ultra_fast_filter = UltraFastEntryFilter()
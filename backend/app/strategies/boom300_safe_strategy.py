@@ -96,7 +96,8 @@ class Boom300SafeStrategy(BaseStrategy):
             fast_filter = ultra_fast_filter.filter_entry(
                 current_candle, 
                 "SELL", 
-                rsi_momentum_down=rsi_hybrid.get("momentum_down") if rsi_hybrid else None
+                rsi_momentum_down=rsi_hybrid.get("momentum_down") if rsi_hybrid else None,
+                symbol_id=getattr(engine, "symbol_id", -1)
             )
             if not fast_filter["allow_entry"]:
                 logger.info(f"[BOOM300] SELL rejected by UltraFastFilter: {fast_filter['reason']}")
@@ -107,7 +108,7 @@ class Boom300SafeStrategy(BaseStrategy):
             return None
 
         # === RULE 5: No spike in last 3 candles ===
-        if self._has_recent_spike(threshold=self.config["spike_threshold_pips"]):
+        if self._has_recent_spike(engine, threshold=self.config["spike_threshold_pips"]):
             return None
             
         # 3. Calculate Confidence via MasterEngine
@@ -158,10 +159,15 @@ class Boom300SafeStrategy(BaseStrategy):
             "strategy": self.name
         }
 
-    def _has_recent_spike(self, threshold: float) -> bool:
-        """Check if there was a positive price jump > threshold in recent history."""
-        # Look back approx 20 ticks
-        history = list(self.tick_history)[-self.config["spike_lookback_ticks"]:]
+    def _has_recent_spike(self, engine, threshold: float) -> bool:
+        """Check if there was a positive price jump (native spike, else > threshold) in recent history."""
+        lookback = self.config["spike_lookback_ticks"]
+        # Native detector: z-score of each tick move, updated in the tick call
+        if engine.symbol_id >= 0:
+            since = engine.ticks_since_spike
+            return 0 <= since < lookback and engine.last_spike > 0
+
+        history = list(self.tick_history)[-lookback:]
         if len(history) < 2:
             return False
             
@@ -96,7 +96,8 @@ class Crash300SafeStrategy(BaseStrategy):
             fast_filter = ultra_fast_filter.filter_entry(
                 current_candle, 
                 "BUY", 
-                rsi_momentum_up=rsi_hybrid.get("momentum_up") if rsi_hybrid else None
+                rsi_momentum_up=rsi_hybrid.get("momentum_up") if rsi_hybrid else None,
+                symbol_id=getattr(engine, "symbol_id", -1)
             )
             if not fast_filter["allow_entry"]:
                 logger.info(f"[CRASH300] BUY rejected by UltraFastFilter: {fast_filter['reason']}")
@@ -108,7 +109,7 @@ class Crash300SafeStrategy(BaseStrategy):
 
         # === RULE 5: No spike in last 3 candles ===
         # Crash spike is DOWN.
-        if self._has_recent_spike(threshold=self.config["spike_threshold_pips"]):
+        if self._has_recent_spike(engine, threshold=self.config["spike_threshold_pips"]):
             return None
             
         # 3. Calculate Confidence via MasterEngine
@@ -159,9 +160,15 @@ class Crash300SafeStrategy(BaseStrategy):
             "strategy": self.name
         }
 
-    def _has_recent_spike(self, threshold: float) -> bool:
-        """Check if there was a negative price drop > threshold in recent history."""
-        history = list(self.tick_history)[-self.config["spike_lookback_ticks"]:]
+    def _has_recent_spike(self, engine, threshold: float) -> bool:
+        """Check if there was a negative price drop (native spike, else > threshold) in recent history."""
+        lookback = self.config["spike_lookback_ticks"]
+        # Prefer the engine's spike detector; scan tick_history without a context
+        if engine.symbol_id >= 0:
+            since = engine.ticks_since_spike
+            return 0 <= since < lookback and engine.last_spike < 0
+
+        history = list(self.tick_history)[-lookback:]
         if len(history) < 2:
             return False
             
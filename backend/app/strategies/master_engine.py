@@ -1,12 +1,17 @@
+import ctypes
 import logging
 import numpy as np
 from collections import deque
 from datetime import datetime
 from typing import Dict, List, Optional, Any, Union
 from .symbol_intelligence import SymbolIntelligence
+from app.core.engine_wrapper import EngineWrapper, EngineTickResult, CandleSeries, TIMEFRAMES
 
 logger = logging.getLogger(__name__)
 
+# Contexts already seeded from the history store (contexts are process-wide)
+_WARM_STARTED = set()
+
 class MasterEngine:
     """
     MASTERENGINE – FINAL MERGED VERSION
@@ -26,16 +31,9 @@ class MasterEngine:
     
     def __init__(self):
         # --- 1. Multi-Timeframe Data Storage ---
-        self.candles_1m = deque(maxlen=200)
-        self.candles_5m = deque(maxlen=200)
-        self.candles_15m = deque(maxlen=200)
-        self.candles_1h = deque(maxlen=100)  # Added 1h
-        
-        # Temp storage for building candles
-        self.current_1m = None
-        self.current_5m = None
-        self.current_15m = None
-        self.current_1h = None
+        # Candles are aggregated natively by the C++ engine (one ring per
+        # symbol and timeframe); candles_1m/5m/15m/1h are zero-copy views.
+        self.symbol_id = -1
         
         # --- 7. Market Memory System ---
         self.memory = {
@@ -49,16 +47,19 @@ class MasterEngine:
         }
         
         # --- 9. Indicator Cache ---
+        # Trend/momentum/ATR are O(1) reads of the engine's streaming state
         self.indicator_cache = {
-            "trend": {}, # {tf: {"value": str, "last_count": int}}
-            "momentum": {}, # {tf: {"value": float, "last_count": int}}
             "volatility": {}, # {tf: {"value": str, "last_count": int}}
-            "atr": {} # {tf: {"value": float, "last_count": int}}
         }
         
         # --- 10. Current Symbol Context ---
         self.current_symbol = None
         self.current_profile = {}
+        self._tick_result = EngineTickResult()
+        self._last_spike = 0
+        # The native feed applies this symbol's ticks on its own thread, so
+        # candles are read as locked snapshots rather than zero-copy views
+        self._copy_candles = False
         
         logger.info("MasterEngine Initialized - Unified Intelligence Module (with Cache)")
 
@@ -66,17 +67,9 @@ class MasterEngine:
         """Reset all data storage and memory for a clean start on a new symbol."""
         logger.info(f"MasterEngine: Resetting all data for symbol {self.current_symbol}")
         
-        # Clear Candle Deques
-        self.candles_1m.clear()
-        self.candles_5m.clear()
-        self.candles_15m.clear()
-        self.candles_1h.clear()
-        
-        # Reset current building candles
-        self.current_1m = None
-        self.current_5m = None
-        self.current_15m = None
-        self.current_1h = None
+        # Clear native candle rings (closed and forming)
+        if self.symbol_id >= 0:
+            EngineWrapper.reset_candles(self.symbol_id)
         
         # Reset Memory
         self.memory["confidence_scores"].clear()
@@ -93,98 +86,80 @@ class MasterEngine:
     # CORE: TICK UPDATE & AGGREGATION
     # ==================================================================
     
-    def update_tick(self, symbol: str, price: float, epoch: int):
+    def update_tick(self, symbol: str, price: float, epoch: int, engine_fed: bool = False,
+                    result: EngineTickResult = None):
         """
         Ingest a new tick, update candle aggregations for 1m, 5m, 15m, 1h.
         Strategies should call this first before requesting analysis.
+        `engine_fed` ticks were already applied by the native feed, which
+        passes their `result`.
         """
+        if engine_fed:
+            self._copy_candles = True
         if symbol != self.current_symbol:
             self.current_symbol = symbol
             self.current_profile = SymbolIntelligence.get_market_profile(symbol)
-            
-        timestamp = datetime.fromtimestamp(epoch)
+            self.symbol_id = EngineWrapper.create_symbol_context(symbol)
+            self._warm_start()
         
         # Update Memory counters
         self.memory["spike_counter"] += 1
         
-        # Aggregate Candles
-        self._update_candidate_candle(self.current_1m, price, timestamp, "1m")
-        self._update_candidate_candle(self.current_5m, price, timestamp, "5m")
-        self._update_candidate_candle(self.current_15m, price, timestamp, "15m")
-        self._update_candidate_candle(self.current_1h, price, timestamp, "1h")
-
-    def _update_candidate_candle(self, current_candle: Optional[Dict], price: float, timestamp: datetime, period: str):
-        """Helper to manage candle construction."""
-        
-        # Determine start of period
-        if period == "1m":
-            interval_start = timestamp.replace(second=0, microsecond=0)
-            target_list = self.candles_1m
-            # Special handling to update the 'current' reference since it's immutable if None
-            # We must assign back to self.current_Xm
-        elif period == "5m":
-            minute = (timestamp.minute // 5) * 5
-            interval_start = timestamp.replace(minute=minute, second=0, microsecond=0)
-            target_list = self.candles_5m
-        elif period == "15m":
-            minute = (timestamp.minute // 15) * 15
-            interval_start = timestamp.replace(minute=minute, second=0, microsecond=0)
-            target_list = self.candles_15m
-        elif period == "1h":
-            interval_start = timestamp.replace(minute=0, second=0, microsecond=0)
-            target_list = self.candles_1h
-        
-        # Get actual reference to current candle
-        if period == "1m": ref = self.current_1m
-        elif period == "5m": ref = self.current_5m
-        elif period == "15m": ref = self.current_15m
-        elif period == "1h": ref = self.current_1h
-        else: return
-
-        # Initialize if strictly None
-        if ref is None:
-            new_candle = {
-                "open": price, "high": price, "low": price, "close": price,
-                "time": interval_start, "volume": 1
-            }
-            self._set_current(period, new_candle)
+        # Aggregate Candles (native, integer epoch bucketing)
+        if result is not None:
+            # The feed reuses its result buffer: keep a copy
+            ctypes.memmove(ctypes.byref(self._tick_result), ctypes.byref(result),
+                           ctypes.sizeof(EngineTickResult))
+        elif not engine_fed:
+            EngineWrapper.process_tick_bin(self.symbol_id, int(epoch), price, self._tick_result)
+        if self._tick_result.spike:
+            self._last_spike = self._tick_result.spike
+
+    def _warm_start(self):
+        """Seed a context's candles/indicators from the on-disk history store, once per process."""
+        if self.symbol_id < 0 or self.symbol_id in _WARM_STARTED:
             return
-
-        # Check if we stepped into a new period
-        try:
-            # ref["time"] might be older timeframe if stream lagged or jumped
-            if interval_start > ref["time"]:
-                # Close current
-                target_list.append(ref.copy())
-                
-                # Start new
-                new_candle = {
-                    "open": price, "high": price, "low": price, "close": price,
-                    "time": interval_start, "volume": 1
-                }
-                self._set_current(period, new_candle)
-            else:
-                # Update current
-                ref["high"] = max(ref["high"], price)
-                ref["low"] = min(ref["low"], price)
-                ref["close"] = price
-                ref["volume"] += 1
-                # No need to set back, dict is mutable
-        except Exception as e:
-            logger.error(f"Error updating candle {period}: {e}")
-
-    def _set_current(self, period, candle):
-        if period == "1m": self.current_1m = candle
-        elif period == "5m": self.current_5m = candle
-        elif period == "15m": self.current_15m = candle
-        elif period == "1h": self.current_1h = candle
+        _WARM_STARTED.add(self.symbol_id)
+        loaded = EngineWrapper.store_warm_start(self.symbol_id)
+        if loaded > 0:
+            logger.info(f"MasterEngine: warmed {self.current_symbol} from {loaded} stored candles")
 
     def inject_external_candles(self, timeframe: str, candles: List[Dict]):
         """Allows injecting history (e.g. from API) to warm up."""
-        if timeframe == "1m": self.candles_1m = deque(candles, maxlen=200)
-        elif timeframe == "5m": self.candles_5m = deque(candles, maxlen=200)
-        elif timeframe == "15m": self.candles_15m = deque(candles, maxlen=200)
-        elif timeframe == "1h": self.candles_1h = deque(candles, maxlen=100)
+        if self.symbol_id >= 0 and timeframe in TIMEFRAMES:
+            EngineWrapper.load_candles(self.symbol_id, timeframe, candles)
+
+    @property
+    def exit_updates(self) -> int:
+        """Tracked positions whose exits changed on the last tick this engine applied."""
+        return self._tick_result.exit_updates
+
+    @property
+    def spike(self) -> int:
+        """1 / -1 if the last tick this engine applied spiked up / down (native detector), else 0."""
+        return self._tick_result.spike
+
+    @property
+    def ticks_since_spike(self) -> int:
+        """Ticks since the symbol's last native spike, -1 before its first."""
+        return self._tick_result.ticks_since_spike
+
+    @property
+    def last_spike(self) -> int:
+        """1 / -1 if the symbol's last native spike was up / down, 0 before its first."""
+        return self._last_spike
+
+    @property
+    def candles_1m(self) -> CandleSeries: return self._get_candles("1m")
+
+    @property
+    def candles_5m(self) -> CandleSeries: return self._get_candles("5m")
+
+    @property
+    def candles_15m(self) -> CandleSeries: return self._get_candles("15m")
+
+    @property
+    def candles_1h(self) -> CandleSeries: return self._get_candles("1h")
 
     # ==================================================================
     # 1. MULTI-TIMEFRAME ANALYZER
@@ -194,21 +169,13 @@ class MasterEngine:
         """
         Trend states: "strong_up", "up", "neutral", "down", "strong_down"
         """
-        # Check Cache
-        candle_count = len(self._get_candles(tf))
-        if tf in self.indicator_cache["trend"] and self.indicator_cache["trend"][tf]["last_count"] == candle_count:
-            return self.indicator_cache["trend"][tf]["value"]
-
-        candles = self._get_candles(tf)
-        if not candles or len(candles) < 20: return "neutral"
-        
-        closes = np.array([c['close'] for c in candles])
-        ema20 = self._ema(closes, 20)
-        ema50 = self._ema(closes, 50)
+        # O(1) read of the engine's streaming EMA20/EMA50
+        ind = self._indicators(tf)
+        if ind is None or ind.samples < 20: return "neutral"
         
-        current_ema20 = ema20[-1]
-        current_ema50 = ema50[-1]
-        prev_ema20 = ema20[-2]
+        current_ema20 = ind.ema_fast
+        current_ema50 = ind.ema_slow
+        prev_ema20 = ind.ema_fast_prev
         
         # Slope check
         slope = current_ema20 - prev_ema20
@@ -225,25 +192,13 @@ class MasterEngine:
             else:
                 val = "down"
             
-        # Update Cache
-        self.indicator_cache["trend"][tf] = {"value": val, "last_count": candle_count}
         return val
 
     def get_momentum(self, tf: str) -> float:
         """Returns RSI (0-100)"""
-        # Check Cache
-        candle_count = len(self._get_candles(tf))
-        if tf in self.indicator_cache["momentum"] and self.indicator_cache["momentum"][tf]["last_count"] == candle_count:
-            return self.indicator_cache["momentum"][tf]["value"]
-
-        candles = self._get_candles(tf)
-        if not candles or len(candles) < 14: return 50.0
-        closes = np.array([c['close'] for c in candles])
-        val = float(self._rsi(closes, 14)[-1])
-        
-        # Update Cache
-        self.indicator_cache["momentum"][tf] = {"value": val, "last_count": candle_count}
-        return val
+        ind = self._indicators(tf)
+        if ind is None or ind.samples < 14: return 50.0
+        return float(ind.rsi)
 
     def get_volatility(self, tf: str) -> str:
         """Returns: 'low', 'normal', 'high', 'extreme'"""
@@ -256,9 +211,9 @@ class MasterEngine:
         if atr_val == 0: return "normal"
         
         candles = self._get_candles(tf)
-        highs = np.array([c['high'] for c in candles])
-        lows = np.array([c['low'] for c in candles])
-        closes = np.array([c['close'] for c in candles])
+        highs = candles.high
+        lows = candles.low
+        closes = candles.close
         atr_series = self._atr(highs, lows, closes, 14)
         avg = np.mean(atr_series[-20:])
         
@@ -273,24 +228,9 @@ class MasterEngine:
 
     def get_atr(self, tf: str) -> float:
         """Returns the raw ATR value for the given timeframe."""
-        # Check Cache
-        candle_count = len(self._get_candles(tf))
-        if tf in self.indicator_cache["atr"] and self.indicator_cache["atr"][tf]["last_count"] == candle_count:
-            return self.indicator_cache["atr"][tf]["value"]
-
-        candles = self._get_candles(tf)
-        if not candles or len(candles) < 20: return 0.0
-        
-        highs = np.array([c['high'] for c in candles])
-        lows = np.array([c['low'] for c in candles])
-        closes = np.array([c['close'] for c in candles])
-        
-        atr = self._atr(highs, lows, closes, 14)
-        val = float(atr[-1])
-        
-        # Update Cache
-        self.indicator_cache["atr"][tf] = {"value": val, "last_count": candle_count}
-        return val
+        ind = self._indicators(tf)
+        if ind is None or ind.samples < 20: return 0.0
+        return float(ind.atr)
 
     def get_macro_trend(self) -> str:
         """Based on 1h timeframe only."""
@@ -408,9 +348,7 @@ class MasterEngine:
             return True
             
         # 2. ATR Spike > 2.5x average (Adjusted by Multiplier)
-        highs = np.array([x['high'] for x in candles])
-        lows = np.array([x['low'] for x in candles])
-        closes = np.array([x['close'] for x in candles])
+        _, highs, lows, closes = self._columns(candles)
         atr = self._atr(highs, lows, closes, 14)
         
         atr_mult = self.current_profile.get("atr_multiplier", 1.0)
@@ -462,11 +400,9 @@ class MasterEngine:
         """
         if not candles or len(candles) < 50: return "range"
         
-        closes = np.array([c['close'] for c in candles])
+        _, highs, lows, closes = self._columns(candles)
         ema20 = self._ema(closes, 20)
         ema50 = self._ema(closes, 50)
-        highs = np.array([c['high'] for c in candles])
-        lows = np.array([c['low'] for c in candles])
         atr = self._atr(highs, lows, closes, 14)
         
         avg_atr = np.mean(atr[-20:])
@@ -685,24 +621,30 @@ class MasterEngine:
     # 9. HELPERS
     # ==================================================================
 
-    def _get_candles(self, timeframe: str) -> List[Dict]:
-        if timeframe == "1m": return list(self.candles_1m)
-        if timeframe == "5m": return list(self.candles_5m)
-        if timeframe == "15m": return list(self.candles_15m)
-        if timeframe == "1h": return list(self.candles_1h)
-        return []
+    def _get_candles(self, timeframe: str) -> CandleSeries:
+        if self.symbol_id < 0 or timeframe not in TIMEFRAMES: return CandleSeries()
+        return EngineWrapper.get_candles(self.symbol_id, timeframe, copy=self._copy_candles)
+
+    def _indicators(self, timeframe: str):
+        """Streaming indicator snapshot from the engine (None before the first tick)."""
+        if self.symbol_id < 0 or timeframe not in TIMEFRAMES: return None
+        return EngineWrapper.get_indicators(self.symbol_id, timeframe)
+
+    def _columns(self, candles):
+        """(opens, highs, lows, closes) arrays from a CandleSeries or list of dicts."""
+        if isinstance(candles, CandleSeries):
+            return candles.open, candles.high, candles.low, candles.close
+        return (np.array([c['open'] for c in candles]), np.array([c['high'] for c in candles]),
+                np.array([c['low'] for c in candles]), np.array([c['close'] for c in candles]))
 
     def _ema(self, data: np.array, period: int) -> np.array:
-        if len(data) < period: return np.zeros_like(data)
-        alpha = 2 / (period + 1)
-        ema = np.zeros_like(data)
-        ema[0] = data[0]
-        for i in range(1, len(data)):
-            ema[i] = alpha * data[i] + (1 - alpha) * ema[i-1]
-        return ema
+        # Native kernel (seeded with data[0]; zeros if len < period)
+        return EngineWrapper.series_ema(data, period)
         
     def _rsi(self, data: np.array, period: int = 14) -> np.array:
-        if len(data) < period + 1: return np.zeros_like(data)
+        # Same convention as the native RSI: 50 while warming up or flat,
+        # 100 over a window without losses
+        if len(data) < period + 1: return np.full_like(data, 50.0, dtype=float)
         delta = np.diff(data)
         gain = (delta > 0) * delta
         loss = (delta < 0) * -delta
@@ -719,17 +661,10 @@ class MasterEngine:
             
         rs = np.divide(avg_gain, avg_loss, out=np.zeros_like(avg_gain), where=avg_loss!=0)
         rsi = 100 - (100 / (1 + rs))
+        rsi[avg_loss == 0] = np.where(avg_gain[avg_loss == 0] > 0, 100.0, 50.0)
+        rsi[:period] = 50.0
         return rsi
 
     def _atr(self, highs, lows, closes, period=14) -> np.array:
-        if len(closes) < 2: return np.zeros_like(closes)
-        tr = np.zeros_like(closes)
-        for i in range(1, len(closes)):
-            tr[i] = max(highs[i] - lows[i], abs(highs[i] - closes[i-1]), abs(lows[i] - closes[i-1]))
-            
-        atr = np.zeros_like(closes)
-        if len(tr) > period:
-            atr[period] = np.mean(tr[1:period+1])
-            for i in range(period+1, len(tr)):
-                atr[i] = (atr[i-1] * (period - 1) + tr[i]) / period
-        return atr
+        # Native kernel: zeros up to `period`, then Wilder-smoothed true range
+        return EngineWrapper.series_atr(highs, lows, closes, period)
@@ -16,6 +16,12 @@ class SpikeBotStrategy(BaseStrategy):
         })
         
     def analyze(self, tick_data, engine, structure_data, indicator_data, **kwargs) -> Optional[Dict]:
+        # A native spike on this tick: trade it now rather than wait for the regime
+        # (the /analyze API passes regime data here, not a MasterEngine)
+        if getattr(engine, "symbol_id", -1) >= 0 and engine.spike:
+            action = "BUY" if engine.spike > 0 else "SELL"
+            return {"action": action, "confidence": 0.8, "strategy": self.name}
+
         # Use MasterEngine methods to get volatility
         # get_volatility returns float (e.g. 15.5), we need to check if it's 'high' or check value
         # But the original code checked for string "extreme". 
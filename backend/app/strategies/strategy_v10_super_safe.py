@@ -190,12 +190,14 @@ class V10SuperSafeStrategy(BaseStrategy):
                 fast_filter = ultra_fast_filter.filter_entry(
                     current_candle, 
                     "BUY", 
-                    rsi_momentum_up=rsi_hybrid.get("momentum_up") if rsi_hybrid else None
+                    rsi_momentum_up=rsi_hybrid.get("momentum_up") if rsi_hybrid else None,
+                    symbol_id=getattr(engine, "symbol_id", -1)
                 )
                 if not fast_filter["allow_entry"]:
                     reason = f"UltraFast BUY Block: {fast_filter['reason']}"
                     logger.info(f"[V10] {reason}")
-                    return {"action": None, "reason": reason}
+                    return {"action": None, "reason": reason,
+                            "filter_code": fast_filter["reason_code"]}
             
             # All conditions met for BUY
             conf_data = {
@@ -287,12 +289,14 @@ class V10SuperSafeStrategy(BaseStrategy):
                 fast_filter = ultra_fast_filter.filter_entry(
                     current_candle, 
                     "SELL", 
-                    rsi_momentum_down=rsi_hybrid.get("momentum_down") if rsi_hybrid else None
+                    rsi_momentum_down=rsi_hybrid.get("momentum_down") if rsi_hybrid else None,
+                    symbol_id=getattr(engine, "symbol_id", -1)
                 )
                 if not fast_filter["allow_entry"]:
                     reason = f"UltraFast SELL Block: {fast_filter['reason']}"
                     logger.info(f"[V10] {reason}")
-                    return {"action": None, "reason": reason}
+                    return {"action": None, "reason": reason,
+                            "filter_code": fast_filter["reason_code"]}
             
             # All conditions met for SELL
             conf_data = {
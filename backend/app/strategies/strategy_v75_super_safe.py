@@ -121,7 +121,8 @@ class V75SuperSafeStrategy(BaseStrategy):
                 fast_filter = ultra_fast_filter.filter_entry(
                     current_candle, 
                     "BUY", 
-                    rsi_momentum_up=rsi_hybrid.get("momentum_up") if rsi_hybrid else None
+                    rsi_momentum_up=rsi_hybrid.get("momentum_up") if rsi_hybrid else None,
+                    symbol_id=getattr(engine, "symbol_id", -1)
                 )
                 if not fast_filter["allow_entry"]:
                     return None
@@ -173,7 +174,8 @@ class V75SuperSafeStrategy(BaseStrategy):
                 fast_filter = ultra_fast_filter.filter_entry(
                     current_candle, 
                     "SELL", 
-                    rsi_momentum_down=rsi_hybrid.get("momentum_down") if rsi_hybrid else None
+                    rsi_momentum_down=rsi_hybrid.get("momentum_down") if rsi_hybrid else None,
+                    symbol_id=getattr(engine, "symbol_id", -1)
                 )
                 if not fast_filter["allow_entry"]:
                     return None
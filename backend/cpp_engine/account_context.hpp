@@ -0,0 +1,138 @@
+/**
+ * Per-account state for trade decisions.
+ *
+ * A trade check combines the signal's symbol (risk policy, losing streak,
+ * cooldown) with the account it would be placed on: balance and free
+ * margin from that account's stream, and its realised results for the
+ * day. The engine's own account (update_account, record_trade_result) is
+ * one AccountContext; every mirrored account gets another, looked up by
+ * handle like a symbol context, so one signal can be checked against all
+ * of them in a single pass (execute_trade_accounts).
+ */
+
+#ifndef ACCOUNT_CONTEXT_HPP
+#define ACCOUNT_CONTEXT_HPP
+
+#include "arena.hpp"
+#include "config.hpp"
+#include "memory_budget.hpp"
+#include "risk_policy.hpp"
+#include "seqlock.hpp"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <string>
+#include <unordered_map>
+
+class AccountContext {
+public:
+  AccountContext(int32_t id, const std::string &name) : id(id), name(name) {}
+
+  AccountContext(const AccountContext &) = delete;
+  AccountContext &operator=(const AccountContext &) = delete;
+
+  const int32_t id;
+  const std::string name; // e.g. the Deriv login id
+  // Realised results of the UTC day (daily loss and stop-loss limits)
+  RiskLedger ledger;
+
+  void set_state(const AccountState &s) {
+    std::lock_guard<std::mutex> lock(writer); // SeqLock needs one writer
+    state.store(s);
+    known.store(true, std::memory_order_release);
+  }
+
+  // False (and `out` untouched) until the account has reported its state
+  bool load(AccountState &out) const {
+    if (!known.load(std::memory_order_acquire))
+      return false;
+    out = state.load();
+    return true;
+  }
+
+  // Balance for sizing and the day's start, 0 if not reported yet
+  double balance() const {
+    AccountState s{};
+    return load(s) ? s.balance : 0.0;
+  }
+
+private:
+  SeqLock<AccountState> state;
+  std::mutex writer;
+  std::atomic<bool> known{false};
+};
+
+// Fixed-capacity table of accounts, with the same handle and arena rules
+// as SymbolRegistry: creation is serialised, lookup is lock-free and
+// accounts are never moved or freed while the engine is alive.
+class AccountRegistry {
+public:
+  AccountRegistry() = default;
+  AccountRegistry(const AccountRegistry &) = delete;
+  AccountRegistry &operator=(const AccountRegistry &) = delete;
+
+  ~AccountRegistry() {
+    for (int32_t id = 0; id < count.load(std::memory_order_relaxed); ++id)
+      accounts[id]->~AccountContext();
+  }
+
+  static size_t bytes_for(const MemoryBudget &budget) {
+    return static_cast<size_t>(budget.max_accounts) *
+           arena_bytes_for<AccountContext>(1);
+  }
+
+  // Before the first create() (false after it)
+  bool attach(Arena &into, const MemoryBudget &budget) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (count.load(std::memory_order_relaxed) > 0)
+      return false;
+    arena = &into;
+    limit = budget.max_accounts;
+    return true;
+  }
+
+  // Existing handle for `name` or a new account; -1 for an empty name,
+  // without an arena or for a full table
+  int32_t create(const std::string &name) {
+    if (name.empty())
+      return -1;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = ids.find(name);
+    if (it != ids.end())
+      return it->second;
+
+    int32_t id = count.load(std::memory_order_relaxed);
+    if (!arena || id >= limit)
+      return -1;
+    void *mem = arena->take<AccountContext>(1);
+    if (!mem)
+      return -1;
+    accounts[id] = new (mem) AccountContext(id, name);
+    ids.emplace(name, id);
+    count.store(id + 1, std::memory_order_release);
+    return id;
+  }
+
+  AccountContext *get(int32_t id) const {
+    if (id < 0 || id >= count.load(std::memory_order_acquire))
+      return nullptr;
+    return accounts[id];
+  }
+
+  int32_t size() const { return count.load(std::memory_order_acquire); }
+  int32_t capacity() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return arena ? limit : 0;
+  }
+
+private:
+  mutable std::mutex mutex;
+  std::unordered_map<std::string, int32_t> ids;
+  Arena *arena = nullptr;
+  int32_t limit = 0;
+  AccountContext *accounts[MAX_ACCOUNT_CONTEXTS] = {};
+  std::atomic<int32_t> count{0};
+};
+
+#endif // ACCOUNT_CONTEXT_HPP
@@ -0,0 +1,93 @@
+/**
+ * One pre-sized block that long-lived engine state is carved from.
+ *
+ * The block is reserved once, then handed out front to back in cache-line
+ * aligned pieces; nothing is returned or moved until the arena is
+ * destroyed, so pointers into it (symbol contexts, zero-copy candle
+ * columns) stay valid for the arena's lifetime. Reserving only claims
+ * address space: pages are committed as pieces are taken, so an arena
+ * sized for the whole budget costs memory only for what is in use, and
+ * never more than its capacity.
+ */
+
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+constexpr size_t ARENA_ALIGN = 64;
+
+// Bytes a piece of `bytes` occupies, padding included
+constexpr size_t arena_bytes(size_t bytes) {
+  return (bytes + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+}
+
+template <typename T> constexpr size_t arena_bytes_for(size_t n) {
+  return arena_bytes(n * sizeof(T));
+}
+
+class Arena {
+public:
+  Arena() = default;
+  explicit Arena(size_t bytes) { reserve(bytes); }
+  ~Arena() { release(); }
+
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+
+  // (Re)size the block; false once anything has been taken from it
+  bool reserve(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (used_ > 0)
+      return false;
+    release();
+    bytes = arena_bytes(bytes);
+    if (bytes > 0)
+      base = static_cast<unsigned char *>(
+          ::operator new(bytes, std::align_val_t(ARENA_ALIGN)));
+    cap = bytes;
+    return true;
+  }
+
+  // Room for `n` Ts, zeroed; nullptr if the block cannot hold them
+  template <typename T> T *take(size_t n) {
+    static_assert(alignof(T) <= ARENA_ALIGN, "over-aligned arena type");
+    return static_cast<T *>(take_bytes(n * sizeof(T)));
+  }
+
+  void *take_bytes(size_t bytes) {
+    bytes = arena_bytes(bytes);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!base || bytes > cap - used_)
+      return nullptr;
+    unsigned char *p = base + used_;
+    used_ += bytes;
+    std::memset(p, 0, bytes);
+    return p;
+  }
+
+  size_t capacity() const { return cap; }
+
+  size_t used() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return used_;
+  }
+
+private:
+  void release() {
+    if (base)
+      ::operator delete(base, std::align_val_t(ARENA_ALIGN));
+    base = nullptr;
+    cap = 0;
+  }
+
+  mutable std::mutex mutex;
+  unsigned char *base = nullptr;
+  size_t cap = 0;
+  size_t used_ = 0;
+};
+
+#endif // ARENA_HPP
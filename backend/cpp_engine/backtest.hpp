@@ -0,0 +1,280 @@
+/**
+ * Event-driven backtester.
+ *
+ * Replays candles or ticks through a private SymbolContext, so signals come
+ * from the same streaming indicators the live tick path uses, and every
+ * entry goes through check_trade_limits with the symbol's risk policy and
+ * the live config. Time is the replayed epoch: cooldowns, the daily loss
+ * counters and losing streaks advance with the data, not the wall clock.
+ * The volatility regime gate reads the replayed bars' own returns; with a
+ * single symbol there is no other exposure for max_correlation to see.
+ *
+ * One position is held at a time. Exits are checked on every bar/tick at
+ * its close price: take profit, stop loss and a maximum holding time, then
+ * any position still open at the end is closed at the last price.
+ *
+ * A parameter sweep folds the indicators once (bar_signals) and replays
+ * the shared per-bar signals through every parameter set.
+ */
+
+#ifndef BACKTEST_HPP
+#define BACKTEST_HPP
+
+#include "arena.hpp"
+#include "config.hpp"
+#include "correlation.hpp"
+#include "engine.hpp"
+#include "risk_policy.hpp"
+#include "symbol_context.hpp"
+#include "trade_checks.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Signal inputs of one closed bar. They depend only on the candles, so a
+// sweep computes them once and shares them across every parameter set.
+struct BarSignal {
+  double signal;
+  double rsi; // RSI with the bar's close as the live price
+};
+
+inline std::vector<BarSignal> bar_signals(const EngineCandle *candles,
+                                          size_t n) {
+  std::vector<BarSignal> out(n);
+  IndicatorSet ind;
+  for (size_t i = 0; i < n; ++i) {
+    ind.update(candles[i]);
+    out[i] = {ind.signal(candles[i].close), ind.rsi_live(candles[i].close)};
+  }
+  return out;
+}
+
+class Backtester {
+public:
+  Backtester(const std::string &symbol, const EngineConfig &live,
+             const EngineBacktestParams &params, EngineBacktestOutput &out)
+      : cfg(live), p(params), out(out),
+        arena(SymbolContext::storage_bytes(MemoryBudget())),
+        ctx(-1, symbol, live.cooldown_ns, 0, // cooldown is epoch-based
+            MemoryBudget(), arena),
+        equity(params.initial_balance), peak(params.initial_balance) {
+    if (p.cooldown_seconds >= 0)
+      cfg.cooldown_ns = p.cooldown_seconds * NS_PER_SECOND;
+    tf = p.timeframe >= 0 && p.timeframe < ENGINE_TF_COUNT ? p.timeframe
+                                                           : ENGINE_TF_1M;
+    out.trades_count = 0;
+    out.equity_count = 0;
+    out.stats = EngineBacktestStats{};
+  }
+
+  // A closed bar of the backtest timeframe
+  void on_candle(const EngineCandle &c) {
+    IndicatorSet &ind = ctx.indicators[tf];
+    ind.update(c);
+    on_bar(c, {ind.signal(c.close), ind.rsi_live(c.close)});
+  }
+
+  // The same bar with its signal inputs precomputed (bar_signals)
+  void on_bar(const EngineCandle &c, const BarSignal &s) {
+    ctx.price = c.close;
+    returns.on_close(c.epoch / TIMEFRAME_SECONDS[tf], c.close);
+    step(c.epoch, c.close, s);
+  }
+
+  // A raw tick, aggregated into every timeframe as live
+  void on_tick(int64_t epoch, double quote) {
+    if (ctx.on_tick(epoch, quote) & (1 << ENGINE_TF_1M)) {
+      EngineCandle bar = ctx.candles[ENGINE_TF_1M].ring().back();
+      returns.on_close(bar.epoch / TIMEFRAME_SECONDS[ENGINE_TF_1M], bar.close);
+    }
+    const IndicatorSet &ind = ctx.indicators[tf];
+    step(epoch, quote, {ind.signal(quote), ind.rsi_live(quote)});
+  }
+
+  void finish() {
+    if (open)
+      close_position(last_epoch, last_price, ENGINE_EXIT_END_OF_DATA);
+    if (out.stats.bars > 0 && last_recorded != out.stats.bars)
+      record_equity(last_epoch);
+    summarise();
+  }
+
+private:
+  void step(int64_t epoch, double price, const BarSignal &s) {
+    ++out.stats.bars;
+    last_epoch = epoch;
+    last_price = price;
+
+    if (open)
+      check_exit(epoch, price);
+    if (!open)
+      check_entry(epoch, price, s);
+
+    peak = std::max(peak, equity);
+    max_dd = std::max(max_dd, peak - equity);
+    if (peak > 0.0)
+      max_dd_pct = std::max(max_dd_pct, (peak - equity) / peak * 100.0);
+
+    int every = std::max(p.equity_every, 1);
+    if (out.stats.bars % every == 0)
+      record_equity(epoch);
+  }
+
+  void check_exit(int64_t epoch, double price) {
+    double change = side * (price - entry_price) / entry_price * 100.0;
+    if (change >= p.take_profit_pct)
+      close_position(epoch, price, ENGINE_EXIT_TAKE_PROFIT);
+    else if (change <= -p.stop_loss_pct)
+      close_position(epoch, price, ENGINE_EXIT_STOP_LOSS);
+    else if (p.max_hold_seconds > 0 &&
+             epoch - entry_epoch >= p.max_hold_seconds)
+      close_position(epoch, price, ENGINE_EXIT_MAX_HOLD);
+  }
+
+  void check_entry(int64_t epoch, double price, const BarSignal &s) {
+    int dir = s.signal >= p.signal_threshold         ? 1
+              : s.signal <= 1.0 - p.signal_threshold ? -1
+                                                     : 0;
+    if (dir == 0)
+      return;
+
+    // RSI band, as IndicatorLayer's rsi_oversold/rsi_overbought
+    if ((dir > 0 && s.rsi >= p.rsi_overbought) ||
+        (dir < 0 && s.rsi <= p.rsi_oversold))
+      return;
+
+    int64_t day = epoch_day(epoch);
+    TradeInputs in;
+    in.stake = p.stake_fraction > 0.0 ? equity * p.stake_fraction
+                                      : ctx.risk->stake_for(equity);
+    in.active_trades = 0;
+    in.account_known = true;
+    in.account = {equity, equity, equity};
+    in.today = ledger.snapshot(day, equity);
+    in.losing_streak = ctx.losing_streak(day);
+    in.cooldown_elapsed_ns = epoch * NS_PER_SECOND - last_entry_ns;
+    in.cooldown_ns = cfg.cooldown_ns;
+    in.correlation = 0.0;
+    in.volatility_ratio = returns.volatility_ratio();
+
+    EngineTradeDecision decision;
+    if (check_trade_limits(cfg, *ctx.risk, in, decision) !=
+        ENGINE_TRADE_APPROVED) {
+      ++out.stats.rejected;
+      return;
+    }
+
+    open = true;
+    side = dir;
+    entry_epoch = epoch;
+    entry_price = price;
+    stake = decision.stake;
+    last_entry_ns = epoch * NS_PER_SECOND;
+  }
+
+  void close_position(int64_t epoch, double price, int32_t reason) {
+    double change = side * (price - entry_price) / entry_price;
+    double pnl = stake * change * p.leverage;
+    equity += pnl;
+    open = false;
+
+    int64_t day = epoch_day(epoch);
+    ledger.record(day, equity, pnl);
+    ctx.record_result(day, pnl);
+
+    EngineBacktestStats &st = out.stats;
+    ++st.trades;
+    if (pnl > 0.0) {
+      ++st.wins;
+      gross_win += pnl;
+      st.largest_win = std::max(st.largest_win, pnl);
+    } else {
+      ++st.losses;
+      gross_loss -= pnl;
+      st.largest_loss = std::min(st.largest_loss, pnl);
+    }
+    pnl_sum += pnl;
+    pnl_sq_sum += pnl * pnl;
+    hold_sum += static_cast<double>(epoch - entry_epoch);
+
+    if (out.trades && out.trades_count < out.trades_capacity) {
+      EngineBacktestTrade &t = out.trades[out.trades_count];
+      t.entry_epoch = entry_epoch;
+      t.exit_epoch = epoch;
+      t.side = side;
+      t.exit_reason = reason;
+      t.entry_price = entry_price;
+      t.exit_price = price;
+      t.stake = stake;
+      t.pnl = pnl;
+      t.pnl_pct = change * p.leverage * 100.0;
+    }
+    ++out.trades_count;
+  }
+
+  void record_equity(int64_t epoch) {
+    double dd = peak > 0.0 ? (peak - equity) / peak * 100.0 : 0.0;
+    if (out.equity && out.equity_count < out.equity_capacity)
+      out.equity[out.equity_count] = {epoch, equity, dd};
+    ++out.equity_count;
+    last_recorded = out.stats.bars;
+  }
+
+  void summarise() {
+    EngineBacktestStats &st = out.stats;
+    st.final_equity = equity;
+    st.total_pnl = equity - p.initial_balance;
+    st.max_drawdown = max_dd;
+    st.max_drawdown_pct = max_dd_pct;
+    if (st.trades == 0)
+      return;
+    double n = static_cast<double>(st.trades);
+    st.win_rate = st.wins / n * 100.0;
+    st.profit_factor = gross_loss > 0.0 ? gross_win / gross_loss
+                       : gross_win > 0.0 ? 999.0
+                                         : 0.0;
+    st.avg_win = st.wins ? gross_win / st.wins : 0.0;
+    st.avg_loss = st.losses ? gross_loss / st.losses : 0.0;
+    st.expectancy = pnl_sum / n;
+    st.avg_hold_seconds = hold_sum / n;
+    double var = pnl_sq_sum / n - st.expectancy * st.expectancy;
+    st.sharpe = var > 0.0 ? st.expectancy / std::sqrt(var) : 0.0;
+  }
+
+  static int64_t epoch_day(int64_t epoch) {
+    return bucket_start(epoch, 86400) / 86400;
+  }
+
+  EngineConfig cfg;
+  const EngineBacktestParams &p;
+  EngineBacktestOutput &out;
+  Arena arena; // the context's candles, at the default capacities
+  SymbolContext ctx;
+  ReturnSeries returns{}; // of the backtest timeframe's bars (1m for ticks)
+  RiskLedger ledger;
+  int32_t tf;
+
+  // Simulated account
+  double equity;
+  double peak;
+  double max_dd = 0.0, max_dd_pct = 0.0;
+
+  // Open position
+  bool open = false;
+  int32_t side = 0;
+  int64_t entry_epoch = 0;
+  double entry_price = 0.0;
+  double stake = 0.0;
+  int64_t last_entry_ns = INT64_MIN / 2;
+
+  int64_t last_epoch = 0;
+  double last_price = 0.0;
+  int64_t last_recorded = 0;
+
+  double gross_win = 0.0, gross_loss = 0.0;
+  double pnl_sum = 0.0, pnl_sq_sum = 0.0, hold_sum = 0.0;
+};
+
+#endif // BACKTEST_HPP
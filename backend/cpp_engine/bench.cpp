@@ -0,0 +1,523 @@
+/**
+ * Microbenchmarks and load test for the engine's C exports.
+ *
+ *   make bench                          # build bench_engine and run it
+ *   make bench BENCH_ARGS="--threads 8 --filter tick"
+ *
+ * Drives the exports the Python side calls (JSON and binary tick paths,
+ * batches, ticks with open positions, trade checks for one account and
+ * fanned out over several, entry filters, candle/indicator reads, the
+ * bulk series kernels, get_metrics, journal recording and replay) and the
+ * indicator, candle, correlation and engine clock kernels
+ * with synthetic Deriv streams: R_100 and V75 random walks, and Boom/Crash
+ * 300 with drift between spikes about every 300 ticks. Each row reports
+ * throughput, a per-call latency distribution (the engine's own
+ * LatencyHistogram; the "clock" row is the timer's own cost) and heap
+ * allocations per call, counted by replacing the global operator new.
+ * --threads N adds a load test with N threads, one symbol each (--shared:
+ * all on one symbol, to measure contention). --json prints one JSON
+ * object per row for comparing runs.
+ *
+ * Streams are seeded, so runs over the same build are comparable.
+ */
+
+#include "arena.hpp"
+#include "candles.hpp"
+#include "clock.hpp"
+#include "correlation.hpp"
+#include "engine.hpp"
+#include "indicators.hpp"
+#include "json.hpp"
+#include "metrics.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using json = nlohmann::json;
+using namespace std;
+
+// --- Allocation counting ---
+// GCC flags free() of operator new memory even when both are replaced
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+static std::atomic<uint64_t> alloc_calls{0};
+static std::atomic<uint64_t> alloc_bytes{0};
+
+void *operator new(size_t n) {
+  alloc_calls.fetch_add(1, std::memory_order_relaxed);
+  alloc_bytes.fetch_add(n, std::memory_order_relaxed);
+  if (void *p = std::malloc(n ? n : 1))
+    return p;
+  throw std::bad_alloc();
+}
+void *operator new[](size_t n) { return operator new(n); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete[](void *p, size_t) noexcept { std::free(p); }
+
+// --- Synthetic Deriv streams ---
+struct StreamSpec {
+  const char *symbol;
+  double start;
+  double sigma;       // per-tick relative volatility
+  double drift;       // per-tick relative drift between spikes
+  double spike_every; // mean ticks between spikes (0 = none)
+  double spike_size;  // relative size of a spike (negative = crash)
+};
+
+// 1-second ticks; sigma from the index's annualised volatility
+static const double SQRT_YEAR_SECONDS = std::sqrt(365.0 * 86400.0);
+static const StreamSpec STREAMS[] = {
+    {"R_100", 1000.0, 1.00 / SQRT_YEAR_SECONDS, 0.0, 0.0, 0.0},
+    {"R_75", 50000.0, 0.75 / SQRT_YEAR_SECONDS, 0.0, 0.0, 0.0},
+    {"BOOM300N", 5000.0, 0.05 / SQRT_YEAR_SECONDS, -2e-5, 300.0, 0.006},
+    {"CRASH300N", 5000.0, 0.05 / SQRT_YEAR_SECONDS, 2e-5, 300.0, -0.006},
+};
+constexpr int STREAM_COUNT = sizeof(STREAMS) / sizeof(STREAMS[0]);
+
+// Continues where it left off, so every batch has newer epochs
+class TickStream {
+public:
+  TickStream(const StreamSpec &spec, uint64_t seed)
+      : spec(spec), price(spec.start), rng(seed) {}
+
+  void fill(int32_t symbol_id, std::vector<EngineTick> &out, size_t n) {
+    std::normal_distribution<double> noise(0.0, spec.sigma);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    out.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+      double r = spec.drift + noise(rng);
+      if (spec.spike_every > 0 && uniform(rng) < 1.0 / spec.spike_every)
+        r += spec.spike_size * (0.5 + uniform(rng));
+      price *= 1.0 + r;
+      out[i] = {symbol_id, 0, epoch++, price};
+    }
+  }
+
+  const StreamSpec &spec;
+
+private:
+  double price;
+  int64_t epoch = 1700000000;
+  std::mt19937_64 rng;
+};
+
+// --- Runner ---
+struct Options {
+  size_t ticks = 200000;
+  int threads = 0;
+  bool shared = false;
+  bool as_json = false;
+  std::string filter;
+};
+
+static Options options;
+
+struct Row {
+  std::string name;
+  uint64_t calls = 0;
+  uint64_t items = 0; // ticks/candles handled (== calls unless batched)
+  double seconds = 0.0;
+  uint64_t allocs = 0;
+  uint64_t bytes = 0;
+  LatencyHistogram::Snapshot latency;
+};
+
+static void print_row(const Row &r) {
+  json s = r.latency.summary();
+  double per_call = r.calls ? double(r.allocs) / r.calls : 0.0;
+  double bytes_per_call = r.calls ? double(r.bytes) / r.calls : 0.0;
+  double rate = r.seconds > 0 ? r.items / r.seconds : 0.0;
+  if (options.as_json) {
+    json row = {{"name", r.name},
+                {"calls", r.calls},
+                {"items", r.items},
+                {"items_per_second", rate},
+                {"allocs_per_call", per_call},
+                {"bytes_per_call", bytes_per_call},
+                {"latency", s}};
+    std::printf("%s\n", row.dump().c_str());
+    return;
+  }
+  std::printf("%-34s %10.3f M/s %9.3f %9.3f %9.3f %10.3f %8.2f %9.1f\n",
+              r.name.c_str(), rate / 1e6, s["p50_us"].get<double>(),
+              s["p99_us"].get<double>(), s["p999_us"].get<double>(),
+              s["max_us"].get<double>(), per_call, bytes_per_call);
+}
+
+static bool selected(const std::string &name) {
+  return options.filter.empty() ||
+         name.find(options.filter) != std::string::npos;
+}
+
+// Time `calls` invocations of fn(i) one by one; each handles `items_per_call`
+static void run(const std::string &name, size_t calls, size_t items_per_call,
+                const std::function<void(size_t)> &fn) {
+  if (!selected(name))
+    return;
+  LatencyHistogram hist;
+  uint64_t allocs0 = alloc_calls.load(), bytes0 = alloc_bytes.load();
+  int64_t begin = steady_now_ns();
+  int64_t t = begin;
+  for (size_t i = 0; i < calls; ++i) {
+    fn(i);
+    int64_t now = steady_now_ns();
+    hist.record_serialised(now - t);
+    t = now;
+  }
+  uint64_t allocs = alloc_calls.load() - allocs0;
+  uint64_t bytes = alloc_bytes.load() - bytes0;
+  Row r;
+  r.name = name;
+  r.calls = calls;
+  r.items = calls * items_per_call;
+  r.seconds = (t - begin) / 1e9;
+  r.allocs = allocs;
+  r.bytes = bytes;
+  r.latency.add(hist);
+  print_row(r);
+}
+
+// --- Benchmarks ---
+static void bench_ticks(const StreamSpec &spec, uint64_t seed) {
+  std::string sym = spec.symbol;
+  int32_t id = create_symbol_context(spec.symbol);
+  TickStream stream(spec, seed);
+  std::vector<EngineTick> ticks;
+  EngineTickResult result;
+
+  stream.fill(id, ticks, options.ticks);
+  run("process_tick_bin/" + sym, ticks.size(), 1,
+      [&](size_t i) { process_tick_bin(&ticks[i], &result); });
+
+  // The same with the symbol's strategy evaluated at every price (its
+  // default kind; trades are rejected by the cooldown after the first)
+  EngineStrategySignal signal;
+  EngineTradeDecision decision;
+  stream.fill(id, ticks, options.ticks);
+  run("process_tick_strategy/" + sym, ticks.size(), 1, [&](size_t i) {
+    process_tick_strategy(&ticks[i], 0, &result, &signal, &decision);
+  });
+
+  // Same stream with open positions to evaluate on every tick; levels are
+  // far enough from price that none of them exits
+  constexpr int64_t POSITIONS = 16;
+  stream.fill(id, ticks, options.ticks);
+  double entry = ticks.front().quote;
+  for (int64_t c = 1; c <= POSITIONS; ++c) {
+    EnginePosition p{c, id, c % 2 ? 1 : -1, ENGINE_TRAIL_NONE, 0, entry,
+                     0.0, 0.0};
+    p.stop_loss = entry * (1.0 - 0.5 * p.side);
+    p.take_profit = entry * (1.0 + 0.5 * p.side);
+    open_position(&p);
+  }
+  run("tick_bin+positions[16]/" + sym, ticks.size(), 1,
+      [&](size_t i) { process_tick_bin(&ticks[i], &result); });
+  for (int64_t c = 1; c <= POSITIONS; ++c)
+    close_position(id, c);
+
+  // JSON strings built up front so only the engine's work is measured
+  stream.fill(id, ticks, options.ticks / 4);
+  std::vector<std::string> frames(ticks.size());
+  char buf[128];
+  for (size_t i = 0; i < ticks.size(); ++i) {
+    std::snprintf(buf, sizeof(buf),
+                  "{\"symbol\":\"%s\",\"quote\":%.5f,\"epoch\":%lld}",
+                  spec.symbol, ticks[i].quote,
+                  static_cast<long long>(ticks[i].epoch));
+    frames[i] = buf;
+  }
+  run("process_tick/" + sym, frames.size(), 1,
+      [&](size_t i) { process_tick(frames[i].c_str()); });
+
+  constexpr size_t BATCH = 1024;
+  stream.fill(id, ticks, options.ticks / BATCH * BATCH);
+  std::vector<EngineTickResult> results(BATCH);
+  run("process_ticks[1024]/" + sym, ticks.size() / BATCH, BATCH,
+      [&](size_t i) {
+        process_ticks(&ticks[i * BATCH], BATCH, results.data());
+      });
+
+  EngineIndicators ind;
+  run("get_indicators/" + sym, options.ticks / 4, 1,
+      [&](size_t) { get_indicators(id, ENGINE_TF_1M, &ind); });
+  EngineCandleView view;
+  run("get_candles/" + sym, options.ticks / 4, 1,
+      [&](size_t) { get_candles(id, ENGINE_TF_1M, &view); });
+  EngineStructure structure;
+  run("get_structure/" + sym, options.ticks / 4, 1,
+      [&](size_t) { get_structure(id, ENGINE_TF_1M, &structure); });
+  EngineFilterRequest filter{id, ENGINE_TF_1M, 1, 0};
+  EngineFilterResult verdict;
+  run("filter_entry/" + sym, options.ticks / 4, 1,
+      [&](size_t) { filter_entry(&filter, &verdict); });
+}
+
+static void bench_trades() {
+  int32_t id = create_symbol_context("R_100");
+  set_symbol_cooldown(id, 0);
+  size_t n = options.ticks / 4;
+
+  EngineTradeRequest approve{id, 0, 1.0};
+  EngineTradeDecision decision;
+  run("execute_trade_bin/approved", n, 1,
+      [&](size_t) { execute_trade_bin(&approve, &decision); });
+  EngineTradeRequest reject{id, 0, 1e9}; // above max stake
+  run("execute_trade_bin/rejected", n, 1,
+      [&](size_t) { execute_trade_bin(&reject, &decision); });
+  EngineTradeRequest sized{id, 0, 0.0}; // stake from the risk policy
+  run("execute_trade_bin/policy_stake", n, 1,
+      [&](size_t) { execute_trade_bin(&sized, &decision); });
+
+  // One signal against 8 mirrored accounts per call
+  constexpr size_t ACCOUNTS = 8;
+  EngineAccountTrade orders[ACCOUNTS];
+  EngineTradeDecision decisions[ACCOUNTS];
+  for (size_t a = 0; a < ACCOUNTS; ++a) {
+    std::string name = "bench-" + std::to_string(a);
+    orders[a] = {create_account_context(name.c_str()), 0, 1.0};
+    set_account_state(orders[a].account_id, 1000.0, 1000.0, 1000.0);
+  }
+  run("execute_trade_accounts[8]", n, ACCOUNTS, [&](size_t) {
+    execute_trade_accounts(id, 1, orders, ACCOUNTS, decisions);
+  });
+
+  const char *params = "{\"symbol\":\"R_100\",\"action\":\"BUY\","
+                       "\"stake\":1.0,\"active_trades\":0}";
+  run("execute_trade/approved", n, 1,
+      [&](size_t) { execute_trade(params); });
+}
+
+// Recording cost on the tick path, then the replay of what was recorded
+static void bench_journal() {
+  if (!selected("journal"))
+    return;
+  const char *path = "bench_engine.journal";
+  std::string sym = STREAMS[0].symbol;
+  int32_t id = create_symbol_context(STREAMS[0].symbol);
+  TickStream stream(STREAMS[0], 13);
+  std::vector<EngineTick> ticks;
+  EngineTickResult result;
+  EngineTradeRequest req{id, 0, 1.0};
+  EngineTradeDecision decision;
+  stream.fill(id, ticks, options.ticks);
+  if (journal_start(path) != ENGINE_OK)
+    return;
+  // A trade check every 64 ticks, as a strategy asks for one
+  run("journal/tick_bin+record/" + sym, ticks.size(), 1, [&](size_t i) {
+    process_tick_bin(&ticks[i], &result);
+    if (i % 64 == 0)
+      execute_trade_bin(&req, &decision);
+  });
+  int64_t records = journal_stop();
+  EngineReplayStats stats{};
+  run("journal/replay", 1, records > 0 ? size_t(records) : 0,
+      [&](size_t) { journal_replay(path, &stats); });
+  if (stats.mismatches > 0)
+    std::fprintf(stderr, "journal replay: %lld mismatched decisions\n",
+                 static_cast<long long>(stats.mismatches));
+  std::remove(path);
+}
+
+static void bench_kernels() {
+  TickStream stream(STREAMS[0], 7);
+  std::vector<EngineTick> ticks;
+  stream.fill(0, ticks, options.ticks);
+
+  Arena arena(CandleRing::bytes_for(1000));
+  CandleAggregator agg;
+  agg.reset(60, arena, 1000);
+  run("kernel/CandleAggregator::on_tick", ticks.size(), 1, [&](size_t i) {
+    agg.on_tick(ticks[i].epoch, ticks[i].quote);
+  });
+
+  std::vector<EngineCandle> candles(ticks.size());
+  for (size_t i = 0; i < ticks.size(); ++i) {
+    double q = ticks[i].quote;
+    candles[i] = {ticks[i].epoch, q, q * 1.0005, q * 0.9995, q, 1.0};
+  }
+  IndicatorSet set;
+  run("kernel/IndicatorSet::update", candles.size(), 1,
+      [&](size_t i) { set.update(candles[i]); });
+
+  // One pair of the correlation gate, over full windows
+  ReturnSeries a{}, b{};
+  for (size_t i = 0; i < candles.size(); ++i) {
+    a.on_close(int64_t(i), candles[i].close);
+    b.on_close(int64_t(i), candles[i].close * (1.0 + 0.001 * (i % 3)));
+  }
+  double corr = 0.0;
+  run("kernel/return_correlation", options.ticks, 1, [&](size_t) {
+    int32_t n = 0;
+    corr += return_correlation(a, b, n);
+  });
+
+  // The clock trade checks read, against reading both system clocks
+  EngineClock clock;
+  int64_t sink = 0;
+  run("kernel/EngineClock::now", options.ticks, 1,
+      [&](size_t) { sink += clock.now().mono_ns; });
+  run("kernel/steady+wall clocks", options.ticks, 1,
+      [&](size_t) { sink += steady_now_ns() + wall_now_ns(); });
+  if (sink == 42 && corr == 0.0)
+    std::printf("\n");
+}
+
+// Bulk series exports over one history window of candle columns
+static void bench_series() {
+  constexpr size_t BARS = 4096;
+  TickStream stream(STREAMS[1], 11);
+  std::vector<EngineTick> ticks;
+  stream.fill(0, ticks, BARS);
+  std::vector<double> high(BARS), low(BARS), close(BARS), a(BARS), b(BARS);
+  std::vector<uint8_t> flags(BARS);
+  for (size_t i = 0; i < BARS; ++i) {
+    close[i] = ticks[i].quote;
+    high[i] = close[i] * 1.0005;
+    low[i] = close[i] * 0.9995;
+  }
+  std::string tag = std::string("[4096]/") + series_backend();
+  size_t calls = std::max<size_t>(options.ticks / BARS, 16);
+  run("series/true_range" + tag, calls, BARS, [&](size_t) {
+    series_true_range(high.data(), low.data(), close.data(), BARS, a.data());
+  });
+  run("series/rolling_max(50)" + tag, calls, BARS, [&](size_t) {
+    series_rolling_max(close.data(), BARS, 50, a.data());
+  });
+  run("series/rolling_mean_std(20)" + tag, calls, BARS, [&](size_t) {
+    series_rolling_mean_std(close.data(), BARS, 20, a.data(), b.data());
+  });
+  run("series/swings(5)" + tag, calls, BARS, [&](size_t) {
+    series_swings(high.data(), low.data(), BARS, 5, flags.data());
+  });
+  run("series/atr(14)" + tag, calls, BARS, [&](size_t) {
+    series_atr(high.data(), low.data(), close.data(), BARS, 14, a.data());
+  });
+}
+
+// --- Load test ---
+static void load_test(int threads, bool shared) {
+  std::vector<std::vector<EngineTick>> streams(threads);
+  for (int t = 0; t < threads; ++t) {
+    const StreamSpec &spec = STREAMS[t % STREAM_COUNT];
+    std::string sym = shared ? "R_100" : std::string(spec.symbol) + "_" +
+                                             std::to_string(t);
+    TickStream stream(shared ? STREAMS[0] : spec, 100 + t);
+    stream.fill(create_symbol_context(sym.c_str()), streams[t],
+                options.ticks);
+  }
+  if (shared) {
+    // One symbol: interleave epochs so every thread's ticks stay ordered
+    for (int t = 0; t < threads; ++t)
+      for (size_t i = 0; i < streams[t].size(); ++i)
+        streams[t][i].epoch = 1800000000 + int64_t(i) * threads + t;
+  }
+
+  std::vector<unique_ptr<LatencyHistogram>> hists(threads);
+  for (auto &h : hists)
+    h.reset(new LatencyHistogram());
+  std::atomic<int> ready{0};
+  std::atomic<bool> go{false};
+  uint64_t allocs0 = alloc_calls.load(), bytes0 = alloc_bytes.load();
+  std::vector<std::thread> pool;
+  for (int t = 0; t < threads; ++t) {
+    pool.emplace_back([&, t] {
+      EngineTickResult res;
+      ready.fetch_add(1);
+      while (!go.load())
+        std::this_thread::yield();
+      int64_t last = steady_now_ns();
+      for (const EngineTick &tick : streams[t]) {
+        process_tick_bin(&tick, &res);
+        int64_t now = steady_now_ns();
+        hists[t]->record_serialised(now - last);
+        last = now;
+      }
+    });
+  }
+  while (ready.load() < threads)
+    std::this_thread::yield();
+  int64_t begin = steady_now_ns();
+  go = true;
+  for (auto &th : pool)
+    th.join();
+  double seconds = (steady_now_ns() - begin) / 1e9;
+  uint64_t allocs = alloc_calls.load() - allocs0;
+  uint64_t bytes = alloc_bytes.load() - bytes0;
+
+  Row r;
+  r.name = "load/process_tick_bin x" + std::to_string(threads) +
+           (shared ? " shared" : "");
+  r.calls = r.items = uint64_t(threads) * options.ticks;
+  r.seconds = seconds;
+  r.allocs = allocs;
+  r.bytes = bytes;
+  for (auto &h : hists)
+    r.latency.add(*h);
+  print_row(r);
+}
+
+static void usage() {
+  std::printf("usage: bench_engine [--ticks N] [--threads N] [--shared] "
+              "[--filter TEXT] [--json]\n");
+}
+
+int main(int argc, char **argv) {
+  for (int i = 1; i < argc; ++i) {
+    std::string a = argv[i];
+    bool has_value = i + 1 < argc;
+    if (a == "--ticks" && has_value)
+      options.ticks = std::max<size_t>(1024, std::strtoull(argv[++i], 0, 10));
+    else if (a == "--threads" && has_value)
+      options.threads = std::atoi(argv[++i]);
+    else if (a == "--shared")
+      options.shared = true;
+    else if (a == "--filter" && has_value)
+      options.filter = argv[++i];
+    else if (a == "--json")
+      options.as_json = true;
+    else {
+      usage();
+      return a == "--help" ? 0 : 2;
+    }
+  }
+
+  // Generous limits so trade checks run to the end instead of failing fast.
+  // With --json, keep the engine's log line out of the JSON rows.
+  if (options.as_json)
+    std::cout.setstate(std::ios::failbit);
+  init_engine("{\"cooldown_seconds\":0,\"max_active_trades\":1000000,"
+              "\"max_stake\":1000,\"max_daily_loss\":100,"
+              "\"max_sl_hits\":1000000}");
+  update_account(1e9, 1e9, 1e9);
+  std::cout.clear();
+
+  if (!options.as_json)
+    std::printf("%-34s %14s %9s %9s %9s %10s %8s %9s\n", "benchmark",
+                "throughput", "p50 us", "p99 us", "p999 us", "max us",
+                "allocs", "bytes");
+
+  run("clock", options.ticks, 1, [](size_t) {});
+  for (int s = 0; s < STREAM_COUNT; ++s)
+    bench_ticks(STREAMS[s], 1 + s);
+  bench_trades();
+  bench_journal();
+  bench_kernels();
+  bench_series();
+  run("get_metrics", 200, 1, [](size_t) { get_metrics(); });
+  if (options.threads > 0 && selected("load"))
+    load_test(options.threads, options.shared);
+  return 0;
+}
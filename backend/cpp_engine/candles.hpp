@@ -0,0 +1,196 @@
+/**
+ * Multi-timeframe OHLC candle aggregation for the trading engine.
+ *
+ * Closed candles live in a fixed-capacity ring of structure-of-arrays
+ * columns (epoch/open/high/low/close/volume). Every slot is written twice,
+ * at i and i + capacity, so the closed candles always form one contiguous
+ * run, oldest first, that can be handed to Python as zero-copy arrays.
+ * The columns are carved from an Arena, so a ring never reallocates and
+ * its views stay valid for the arena's lifetime.
+ *
+ * Bucketing is plain integer math on the epoch: a tick belongs to the
+ * candle starting at epoch - epoch % period (UTC aligned, like Deriv).
+ */
+
+#ifndef CANDLES_HPP
+#define CANDLES_HPP
+
+#include "arena.hpp"
+#include "engine.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// Period of each EngineTimeframe in seconds
+constexpr int64_t TIMEFRAME_SECONDS[ENGINE_TF_COUNT] = {60, 300, 900, 3600};
+constexpr const char *TIMEFRAME_NAMES[ENGINE_TF_COUNT] = {"1m", "5m", "15m",
+                                                         "1h"};
+
+// Closed candles kept per timeframe (the deque maxlens MasterEngine used),
+// unless the memory budget sets other capacities
+constexpr size_t DEFAULT_CANDLE_CAPACITY[ENGINE_TF_COUNT] = {200, 200, 200,
+                                                             100};
+
+inline int64_t bucket_start(int64_t epoch, int64_t period) {
+  int64_t rem = epoch % period;
+  if (rem < 0)
+    rem += period;
+  return epoch - rem;
+}
+
+class CandleRing {
+public:
+  // Arena bytes of a ring of `capacity` candles
+  static constexpr size_t bytes_for(size_t capacity) {
+    return arena_bytes_for<int64_t>(2 * capacity) +
+           5 * arena_bytes_for<double>(2 * capacity);
+  }
+
+  // Take the columns from `arena`; a ring is sized once. False (and an
+  // empty ring) if the arena cannot hold them.
+  bool reset(Arena &arena, size_t capacity) {
+    total_ = 0;
+    epoch_ = arena.take<int64_t>(2 * capacity);
+    open_ = arena.take<double>(2 * capacity);
+    high_ = arena.take<double>(2 * capacity);
+    low_ = arena.take<double>(2 * capacity);
+    close_ = arena.take<double>(2 * capacity);
+    volume_ = arena.take<double>(2 * capacity);
+    bool ok = epoch_ && open_ && high_ && low_ && close_ && volume_;
+    cap = ok ? capacity : 0;
+    return ok;
+  }
+
+  void clear() { total_ = 0; }
+
+  void push(const EngineCandle &c) {
+    if (cap == 0)
+      return;
+    size_t slot = static_cast<size_t>(total_ % cap);
+    write(slot, c);
+    write(slot + cap, c);
+    ++total_;
+  }
+
+  // Overwrite the newest closed candle in place
+  void replace_back(const EngineCandle &c) {
+    if (size() == 0)
+      return;
+    size_t slot = static_cast<size_t>((total_ - 1) % cap);
+    write(slot, c);
+    write(slot + cap, c);
+  }
+
+  size_t size() const {
+    return total_ < cap ? static_cast<size_t>(total_) : cap;
+  }
+  size_t capacity() const { return cap; }
+  uint64_t total() const { return total_; }
+
+  EngineCandle back() const { return at(size() - 1); }
+
+  // i-th closed candle, oldest first
+  EngineCandle at(size_t i) const {
+    size_t p = first() + i;
+    return {epoch_[p], open_[p], high_[p], low_[p], close_[p], volume_[p]};
+  }
+
+  // Contiguous columns of size() candles, oldest first
+  const int64_t *epochs() const { return epoch_ + first(); }
+  const double *opens() const { return open_ + first(); }
+  const double *highs() const { return high_ + first(); }
+  const double *lows() const { return low_ + first(); }
+  const double *closes() const { return close_ + first(); }
+  const double *volumes() const { return volume_ + first(); }
+
+private:
+  size_t first() const {
+    return cap == 0 ? 0 : static_cast<size_t>((total_ - size()) % cap);
+  }
+
+  void write(size_t p, const EngineCandle &c) {
+    epoch_[p] = c.epoch;
+    open_[p] = c.open;
+    high_[p] = c.high;
+    low_[p] = c.low;
+    close_[p] = c.close;
+    volume_[p] = c.volume;
+  }
+
+  size_t cap = 0;
+  uint64_t total_ = 0;
+  int64_t *epoch_ = nullptr;
+  double *open_ = nullptr, *high_ = nullptr, *low_ = nullptr,
+         *close_ = nullptr, *volume_ = nullptr;
+};
+
+// Builds one timeframe's candles from ticks and closes them into its ring
+class CandleAggregator {
+public:
+  bool reset(int64_t period_seconds, Arena &arena, size_t capacity) {
+    period = period_seconds;
+    has_current = false;
+    return ring_.reset(arena, capacity);
+  }
+
+  void clear() {
+    ring_.clear();
+    has_current = false;
+  }
+
+  // Returns true when this tick closed the previous candle
+  bool on_tick(int64_t epoch, double price) {
+    int64_t start = bucket_start(epoch, period);
+    if (!has_current) {
+      open_candle(start, price);
+      return false;
+    }
+    if (start > current_.epoch) {
+      ring_.push(current_);
+      open_candle(start, price);
+      return true;
+    }
+    // Same period (or a late tick): update the forming candle
+    if (price > current_.high)
+      current_.high = price;
+    if (price < current_.low)
+      current_.low = price;
+    current_.close = price;
+    current_.volume += 1;
+    return false;
+  }
+
+  // Apply an externally built candle (e.g. a streaming OHLC update) at or
+  // after the forming bucket: a newer bucket closes the forming candle and
+  // starts `c`, the forming bucket itself is overwritten in place.
+  // Returns true when the previous candle closed.
+  bool upsert(const EngineCandle &c) {
+    EngineCandle bar = c;
+    bar.epoch = bucket_start(c.epoch, period);
+    bool closed = has_current && bar.epoch > current_.epoch;
+    if (closed)
+      ring_.push(current_);
+    current_ = bar;
+    has_current = true;
+    return closed;
+  }
+
+  int64_t period_seconds() const { return period; }
+
+  const CandleRing &ring() const { return ring_; }
+  CandleRing &ring() { return ring_; }
+  const EngineCandle &current() const { return current_; }
+  bool forming() const { return has_current; }
+
+private:
+  void open_candle(int64_t start, double price) {
+    current_ = {start, price, price, price, price, 1.0};
+    has_current = true;
+  }
+
+  int64_t period = 60;
+  CandleRing ring_;
+  EngineCandle current_{};
+  bool has_current = false;
+};
+
+#endif // CANDLES_HPP
@@ -0,0 +1,228 @@
+/**
+ * The clock trade decisions read.
+ *
+ * Cooldowns run on the monotonic clock; the daily risk counters and event
+ * timestamps on the wall clock. The engine reads both through one
+ * EngineClock rather than the system clocks, so a journal replay (see
+ * journal.hpp) can pin them to the times recorded with each input and make
+ * every decision again exactly as it was made live. Latency metrics keep
+ * reading steady_now_ns() directly: they measure this process, they do not
+ * decide anything.
+ *
+ * Live, both clocks come from one read of the CPU's invariant cycle
+ * counter (rdtsc, cntvct_el0), converted with an anchor taken from the
+ * system clocks: a few ns instead of two clock_gettime calls. Whichever
+ * reader finds the anchor older than CYCLE_REANCHOR_NS re-takes it and
+ * re-measures the counter's rate over the interval, so the conversion
+ * follows NTP slewing, and the monotonic reading never steps back. Without
+ * an invariant counter the system clocks are read directly (the wall clock
+ * coarsely; it only feeds days and millisecond timestamps).
+ */
+
+#ifndef CLOCK_HPP
+#define CLOCK_HPP
+
+#include "metrics.hpp"
+#include "seqlock.hpp"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <ctime>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+constexpr int64_t NS_PER_DAY = 86400 * NS_PER_SECOND;
+
+// How long a cycle-counter anchor is extrapolated before it is re-taken
+constexpr int64_t CYCLE_REANCHOR_NS = 100 * 1000000;
+
+inline int64_t wall_now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+// Wall clock at the kernel tick's resolution (a few ms), without a
+// hardware counter read
+inline int64_t coarse_wall_now_ns() {
+#ifdef CLOCK_REALTIME_COARSE
+  timespec ts;
+  if (clock_gettime(CLOCK_REALTIME_COARSE, &ts) == 0)
+    return int64_t(ts.tv_sec) * NS_PER_SECOND + ts.tv_nsec;
+#endif
+  return wall_now_ns();
+}
+
+// Seconds (possibly fractional) as a duration on the engine clock
+inline int64_t seconds_to_ns(double seconds) {
+  return static_cast<int64_t>(std::llround(seconds * NS_PER_SECOND));
+}
+
+inline double ns_to_seconds(int64_t ns) {
+  return static_cast<double>(ns) / NS_PER_SECOND;
+}
+
+// Both clocks read at one instant
+struct ClockReading {
+  int64_t mono_ns;
+  int64_t wall_ns;
+
+  // Days since the Unix epoch (UTC), for the daily risk counters
+  int64_t day() const { return wall_ns / NS_PER_DAY; }
+};
+
+inline uint64_t read_cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#elif defined(__aarch64__)
+  uint64_t v;
+  asm volatile("mrs %0, cntvct_el0" : "=r"(v));
+  return v;
+#else
+  return 0;
+#endif
+}
+
+// True if the counter ticks at a constant rate across cores and power
+// states (the generic timer always does)
+inline bool cycles_invariant() {
+#if defined(__x86_64__) || defined(__i386__)
+  unsigned a, b, c, d;
+  if (!__get_cpuid(0x80000007, &a, &b, &c, &d))
+    return false;
+  return (d & (1u << 8)) != 0;
+#elif defined(__aarch64__)
+  return true;
+#else
+  return false;
+#endif
+}
+
+// Process-wide converter from the cycle counter to both clocks
+class CycleClock {
+public:
+  CycleClock() : usable(cycles_invariant()) {
+    if (!usable)
+      return;
+    // First rate from a short spin; the first re-anchor refines it
+    Anchor a = sample();
+    Anchor b;
+    do
+      b = sample();
+    while (b.real_mono_ns - a.real_mono_ns < 1000000);
+    b.ns_per_cycle = rate(a, b);
+    usable = b.ns_per_cycle > 0.0;
+    anchor.store(b);
+  }
+
+  bool ok() const { return usable; }
+
+  ClockReading now() {
+    Anchor a = anchor.load();
+    int64_t ns = since(a, read_cycles());
+    if (ns >= CYCLE_REANCHOR_NS &&
+        !writing.exchange(true, std::memory_order_acquire)) {
+      a = reanchor(a);
+      writing.store(false, std::memory_order_release);
+      ns = 0;
+    }
+    return {a.mono_ns + ns, a.wall_ns + ns};
+  }
+
+private:
+  struct Anchor {
+    uint64_t cycles;
+    int64_t mono_ns;      // reported at `cycles` (never behind the last)
+    int64_t wall_ns;
+    int64_t real_mono_ns; // the steady clock at `cycles`, for the rate
+    double ns_per_cycle;
+    int64_t reserved;
+  };
+
+  static Anchor sample() {
+    Anchor a = {};
+    a.cycles = read_cycles();
+    a.real_mono_ns = a.mono_ns = steady_now_ns();
+    a.wall_ns = wall_now_ns();
+    return a;
+  }
+
+  // Nanoseconds from the anchor to counter value `c` (0 if `c` is behind
+  // it, e.g. read on a core whose counter lags by a few cycles)
+  static int64_t since(const Anchor &a, uint64_t c) {
+    int64_t cycles = static_cast<int64_t>(c - a.cycles);
+    if (cycles <= 0)
+      return 0;
+    return static_cast<int64_t>(static_cast<double>(cycles) * a.ns_per_cycle);
+  }
+
+  static double rate(const Anchor &from, const Anchor &to) {
+    if (to.cycles <= from.cycles)
+      return 0.0;
+    return static_cast<double>(to.real_mono_ns - from.real_mono_ns) /
+           static_cast<double>(to.cycles - from.cycles);
+  }
+
+  // Caller holds `writing`
+  Anchor reanchor(const Anchor &prev) {
+    Anchor next = sample();
+    // Keep the old rate if the new one is implausible (a migration
+    // between unsynchronised sockets, a suspended VM)
+    double r = rate(prev, next);
+    bool plausible = r > 0.5 * prev.ns_per_cycle && r < 2.0 * prev.ns_per_cycle;
+    next.ns_per_cycle = plausible ? r : prev.ns_per_cycle;
+    int64_t extrapolated = prev.mono_ns + since(prev, next.cycles);
+    if (extrapolated > next.mono_ns)
+      next.mono_ns = extrapolated;
+    anchor.store(next);
+    return next;
+  }
+
+  bool usable;
+  SeqLock<Anchor> anchor;
+  std::atomic<bool> writing{false};
+};
+
+inline CycleClock &cycle_clock() {
+  static CycleClock clock;
+  return clock;
+}
+
+class EngineClock {
+public:
+  // A manual clock only moves when set (journal replay); otherwise it
+  // reads the system clocks
+  explicit EngineClock(bool manual = false) : manual(manual) {}
+
+  ClockReading now() const {
+    if (manual)
+      return {mono.load(std::memory_order_relaxed),
+              wall.load(std::memory_order_relaxed)};
+    CycleClock &cycles = cycle_clock();
+    if (cycles.ok())
+      return cycles.now();
+    return {steady_now_ns(), coarse_wall_now_ns()};
+  }
+
+  void set(const ClockReading &r) {
+    mono.store(r.mono_ns, std::memory_order_relaxed);
+    wall.store(r.wall_ns, std::memory_order_relaxed);
+  }
+
+  // "manual", "cycles" or "system", for get_bot_state
+  const char *source() const {
+    if (manual)
+      return "manual";
+    return cycle_clock().ok() ? "cycles" : "system";
+  }
+
+private:
+  const bool manual;
+  std::atomic<int64_t> mono{0};
+  std::atomic<int64_t> wall{0};
+};
+
+#endif // CLOCK_HPP
@@ -0,0 +1,386 @@
+/**
+ * Append-only columnar history store for ticks and candles.
+ *
+ * Every symbol has one directory per series ("ticks", "1m", "5m", "15m",
+ * "1h") holding numbered segment files. A segment is a fixed-size file: a
+ * 64-byte header followed by an int64 epoch column and one double column
+ * per value (1 for ticks, 5 for candles: open/high/low/close/volume), each
+ * `capacity` rows long. Rows are written in place through a shared mapping:
+ * the values first, then the header's row count with release semantics, so
+ * a reader that maps the same file only ever sees complete rows. A full
+ * segment is never touched again; writing continues in the next one.
+ *
+ * Epochs within a series are strictly increasing (the writer drops rows
+ * that are not newer than the last one), which makes range lookups a
+ * binary search on the epoch column and makes re-feeding history that is
+ * already on disk a no-op.
+ */
+
+#ifndef COLUMN_STORE_HPP
+#define COLUMN_STORE_HPP
+
+#include "engine.hpp"
+#include "mapped_file.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <memory>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+constexpr char STORE_MAGIC[8] = {'I', 'T', 'C', 'C', 'O', 'L', '0', '1'};
+constexpr uint32_t STORE_VERSION = 1;
+constexpr uint32_t STORE_MAX_COLUMNS = 5;
+
+// Rows per segment: ~36 h of 1 s ticks (2 MB), ~11 days of 1m candles
+constexpr uint64_t TICK_SEGMENT_ROWS = 1 << 17;
+constexpr uint64_t CANDLE_SEGMENT_ROWS = 1 << 14;
+
+// Directory name of each series, indexed by EngineTimeframe then ticks
+constexpr const char *STORE_SERIES_NAMES[ENGINE_TF_COUNT + 1] = {
+    "1m", "5m", "15m", "1h", "ticks"};
+
+struct SegmentHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t columns;  // double columns after the epoch column
+  uint64_t capacity; // rows reserved in every column
+  uint64_t count;    // rows written, published after the row itself
+  int64_t first_epoch;
+  int64_t last_epoch;
+  uint64_t reserved[2];
+};
+static_assert(sizeof(SegmentHeader) == 64, "SegmentHeader layout changed");
+
+inline size_t segment_bytes(uint32_t columns, uint64_t capacity) {
+  return sizeof(SegmentHeader) + capacity * sizeof(int64_t) * (1 + columns);
+}
+
+// Symbol names become directory names: only [A-Za-z0-9_-] are accepted
+inline bool valid_store_name(const std::string &name) {
+  if (name.empty())
+    return false;
+  for (char c : name) {
+    bool ok = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+              (c >= '0' && c <= '9') || c == '_' || c == '-';
+    if (!ok)
+      return false;
+  }
+  return true;
+}
+
+inline std::string series_dir(const std::string &root,
+                              const std::string &symbol, int32_t series) {
+  return root + "/" + symbol + "/" + STORE_SERIES_NAMES[series];
+}
+
+// mkdir -p
+inline bool make_dirs(const std::string &path) {
+  for (size_t pos = 1; pos <= path.size(); ++pos) {
+    if (pos != path.size() && path[pos] != '/')
+      continue;
+    std::string part = path.substr(0, pos);
+    if (::mkdir(part.c_str(), 0755) != 0 && errno != EEXIST)
+      return false;
+  }
+  return true;
+}
+
+inline std::string segment_path(const std::string &dir, long index) {
+  char name[32];
+  std::snprintf(name, sizeof(name), "/%06ld.seg", index);
+  return dir + name;
+}
+
+// Indices of the segment files in `dir`, ascending
+inline std::vector<long> list_segments(const std::string &dir) {
+  std::vector<long> found;
+  DIR *d = ::opendir(dir.c_str());
+  if (!d)
+    return found;
+  while (dirent *e = ::readdir(d)) {
+    const char *name = e->d_name;
+    size_t len = std::strlen(name);
+    if (len < 5 || std::strcmp(name + len - 4, ".seg") != 0)
+      continue;
+    char *end = nullptr;
+    long index = std::strtol(name, &end, 10);
+    if (end == name + len - 4 && index >= 0)
+      found.push_back(index);
+  }
+  ::closedir(d);
+  std::sort(found.begin(), found.end());
+  return found;
+}
+
+// Columns of one segment as plain arrays
+struct SegmentView {
+  const SegmentHeader *header = nullptr;
+  const int64_t *epoch = nullptr;
+  const double *values[STORE_MAX_COLUMNS] = {};
+
+  size_t rows() const {
+    return static_cast<size_t>(
+        __atomic_load_n(&header->count, __ATOMIC_ACQUIRE));
+  }
+};
+
+inline bool bind_segment(const void *base, size_t length, uint32_t columns,
+                         SegmentView &view) {
+  if (length < sizeof(SegmentHeader))
+    return false;
+  auto *h = static_cast<const SegmentHeader *>(base);
+  if (std::memcmp(h->magic, STORE_MAGIC, sizeof(STORE_MAGIC)) != 0 ||
+      h->version != STORE_VERSION || h->columns != columns ||
+      length < segment_bytes(columns, h->capacity))
+    return false;
+  const int64_t *col = reinterpret_cast<const int64_t *>(h + 1);
+  view.header = h;
+  view.epoch = col;
+  for (uint32_t k = 0; k < columns; ++k)
+    view.values[k] =
+        reinterpret_cast<const double *>(col + (k + 1) * h->capacity);
+  return true;
+}
+
+// Appends rows to a series through a writable mapping of its newest
+// segment. Not thread-safe; each symbol context serialises its writers.
+class SeriesWriter {
+public:
+  SeriesWriter() = default;
+  ~SeriesWriter() { unmap(); }
+  SeriesWriter(const SeriesWriter &) = delete;
+  SeriesWriter &operator=(const SeriesWriter &) = delete;
+
+  // Continue the series in `dir` (created if missing). False on I/O error.
+  bool open(const std::string &directory, uint32_t value_columns,
+            uint64_t rows_per_segment) {
+    unmap();
+    dir = directory;
+    columns = value_columns;
+    capacity = rows_per_segment;
+    last = INT64_MIN;
+    if (!make_dirs(dir))
+      return false;
+    std::vector<long> segments = list_segments(dir);
+    long index = segments.empty() ? 0 : segments.back();
+    if (!map_segment(index))
+      return false;
+    last = header->count ? header->last_epoch : last;
+    // An earlier segment holds the last row if the newest one is empty
+    if (header->count == 0 && segments.size() > 1) {
+      long prev_index = segments[segments.size() - 2];
+      MappedFile prev(segment_path(dir, prev_index).c_str());
+      SegmentView v;
+      if (prev.ok() &&
+          bind_segment(prev.as<char>(), prev.size(), columns, v) &&
+          v.rows() > 0)
+        last = v.header->last_epoch;
+    }
+    return true;
+  }
+
+  bool is_open() const { return header != nullptr; }
+  int64_t last_epoch() const { return last; }
+
+  // Returns false only on I/O error; rows not newer than the last one are
+  // dropped silently.
+  bool append(int64_t epoch, const double *values) {
+    if (!header)
+      return false;
+    if (epoch <= last)
+      return true;
+    if (header->count == header->capacity && !map_segment(segment + 1)) {
+      unmap();
+      return false;
+    }
+    uint64_t row = header->count;
+    epoch_col[row] = epoch;
+    for (uint32_t k = 0; k < columns; ++k)
+      value_cols[k][row] = values[k];
+    if (row == 0)
+      header->first_epoch = epoch;
+    header->last_epoch = epoch;
+    __atomic_store_n(&header->count, row + 1, __ATOMIC_RELEASE);
+    last = epoch;
+    return true;
+  }
+
+  // Schedule write-back of the dirty pages (the page cache already makes
+  // rows visible to readers; this only matters for a machine crash)
+  void flush() {
+    if (base)
+      ::msync(base, length, MS_ASYNC);
+  }
+
+private:
+  bool map_segment(long index) {
+    unmap();
+    std::string path = segment_path(dir, index);
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+      return false;
+    struct stat st;
+    size_t want = segment_bytes(columns, capacity);
+    bool fresh = ::fstat(fd, &st) == 0 && st.st_size == 0;
+    if (fresh && ::ftruncate(fd, static_cast<off_t>(want)) != 0) {
+      ::close(fd);
+      return false;
+    }
+    size_t size = fresh ? want : static_cast<size_t>(st.st_size);
+    void *p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED)
+      return false;
+    base = p;
+    length = size;
+
+    auto *h = static_cast<SegmentHeader *>(base);
+    if (fresh) {
+      std::memcpy(h->magic, STORE_MAGIC, sizeof(STORE_MAGIC));
+      h->version = STORE_VERSION;
+      h->columns = columns;
+      h->capacity = capacity;
+    }
+    SegmentView view;
+    if (!bind_segment(base, length, columns, view)) {
+      unmap();
+      return false;
+    }
+    header = h;
+    segment = index;
+    epoch_col = const_cast<int64_t *>(view.epoch);
+    for (uint32_t k = 0; k < columns; ++k)
+      value_cols[k] = const_cast<double *>(view.values[k]);
+    return true;
+  }
+
+  void unmap() {
+    if (base)
+      ::munmap(base, length);
+    base = nullptr;
+    length = 0;
+    header = nullptr;
+  }
+
+  std::string dir;
+  uint32_t columns = 0;
+  uint64_t capacity = 0;
+  long segment = 0;
+  void *base = nullptr;
+  size_t length = 0;
+  SegmentHeader *header = nullptr;
+  int64_t *epoch_col = nullptr;
+  double *value_cols[STORE_MAX_COLUMNS] = {};
+  int64_t last = INT64_MIN;
+};
+
+// Read-only view of a whole series: every segment mapped, addressed by a
+// global row index. Rows appended after opening are picked up up to the
+// end of the segments that existed then.
+class SeriesReader {
+public:
+  bool open(const std::string &dir, uint32_t value_columns) {
+    files.clear();
+    views.clear();
+    columns = value_columns;
+    for (long index : list_segments(dir)) {
+      std::unique_ptr<MappedFile> f(
+          new MappedFile(segment_path(dir, index).c_str()));
+      SegmentView v;
+      if (!f->ok() || !bind_segment(f->as<char>(), f->size(), columns, v))
+        return false;
+      files.push_back(std::move(f));
+      views.push_back(v);
+    }
+    return true;
+  }
+
+  size_t rows() const {
+    size_t n = 0;
+    for (const SegmentView &v : views)
+      n += v.rows();
+    return n;
+  }
+
+  // Index of the first row with epoch >= `epoch`
+  size_t lower_bound(int64_t epoch) const {
+    size_t base = 0;
+    for (const SegmentView &v : views) {
+      size_t n = v.rows();
+      if (n > 0 && v.epoch[n - 1] >= epoch)
+        return base + static_cast<size_t>(
+                          std::lower_bound(v.epoch, v.epoch + n, epoch) -
+                          v.epoch);
+      base += n;
+    }
+    return base;
+  }
+
+  // fn(const SegmentView &, size_t row) for global rows [begin, end)
+  template <typename Fn>
+  void for_rows(size_t begin, size_t end, Fn &&fn) const {
+    size_t base = 0;
+    for (const SegmentView &v : views) {
+      size_t n = v.rows();
+      size_t lo = std::max(begin, base), hi = std::min(end, base + n);
+      for (size_t i = lo; i < hi; ++i)
+        fn(v, i - base);
+      base += n;
+      if (base >= end)
+        break;
+    }
+  }
+
+private:
+  uint32_t columns = 0;
+  std::vector<std::unique_ptr<MappedFile>> files;
+  std::vector<SegmentView> views;
+};
+
+inline EngineCandle candle_row(const SegmentView &v, size_t i) {
+  return {v.epoch[i],     v.values[0][i], v.values[1][i],
+          v.values[2][i], v.values[3][i], v.values[4][i]};
+}
+
+// The writers of one symbol: raw ticks plus every candle timeframe
+struct SymbolHistory {
+  SeriesWriter ticks;
+  SeriesWriter candles[ENGINE_TF_COUNT];
+
+  bool open(const std::string &root, const std::string &symbol) {
+    if (!ticks.open(series_dir(root, symbol, ENGINE_SERIES_TICKS), 1,
+                    TICK_SEGMENT_ROWS))
+      return false;
+    for (int32_t tf = 0; tf < ENGINE_TF_COUNT; ++tf)
+      if (!candles[tf].open(series_dir(root, symbol, tf), 5,
+                            CANDLE_SEGMENT_ROWS))
+        return false;
+    return true;
+  }
+
+  void append_tick(int64_t epoch, double quote) {
+    ticks.append(epoch, &quote);
+  }
+
+  void append_candle(int32_t tf, const EngineCandle &c) {
+    const double values[5] = {c.open, c.high, c.low, c.close, c.volume};
+    candles[tf].append(c.epoch, values);
+  }
+
+  void flush() {
+    ticks.flush();
+    for (auto &w : candles)
+      w.flush();
+  }
+};
+
+#endif // COLUMN_STORE_HPP
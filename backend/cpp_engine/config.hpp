@@ -0,0 +1,91 @@
+/**
+ * Hot-reloadable engine configuration.
+ *
+ * The live configuration is an immutable EngineConfig snapshot published
+ * through an atomic pointer (read-copy-update): a reload copies the current
+ * snapshot, applies the changes and swaps the pointer in one release store.
+ * Readers on the tick and trade paths take a single acquire load and never
+ * lock or re-parse JSON, so retuning limits mid-session never stalls them.
+ *
+ * Replaced snapshots are retired rather than freed, because a reader may
+ * still hold a reference. Reloads are rare (settings changes), so keeping
+ * them until the engine shuts down costs well under a kilobyte per reload.
+ */
+
+#ifndef CONFIG_HPP
+#define CONFIG_HPP
+
+#include "filter_pipeline.hpp"
+#include "metrics.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct EngineConfig {
+  uint64_t version = 0;
+
+  // Default trade cooldown for symbol contexts, on the engine clock
+  int64_t cooldown_ns = 60 * NS_PER_SECOND;
+
+  // Trade validation limits
+  int max_active_trades = 10;
+  double min_stake = 0.35;
+  double max_stake = 100.0;
+
+  // Account-wide daily limits (reset at 00:00 UTC)
+  double max_daily_loss_pct = 5.0;
+  int max_sl_hits = 3;
+
+  // Portfolio gates over the correlation/regime matrix; 0 = off
+  double max_correlation = 0.0;
+  double max_volatility_ratio = 0.0;
+
+  // Tick move, in standard deviations, that counts as a spike; 0 = off
+  double spike_threshold = 6.0;
+
+  // Pre-entry checks run by filter_entry
+  FilterPipeline entry_filters = default_entry_filters();
+};
+
+// Balance figures pushed by the account stream (update_account)
+struct AccountState {
+  double balance;
+  double equity;
+  double margin_free;
+};
+
+class ConfigStore {
+public:
+  ConfigStore() : current(new EngineConfig()) {}
+  ~ConfigStore() { delete current.load(); }
+
+  ConfigStore(const ConfigStore &) = delete;
+  ConfigStore &operator=(const ConfigStore &) = delete;
+
+  // The live snapshot; valid for the lifetime of the store
+  const EngineConfig &get() const {
+    return *current.load(std::memory_order_acquire);
+  }
+
+  // Copy the live snapshot, let `edit` change the copy, publish it.
+  // Writers are serialised; readers see either the old or new snapshot.
+  template <typename Fn> const EngineConfig &update(Fn &&edit) {
+    std::lock_guard<std::mutex> lock(writer);
+    const EngineConfig *old = current.load(std::memory_order_relaxed);
+    auto next = std::make_unique<EngineConfig>(*old);
+    edit(*next);
+    next->version = old->version + 1;
+    current.store(next.release(), std::memory_order_release);
+    retired.emplace_back(old);
+    return get();
+  }
+
+private:
+  std::atomic<const EngineConfig *> current;
+  std::mutex writer;
+  std::vector<std::unique_ptr<const EngineConfig>> retired;
+};
+
+#endif // CONFIG_HPP
@@ -0,0 +1,196 @@
+/**
+ * Cross-symbol return correlations and volatility regimes.
+ *
+ * Every symbol keeps the log returns of its last RETURN_WINDOW closed 1m
+ * candles in one row of a symbols x window matrix, slotted by bar index
+ * (epoch / 60) modulo the window. Two symbols' returns for the same bar
+ * therefore sit in the same column, so a pair's correlation is one pass
+ * over two rows with no alignment step. A candle close updates its row in
+ * O(1); a correction of the newest candle revises it in place.
+ *
+ * The volatility regime compares a symbol's realised volatility over the
+ * window with a slow EWMA of it (REGIME_BASELINE_BARS), so "volatile" is
+ * relative to what is normal for that symbol (a Boom/Crash index is not
+ * held to R_10's scale).
+ *
+ * Rows are written by their symbol's tick path (under its state_lock) and
+ * read lock-free by trade checks on any thread, through a seqlock per row.
+ */
+
+#ifndef CORRELATION_HPP
+#define CORRELATION_HPP
+
+#include "engine.hpp"
+#include "seqlock.hpp"
+#include "symbol_context.hpp"
+#include <cmath>
+#include <cstdint>
+
+// Bars of returns per row; one bit each in ReturnSeries::valid
+constexpr int32_t RETURN_WINDOW = 64;
+
+// Fewer common returns than this and a pair is reported uncorrelated
+constexpr int32_t CORRELATION_MIN_RETURNS = 16;
+
+// Span of the regime baseline: a running mean of squared returns up to
+// this many bars, an EWMA with weight 1/span after
+constexpr int64_t REGIME_BASELINE_BARS = 1024;
+
+// Window volatility over baseline below / at or above which a symbol is
+// calm / volatile
+constexpr double REGIME_CALM_RATIO = 0.75;
+constexpr double REGIME_VOLATILE_RATIO = 1.5;
+
+// One symbol's row. Zero-initialised is empty.
+struct ReturnSeries {
+  double returns[RETURN_WINDOW]; // log return into bar b, at b % window
+  uint64_t valid;                // bit per slot holding a return
+  int64_t last_bar;              // bar index of the newest close
+  double last_close;             // 0 = no close yet
+  double prev_close;             // the close before it, to revise it
+  double baseline;               // EWMA of squared returns
+  double baseline_prev;          // before the newest return
+  int64_t bars;                  // returns folded into the baseline
+
+  void reset() { *this = ReturnSeries{}; }
+
+  // A 1m candle closed (or the newest one was corrected). Older bars are
+  // ignored.
+  void on_close(int64_t bar, double close) {
+    if (close <= 0.0)
+      return;
+    if (last_close > 0.0 && bar == last_bar) {
+      last_close = close;
+      if (prev_close > 0.0 && (valid & bit(bar))) {
+        double r = std::log(close / prev_close);
+        returns[slot(bar)] = r;
+        baseline = fold(baseline_prev, r, bars);
+      }
+      return;
+    }
+    if (last_close > 0.0 && bar < last_bar)
+      return;
+
+    if (last_close > 0.0) {
+      // Bars between the two closes had no close of their own
+      if (bar - last_bar >= RETURN_WINDOW)
+        valid = 0;
+      else
+        for (int64_t b = last_bar + 1; b < bar; ++b)
+          valid &= ~bit(b);
+      double r = std::log(close / last_close);
+      returns[slot(bar)] = r;
+      valid |= bit(bar);
+      baseline_prev = baseline;
+      baseline = fold(baseline, r, ++bars);
+    }
+    prev_close = last_close;
+    last_close = close;
+    last_bar = bar;
+  }
+
+  // Slots holding a return for one of the last RETURN_WINDOW bars up to
+  // and including `newest`
+  uint64_t held(int64_t newest) const {
+    if (last_close <= 0.0 || newest - last_bar >= RETURN_WINDOW)
+      return 0;
+    uint64_t mask = valid;
+    for (int64_t b = last_bar + 1; b <= newest; ++b)
+      mask &= ~bit(b); // slots that bar `newest` has moved past
+    return mask;
+  }
+
+  // Realised volatility: RMS of the window's log returns
+  double volatility() const {
+    uint64_t mask = valid;
+    int32_t n = __builtin_popcountll(mask);
+    if (n == 0)
+      return 0.0;
+    double sum = 0.0;
+    for (int32_t s = 0; s < RETURN_WINDOW; ++s)
+      if (mask >> s & 1)
+        sum += returns[s] * returns[s];
+    return std::sqrt(sum / n);
+  }
+
+  // Window volatility over the baseline's; 0 until both are established
+  double volatility_ratio() const {
+    if (bars < RETURN_WINDOW || baseline <= 0.0 ||
+        __builtin_popcountll(valid) < CORRELATION_MIN_RETURNS)
+      return 0.0;
+    return volatility() / std::sqrt(baseline);
+  }
+
+  int32_t regime() const {
+    double ratio = volatility_ratio();
+    if (ratio <= 0.0)
+      return ENGINE_REGIME_UNKNOWN;
+    if (ratio < REGIME_CALM_RATIO)
+      return ENGINE_REGIME_CALM;
+    return ratio < REGIME_VOLATILE_RATIO ? ENGINE_REGIME_NORMAL
+                                         : ENGINE_REGIME_VOLATILE;
+  }
+
+  static int32_t slot(int64_t bar) {
+    return static_cast<int32_t>(((bar % RETURN_WINDOW) + RETURN_WINDOW) %
+                                RETURN_WINDOW);
+  }
+  static uint64_t bit(int64_t bar) { return uint64_t(1) << slot(bar); }
+
+private:
+  // `n`: returns folded so far, this one included
+  static double fold(double base, double r, int64_t n) {
+    int64_t bars = n < REGIME_BASELINE_BARS ? n : REGIME_BASELINE_BARS;
+    double weight = 1.0 / static_cast<double>(bars);
+    return base + weight * (r * r - base);
+  }
+};
+
+// Pearson correlation of two rows over the bars both hold within the
+// window ending at the newer of their closes; `n` receives how many.
+// 0 below CORRELATION_MIN_RETURNS or if either side is flat.
+inline double return_correlation(const ReturnSeries &a, const ReturnSeries &b,
+                                 int32_t &n) {
+  int64_t newest = a.last_bar > b.last_bar ? a.last_bar : b.last_bar;
+  uint64_t mask = a.held(newest) & b.held(newest);
+  n = __builtin_popcountll(mask);
+  if (n < CORRELATION_MIN_RETURNS)
+    return 0.0;
+  double sa = 0.0, sb = 0.0, saa = 0.0, sbb = 0.0, sab = 0.0;
+  for (int32_t s = 0; s < RETURN_WINDOW; ++s) {
+    if (!(mask >> s & 1))
+      continue;
+    double x = a.returns[s], y = b.returns[s];
+    sa += x;
+    sb += y;
+    saa += x * x;
+    sbb += y * y;
+    sab += x * y;
+  }
+  double va = saa - sa * sa / n;
+  double vb = sbb - sb * sb / n;
+  if (va <= 0.0 || vb <= 0.0)
+    return 0.0;
+  double c = (sab - sa * sb / n) / std::sqrt(va * vb);
+  return c > 1.0 ? 1.0 : c < -1.0 ? -1.0 : c;
+}
+
+// The symbols x window matrix, one row per symbol handle
+class ReturnMatrix {
+public:
+  // Writers: the row's symbol, serialised by its state_lock
+  void on_close(int32_t id, int64_t bar, double close) {
+    ReturnSeries s = rows[id].load();
+    s.on_close(bar, close);
+    rows[id].store(s);
+  }
+
+  void set(int32_t id, const ReturnSeries &s) { rows[id].store(s); }
+
+  ReturnSeries row(int32_t id) const { return rows[id].load(); }
+
+private:
+  SeqLock<ReturnSeries> rows[MAX_SYMBOL_CONTEXTS];
+};
+
+#endif // CORRELATION_HPP
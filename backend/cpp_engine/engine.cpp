@@ -1,216 +1,2598 @@
+#include "engine.hpp"
+#include "account_context.hpp"
+#include "arena.hpp"
+#include "backtest.hpp"
+#include "clock.hpp"
+#include "column_store.hpp"
+#include "config.hpp"
+#include "correlation.hpp"
+#include "filter_pipeline.hpp"
+#include "memory_budget.hpp"
+#include "strategy.hpp"
+#include "symbol_context.hpp"
+#include "trade_checks.hpp"
+#include "work_pool.hpp"
+#include "journal.hpp"
 #include "json.hpp" // Using nlohmann/json
+#include "mapped_file.hpp"
+#include "metrics.hpp"
+#include "mpsc_ring.hpp"
+#include "result_buffers.hpp"
+#include "series_kernels.hpp"
+#ifdef ENGINE_WITH_FEED
+#include "feed_handler.hpp"
+#endif
+#include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <iostream>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 using json = nlohmann::json;
 using namespace std;
 
-// --- Safety Constants ---
-const double MAX_LATENCY_MS = 1000.0;
-const int MAX_ACTIVE_TRADES = 10;
-const double MIN_STAKE = 0.35;
-const double MAX_STAKE = 100.0;
+static_assert(sizeof(EngineTick) == 24, "EngineTick layout changed");
+static_assert(sizeof(EngineTickResult) == 56,
+              "EngineTickResult layout changed");
+static_assert(sizeof(EngineCandle) == 48, "EngineCandle layout changed");
+static_assert(sizeof(EngineCandleView) == 128,
+              "EngineCandleView layout changed");
+static_assert(sizeof(EngineIndicators) == 112,
+              "EngineIndicators layout changed");
+static_assert(sizeof(EngineStructure) == 128,
+              "EngineStructure layout changed");
+static_assert(sizeof(EngineRegime) == 32, "EngineRegime layout changed");
+static_assert(sizeof(EngineTradeRequest) == 16,
+              "EngineTradeRequest layout changed");
+static_assert(sizeof(EngineAccountTrade) == 16,
+              "EngineAccountTrade layout changed");
+static_assert(sizeof(EngineTradeDecision) == 32,
+              "EngineTradeDecision layout changed");
+static_assert(sizeof(EnginePosition) == 48, "EnginePosition layout changed");
+static_assert(sizeof(EnginePositionUpdate) == 48,
+              "EnginePositionUpdate layout changed");
+static_assert(sizeof(EngineFilterRequest) == 16,
+              "EngineFilterRequest layout changed");
+static_assert(sizeof(EngineFilterResult) == 24,
+              "EngineFilterResult layout changed");
+static_assert(sizeof(EngineStrategySignal) == 72,
+              "EngineStrategySignal layout changed");
+static_assert(sizeof(EngineEvent) == 56, "EngineEvent layout changed");
+static_assert(sizeof(EngineBacktestParams) == 88,
+              "EngineBacktestParams layout changed");
+static_assert(sizeof(EngineBacktestTrade) == 64,
+              "EngineBacktestTrade layout changed");
+static_assert(sizeof(EngineEquityPoint) == 24,
+              "EngineEquityPoint layout changed");
+static_assert(sizeof(EngineBacktestOutput) == 192,
+              "EngineBacktestOutput layout changed");
+static_assert(sizeof(EngineSweepResult) == 160,
+              "EngineSweepResult layout changed");
+static_assert(sizeof(EngineFeedStats) == 72, "EngineFeedStats layout changed");
+static_assert(sizeof(EngineReplayStats) == 64,
+              "EngineReplayStats layout changed");
+
+// --- Configuration ---
+// Build an entry filter pipeline from its config list (see update_config
+// in engine.hpp); throws on an unknown stage or too many stages
+static FilterPipeline parse_entry_filters(const json &stages) {
+  FilterPipeline p;
+  for (const json &stage : stages) {
+    if (stage.is_string())
+      p.add(filter_stage_kind(stage.get<string>()));
+    else
+      p.add(filter_stage_kind(stage.at("stage").get<string>()),
+            stage.value("limit", 0.0));
+  }
+  return p;
+}
+
+static json describe_entry_filters(const FilterPipeline &p) {
+  json stages = json::array();
+  for (int32_t i = 0; i < p.count; ++i)
+    stages.push_back({{"stage", FILTER_STAGE_NAMES[p.stages[i].kind]},
+                      {"limit", p.stages[i].limit}});
+  return stages;
+}
+
+// The "memory" object of an init_engine config (see engine.hpp); absent
+// keys keep their defaults. Throws on a budget outside the hard limits.
+static MemoryBudget parse_memory_budget(const json &j) {
+  MemoryBudget b;
+  b.max_symbols = j.value("max_symbols", b.max_symbols);
+  b.max_accounts = j.value("max_accounts", b.max_accounts);
+  b.max_positions = j.value("max_positions", b.max_positions);
+  if (j.contains("candles")) {
+    const json &candles = j.at("candles");
+    for (int tf = 0; tf < ENGINE_TF_COUNT; ++tf)
+      b.candles[tf] = candles.value(TIMEFRAME_NAMES[tf], b.candles[tf]);
+  }
+  if (!b.valid())
+    throw std::invalid_argument("memory budget out of range");
+  return b;
+}
+
+static json describe_memory_budget(const MemoryBudget &b) {
+  json candles;
+  for (int tf = 0; tf < ENGINE_TF_COUNT; ++tf)
+    candles[TIMEFRAME_NAMES[tf]] = b.candles[tf];
+  return {{"max_symbols", b.max_symbols},
+          {"max_accounts", b.max_accounts},
+          {"max_positions", b.max_positions},
+          {"candles", std::move(candles)}};
+}
+
+// Apply the recognised keys of a config JSON onto a snapshot being built.
+// Unknown keys (strategy settings the engine does not use) are ignored.
+static void apply_config(EngineConfig &cfg, const json &j) {
+  // Cooldowns may be fractional: "cooldown_seconds" or "cooldown_ms"
+  if (j.contains("cooldown_seconds"))
+    cfg.cooldown_ns = seconds_to_ns(j.at("cooldown_seconds").get<double>());
+  if (j.contains("cooldown_ms"))
+    cfg.cooldown_ns = seconds_to_ns(j.at("cooldown_ms").get<double>() / 1000.0);
+  // The settings API calls the open-trade limit "max_open_trades"
+  cfg.max_active_trades = j.value("max_open_trades", cfg.max_active_trades);
+  cfg.max_active_trades = j.value("max_active_trades", cfg.max_active_trades);
+  cfg.min_stake = j.value("min_stake", cfg.min_stake);
+  cfg.max_stake = j.value("max_stake", cfg.max_stake);
+  cfg.max_daily_loss_pct = j.value("max_daily_loss", cfg.max_daily_loss_pct);
+  cfg.max_sl_hits = j.value("max_sl_hits", cfg.max_sl_hits);
+  cfg.max_correlation = j.value("max_correlation", cfg.max_correlation);
+  cfg.max_volatility_ratio =
+      j.value("max_volatility_ratio", cfg.max_volatility_ratio);
+  cfg.spike_threshold = j.value("spike_threshold", cfg.spike_threshold);
+  if (j.contains("entry_filters"))
+    cfg.entry_filters = parse_entry_filters(j.at("entry_filters"));
+}
+
+// Every recognised key of a snapshot, in the form apply_config reads
+static json describe_config(const EngineConfig &cfg) {
+  return {{"cooldown_seconds", ns_to_seconds(cfg.cooldown_ns)},
+          {"max_active_trades", cfg.max_active_trades},
+          {"min_stake", cfg.min_stake},
+          {"max_stake", cfg.max_stake},
+          {"max_daily_loss", cfg.max_daily_loss_pct},
+          {"max_sl_hits", cfg.max_sl_hits},
+          {"max_correlation", cfg.max_correlation},
+          {"max_volatility_ratio", cfg.max_volatility_ratio},
+          {"spike_threshold", cfg.spike_threshold},
+          {"entry_filters", describe_entry_filters(cfg.entry_filters)}};
+}
+
+// --- Trade decisions ---
+static const char *const TRADE_REASON_TEXT[ENGINE_TRADE_REASON_COUNT] = {
+    "OK",
+    "Engine not initialized",
+    "Bot is stopped",
+    "Unknown symbol",
+    "Stake below minimum",
+    "Stake above maximum",
+    "Insufficient free margin",
+    "Max active trades limit reached",
+    "Daily loss limit hit",
+    "Max SL hits reached",
+    "consecutive losses - cooldown required",
+    "Cooldown active",
+    "Unknown account",
+    "Correlated with open positions",
+    "Volatility above its regime limit",
+};
+
+static const char *trade_reason_text(int32_t reason) {
+  if (reason < 0 || reason >= ENGINE_TRADE_REASON_COUNT)
+    return "";
+  return TRADE_REASON_TEXT[reason];
+}
+
+// Human-readable reason for the JSON API (the only place that allocates)
+static string describe_decision(const EngineTradeDecision &d) {
+  string text = trade_reason_text(d.reason);
+  switch (d.reason) {
+  case ENGINE_REJECT_STAKE_BELOW_MIN:
+  case ENGINE_REJECT_STAKE_ABOVE_MAX:
+    return text + " (" + to_string(d.limit) + ")";
+  case ENGINE_REJECT_DAILY_LOSS:
+    return text + " (-$" + to_string(d.detail) + ")";
+  case ENGINE_REJECT_MAX_SL_HITS:
+    return text + " (" + to_string(static_cast<int>(d.detail)) + ")";
+  case ENGINE_REJECT_LOSS_STREAK:
+    return to_string(static_cast<int>(d.detail)) + " " + text;
+  case ENGINE_REJECT_COOLDOWN: {
+    char wait[32];
+    snprintf(wait, sizeof wait, ". Wait %.1fs", d.detail);
+    return text + wait;
+  }
+  case ENGINE_REJECT_CORRELATED:
+  case ENGINE_REJECT_VOLATILITY: {
+    char values[48];
+    snprintf(values, sizeof values, " (%.2f >= %.2f)", d.detail, d.limit);
+    return text + values;
+  }
+  default:
+    return text;
+  }
+}
+
+// Sweep score of one run for an EngineSweepRank
+static double sweep_score(const EngineBacktestStats &st, int32_t rank_by) {
+  switch (rank_by) {
+  case ENGINE_RANK_PROFIT_FACTOR:
+    return st.profit_factor;
+  case ENGINE_RANK_SHARPE:
+    return st.sharpe;
+  case ENGINE_RANK_WIN_RATE:
+    return st.win_rate;
+  case ENGINE_RANK_RETURN_OVER_DRAWDOWN:
+    return st.max_drawdown > 0.0 ? st.total_pnl / st.max_drawdown
+                                 : st.total_pnl;
+  default:
+    return st.total_pnl;
+  }
+}
+
+// Bars (and ticks) replayed into the indicators by store_warm_start
+constexpr size_t WARM_START_BARS = 1000;
+
+// A decision re-made by journal_replay matches the recorded one
+static bool same_decision(const EngineTradeDecision &a,
+                          const EngineTradeDecision &b) {
+  return a.reason == b.reason && a.stake == b.stake && a.detail == b.detail &&
+         a.limit == b.limit;
+}
+
+// Capacity of the engine event ring (see drain_events)
+constexpr size_t EVENT_RING_CAPACITY = 4096;
 
 class TradingEngine {
 private:
-  std::unordered_map<std::string, double> price_cache;
-  std::chrono::time_point<std::chrono::steady_clock> last_trade_time;
-  int cooldown_seconds = 60;
-  bool is_initialized = false;
-  bool is_running = true;
-  std::chrono::time_point<std::chrono::steady_clock> start_time;
+  // Where the symbol and account tables are built, sized for `budget`
+  // (declared first: the tables are destroyed before it)
+  Arena arena;
+  MemoryBudget budget;
+  // Serialises sizing the arena with creating contexts in it
+  std::mutex memory_lock;
+  // Per-symbol contexts (price, candles, indicators, cooldown)
+  SymbolRegistry contexts;
+  // 1m returns of every symbol, for correlation and regime checks
+  ReturnMatrix returns;
+  // Live safety limits, swapped atomically on reload
+  ConfigStore config;
+  // The engine's own account (update_account) and the mirrored ones
+  AccountContext primary{-1, "primary"};
+  AccountRegistry accounts;
+  std::atomic<bool> is_initialized{false};
+  std::atomic<bool> is_running{true};
+  // History store root while persistence is on; guards attaching writers
+  std::mutex store_mutex;
+  string store_root;
+  std::atomic<bool> store_enabled{false};
+  // Signals and decisions for the UI; drained by one consumer at a time
+  MpscRing<EngineEvent> events{EVENT_RING_CAPACITY};
+  std::atomic<int64_t> event_seq{0};
+  std::mutex events_reader;
+  // What cooldowns, daily limits and events read; pinned while replaying
+  EngineClock clock;
+  // A replaying engine prints nothing
+  const bool quiet;
+  // Engine clock at construction, for uptime
+  const int64_t start_ns;
+  // Input journal while recording (journal_start); serialises start/stop
+  JournalWriter journal;
+  std::mutex journal_control;
+  // Candle and tick scratch of journal_replay (payloads are unaligned)
+  vector<EngineCandle> replay_bars;
+  vector<EngineTick> replay_ticks;
 
 public:
-  TradingEngine() {
-    // Initialize with a past time to allow immediate trading
-    last_trade_time = std::chrono::steady_clock::now() -
-                      std::chrono::seconds(cooldown_seconds * 2);
-    start_time = std::chrono::steady_clock::now();
-  }
+  // Hot-path latency histograms and counters (lock-free, see metrics.hpp)
+  EngineMetrics metrics;
+
+  // `replaying`: a private engine for journal_replay, on a manual clock
+  explicit TradingEngine(bool replaying = false)
+      : clock(replaying), quiet(replaying), start_ns(clock.now().mono_ns) {}
 
   void initialize(const string &config_json) {
+    journal_text(JOURNAL_INIT, -1, config_json);
     try {
-      auto config = json::parse(config_json);
-      if (config.contains("cooldown_seconds")) {
-        cooldown_seconds = config["cooldown_seconds"];
-      }
+      auto j = json::parse(config_json);
+      MemoryBudget b = j.contains("memory") ? parse_memory_budget(j["memory"])
+                                            : MemoryBudget();
+      if (!reserve_memory(b) && !quiet)
+        cout << "[CPP] Memory budget unchanged: contexts already exist"
+             << endl;
+      const EngineConfig &cfg = config.update([&](EngineConfig &c) {
+        c = EngineConfig();
+        apply_config(c, j);
+      });
+      // Per-symbol overrides (set_symbol_cooldown) survive a re-init that
+      // does not set the cooldown
+      if (j.contains("cooldown_seconds") || j.contains("cooldown_ms"))
+        apply_cooldown(cfg.cooldown_ns);
       is_initialized = true;
-      cout << "[CPP] Engine Initialized. Cooldown: " << cooldown_seconds << "s"
-           << endl;
+      if (!quiet)
+        cout << "[CPP] Engine Initialized. Cooldown: "
+             << ns_to_seconds(cfg.cooldown_ns) << "s" << endl;
     } catch (...) {
-      cout << "[CPP] Init Error: Invalid Config" << endl;
+      if (!quiet)
+        cout << "[CPP] Init Error: Invalid Config" << endl;
+    }
+  }
+
+  // Hot reload: keys present in the JSON override the live snapshot, the
+  // rest carry over. A malformed update leaves the live snapshot untouched.
+  void update_config(const string &config_json) {
+    journal_text(JOURNAL_CONFIG, -1, config_json);
+    try {
+      auto j = json::parse(config_json);
+      const EngineConfig &cfg =
+          config.update([&](EngineConfig &c) { apply_config(c, j); });
+      if (j.contains("cooldown_seconds") || j.contains("cooldown_ms"))
+        apply_cooldown(cfg.cooldown_ns);
+      if (!quiet)
+        cout << "[CPP] Config Reloaded (v" << cfg.version
+             << "). Max trades: " << cfg.max_active_trades
+             << ", Stake: " << cfg.min_stake << "-" << cfg.max_stake << endl;
+    } catch (...) {
+      if (!quiet)
+        cout << "[CPP] Config Error: Invalid Config" << endl;
+    }
+  }
+
+  void update_account(double balance, double equity, double margin_free) {
+    AccountState state = {balance, equity, margin_free};
+    journal_input(JOURNAL_ACCOUNT_STATE, JournalAccountState{-1, 0, state});
+    primary.set_state(state);
+  }
+
+  // --- Memory ---
+  // Size the arena for `b` and build the tables in it. Only until the
+  // first context is created; false (keeping the budget in force) after.
+  bool reserve_memory(const MemoryBudget &b) {
+    std::lock_guard<std::mutex> lock(memory_lock);
+    return reserve_memory_locked(b);
+  }
+
+  bool reserve_memory_locked(const MemoryBudget &b) {
+    if (arena.capacity() > 0 && b == budget)
+      return true;
+    size_t bytes = SymbolRegistry::bytes_for(b) + AccountRegistry::bytes_for(b);
+    if (!arena.reserve(bytes))
+      return false;
+    contexts.attach(arena, b);
+    accounts.attach(arena, b);
+    budget = b;
+    return true;
+  }
+
+  // Creating a context before init_engine sizes the default budget
+  void ensure_memory_locked() {
+    if (arena.capacity() == 0)
+      reserve_memory_locked(budget);
+  }
+
+  // --- Accounts ---
+  int32_t create_account_context(const string &name) {
+    int32_t known = accounts.size();
+    int32_t id;
+    {
+      std::lock_guard<std::mutex> lock(memory_lock);
+      ensure_memory_locked();
+      id = accounts.create(name);
+    }
+    if (id >= known)
+      journal_text(JOURNAL_ACCOUNT_CREATE, id, name);
+    return id;
+  }
+
+  int32_t set_account_state(int32_t id, const AccountState &state) {
+    AccountContext *acct = accounts.get(id);
+    if (!acct)
+      return ENGINE_ERR_UNKNOWN_ACCOUNT;
+    journal_input(JOURNAL_ACCOUNT_STATE, JournalAccountState{id, 0, state});
+    acct->set_state(state);
+    return ENGINE_OK;
+  }
+
+  int32_t record_account_result(int32_t id, double profit) {
+    AccountContext *acct = accounts.get(id);
+    if (!acct)
+      return ENGINE_ERR_UNKNOWN_ACCOUNT;
+    ClockReading now = clock.now();
+    journal_input(JOURNAL_ACCOUNT_RESULT, JournalIdAmount{id, 0, profit}, now);
+    acct->ledger.record(now.day(), acct->balance(), profit);
+    return ENGINE_OK;
+  }
+
+  // Interned: a known name resolves without the registry's lock
+  int32_t create_symbol_context(const string &symbol) {
+    int32_t id = contexts.find(symbol);
+    if (id >= 0)
+      return id;
+    int32_t known = contexts.size();
+    ClockReading now = clock.now();
+    {
+      std::lock_guard<std::mutex> lock(memory_lock);
+      ensure_memory_locked();
+      id = contexts.create(symbol, config.get().cooldown_ns, now.mono_ns);
+    }
+    if (id >= known)
+      journal_text(JOURNAL_SYMBOL_CREATE, id, symbol, now);
+    if (id >= 0 && store_enabled.load(std::memory_order_acquire)) {
+      std::lock_guard<std::mutex> lock(store_mutex);
+      attach_history(contexts.get(id));
+    }
+    return id;
+  }
+
+  int32_t set_symbol_cooldown(int32_t id, int64_t cooldown_ns) {
+    SymbolContext *ctx = contexts.get(id);
+    if (!ctx)
+      return ENGINE_ERR_UNKNOWN_SYMBOL;
+    if (cooldown_ns < 0)
+      return ENGINE_ERR_BAD_ARG;
+    journal_input(JOURNAL_SYMBOL_COOLDOWN, JournalIdNs{id, 0, cooldown_ns});
+    ctx->cooldown_ns = cooldown_ns;
+    return ENGINE_OK;
+  }
+
+  // --- Strategies ---
+  int32_t set_symbol_strategy(int32_t id, int32_t kind) {
+    SymbolContext *ctx = contexts.get(id);
+    if (!ctx)
+      return ENGINE_ERR_UNKNOWN_SYMBOL;
+    if (kind < 0 || kind >= ENGINE_STRATEGY_KIND_COUNT)
+      return ENGINE_ERR_BAD_ARG;
+    journal_input(JOURNAL_SYMBOL_STRATEGY, JournalIdValue{id, kind});
+    std::lock_guard<std::mutex> lock(ctx->state_lock);
+    ctx->strategy.set(kind);
+    ctx->last_signal = EngineStrategySignal{};
+    ctx->last_signal.strategy = kind;
+    ctx->last_signal.reason = ENGINE_STRATEGY_OFF;
+    return ENGINE_OK;
+  }
+
+  int32_t get_strategy_signal(int32_t id, EngineStrategySignal &out) {
+    SymbolContext *ctx = contexts.get(id);
+    if (!ctx)
+      return ENGINE_ERR_UNKNOWN_SYMBOL;
+    std::lock_guard<std::mutex> lock(ctx->state_lock);
+    out = ctx->last_signal;
+    return ENGINE_OK;
+  }
+
+  // The tick, the strategy at its price and, for an entry, the trade
+  // decision: one pass under the symbol's lock, then the usual
+  // decide_trade (which claims the cooldown) outside it
+  int32_t process_tick_strategy(const EngineTick &tick, int32_t active_trades,
+                                EngineTickResult &out,
+                                EngineStrategySignal &signal,
+                                EngineTradeDecision &decision) {
+    signal = EngineStrategySignal{};
+    signal.reason = ENGINE_STRATEGY_OFF;
+    int64_t clock_ns = steady_now_ns();
+    if (process_tick(tick, out, clock_ns, &signal) != ENGINE_OK)
+      return out.status;
+    if (signal.direction == 0)
+      return out.status;
+    SymbolContext *sym = contexts.get(tick.symbol_id);
+    post_event(ENGINE_EVENT_STRATEGY_ENTRY, sym->id, signal.strategy,
+               signal.direction, clock.now(), signal.confidence, signal.sl);
+    decide_trade(sym, active_trades, 0.0, signal.direction, decision);
+    return out.status;
+  }
+
+  // --- Risk ---
+  int32_t record_trade_result(int32_t id, double profit) {
+    SymbolContext *ctx = contexts.get(id);
+    if (!ctx)
+      return ENGINE_ERR_UNKNOWN_SYMBOL;
+    ClockReading now = clock.now();
+    journal_input(JOURNAL_TRADE_RESULT, JournalIdAmount{id, 0, profit}, now);
+    int64_t day = now.day();
+    primary.ledger.record(day, primary.balance(), profit);
+    std::lock_guard<std::mutex> lock(ctx->state_lock);
+    ctx->record_result(day, profit);
+    return ENGINE_OK;
+  }
+
+  int32_t get_recommended_stake(int32_t id, double balance, double &stake) {
+    SymbolContext *ctx = contexts.get(id);
+    if (!ctx)
+      return ENGINE_ERR_UNKNOWN_SYMBOL;
+    stake = ctx->risk->stake_for(balance);
+    return ENGINE_OK;
+  }
+
+  int32_t get_last_quote(int32_t id, double &price, int64_t &epoch) {
+    SymbolContext *ctx = contexts.get(id);
+    if (!ctx)
+      return ENGINE_ERR_UNKNOWN_SYMBOL;
+    Quote q = ctx->last_quote.load();
+    price = q.price;
+    epoch = q.epoch;
+    return ENGINE_OK;
+  }
+
+  // --- Candles ---
+  int32_t get_candles(int32_t id, int32_t tf, EngineCandleView &out) {
+    SymbolContext *sym = contexts.get(id);
+    if (!sym)
+      return ENGINE_ERR_UNKNOWN_SYMBOL;
+    if (tf < 0 || tf >= ENGINE_TF_COUNT)
+      return ENGINE_ERR_BAD_TIMEFRAME;
+    std::lock_guard<std::mutex> lock(sym->state_lock);
+
+    const CandleAggregator &agg = sym->candles[tf];
+    const CandleRing &ring = agg.ring();
+    out.epoch = ring.epochs();
+    out.open = ring.opens();
+    out.high = ring.highs();
+    out.low = ring.lows();
+    out.close = ring.closes();
+    out.volume = ring.volumes();
+    out.count = static_cast<int64_t>(ring.size());
+    out.capacity = static_cast<int64_t>(ring.capacity());
+    out.total_closed = static_cast<int64_t>(ring.total());
+    out.has_current = agg.forming() ? 1 : 0;
+    out.reserved = 0;
+    out.current = agg.current();
+    return ENGINE_OK;
+  }
+
+  int64_t copy_candles(int32_t id, int32_t tf, EngineCandle *out, size_t max,
+                       int64_t &total_closed) {
+    SymbolContext *sym = contexts.get(id);
+    if (!sym)
+      return ENGINE_ERR_UNKNOWN_SYMBOL;
+    if (tf < 0 || tf >= ENGINE_TF_COUNT)
+      return ENGINE_ERR_BAD_TIMEFRAME;
+    std::lock_guard<std::mutex> lock(sym->state_lock);
+
+    const CandleRing &ring = sym->candles[tf].ring();
+    size_t size = ring.size();
+    size_t n = size < max ? size : max;
+    for (size_t i = 0; i < n; ++i)
+      out[i] = ring.at(size - n + i);
+    total_closed = static_cast<int64_t>(ring.total());
+    return static_cast<int64_t>(n);
+  }
+
+  int32_t load_candles(int32_t id, int32_t tf, const EngineCandle *candles,
+                       size_t n) {
+    SymbolContext *sym = contexts.get(id);
+    if (!sym)
+      return ENGINE_ERR_UNKNOWN_SYMBOL;
+    if (tf < 0 || tf >= ENGINE_TF_COUNT)
+      return ENGINE_ERR_BAD_TIMEFRAME;
+    journal_candles(id, tf, candles, n);
+    std::lock_guard<std::mutex> lock(sym->state_lock);
+    seed_candles(*sym, tf, candles, n);
+    if (tf == ENGINE_TF_1M)
+      seed_returns(*sym);
+    // API history ends with the forming candle; it is stored once closed
+    if (sym->history)
+      for (size_t i = 0; i + 1 < n; ++i)
+        sym->history->append_candle(tf, candles[i]);
+    return ENGINE_OK;
+  }
+
+  // Create/look up the context and seed one timeframe in a single pass
+  int32_t seed_history(const string &symbol, int32_t tf,
+                       const EngineCandle *candles, size_t n) {
+    if (tf < 0 || tf >= ENGINE_TF_COUNT)
+      return ENGINE_ERR_BAD_TIMEFRAME;
+    int32_t id = create_symbol_context(symbol);
+    SymbolContext *sym = contexts.get(id);
+    if (!sym)
+      return ENGINE_ERR_UNKNOWN_SYMBOL;
+    journal_candles(id, tf, candles, n);
+    std::lock_guard<std::mutex> lock(sym->state_lock);
+    seed_candles(*sym, tf, candles, n);
+    if (tf == ENGINE_TF_1M)
+      seed_returns(*sym);
+    if (sym->history)
+      for (size_t i = 0; i < n; ++i)
+        sym->history->append_candle(tf, candles[i]);
+    return id;
+  }
+
+  int32_t upsert_candle(int32_t id, int32_t tf, const EngineCandle &c) {
+    SymbolContext *sym = contexts.get(id);
+    if (!sym)
+      return ENGINE_ERR_UNKNOWN_SYMBOL;
+    if (tf < 0 || tf >= ENGINE_TF_COUNT)
+      return ENGINE_ERR_BAD_TIMEFRAME;
+    journal_input(JOURNAL_CANDLE_UPSERT, JournalCandle{id, tf, c});
+    std::lock_guard<std::mutex> lock(sym->state_lock);
+    int32_t status = sym->upsert_candle(tf, c);
+    // A close or a correction of the newest closed candle
+    if (tf == ENGINE_TF_1M && status >= 0)
+      fold_return(*sym);
+    return status;
+  }
+
+  int32_t reset_candles(int32_t id) {
+    SymbolContext *sym = contexts.get(id);
+    if (!sym)
+      return ENGINE_ERR_UNKNOWN_SYMBOL;
+    journal_input(JOURNAL_CANDLES_RESET, JournalIdValue{id, 0});
+    std::lock_guard<std::mutex> lock(sym->state_lock);
+    for (auto &agg : sym->candles)
+      agg.clear();
+    for (auto &ind : sym->indicators)
+      ind.reset();
+    for (auto &ind : sym->indicators_prev)
+      ind.reset();
+    for (int tf = 0; tf < ENGINE_TF_COUNT; ++tf) {
+      sym->structure[tf].reset();
+      sym->structure_prev[tf].reset();
     }
+    sym->tick_indicators.reset();
+    returns.set(id, ReturnSeries{});
+    return ENGINE_OK;
+  }
+
+  // --- Indicators ---
+  int32_t get_indicators(int32_t id, int32_t tf, EngineIndicators &out) {
+    SymbolContext *sym = contexts.get(id);
+    if (!sym)
+      return ENGINE_ERR_UNKNOWN_SYMBOL;
+    if (tf < 0 || tf >= ENGINE_TF_COUNT)
+      return ENGINE_ERR_BAD_TIMEFRAME;
+    std::lock_guard<std::mutex> lock(sym->state_lock);
+    sym->indicators[tf].snapshot(sym->price, out);
+    return ENGINE_OK;
+  }
+
+  int32_t get_tick_indicators(int32_t id, EngineIndicators &out) {
+    SymbolContext *sym = contexts.get(id);
+    if (!sym)
+      return ENGINE_ERR_UNKNOWN_SYMBOL;
+    std::lock_guard<std::mutex> lock(sym->state_lock);
+    sym->tick_indicators.snapshot(sym->price, out);
+    return ENGINE_OK;
+  }
+
+  int32_t get_structure(int32_t id, int32_t tf, EngineStructure &out) {
+    SymbolContext *sym = contexts.get(id);
+    if (!sym)
+      return ENGINE_ERR_UNKNOWN_SYMBOL;
+    if (tf < 0 || tf >= ENGINE_TF_COUNT)
+      return ENGINE_ERR_BAD_TIMEFRAME;
+    std::lock_guard<std::mutex> lock(sym->state_lock);
+    sym->structure[tf].snapshot(out);
+    return ENGINE_OK;
+  }
+
+  // --- Correlation and regimes ---
+  int32_t get_regime(int32_t id, EngineRegime &out) const {
+    if (!contexts.get(id))
+      return ENGINE_ERR_UNKNOWN_SYMBOL;
+    describe_regime(returns.row(id), out);
+    return ENGINE_OK;
+  }
+
+  int32_t get_correlation(int32_t a, int32_t b, double &corr,
+                          int32_t &n) const {
+    if (!contexts.get(a) || !contexts.get(b))
+      return ENGINE_ERR_UNKNOWN_SYMBOL;
+    corr = return_correlation(returns.row(a), returns.row(b), n);
+    return ENGINE_OK;
+  }
+
+  void get_correlations(string &out) const {
+    int32_t count = contexts.size();
+    vector<ReturnSeries> rows(count);
+    json doc;
+    json &names = doc["symbols"] = json::array();
+    json &regimes = doc["regimes"] = json::array();
+    for (int32_t id = 0; id < count; ++id) {
+      rows[id] = returns.row(id);
+      EngineRegime r;
+      describe_regime(rows[id], r);
+      names.push_back(contexts.get(id)->name);
+      regimes.push_back({{"symbol", contexts.get(id)->name},
+                         {"regime", r.regime},
+                         {"volatility", r.volatility},
+                         {"baseline", r.baseline},
+                         {"ratio", r.ratio},
+                         {"returns", r.returns}});
+    }
+    // A symbol is fully correlated with itself, whatever it holds; its
+    // regime's "returns" against min_returns tells whether it has data
+    doc["min_returns"] = CORRELATION_MIN_RETURNS;
+    json &matrix = doc["correlation"] = json::array();
+    for (int32_t a = 0; a < count; ++a) {
+      json row = json::array();
+      int32_t n = 0;
+      for (int32_t b = 0; b < count; ++b)
+        row.push_back(a == b ? 1.0 : return_correlation(rows[a], rows[b], n));
+      matrix.push_back(std::move(row));
+    }
+    dump_into(doc, out);
+  }
+
+  // --- Open positions ---
+  int32_t open_position(const EnginePosition &pos) {
+    SymbolContext *sym = contexts.get(pos.symbol_id);
+    if (!sym)
+      return ENGINE_ERR_UNKNOWN_SYMBOL;
+    if ((pos.side != 1 && pos.side != -1) || pos.entry_price <= 0.0 ||
+        pos.trail_rule < ENGINE_TRAIL_NONE ||
+        pos.trail_rule > ENGINE_TRAIL_CRASH300)
+      return ENGINE_ERR_BAD_ARG;
+    journal_input(JOURNAL_POSITION_OPEN, pos);
+    std::lock_guard<std::mutex> lock(sym->state_lock);
+    bool opened = sym->positions.open(pos);
+    sym->exposure.store(sym->positions.net_side(), std::memory_order_relaxed);
+    return opened ? ENGINE_OK : ENGINE_ERR_BAD_ARG;
+  }
+
+  int32_t close_position(int32_t id, int64_t contract_id) {
+    SymbolContext *sym = contexts.get(id);
+    if (!sym)
+      return ENGINE_ERR_UNKNOWN_SYMBOL;
+    journal_input(JOURNAL_POSITION_CLOSE,
+                  JournalPositionClose{id, 0, contract_id});
+    std::lock_guard<std::mutex> lock(sym->state_lock);
+    bool closed = sym->positions.close(contract_id);
+    sym->exposure.store(sym->positions.net_side(), std::memory_order_relaxed);
+    return closed ? ENGINE_OK : ENGINE_ERR_BAD_ARG;
+  }
+
+  int32_t get_position(int32_t id, int64_t contract_id, EnginePosition &out) {
+    SymbolContext *sym = contexts.get(id);
+    if (!sym)
+      return ENGINE_ERR_UNKNOWN_SYMBOL;
+    std::lock_guard<std::mutex> lock(sym->state_lock);
+    return sym->positions.get(contract_id, out) ? ENGINE_OK
+                                                : ENGINE_ERR_BAD_ARG;
+  }
+
+  int64_t poll_position_updates(int32_t id, EnginePositionUpdate *out,
+                                size_t max) {
+    SymbolContext *sym = contexts.get(id);
+    if (!sym)
+      return ENGINE_ERR_UNKNOWN_SYMBOL;
+    std::lock_guard<std::mutex> lock(sym->state_lock);
+    return static_cast<int64_t>(sym->positions.drain(out, max));
   }
 
   // Safety Validation Layer
-  struct ValidationResult {
-    bool valid;
-    string error;
-  };
+  // Allocation-free: the outcome is a reason code plus numeric detail in
+  // `out` (stake to check in out.stake); only the JSON path turns it into
+  // text (describe_decision). The limits themselves are check_trade_limits,
+  // shared with the backtester. `observed_last` receives the cooldown slot
+  // the check was made against, for the caller to claim with
+  // SymbolContext::claim_trade.
+  int32_t validate_trade(const SymbolContext *ctx, AccountContext &acct,
+                         int active_trades, int32_t direction,
+                         const ClockReading &now, int64_t &observed_last,
+                         EngineTradeDecision &out) {
+    int32_t refusal = trade_refusal(ctx);
+    if (refusal != ENGINE_TRADE_APPROVED)
+      return set_decision(out, refusal);
+
+    const EngineConfig &cfg = config.get();
+    TradeInputs in;
+    in.stake = out.stake;
+    in.active_trades = active_trades;
+    account_inputs(acct, now.day(), in);
+    symbol_inputs(*ctx, now.day(), now.mono_ns, observed_last, in);
+    portfolio_inputs(*ctx, direction, cfg, in);
+    return check_trade_limits(cfg, *ctx->risk, in, out);
+  }
 
-  ValidationResult validate_trade(double stake, const string &symbol,
-                                  int active_trades) {
+  // Checks that refuse every trade before any symbol or account input is
+  // read; ENGINE_TRADE_APPROVED if none applies
+  int32_t trade_refusal(const SymbolContext *ctx) const {
     if (!is_initialized)
-      return {false, "Engine not initialized"};
+      return ENGINE_REJECT_NOT_INITIALIZED;
     if (!is_running)
-      return {false, "Bot is stopped"};
+      return ENGINE_REJECT_BOT_STOPPED;
+    if (!ctx)
+      return ENGINE_REJECT_UNKNOWN_SYMBOL;
+    return ENGINE_TRADE_APPROVED;
+  }
+
+  // The symbol's half of a check: losing streak and cooldown
+  static void symbol_inputs(const SymbolContext &ctx, int64_t day,
+                            int64_t now_ns, int64_t &observed_last,
+                            TradeInputs &in) {
+    in.losing_streak = ctx.losing_streak(day);
+    observed_last = ctx.last_trade_ns.load(std::memory_order_acquire);
+    in.cooldown_elapsed_ns = now_ns - observed_last;
+    in.cooldown_ns = ctx.cooldown_ns.load(std::memory_order_relaxed);
+  }
+
+  // Across symbols: the strongest correlation with another symbol's open
+  // exposure (a position against `direction` counts negatively, as a
+  // hedge; without a direction its size counts) and the symbol's
+  // volatility regime. Skipped while both gates are off.
+  void portfolio_inputs(const SymbolContext &ctx, int32_t direction,
+                        const EngineConfig &cfg, TradeInputs &in) const {
+    in.correlation = 0.0;
+    in.volatility_ratio = 0.0;
+    if (cfg.max_correlation <= 0.0 && cfg.max_volatility_ratio <= 0.0)
+      return;
+    ReturnSeries own = returns.row(ctx.id);
+    in.volatility_ratio = own.volatility_ratio();
+    if (cfg.max_correlation <= 0.0)
+      return;
+    for (int32_t id = 0; id < contexts.size(); ++id) {
+      int32_t exposure =
+          contexts.get(id)->exposure.load(std::memory_order_relaxed);
+      if (id == ctx.id || exposure == 0)
+        continue;
+      int32_t n = 0;
+      double c = return_correlation(own, returns.row(id), n);
+      if (direction == 0)
+        c = std::fabs(c);
+      else if ((direction > 0) != (exposure > 0))
+        c = -c;
+      in.correlation = std::max(in.correlation, c);
+    }
+  }
+
+  // The account's half: balance, margin and the day's results
+  static void account_inputs(AccountContext &acct, int64_t day,
+                             TradeInputs &in) {
+    in.account = AccountState{};
+    in.account_known = acct.load(in.account);
+    in.today = acct.ledger.snapshot(day, in.account.balance);
+  }
+
+  // `stake`, or the symbol policy's stake for the account's balance if
+  // none was given (and the balance is known)
+  static double size_stake(const SymbolContext *ctx,
+                           const AccountContext &acct, double stake) {
+    AccountState state;
+    if (stake <= 0.0 && ctx && acct.load(state))
+      stake = ctx->risk->stake_for(state.balance);
+    return stake;
+  }
 
-    if (stake < MIN_STAKE)
-      return {false, "Stake below minimum (" + to_string(MIN_STAKE) + ")"};
-    if (stake > MAX_STAKE)
-      return {false, "Stake above maximum (" + to_string(MAX_STAKE) + ")"};
+  // Size (if no stake was given), validate and claim the cooldown slot.
+  // Claiming is atomic, so two concurrent requests for one symbol cannot
+  // both be approved.
+  int32_t decide_trade(SymbolContext *ctx, int active_trades, double stake,
+                       int32_t direction, EngineTradeDecision &out) {
+    int64_t start = steady_now_ns();
+    ClockReading now = clock.now();
+    out.stake = size_stake(ctx, primary, stake);
+
+    int64_t observed_last = 0;
+    int32_t reason =
+        validate_trade(ctx, primary, active_trades, direction, now,
+                       observed_last, out);
+    if (reason == ENGINE_TRADE_APPROVED &&
+        !ctx->claim_trade(observed_last, now.mono_ns)) {
+      double cooldown = ns_to_seconds(ctx->cooldown_ns.load());
+      reason = set_decision(out, ENGINE_REJECT_COOLDOWN, cooldown, cooldown);
+    }
+
+    if (journal.active()) {
+      JournalTrade t = {{ctx ? ctx->id : -1, active_trades, stake},
+                        direction, 0, out};
+      journal.record(JOURNAL_TRADE, now, {{&t, sizeof t}});
+    }
+    record_decision(ctx, direction, -1, now, out);
+    if (ctx)
+      ctx->metrics.stages[STAGE_DECISION].record(steady_now_ns() - start);
+    return reason;
+  }
+
+  int32_t execute_trade(const EngineTradeRequest &req,
+                        EngineTradeDecision &out) {
+    return decide_trade(contexts.get(req.symbol_id), req.active_trades,
+                        req.stake, 0, out);
+  }
+
+  // One signal, n accounts: the symbol's inputs are read once and the
+  // cooldown slot is claimed once for the whole fan-out
+  int64_t execute_trade_accounts(int32_t symbol_id, int32_t direction,
+                                 const EngineAccountTrade *orders, size_t n,
+                                 EngineTradeDecision *out) {
+    int64_t start = steady_now_ns();
+    ClockReading now = clock.now();
+    SymbolContext *ctx = contexts.get(symbol_id);
+    int32_t refusal = trade_refusal(ctx);
+    const EngineConfig &cfg = config.get();
+    int64_t day = now.day();
+    TradeInputs shared = {};
+    int64_t observed_last = 0;
+    if (refusal == ENGINE_TRADE_APPROVED) {
+      symbol_inputs(*ctx, day, now.mono_ns, observed_last, shared);
+      portfolio_inputs(*ctx, direction, cfg, shared);
+    }
+
+    int64_t approved = 0;
+    for (size_t i = 0; i < n; ++i) {
+      EngineTradeDecision &d = out[i];
+      d.stake = orders[i].stake;
+      AccountContext *acct = accounts.get(orders[i].account_id);
+      if (refusal != ENGINE_TRADE_APPROVED) {
+        set_decision(d, refusal);
+        continue;
+      }
+      if (!acct) {
+        set_decision(d, ENGINE_REJECT_UNKNOWN_ACCOUNT);
+        continue;
+      }
+      TradeInputs in = shared;
+      in.stake = size_stake(ctx, *acct, orders[i].stake);
+      in.active_trades = orders[i].active_trades;
+      account_inputs(*acct, day, in);
+      if (check_trade_limits(cfg, *ctx->risk, in, d) == ENGINE_TRADE_APPROVED)
+        ++approved;
+    }
 
-    if (symbol.empty())
-      return {false, "Symbol is empty"};
+    if (approved > 0 && !ctx->claim_trade(observed_last, now.mono_ns)) {
+      double cooldown = ns_to_seconds(ctx->cooldown_ns.load());
+      for (size_t i = 0; i < n; ++i)
+        if (out[i].reason == ENGINE_TRADE_APPROVED)
+          set_decision(out[i], ENGINE_REJECT_COOLDOWN, cooldown, cooldown);
+      approved = 0;
+    }
 
-    if (active_trades >= MAX_ACTIVE_TRADES) {
-      return {false, "Max active trades limit reached"};
+    if (journal.active()) {
+      JournalTradeAccounts t = {symbol_id, direction, static_cast<int64_t>(n)};
+      journal.record(JOURNAL_TRADE_ACCOUNTS, now,
+                     {{&t, sizeof t},
+                      {orders, n * sizeof *orders},
+                      {out, n * sizeof *out}});
     }
+    for (size_t i = 0; i < n; ++i)
+      record_decision(ctx, direction, orders[i].account_id, now, out[i]);
+    if (ctx)
+      ctx->metrics.stages[STAGE_DECISION].record(steady_now_ns() - start);
+    return approved;
+  }
 
-    // Cooldown check
-    auto now = std::chrono::steady_clock::now();
-    auto elapsed =
-        std::chrono::duration_cast<std::chrono::seconds>(now - last_trade_time)
-            .count();
-    if (elapsed < cooldown_seconds) {
-      return {false, "Cooldown active. Wait " +
-                         to_string(cooldown_seconds - elapsed) + "s"};
+  // Entry filters: gathers only what the configured stages read, under
+  // the context lock, then runs the pipeline outside it
+  int32_t filter_entry(const EngineFilterRequest &req,
+                       EngineFilterResult &out) {
+    SymbolContext *sym = contexts.get(req.symbol_id);
+    if (!sym)
+      return ENGINE_ERR_UNKNOWN_SYMBOL;
+    if (req.timeframe < 0 || req.timeframe >= ENGINE_TF_COUNT)
+      return ENGINE_ERR_BAD_TIMEFRAME;
+    if (req.direction != 1 && req.direction != -1)
+      return ENGINE_ERR_BAD_ARG;
+
+    const FilterPipeline &pipeline = config.get().entry_filters;
+    FilterInputs in = {};
+    in.direction = req.direction;
+    in.rsi_momentum = req.rsi_momentum;
+    {
+      std::lock_guard<std::mutex> lock(sym->state_lock);
+      const CandleRing &ring = sym->candles[req.timeframe].ring();
+      in.has_candle = ring.size() > 0;
+      if (in.has_candle)
+        in.candle = ring.back();
+      const IndicatorSet &ind = sym->indicators[req.timeframe];
+      double live = sym->price != 0.0 ? sym->price : in.candle.close;
+      if (pipeline.reads_indicators())
+        ind.snapshot(live, in.indicators);
+      if (pipeline.reads_signal())
+        in.signal = ind.signal(live);
+      if (pipeline.reads_structure())
+        sym->structure[req.timeframe].snapshot(in.structure);
     }
 
-    return {true, "OK"};
+    int32_t reason = run_filters(pipeline, in, out);
+    metrics.count_filter(reason);
+    if (reason != ENGINE_FILTER_PASSED)
+      post_event(ENGINE_EVENT_ENTRY_SKIPPED, sym->id, reason, req.direction,
+                 clock.now(), out.value, out.limit);
+    return reason;
+  }
+
+  // --- Events ---
+  int64_t drain_events(EngineEvent *out, size_t max) {
+    std::lock_guard<std::mutex> lock(events_reader);
+    size_t n = 0;
+    while (n < max && events.pop(out[n]))
+      ++n;
+    return static_cast<int64_t>(n);
   }
 
   // Core Processing
-  string process_tick(const string &tick_json) {
+  void process_tick(const char *tick_json, string &out) {
     try {
+      int64_t start = steady_now_ns();
       auto tick = json::parse(tick_json);
-      string symbol = tick["symbol"];
+      const string &symbol = tick["symbol"].get_ref<const string &>();
       double price = tick["quote"];
+      bool has_epoch = tick.contains("epoch");
+      int64_t epoch = has_epoch ? tick["epoch"].get<int64_t>() : 0;
+      int64_t parsed = steady_now_ns();
+      metrics.stages[STAGE_PARSE].record(parsed - start);
+
+      // Only symbols given a context (create_symbol_context, seed_history)
+      // are analysed: a request cannot claim a slot of the budget
+      SymbolContext *ctx = contexts.get(contexts.find(symbol));
+      if (!ctx) {
+        metrics.count(metrics.unknown_symbol_ticks);
+        dump_into({{"symbol", symbol}, {"error", "Unknown symbol"}}, out);
+        return;
+      }
 
-      // Update cache
-      price_cache[symbol] = price;
+      // Update cache and candles (aggregation needs the tick epoch)
+      EngineTickResult res = {};
+      res.signal = 0.5; // Neutral
+      if (has_epoch)
+        apply_tick(*ctx, epoch, price, parsed, res);
+      else
+        res.signal = apply_quote(*ctx, price);
 
       // Return analysis
       json result;
       result["symbol"] = symbol;
       result["price"] = price;
-      result["signal"] = 0.5; // Neutral
+      result["signal"] = res.signal;
+      if (res.exit_updates > 0)
+        result["exit_updates"] = res.exit_updates;
+      if (res.spike != 0) {
+        result["spike"] = res.spike;
+        result["spike_score"] = res.spike_score;
+      }
 
-      return result.dump();
+      dump_into(result, out);
 
     } catch (const exception &e) {
-      return "{\"error\": \"" + string(e.what()) + "\"}";
+      metrics.count(metrics.parse_errors);
+      out.assign("{\"error\": \"").append(e.what()).append("\"}");
     }
   }
 
+  // Binary hot path: same analysis as process_tick without JSON
+  int32_t process_tick(const EngineTick &tick, EngineTickResult &out) {
+    int64_t start = steady_now_ns();
+    return process_tick(tick, out, start);
+  }
+
+  // `clock_ns` is the tick's arrival time and receives its completion time,
+  // so a batch reads the clock once per tick. With `signal`, the symbol's
+  // strategy is evaluated on the tick.
+  int32_t process_tick(const EngineTick &tick, EngineTickResult &out,
+                       int64_t &clock_ns,
+                       EngineStrategySignal *signal = nullptr) {
+    out.symbol_id = tick.symbol_id;
+    out.epoch = tick.epoch;
+    out.price = tick.quote;
+    out.signal = 0.5; // Neutral
+    out.closed_mask = 0;
+    out.exit_updates = 0;
+    out.spike = 0;
+    out.ticks_since_spike = -1;
+    out.spike_score = 0.0;
+
+    SymbolContext *sym = contexts.get(tick.symbol_id);
+    if (!sym) {
+      metrics.count(metrics.unknown_symbol_ticks);
+      out.status = ENGINE_ERR_UNKNOWN_SYMBOL;
+      return out.status;
+    }
+
+    apply_tick(*sym, tick.epoch, tick.quote, clock_ns, out, signal);
+    out.status = ENGINE_OK;
+    return out.status;
+  }
+
+  int64_t process_ticks(const EngineTick *ticks, size_t n,
+                        EngineTickResult *out) {
+    int64_t ok = 0;
+    int64_t clock_ns = steady_now_ns();
+    for (size_t i = 0; i < n; ++i) {
+      if (process_tick(ticks[i], out[i], clock_ns) == ENGINE_OK)
+        ++ok;
+    }
+    return ok;
+  }
+
   // Unified Trade Execution Interface
-  string execute_trade(const string &params_json) {
+  void execute_trade(const char *params_json, string &out) {
     try {
+      int64_t start = steady_now_ns();
       auto params = json::parse(params_json);
 
-      string symbol = params["symbol"];
+      const string &symbol = params["symbol"].get_ref<const string &>();
       string action = params["action"];
-      double stake = params["stake"];
+      double stake = params.value("stake", 0.0);
       int active_trades = params.value("active_trades", 0);
+      int32_t direction = action == "BUY" ? 1 : action == "SELL" ? -1 : 0;
+      metrics.stages[STAGE_PARSE].record(steady_now_ns() - start);
 
-      // 1. Validate
-      ValidationResult val = validate_trade(stake, symbol, active_trades);
-
-      if (!val.valid) {
+      // 1. Validate (without a stake, size it from the symbol's policy);
+      // a symbol without a context is rejected, not given one
+      SymbolContext *ctx = contexts.get(contexts.find(symbol));
+      EngineTradeDecision decision;
+      if (decide_trade(ctx, active_trades, stake, direction, decision) !=
+          ENGINE_TRADE_APPROVED) {
         json error_res;
         error_res["status"] = "rejected";
-        error_res["reason"] = val.error;
-        return error_res.dump();
+        error_res["reason"] = symbol.empty() ? "Symbol is empty"
+                                             : describe_decision(decision);
+        error_res["reason_code"] = decision.reason;
+        dump_into(error_res, out);
+        return;
       }
-
-      // Update state
-      last_trade_time = std::chrono::steady_clock::now();
+      stake = decision.stake;
 
       json success_res;
       success_res["status"] = "approved";
       success_res["symbol"] = symbol;
       success_res["action"] = action;
       success_res["stake"] = stake;
+      success_res["risk_profile"] = ctx->risk->name;
 
-      return success_res.dump();
+      dump_into(success_res, out);
 
     } catch (const exception &e) {
+      metrics.count(metrics.parse_errors);
       json err;
       err["status"] = "error";
       err["message"] = e.what();
-      return err.dump();
+      dump_into(err, out);
+    }
+  }
+
+  // --- Backtest ---
+  // Reads only the live config snapshot; all other state is private to
+  // the run, so backtests may run concurrently with live trading.
+  int32_t backtest(const char *symbol, const EngineCandle *candles, size_t n,
+                   const EngineBacktestParams &params,
+                   EngineBacktestOutput &out) {
+    if (params.timeframe < 0 || params.timeframe >= ENGINE_TF_COUNT)
+      return ENGINE_ERR_BAD_TIMEFRAME;
+    Backtester bt(symbol, config.get(), params, out);
+    for (size_t i = 0; i < n; ++i)
+      bt.on_candle(candles[i]);
+    bt.finish();
+    return ENGINE_OK;
+  }
+
+  int32_t backtest(const char *symbol, const EngineTick *ticks, size_t n,
+                   const EngineBacktestParams &params,
+                   EngineBacktestOutput &out) {
+    if (params.timeframe < 0 || params.timeframe >= ENGINE_TF_COUNT)
+      return ENGINE_ERR_BAD_TIMEFRAME;
+    Backtester bt(symbol, config.get(), params, out);
+    for (size_t i = 0; i < n; ++i)
+      bt.on_tick(ticks[i].epoch, ticks[i].quote);
+    bt.finish();
+    return ENGINE_OK;
+  }
+
+  // Parameter sweep: independent backtests over shared read-only candles
+  int32_t sweep(const char *symbol, const EngineCandle *candles, size_t n,
+                const EngineBacktestParams *grid, size_t n_params,
+                int32_t threads, int32_t rank_by, EngineSweepResult *out) {
+    if (rank_by < 0 || rank_by >= ENGINE_RANK_COUNT)
+      return ENGINE_ERR_BAD_ARG;
+    for (size_t k = 0; k < n_params; ++k)
+      if (grid[k].timeframe < 0 || grid[k].timeframe >= ENGINE_TF_COUNT)
+        return ENGINE_ERR_BAD_TIMEFRAME;
+
+    // One snapshot for every run, even if the config is reloaded meanwhile
+    const EngineConfig cfg = config.get();
+    string name = symbol;
+    // Indicators see the same bars in every run: fold them once
+    const vector<BarSignal> signals = bar_signals(candles, n);
+    auto run_one = [&](size_t k) {
+      EngineBacktestOutput run{};
+      Backtester bt(name, cfg, grid[k], run);
+      for (size_t i = 0; i < n; ++i)
+        bt.on_bar(candles[i], signals[i]);
+      bt.finish();
+      out[k].index = static_cast<int64_t>(k);
+      out[k].score = sweep_score(run.stats, rank_by);
+      out[k].stats = run.stats;
+    };
+    parallel_for_stealing(n_params, resolve_workers(threads, n_params),
+                          run_one);
+
+    std::stable_sort(
+        out, out + n_params,
+        [](const EngineSweepResult &a, const EngineSweepResult &b) {
+          return a.score > b.score;
+        });
+    return ENGINE_OK;
+  }
+
+  // --- History store ---
+  int32_t store_open(const string &root) {
+    if (root.empty())
+      return ENGINE_ERR_BAD_ARG;
+    if (!make_dirs(root))
+      return ENGINE_ERR_IO;
+    std::lock_guard<std::mutex> lock(store_mutex);
+    if (store_root != root)
+      detach_histories();
+    store_root = root;
+    store_enabled = true;
+    int32_t status = ENGINE_OK;
+    for (int32_t id = 0; id < contexts.size(); ++id)
+      if (!attach_history(contexts.get(id)))
+        status = ENGINE_ERR_IO;
+    return status;
+  }
+
+  void store_close() {
+    std::lock_guard<std::mutex> lock(store_mutex);
+    store_enabled = false;
+    store_root.clear();
+    detach_histories();
+  }
+
+  int32_t store_flush() {
+    for (int32_t id = 0; id < contexts.size(); ++id) {
+      SymbolContext *sym = contexts.get(id);
+      std::lock_guard<std::mutex> lock(sym->state_lock);
+      if (sym->history)
+        sym->history->flush();
     }
+    return ENGINE_OK;
   }
 
-  // Set cooldown dynamically
-  void set_cooldown(int seconds) { cooldown_seconds = seconds; }
+  int64_t store_warm_start(int32_t id) {
+    SymbolContext *sym = contexts.get(id);
+    if (!sym)
+      return ENGINE_ERR_UNKNOWN_SYMBOL;
+    int64_t loaded = 0;
+    vector<EngineCandle> bars;
+    for (int32_t tf = 0; tf < ENGINE_TF_COUNT; ++tf) {
+      SeriesReader reader;
+      size_t begin = 0, end = 0;
+      int32_t status = open_series(sym->name, tf, 0, 0, reader, begin, end);
+      if (status != ENGINE_OK)
+        return status;
+      size_t keep =
+          std::max(WARM_START_BARS, sym->candles[tf].ring().capacity());
+      begin = end > keep ? end - keep : 0;
+      bars.clear();
+      reader.for_rows(begin, end, [&](const SegmentView &v, size_t i) {
+        bars.push_back(candle_row(v, i));
+      });
+      if (bars.empty())
+        continue; // nothing stored: keep whatever the context has
+      journal_candles(id, tf, bars.data(), bars.size());
+      std::lock_guard<std::mutex> lock(sym->state_lock);
+      seed_candles(*sym, tf, bars.data(), bars.size());
+      if (tf == ENGINE_TF_1M)
+        seed_returns(*sym);
+      loaded += static_cast<int64_t>(bars.size());
+    }
+
+    SeriesReader reader;
+    size_t begin = 0, end = 0;
+    int32_t status =
+        open_series(sym->name, ENGINE_SERIES_TICKS, 0, 0, reader, begin, end);
+    if (status != ENGINE_OK)
+      return status;
+    if (end > 0) {
+      begin = end > WARM_START_BARS ? end - WARM_START_BARS : 0;
+      vector<EngineTick> ticks;
+      reader.for_rows(begin, end, [&](const SegmentView &v, size_t i) {
+        ticks.push_back({id, 0, v.epoch[i], v.values[0][i]});
+      });
+      journal_ticks(id, ticks.data(), ticks.size());
+      std::lock_guard<std::mutex> lock(sym->state_lock);
+      seed_ticks(*sym, ticks.data(), ticks.size());
+    }
+    return loaded;
+  }
+
+  // Stored rows in [from, to] copied out; returns the rows in range
+  int64_t store_read(const char *symbol, int32_t series, int64_t from,
+                     int64_t to, EngineCandle *candles, EngineTick *ticks,
+                     size_t max) {
+    SeriesReader reader;
+    size_t begin = 0, end = 0;
+    int32_t status = open_series(symbol, series, from, to, reader, begin, end);
+    if (status != ENGINE_OK)
+      return status;
+    size_t k = 0;
+    reader.for_rows(begin, std::min(end, begin + max),
+                    [&](const SegmentView &v, size_t i) {
+                      if (ticks)
+                        ticks[k++] = {-1, 0, v.epoch[i], v.values[0][i]};
+                      else
+                        candles[k++] = candle_row(v, i);
+                    });
+    return static_cast<int64_t>(end - begin);
+  }
 
-  void set_bot_state(bool state) { is_running = state; }
+  // Backtest over the mapped columns: no copy of the history is made
+  int32_t backtest_store(const char *symbol, int32_t series, int64_t from,
+                         int64_t to, const EngineBacktestParams &params,
+                         EngineBacktestOutput &out) {
+    if (params.timeframe < 0 || params.timeframe >= ENGINE_TF_COUNT)
+      return ENGINE_ERR_BAD_TIMEFRAME;
+    if (series != ENGINE_SERIES_TICKS && series != params.timeframe)
+      return ENGINE_ERR_BAD_TIMEFRAME;
+    SeriesReader reader;
+    size_t begin = 0, end = 0;
+    int32_t status = open_series(symbol, series, from, to, reader, begin, end);
+    if (status != ENGINE_OK)
+      return status;
 
-  string get_bot_state() {
+    Backtester bt(symbol, config.get(), params, out);
+    if (series == ENGINE_SERIES_TICKS)
+      reader.for_rows(begin, end, [&](const SegmentView &v, size_t i) {
+        bt.on_tick(v.epoch[i], v.values[0][i]);
+      });
+    else
+      reader.for_rows(begin, end, [&](const SegmentView &v, size_t i) {
+        bt.on_candle(candle_row(v, i));
+      });
+    bt.finish();
+    return ENGINE_OK;
+  }
+
+  // Set cooldown dynamically: the default for new symbols and the
+  // current value for every existing context
+  void set_cooldown(int64_t cooldown_ns) {
+    journal_input(JOURNAL_COOLDOWN, JournalIdNs{-1, 0, cooldown_ns});
+    config.update([&](EngineConfig &c) { c.cooldown_ns = cooldown_ns; });
+    apply_cooldown(cooldown_ns);
+  }
+
+  void set_bot_state(bool state) {
+    journal_input(JOURNAL_BOT_STATE, JournalIdValue{-1, state ? 1 : 0});
+    is_running = state;
+  }
+
+  void get_bot_state(string &out) {
     json state;
-    state["is_running"] = is_running;
+    state["is_running"] = is_running.load();
+    state["uptime_seconds"] = uptime_seconds();
+    state["clock"] = clock.source();
+    state["config_version"] = config.get().version;
+    state["entry_filters"] = describe_entry_filters(config.get().entry_filters);
+
+    dump_into(state, out);
+  }
+
+  // Snapshot of the instrumentation as JSON (see get_metrics in engine.hpp)
+  void get_metrics(string &out) {
+    json m;
+    m["uptime_seconds"] = uptime_seconds();
+
+    // Symbol stages are reported per symbol and summed across symbols
+    LatencyHistogram::Snapshot totals[SYMBOL_STAGE_COUNT];
+    json &symbols = m["symbols"];
+    symbols = json::object();
+    for (int32_t id = 0; id < contexts.size(); ++id) {
+      const SymbolContext *sym = contexts.get(id);
+      json &entry = symbols[sym->name];
+      for (int i = 0; i < SYMBOL_STAGE_COUNT; ++i) {
+        LatencyHistogram::Snapshot snap;
+        snap.add(sym->metrics.stages[i]);
+        entry[SYMBOL_STAGE_NAMES[i]] = snap.summary();
+        totals[i].add(sym->metrics.stages[i]);
+      }
+    }
+    json &stages = m["stages"];
+    for (int i = 0; i < SYMBOL_STAGE_COUNT; ++i)
+      stages[SYMBOL_STAGE_NAMES[i]] = totals[i].summary();
+    for (int i = 0; i < ENGINE_STAGE_COUNT; ++i)
+      stages[ENGINE_STAGE_NAMES[i]] = metrics.stages[i].summary();
+    json &exports = m["exports"];
+    for (int i = 0; i < EXPORT_COUNT; ++i)
+      exports[EXPORT_NAMES[i]] = metrics.exports[i].summary();
+
+    m["ticks"] = stages["tick"]["count"];
+    m["unknown_symbol_ticks"] =
+        metrics.unknown_symbol_ticks.load(std::memory_order_relaxed);
+    m["parse_errors"] = metrics.parse_errors.load(std::memory_order_relaxed);
+    m["approved"] = metrics.decisions[ENGINE_TRADE_APPROVED].load(
+        std::memory_order_relaxed);
+    json rejects = json::array();
+    for (int32_t r = 1; r < ENGINE_TRADE_REASON_COUNT; ++r) {
+      uint64_t n = metrics.decisions[r].load(std::memory_order_relaxed);
+      if (n > 0)
+        rejects.push_back(
+            {{"reason", r}, {"text", trade_reason_text(r)}, {"count", n}});
+    }
+    m["rejects"] = std::move(rejects);
+
+    json &filters = m["filters"];
+    filters["passed"] =
+        metrics.filters[ENGINE_FILTER_PASSED].load(std::memory_order_relaxed);
+    json filter_rejects = json::array();
+    for (int32_t r = 1; r < ENGINE_FILTER_REASON_COUNT; ++r) {
+      uint64_t n = metrics.filters[r].load(std::memory_order_relaxed);
+      if (n > 0)
+        filter_rejects.push_back(
+            {{"reason", r}, {"text", filter_reason_text(r)}, {"count", n}});
+    }
+    filters["rejects"] = std::move(filter_rejects);
+    m["events"] = {
+        {"posted", metrics.events_posted.load(std::memory_order_relaxed)},
+        {"dropped", metrics.events_dropped.load(std::memory_order_relaxed)}};
+    m["memory"] = describe_memory();
+    dump_into(m, out);
+  }
+
+  // The budget in force and how much of it is in use
+  json describe_memory() {
+    std::lock_guard<std::mutex> lock(memory_lock);
+    size_t symbol_bytes = arena_bytes_for<SymbolContext>(1) +
+                          SymbolContext::storage_bytes(budget);
+    return {{"budget", describe_memory_budget(budget)},
+            {"arena_bytes", arena.capacity()},
+            {"arena_used", arena.used()},
+            {"symbols", contexts.size()},
+            {"accounts", accounts.size()},
+            {"symbol_bytes", symbol_bytes},
+            {"account_bytes", arena_bytes_for<AccountContext>(1)},
+            {"engine_bytes", sizeof(TradingEngine)},
+            {"event_ring_bytes", events.bytes()}};
+  }
+
+  void reset_metrics() {
+    metrics.reset();
+    for (int32_t id = 0; id < contexts.size(); ++id)
+      contexts.get(id)->metrics.reset();
+  }
+
+  // --- Journal ---
+  // The snapshot is written before inputs are recorded, so it is never
+  // interleaved with them
+  int32_t journal_start(const string &path) {
+    std::lock_guard<std::mutex> lock(journal_control);
+    if (!journal.open(path))
+      return ENGINE_ERR_IO;
+    write_journal_snapshot();
+    journal.activate();
+    return ENGINE_OK;
+  }
+
+  int64_t journal_stop() {
+    std::lock_guard<std::mutex> lock(journal_control);
+    int64_t written = journal.close();
+    return written < 0 ? static_cast<int64_t>(ENGINE_ERR_IO) : written;
+  }
+
+  // Runs on a private engine; nothing of the live one is read or changed
+  static int32_t journal_replay(const char *path, EngineReplayStats &out) {
+    out = EngineReplayStats{};
+    out.first_mismatch = -1;
+    JournalReader reader(path);
+    if (!reader.ok())
+      return ENGINE_ERR_IO;
+    int64_t start = steady_now_ns();
+    std::unique_ptr<TradingEngine> replica(new TradingEngine(true));
+    ReplayIds ids;
+    JournalHeader h;
+    const char *payload = nullptr;
+    while (reader.next(h, payload)) {
+      replica->clock.set({h.mono_ns, h.wall_ns});
+      replica->replay_record(h, payload, ids, out);
+      ++out.records;
+    }
+    out.bytes = static_cast<int64_t>(reader.consumed());
+    out.elapsed_ns = steady_now_ns() - start;
+    return ENGINE_OK;
+  }
+
+private:
+  // Apply one tick to a context, timed from `start_ns` (its arrival at the
+  // engine); returns the signal and leaves the completion time in `start_ns`.
+  // A non-null `strategy` receives the symbol's strategy evaluated on it.
+  // Fills the analysis fields of `out` (signal, closed_mask, exit_updates
+  // and the spike reading)
+  void apply_tick(SymbolContext &sym, int64_t epoch, double quote,
+                  int64_t &start_ns, EngineTickResult &out,
+                  EngineStrategySignal *strategy = nullptr) {
+    journal_input(JOURNAL_TICK, EngineTick{sym.id, 0, epoch, quote});
+    const EngineConfig &cfg = config.get();
+    std::lock_guard<std::mutex> lock(sym.state_lock);
+    out.closed_mask = sym.on_tick(epoch, quote);
+    out.exit_updates =
+        sym.positions.empty() ? 0 : sym.positions.on_price(quote, epoch);
+    int32_t previous = sym.spikes.ticks_since();
+    SpikeReading spike = sym.spikes.on_tick(quote, cfg.spike_threshold);
+    out.spike = spike.direction;
+    out.ticks_since_spike = spike.ticks_since;
+    out.spike_score = spike.score;
+    if (spike.direction != 0)
+      post_event(ENGINE_EVENT_SPIKE, sym.id, previous < 0 ? -1 : previous + 1,
+                 spike.direction, clock.now(), spike.score, spike.move);
+    out.signal = sym.signal();
+    if (out.closed_mask & (1 << ENGINE_TF_1M)) {
+      fold_return(sym);
+      post_event(ENGINE_EVENT_SIGNAL, sym.id, ENGINE_TF_1M, 0, clock.now(),
+                 out.signal, quote);
+    }
+    if (strategy)
+      sym.evaluate_strategy(cfg.entry_filters, epoch, *strategy);
+    int64_t done = steady_now_ns();
+    // The lock serialises this symbol's writers
+    sym.metrics.stages[STAGE_TICK].record_serialised(done - start_ns);
+    start_ns = done;
+  }
+
+  // A price without an epoch: no candle can take it, only the price moves
+  double apply_quote(SymbolContext &sym, double price) {
+    journal_input(JOURNAL_QUOTE, EngineTick{sym.id, 0, 0, price});
+    std::lock_guard<std::mutex> lock(sym.state_lock);
+    sym.price = price;
+    sym.last_quote.store({price, 0});
+    return sym.signal();
+  }
+
+  // Count a decision and post its event
+  void record_decision(const SymbolContext *ctx, int32_t direction,
+                       int32_t account_id, const ClockReading &at,
+                       const EngineTradeDecision &d) {
+    metrics.count_decision(d.reason);
+    int32_t symbol_id = ctx ? ctx->id : -1;
+    if (d.reason == ENGINE_TRADE_APPROVED)
+      post_event(ENGINE_EVENT_TRADE_APPROVED, symbol_id, d.reason, direction,
+                 at, d.stake, 0.0, account_id);
+    else
+      post_event(ENGINE_EVENT_TRADE_REJECTED, symbol_id, d.reason, direction,
+                 at, d.detail, d.limit, account_id);
+  }
+
+  // Lock-free from any thread; never waits on the consumer
+  void post_event(int32_t type, int32_t symbol_id, int32_t code,
+                  int32_t direction, const ClockReading &at, double value,
+                  double limit = 0.0, int32_t account_id = -1) {
+    EngineEvent e;
+    e.seq = event_seq.fetch_add(1, std::memory_order_relaxed) + 1;
+    e.time_ms = at.wall_ns / 1000000;
+    e.type = type;
+    e.symbol_id = symbol_id;
+    e.code = code;
+    e.direction = direction;
+    e.account_id = account_id;
+    e.reserved = 0;
+    e.value = value;
+    e.limit = limit;
+    metrics.count(events.push(e) ? metrics.events_posted
+                                 : metrics.events_dropped);
+  }
+
+  // --- Journal recording ---
+  // Record an input while a journal is recording, stamped with the clock
+  // reading it was (or will be) decided with
+  template <typename T> void journal_input(uint32_t type, const T &payload) {
+    if (journal.active())
+      journal.write(type, clock.now(), {{&payload, sizeof payload}});
+  }
 
-    auto now = std::chrono::steady_clock::now();
-    auto uptime =
-        std::chrono::duration_cast<std::chrono::seconds>(now - start_time)
-            .count();
-    state["uptime_seconds"] = uptime;
+  template <typename T>
+  void journal_input(uint32_t type, const T &payload, const ClockReading &at) {
+    journal.record(type, at, {{&payload, sizeof payload}});
+  }
+
+  // A name or config JSON, after the handle it belongs to (-1 if none)
+  void journal_text(uint32_t type, int32_t id, const string &text) {
+    if (journal.active())
+      write_journal_text(type, id, text, clock.now());
+  }
+
+  void journal_text(uint32_t type, int32_t id, const string &text,
+                    const ClockReading &at) {
+    if (journal.active())
+      write_journal_text(type, id, text, at);
+  }
+
+  void journal_candles(int32_t id, int32_t tf, const EngineCandle *candles,
+                       size_t n) {
+    if (!journal.active())
+      return;
+    JournalIdValue head = {id, tf};
+    journal.write(JOURNAL_CANDLES_LOAD, clock.now(),
+                  {{&head, sizeof head}, {candles, n * sizeof *candles}});
+  }
+
+  void journal_ticks(int32_t id, const EngineTick *ticks, size_t n) {
+    if (!journal.active())
+      return;
+    JournalIdValue head = {id, 0};
+    journal.write(JOURNAL_TICKS_SEED, clock.now(),
+                  {{&head, sizeof head}, {ticks, n * sizeof *ticks}});
+  }
+
+  // Unconditional writes, for the snapshot that opens a journal
+  void write_journal_text(uint32_t type, int32_t id, const string &text,
+                          const ClockReading &at) {
+    JournalIdValue head = {id, 0};
+    journal.write(type, at, {{&head, sizeof head}, {text.data(), text.size()}});
+  }
+
+  // Everything a replay needs to start where the live engine stands.
+  // Derived state (indicators, structure) is rebuilt from the candles.
+  void write_journal_snapshot() {
+    ClockReading now = clock.now();
+    json cfg = describe_config(config.get());
+    if (is_initialized)
+      cfg["memory"] = describe_memory_budget(budget); // sized as live
+    write_journal_text(is_initialized ? JOURNAL_INIT : JOURNAL_CONFIG, -1,
+                       cfg.dump(), now);
+    JournalIdValue running = {-1, is_running ? 1 : 0};
+    journal.write(JOURNAL_BOT_STATE, now, {{&running, sizeof running}});
+    write_journal_account(primary, now);
+    for (int32_t id = 0; id < accounts.size(); ++id) {
+      AccountContext *acct = accounts.get(id);
+      write_journal_text(JOURNAL_ACCOUNT_CREATE, id, acct->name, now);
+      write_journal_account(*acct, now);
+    }
+
+    vector<EngineCandle> bars;
+    for (int32_t id = 0; id < contexts.size(); ++id) {
+      SymbolContext *sym = contexts.get(id);
+      write_journal_text(JOURNAL_SYMBOL_CREATE, id, sym->name, now);
+      JournalIdNs cooldown = {id, 0, sym->cooldown_ns.load()};
+      journal.write(JOURNAL_SYMBOL_COOLDOWN, now,
+                    {{&cooldown, sizeof cooldown}});
+
+      std::lock_guard<std::mutex> lock(sym->state_lock);
+      JournalIdValue strategy = {id, sym->strategy.kind()};
+      journal.write(JOURNAL_SYMBOL_STRATEGY, now,
+                    {{&strategy, sizeof strategy}});
+      for (int32_t tf = 0; tf < ENGINE_TF_COUNT; ++tf) {
+        const CandleAggregator &agg = sym->candles[tf];
+        bars.clear();
+        for (size_t i = 0; i < agg.ring().size(); ++i)
+          bars.push_back(agg.ring().at(i));
+        JournalIdValue head = {id, tf};
+        if (!bars.empty())
+          journal.write(JOURNAL_CANDLES_LOAD, now,
+                        {{&head, sizeof head},
+                         {bars.data(), bars.size() * sizeof(EngineCandle)}});
+        JournalCandle forming = {id, tf, agg.current()};
+        if (agg.forming())
+          journal.write(JOURNAL_CANDLE_UPSERT, now,
+                        {{&forming, sizeof forming}});
+      }
+      JournalIdValue row = {id, 0};
+      ReturnSeries series = returns.row(id);
+      journal.write(JOURNAL_RETURNS, now,
+                    {{&row, sizeof row}, {&series, sizeof series}});
+      for (int32_t i = 0; i < sym->positions.size(); ++i)
+        journal.write(JOURNAL_POSITION_OPEN, now,
+                      {{&sym->positions.at(i), sizeof(EnginePosition)}});
+      JournalSymbolRisk risk = {id, sym->loss_streak.load(),
+                                sym->loss_streak_day.load(),
+                                sym->last_trade_ns.load()};
+      journal.write(JOURNAL_SYMBOL_RISK, now, {{&risk, sizeof risk}});
+    }
+  }
+
+  void write_journal_account(AccountContext &acct, const ClockReading &at) {
+    JournalAccountState state = {acct.id, 0, {}};
+    if (acct.load(state.state))
+      journal.write(JOURNAL_ACCOUNT_STATE, at, {{&state, sizeof state}});
+    JournalLedger l = {acct.id, 0, 0, 0.0, 0.0};
+    RiskLedger::Snapshot today = acct.ledger.peek(l.day);
+    l.sl_hits = today.sl_hits;
+    l.day_start_balance = today.day_start_balance;
+    l.realised_pnl = today.realised_pnl;
+    journal.write(JOURNAL_LEDGER, at, {{&l, sizeof l}});
+  }
+
+  // --- Journal replay ---
+  // Recorded handles to this engine's: creations that raced while
+  // recording may have been written in another order than they were made
+  struct ReplayIds {
+    vector<int32_t> symbols;
+    vector<int32_t> accounts;
+
+    static int32_t map(const vector<int32_t> &ids, int32_t recorded) {
+      if (recorded < 0 || static_cast<size_t>(recorded) >= ids.size())
+        return -1;
+      return ids[recorded];
+    }
+
+    static void bind(vector<int32_t> &ids, int32_t recorded, int32_t id) {
+      if (recorded < 0)
+        return;
+      if (static_cast<size_t>(recorded) >= ids.size())
+        ids.resize(recorded + 1, -1);
+      ids[recorded] = id;
+    }
+  };
+
+  // Apply one record to this (replaying) engine at the clock already set.
+  // Records of an unknown type or too short for their payload are skipped.
+  void replay_record(const JournalHeader &h, const char *p, ReplayIds &ids,
+                     EngineReplayStats &st) {
+    JournalIdValue iv;
+    JournalIdNs in;
+    JournalIdAmount amount;
+    switch (h.type) {
+    case JOURNAL_INIT:
+    case JOURNAL_CONFIG:
+    case JOURNAL_ACCOUNT_CREATE:
+    case JOURNAL_SYMBOL_CREATE: {
+      if (!journal_payload(h, p, iv))
+        return;
+      string text(p + sizeof iv, h.size - sizeof iv);
+      if (h.type == JOURNAL_INIT)
+        initialize(text);
+      else if (h.type == JOURNAL_CONFIG)
+        update_config(text);
+      else if (h.type == JOURNAL_ACCOUNT_CREATE)
+        ReplayIds::bind(ids.accounts, iv.id, create_account_context(text));
+      else
+        ReplayIds::bind(ids.symbols, iv.id, create_symbol_context(text));
+      return;
+    }
+    case JOURNAL_COOLDOWN:
+      if (journal_payload(h, p, in))
+        set_cooldown(in.ns);
+      return;
+    case JOURNAL_BOT_STATE:
+      if (journal_payload(h, p, iv))
+        set_bot_state(iv.value != 0);
+      return;
+    case JOURNAL_ACCOUNT_STATE: {
+      JournalAccountState a;
+      if (!journal_payload(h, p, a))
+        return;
+      if (a.id < 0)
+        update_account(a.state.balance, a.state.equity, a.state.margin_free);
+      else
+        set_account_state(ReplayIds::map(ids.accounts, a.id), a.state);
+      return;
+    }
+    case JOURNAL_ACCOUNT_RESULT:
+      if (journal_payload(h, p, amount))
+        record_account_result(ReplayIds::map(ids.accounts, amount.id),
+                              amount.amount);
+      return;
+    case JOURNAL_LEDGER: {
+      JournalLedger l;
+      if (!journal_payload(h, p, l))
+        return;
+      AccountContext *acct =
+          l.account_id < 0
+              ? &primary
+              : accounts.get(ReplayIds::map(ids.accounts, l.account_id));
+      if (acct)
+        acct->ledger.restore(
+            l.day, {l.day_start_balance, l.realised_pnl, l.sl_hits});
+      return;
+    }
+    case JOURNAL_SYMBOL_COOLDOWN:
+      if (journal_payload(h, p, in))
+        set_symbol_cooldown(ReplayIds::map(ids.symbols, in.id), in.ns);
+      return;
+    case JOURNAL_SYMBOL_STRATEGY:
+      if (journal_payload(h, p, iv))
+        set_symbol_strategy(ReplayIds::map(ids.symbols, iv.id), iv.value);
+      return;
+    case JOURNAL_SYMBOL_RISK: {
+      JournalSymbolRisk r;
+      if (!journal_payload(h, p, r))
+        return;
+      SymbolContext *sym = contexts.get(ReplayIds::map(ids.symbols, r.id));
+      if (!sym)
+        return;
+      std::lock_guard<std::mutex> lock(sym->state_lock);
+      sym->loss_streak = r.loss_streak;
+      sym->loss_streak_day = r.loss_streak_day;
+      sym->last_trade_ns = r.last_trade_ns;
+      return;
+    }
+    case JOURNAL_TRADE_RESULT:
+      if (journal_payload(h, p, amount))
+        record_trade_result(ReplayIds::map(ids.symbols, amount.id),
+                            amount.amount);
+      return;
+    case JOURNAL_TICK:
+    case JOURNAL_QUOTE: {
+      EngineTick t;
+      if (!journal_payload(h, p, t))
+        return;
+      ++st.ticks;
+      SymbolContext *sym =
+          contexts.get(ReplayIds::map(ids.symbols, t.symbol_id));
+      if (!sym)
+        return;
+      int64_t clock_ns = steady_now_ns();
+      EngineTickResult res;
+      if (h.type == JOURNAL_TICK)
+        apply_tick(*sym, t.epoch, t.quote, clock_ns, res);
+      else
+        apply_quote(*sym, t.quote);
+      return;
+    }
+    case JOURNAL_CANDLES_LOAD: {
+      if (!journal_payload(h, p, iv))
+        return;
+      replay_bars.resize((h.size - sizeof iv) / sizeof(EngineCandle));
+      std::memcpy(replay_bars.data(), p + sizeof iv,
+                  replay_bars.size() * sizeof(EngineCandle));
+      load_candles(ReplayIds::map(ids.symbols, iv.id), iv.value,
+                   replay_bars.data(), replay_bars.size());
+      return;
+    }
+    case JOURNAL_TICKS_SEED: {
+      if (!journal_payload(h, p, iv))
+        return;
+      replay_ticks.resize((h.size - sizeof iv) / sizeof(EngineTick));
+      std::memcpy(replay_ticks.data(), p + sizeof iv,
+                  replay_ticks.size() * sizeof(EngineTick));
+      SymbolContext *sym = contexts.get(ReplayIds::map(ids.symbols, iv.id));
+      if (!sym || replay_ticks.empty())
+        return;
+      std::lock_guard<std::mutex> lock(sym->state_lock);
+      seed_ticks(*sym, replay_ticks.data(), replay_ticks.size());
+      return;
+    }
+    case JOURNAL_RETURNS: {
+      ReturnSeries series;
+      if (!journal_payload(h, p, iv) || h.size < sizeof iv + sizeof series)
+        return;
+      std::memcpy(&series, p + sizeof iv, sizeof series);
+      int32_t id = ReplayIds::map(ids.symbols, iv.id);
+      if (contexts.get(id))
+        returns.set(id, series);
+      return;
+    }
+    case JOURNAL_CANDLES_RESET:
+      if (journal_payload(h, p, iv))
+        reset_candles(ReplayIds::map(ids.symbols, iv.id));
+      return;
+    case JOURNAL_CANDLE_UPSERT: {
+      JournalCandle c;
+      if (journal_payload(h, p, c))
+        upsert_candle(ReplayIds::map(ids.symbols, c.id), c.tf, c.candle);
+      return;
+    }
+    case JOURNAL_POSITION_OPEN: {
+      EnginePosition pos;
+      if (!journal_payload(h, p, pos))
+        return;
+      pos.symbol_id = ReplayIds::map(ids.symbols, pos.symbol_id);
+      open_position(pos);
+      return;
+    }
+    case JOURNAL_POSITION_CLOSE: {
+      JournalPositionClose c;
+      if (journal_payload(h, p, c))
+        close_position(ReplayIds::map(ids.symbols, c.id), c.contract_id);
+      return;
+    }
+    case JOURNAL_TRADE: {
+      JournalTrade t;
+      if (!journal_payload(h, p, t))
+        return;
+      SymbolContext *ctx =
+          contexts.get(ReplayIds::map(ids.symbols, t.request.symbol_id));
+      EngineTradeDecision d;
+      decide_trade(ctx, t.request.active_trades, t.request.stake,
+                   t.direction, d);
+      replay_check(t.decision, d, st);
+      return;
+    }
+    case JOURNAL_TRADE_ACCOUNTS: {
+      JournalTradeAccounts t;
+      if (!journal_payload(h, p, t) || t.n < 0)
+        return;
+      size_t n = static_cast<size_t>(t.n);
+      size_t orders_bytes = n * sizeof(EngineAccountTrade);
+      size_t decisions_bytes = n * sizeof(EngineTradeDecision);
+      if (h.size != sizeof t + orders_bytes + decisions_bytes)
+        return;
+      vector<EngineAccountTrade> orders(n);
+      vector<EngineTradeDecision> recorded(n), made(n);
+      std::memcpy(orders.data(), p + sizeof t, orders_bytes);
+      std::memcpy(recorded.data(), p + sizeof t + orders_bytes,
+                  decisions_bytes);
+      for (EngineAccountTrade &o : orders)
+        o.account_id = ReplayIds::map(ids.accounts, o.account_id);
+      execute_trade_accounts(ReplayIds::map(ids.symbols, t.symbol_id),
+                             t.direction, orders.data(), n, made.data());
+      for (size_t i = 0; i < n; ++i)
+        replay_check(recorded[i], made[i], st);
+      return;
+    }
+    default:
+      return;
+    }
+  }
+
+  static void replay_check(const EngineTradeDecision &recorded,
+                           const EngineTradeDecision &made,
+                           EngineReplayStats &st) {
+    ++st.decisions;
+    if (made.reason == ENGINE_TRADE_APPROVED)
+      ++st.approved;
+    if (same_decision(recorded, made))
+      return;
+    if (st.mismatches++ == 0)
+      st.first_mismatch = st.records;
+  }
+
+  // Replace a timeframe's closed candles; caller holds sym.state_lock
+  static void seed_candles(SymbolContext &sym, int32_t tf,
+                           const EngineCandle *candles, size_t n) {
+    CandleRing &ring = sym.candles[tf].ring();
+    IndicatorSet &ind = sym.indicators[tf];
+    MarketStructure &st = sym.structure[tf];
+    ring.clear();
+    ind.reset();
+    st.reset();
+    size_t skip = n > ring.capacity() ? n - ring.capacity() : 0;
+    for (size_t i = 0; i < n; ++i) {
+      if (i + 1 == n) {
+        sym.indicators_prev[tf] = ind;
+        sym.structure_prev[tf] = st;
+      }
+      ind.update(candles[i]);
+      st.update(candles[i]);
+      if (i >= skip)
+        ring.push(candles[i]);
+    }
+  }
+
+  // Fold the newest closed 1m candle into the symbol's returns row; caller
+  // holds sym.state_lock
+  void fold_return(const SymbolContext &sym) {
+    const CandleRing &ring = sym.candles[ENGINE_TF_1M].ring();
+    if (ring.size() == 0)
+      return;
+    EngineCandle bar = ring.back();
+    returns.on_close(sym.id, bar.epoch / TIMEFRAME_SECONDS[ENGINE_TF_1M],
+                     bar.close);
+  }
+
+  // Refold the tick indicators over `ticks` (n > 0), the last one becoming
+  // the symbol's quote; caller holds the lock
+  static void seed_ticks(SymbolContext &sym, const EngineTick *ticks,
+                         size_t n) {
+    sym.tick_indicators.reset();
+    for (size_t i = 0; i < n; ++i)
+      sym.tick_indicators.update(ticks[i].quote, ticks[i].quote,
+                                 ticks[i].quote);
+    sym.price = ticks[n - 1].quote;
+    sym.last_quote.store({ticks[n - 1].quote, ticks[n - 1].epoch});
+  }
+
+  // Rebuild the row from the 1m candles just seeded; caller holds the lock
+  void seed_returns(const SymbolContext &sym) {
+    const CandleRing &ring = sym.candles[ENGINE_TF_1M].ring();
+    ReturnSeries s{};
+    for (size_t i = 0; i < ring.size(); ++i) {
+      EngineCandle bar = ring.at(i);
+      s.on_close(bar.epoch / TIMEFRAME_SECONDS[ENGINE_TF_1M], bar.close);
+    }
+    returns.set(sym.id, s);
+  }
+
+  static void describe_regime(const ReturnSeries &s, EngineRegime &out) {
+    out.volatility = s.volatility();
+    out.baseline = std::sqrt(s.baseline);
+    out.ratio = s.volatility_ratio();
+    out.regime = s.regime();
+    out.returns = __builtin_popcountll(s.valid);
+  }
+
+  // Give a context its store writers; caller holds store_mutex.
+  // Symbols that are not valid directory names are not persisted.
+  bool attach_history(SymbolContext *sym) {
+    if (!sym || !valid_store_name(sym->name))
+      return true;
+    std::lock_guard<std::mutex> lock(sym->state_lock);
+    if (sym->history)
+      return true;
+    std::unique_ptr<SymbolHistory> history(new SymbolHistory());
+    if (!history->open(store_root, sym->name))
+      return false;
+    sym->history = std::move(history);
+    return true;
+  }
+
+  // Caller holds store_mutex
+  void detach_histories() {
+    for (int32_t id = 0; id < contexts.size(); ++id) {
+      SymbolContext *sym = contexts.get(id);
+      std::lock_guard<std::mutex> lock(sym->state_lock);
+      sym->history.reset();
+    }
+  }
+
+  // Map one stored series and find the rows with from <= epoch <= to
+  // (to <= 0: through the end) as [begin, end)
+  int32_t open_series(const string &symbol, int32_t series, int64_t from,
+                      int64_t to, SeriesReader &reader, size_t &begin,
+                      size_t &end) {
+    if (series < 0 || series > ENGINE_SERIES_TICKS)
+      return ENGINE_ERR_BAD_TIMEFRAME;
+    if (!valid_store_name(symbol))
+      return ENGINE_ERR_BAD_ARG;
+    string dir;
+    {
+      std::lock_guard<std::mutex> lock(store_mutex);
+      if (store_root.empty())
+        return ENGINE_ERR_IO;
+      dir = series_dir(store_root, symbol, series);
+    }
+    uint32_t columns = series == ENGINE_SERIES_TICKS ? 1 : 5;
+    if (!reader.open(dir, columns))
+      return ENGINE_ERR_IO;
+    begin = reader.lower_bound(from);
+    end = to > 0 ? reader.lower_bound(to + 1) : reader.rows();
+    end = std::max(begin, end);
+    return ENGINE_OK;
+  }
 
-    return state.dump();
+  void apply_cooldown(int64_t cooldown_ns) {
+    for (int32_t id = 0; id < contexts.size(); ++id)
+      contexts.get(id)->cooldown_ns = cooldown_ns;
+  }
+
+  // Whole seconds on the engine clock since construction
+  int64_t uptime_seconds() const {
+    return (clock.now().mono_ns - start_ns) / NS_PER_SECOND;
   }
 };
 
 // Global Engine Instance
 TradingEngine engine;
 
-// --- C Exports for Python ctypes ---
+#ifdef ENGINE_WITH_FEED
+// The running market-data feed, if any; guarded by feed_lock
+static std::mutex feed_lock;
+static std::unique_ptr<FeedHandler<TradingEngine>> feed;
+#endif
 
-#include <cstring>
-
-#include <cstdlib>
-#include <cstring>
+// --- C Exports for Python ctypes ---
 
 extern "C" {
 
 void init_engine(const char *config_json) { engine.initialize(config_json); }
 
-char *process_tick(const char *tick_json) {
-  string result = engine.process_tick(tick_json);
-  char *cstr = (char *)malloc(result.length() + 1);
-  if (cstr) {
-    std::strcpy(cstr, result.c_str());
-  }
-  return cstr;
+void update_config(const char *config_json) {
+  if (config_json)
+    engine.update_config(config_json);
+}
+
+void update_account(double balance, double equity, double margin_free) {
+  engine.update_account(balance, equity, margin_free);
+}
+
+int32_t create_account_context(const char *account) {
+  if (!account)
+    return -1;
+  return engine.create_account_context(account);
+}
+
+int32_t set_account_state(int32_t account_id, double balance, double equity,
+                          double margin_free) {
+  return engine.set_account_state(account_id,
+                                  {balance, equity, margin_free});
+}
+
+int32_t record_account_result(int32_t account_id, double profit) {
+  return engine.record_account_result(account_id, profit);
+}
+
+int32_t create_symbol_context(const char *symbol) {
+  if (!symbol)
+    return -1;
+  return engine.create_symbol_context(symbol);
+}
+
+int32_t set_symbol_cooldown(int32_t symbol_id, int seconds) {
+  return engine.set_symbol_cooldown(symbol_id, seconds * NS_PER_SECOND);
+}
+
+int32_t set_symbol_cooldown_ms(int32_t symbol_id, int64_t ms) {
+  return engine.set_symbol_cooldown(symbol_id, ms * 1000000);
+}
+
+int32_t record_trade_result(int32_t symbol_id, double profit) {
+  return engine.record_trade_result(symbol_id, profit);
+}
+
+int32_t get_recommended_stake(int32_t symbol_id, double balance,
+                              double *stake) {
+  if (!stake)
+    return ENGINE_ERR_NULL_ARG;
+  return engine.get_recommended_stake(symbol_id, balance, *stake);
+}
+
+int32_t get_policy_stake(const char *symbol, double balance, double *stake) {
+  if (!symbol || !stake)
+    return ENGINE_ERR_NULL_ARG;
+  *stake = risk_profile_for(symbol).stake_for(balance);
+  return ENGINE_OK;
+}
+
+int32_t get_last_quote(int32_t symbol_id, double *price, int64_t *epoch) {
+  if (!price || !epoch)
+    return ENGINE_ERR_NULL_ARG;
+  return engine.get_last_quote(symbol_id, *price, *epoch);
+}
+
+const char *process_tick(const char *tick_json) {
+  ExportTimer timer(engine.metrics, EXPORT_PROCESS_TICK);
+  string &out = thread_results().next();
+  engine.process_tick(tick_json ? tick_json : "", out);
+  return out.c_str();
+}
+
+int32_t process_tick_bin(const EngineTick *tick, EngineTickResult *out) {
+  ExportTimer timer(engine.metrics, EXPORT_PROCESS_TICK_BIN);
+  if (!tick || !out)
+    return ENGINE_ERR_NULL_ARG;
+  return engine.process_tick(*tick, *out);
+}
+
+int64_t process_ticks(const EngineTick *ticks, size_t n,
+                      EngineTickResult *out) {
+  ExportTimer timer(engine.metrics, EXPORT_PROCESS_TICKS);
+  if (n == 0)
+    return 0;
+  if (!ticks || !out)
+    return ENGINE_ERR_NULL_ARG;
+  return engine.process_ticks(ticks, n, out);
+}
+
+int32_t get_candles(int32_t symbol_id, int32_t timeframe,
+                    EngineCandleView *out) {
+  if (!out)
+    return ENGINE_ERR_NULL_ARG;
+  return engine.get_candles(symbol_id, timeframe, *out);
+}
+
+int64_t copy_candles(int32_t symbol_id, int32_t timeframe, EngineCandle *out,
+                     size_t max, int64_t *total_closed) {
+  if (!out && max > 0)
+    return ENGINE_ERR_NULL_ARG;
+  int64_t total = 0;
+  int64_t n = engine.copy_candles(symbol_id, timeframe, out, max, total);
+  if (total_closed)
+    *total_closed = total;
+  return n;
+}
+
+int32_t load_candles(int32_t symbol_id, int32_t timeframe,
+                     const EngineCandle *candles, size_t n) {
+  if (!candles && n > 0)
+    return ENGINE_ERR_NULL_ARG;
+  return engine.load_candles(symbol_id, timeframe, candles, n);
+}
+
+int32_t seed_history(const char *symbol, int32_t timeframe,
+                     const EngineCandle *candles, size_t n) {
+  if (!symbol || (!candles && n > 0))
+    return ENGINE_ERR_NULL_ARG;
+  return engine.seed_history(symbol, timeframe, candles, n);
+}
+
+int32_t upsert_candle(int32_t symbol_id, int32_t timeframe,
+                      const EngineCandle *candle) {
+  if (!candle)
+    return ENGINE_ERR_NULL_ARG;
+  return engine.upsert_candle(symbol_id, timeframe, *candle);
+}
+
+int32_t reset_candles(int32_t symbol_id) {
+  return engine.reset_candles(symbol_id);
+}
+
+int32_t get_indicators(int32_t symbol_id, int32_t timeframe,
+                       EngineIndicators *out) {
+  if (!out)
+    return ENGINE_ERR_NULL_ARG;
+  return engine.get_indicators(symbol_id, timeframe, *out);
+}
+
+int32_t get_tick_indicators(int32_t symbol_id, EngineIndicators *out) {
+  if (!out)
+    return ENGINE_ERR_NULL_ARG;
+  return engine.get_tick_indicators(symbol_id, *out);
+}
+
+int32_t get_structure(int32_t symbol_id, int32_t timeframe,
+                      EngineStructure *out) {
+  if (!out)
+    return ENGINE_ERR_NULL_ARG;
+  return engine.get_structure(symbol_id, timeframe, *out);
+}
+
+int32_t get_regime(int32_t symbol_id, EngineRegime *out) {
+  if (!out)
+    return ENGINE_ERR_NULL_ARG;
+  return engine.get_regime(symbol_id, *out);
+}
+
+int32_t get_correlation(int32_t symbol_a, int32_t symbol_b, double *corr,
+                        int32_t *returns) {
+  if (!corr)
+    return ENGINE_ERR_NULL_ARG;
+  int32_t n = 0;
+  int32_t status = engine.get_correlation(symbol_a, symbol_b, *corr, n);
+  if (returns)
+    *returns = n;
+  return status;
+}
+
+const char *get_correlations() {
+  string &out = thread_results().next();
+  engine.get_correlations(out);
+  return out.c_str();
+}
+
+const char *series_backend() { return series_ops().name; }
+
+int32_t series_true_range(const double *high, const double *low,
+                          const double *close, size_t n, double *out) {
+  if (n > 0 && (!high || !low || !close || !out))
+    return ENGINE_ERR_NULL_ARG;
+  compute_true_range(high, low, close, n, out);
+  return ENGINE_OK;
+}
+
+int32_t series_rolling_min(const double *x, size_t n, int32_t window,
+                           double *out) {
+  if (n > 0 && (!x || !out))
+    return ENGINE_ERR_NULL_ARG;
+  if (window < 1)
+    return ENGINE_ERR_BAD_ARG;
+  compute_rolling_min(x, n, static_cast<size_t>(window), out);
+  return ENGINE_OK;
+}
+
+int32_t series_rolling_max(const double *x, size_t n, int32_t window,
+                           double *out) {
+  if (n > 0 && (!x || !out))
+    return ENGINE_ERR_NULL_ARG;
+  if (window < 1)
+    return ENGINE_ERR_BAD_ARG;
+  compute_rolling_max(x, n, static_cast<size_t>(window), out);
+  return ENGINE_OK;
+}
+
+int32_t series_rolling_mean_std(const double *x, size_t n, int32_t window,
+                                double *mean, double *stddev) {
+  if (n > 0 && !x)
+    return ENGINE_ERR_NULL_ARG;
+  if (window < 1)
+    return ENGINE_ERR_BAD_ARG;
+  compute_rolling_mean_std(x, n, static_cast<size_t>(window), mean, stddev);
+  return ENGINE_OK;
+}
+
+int32_t series_swings(const double *high, const double *low, size_t n,
+                      int32_t k, uint8_t *flags) {
+  if (n > 0 && (!high || !low || !flags))
+    return ENGINE_ERR_NULL_ARG;
+  if (k < 1)
+    return ENGINE_ERR_BAD_ARG;
+  compute_swings(high, low, n, static_cast<size_t>(k), flags);
+  return ENGINE_OK;
+}
+
+int32_t series_atr(const double *high, const double *low, const double *close,
+                   size_t n, int32_t period, double *out) {
+  if (n > 0 && (!high || !low || !close || !out))
+    return ENGINE_ERR_NULL_ARG;
+  if (period < 1)
+    return ENGINE_ERR_BAD_ARG;
+  compute_atr(high, low, close, n, static_cast<size_t>(period), out);
+  return ENGINE_OK;
+}
+
+int32_t series_ema(const double *x, size_t n, int32_t period, double *out) {
+  if (n > 0 && (!x || !out))
+    return ENGINE_ERR_NULL_ARG;
+  if (period < 1)
+    return ENGINE_ERR_BAD_ARG;
+  compute_ema(x, n, static_cast<size_t>(period), out);
+  return ENGINE_OK;
+}
+
+const char *execute_trade(const char *params_json) {
+  ExportTimer timer(engine.metrics, EXPORT_EXECUTE_TRADE);
+  string &out = thread_results().next();
+  engine.execute_trade(params_json ? params_json : "", out);
+  return out.c_str();
+}
+
+int32_t execute_trade_bin(const EngineTradeRequest *req,
+                          EngineTradeDecision *out) {
+  ExportTimer timer(engine.metrics, EXPORT_EXECUTE_TRADE_BIN);
+  if (!req || !out)
+    return ENGINE_ERR_NULL_ARG;
+  return engine.execute_trade(*req, *out);
+}
+
+int64_t execute_trade_accounts(int32_t symbol_id, int32_t direction,
+                               const EngineAccountTrade *accounts, size_t n,
+                               EngineTradeDecision *out) {
+  ExportTimer timer(engine.metrics, EXPORT_EXECUTE_TRADE_ACCOUNTS);
+  if ((!accounts || !out) && n > 0)
+    return ENGINE_ERR_NULL_ARG;
+  return engine.execute_trade_accounts(symbol_id, direction, accounts, n,
+                                       out);
+}
+
+const char *trade_reason_string(int32_t reason) {
+  return trade_reason_text(reason);
+}
+
+int32_t open_position(const EnginePosition *pos) {
+  if (!pos)
+    return ENGINE_ERR_NULL_ARG;
+  return engine.open_position(*pos);
+}
+
+int32_t close_position(int32_t symbol_id, int64_t contract_id) {
+  return engine.close_position(symbol_id, contract_id);
+}
+
+int32_t get_position(int32_t symbol_id, int64_t contract_id,
+                     EnginePosition *out) {
+  if (!out)
+    return ENGINE_ERR_NULL_ARG;
+  return engine.get_position(symbol_id, contract_id, *out);
+}
+
+int64_t poll_position_updates(int32_t symbol_id, EnginePositionUpdate *out,
+                              size_t max) {
+  if (!out && max > 0)
+    return ENGINE_ERR_NULL_ARG;
+  return engine.poll_position_updates(symbol_id, out, max);
+}
+
+int32_t filter_entry(const EngineFilterRequest *req, EngineFilterResult *out) {
+  ExportTimer timer(engine.metrics, EXPORT_FILTER_ENTRY);
+  if (!req || !out)
+    return ENGINE_ERR_NULL_ARG;
+  return engine.filter_entry(*req, *out);
+}
+
+const char *filter_reason_string(int32_t reason) {
+  return filter_reason_text(reason);
+}
+
+int32_t set_symbol_strategy(int32_t symbol_id, int32_t kind) {
+  return engine.set_symbol_strategy(symbol_id, kind);
 }
 
-char *execute_trade(const char *params_json) {
-  string result = engine.execute_trade(params_json);
-  char *cstr = (char *)malloc(result.length() + 1);
-  if (cstr) {
-    std::strcpy(cstr, result.c_str());
+int32_t process_tick_strategy(const EngineTick *tick, int32_t active_trades,
+                              EngineTickResult *out,
+                              EngineStrategySignal *signal,
+                              EngineTradeDecision *decision) {
+  ExportTimer timer(engine.metrics, EXPORT_PROCESS_TICK_STRATEGY);
+  if (!tick || !out || !signal || !decision)
+    return ENGINE_ERR_NULL_ARG;
+  return engine.process_tick_strategy(*tick, active_trades, *out, *signal,
+                                      *decision);
+}
+
+int32_t get_strategy_signal(int32_t symbol_id, EngineStrategySignal *out) {
+  if (!out)
+    return ENGINE_ERR_NULL_ARG;
+  return engine.get_strategy_signal(symbol_id, *out);
+}
+
+const char *strategy_reason_string(int32_t reason) {
+  return strategy_reason_text(reason);
+}
+
+int64_t drain_events(EngineEvent *out, size_t max) {
+  if (!out && max > 0)
+    return ENGINE_ERR_NULL_ARG;
+  return engine.drain_events(out, max);
+}
+
+int32_t backtest_run(const char *symbol, const EngineCandle *candles, size_t n,
+                     const EngineBacktestParams *params,
+                     EngineBacktestOutput *out) {
+  if (!symbol || !params || !out || (!candles && n > 0))
+    return ENGINE_ERR_NULL_ARG;
+  return engine.backtest(symbol, candles, n, *params, *out);
+}
+
+int32_t backtest_run_ticks(const char *symbol, const EngineTick *ticks,
+                           size_t n, const EngineBacktestParams *params,
+                           EngineBacktestOutput *out) {
+  if (!symbol || !params || !out || (!ticks && n > 0))
+    return ENGINE_ERR_NULL_ARG;
+  return engine.backtest(symbol, ticks, n, *params, *out);
+}
+
+int32_t backtest_sweep(const char *symbol, const EngineCandle *candles,
+                       size_t n, const EngineBacktestParams *grid,
+                       size_t n_params, int32_t threads, int32_t rank_by,
+                       EngineSweepResult *out) {
+  if (!symbol || (!candles && n > 0) || (n_params > 0 && (!grid || !out)))
+    return ENGINE_ERR_NULL_ARG;
+  return engine.sweep(symbol, candles, n, grid, n_params, threads, rank_by,
+                      out);
+}
+
+int32_t backtest_sweep_file(const char *symbol, const char *path,
+                            const EngineBacktestParams *grid, size_t n_params,
+                            int32_t threads, int32_t rank_by,
+                            EngineSweepResult *out) {
+  if (!symbol || !path || (n_params > 0 && (!grid || !out)))
+    return ENGINE_ERR_NULL_ARG;
+  MappedFile file(path);
+  if (!file.ok())
+    return ENGINE_ERR_IO;
+  return engine.sweep(symbol, file.as<EngineCandle>(),
+                      file.count<EngineCandle>(), grid, n_params, threads,
+                      rank_by, out);
+}
+
+int32_t store_open(const char *root_dir) {
+  if (!root_dir)
+    return ENGINE_ERR_NULL_ARG;
+  return engine.store_open(root_dir);
+}
+
+void store_close() { engine.store_close(); }
+
+int32_t store_flush() { return engine.store_flush(); }
+
+int64_t store_warm_start(int32_t symbol_id) {
+  return engine.store_warm_start(symbol_id);
+}
+
+int64_t store_read_candles(const char *symbol, int32_t timeframe,
+                           int64_t from_epoch, int64_t to_epoch,
+                           EngineCandle *out, size_t max) {
+  if (!symbol || (!out && max > 0))
+    return ENGINE_ERR_NULL_ARG;
+  if (timeframe < 0 || timeframe >= ENGINE_TF_COUNT)
+    return ENGINE_ERR_BAD_TIMEFRAME;
+  return engine.store_read(symbol, timeframe, from_epoch, to_epoch, out,
+                           nullptr, max);
+}
+
+int64_t store_read_ticks(const char *symbol, int64_t from_epoch,
+                         int64_t to_epoch, EngineTick *out, size_t max) {
+  if (!symbol || (!out && max > 0))
+    return ENGINE_ERR_NULL_ARG;
+  return engine.store_read(symbol, ENGINE_SERIES_TICKS, from_epoch, to_epoch,
+                           nullptr, out, max);
+}
+
+int32_t backtest_run_store(const char *symbol, int32_t series,
+                           int64_t from_epoch, int64_t to_epoch,
+                           const EngineBacktestParams *params,
+                           EngineBacktestOutput *out) {
+  if (!symbol || !params || !out)
+    return ENGINE_ERR_NULL_ARG;
+  return engine.backtest_store(symbol, series, from_epoch, to_epoch, *params,
+                               *out);
+}
+
+#ifdef ENGINE_WITH_FEED
+int32_t feed_start(const char *url, const char *symbols,
+                   int32_t ohlc_granularity) {
+  if (!url || !symbols)
+    return ENGINE_ERR_NULL_ARG;
+  int32_t tf = -1;
+  for (int32_t i = 0; i < ENGINE_TF_COUNT; ++i)
+    if (TIMEFRAME_SECONDS[i] == ohlc_granularity)
+      tf = i;
+  if (ohlc_granularity != 0 && tf < 0)
+    return ENGINE_ERR_BAD_TIMEFRAME;
+
+  vector<string> names;
+  string list = symbols;
+  size_t start = 0;
+  while (start <= list.size()) {
+    size_t comma = list.find(',', start);
+    string name = list.substr(start, comma - start);
+    if (!name.empty())
+      names.push_back(name);
+    if (comma == string::npos)
+      break;
+    start = comma + 1;
+  }
+  if (names.empty())
+    return ENGINE_ERR_BAD_ARG;
+
+  std::lock_guard<std::mutex> lock(feed_lock);
+  feed.reset(); // stop the previous feed first
+  feed.reset(new FeedHandler<TradingEngine>(engine, url, names, tf,
+                                            ohlc_granularity));
+  if (feed->symbols() == 0) {
+    feed.reset();
+    return ENGINE_ERR_BAD_ARG;
   }
-  return cstr;
+  feed->start();
+  return ENGINE_OK;
+}
+
+void feed_stop() {
+  std::lock_guard<std::mutex> lock(feed_lock);
+  feed.reset();
+}
+
+int64_t feed_poll(EngineTickResult *out, size_t max) {
+  if (!out && max > 0)
+    return ENGINE_ERR_NULL_ARG;
+  std::lock_guard<std::mutex> lock(feed_lock);
+  return feed ? static_cast<int64_t>(feed->poll(out, max)) : 0;
+}
+
+int32_t feed_stats(EngineFeedStats *out) {
+  if (!out)
+    return ENGINE_ERR_NULL_ARG;
+  std::lock_guard<std::mutex> lock(feed_lock);
+  *out = EngineFeedStats{};
+  if (feed)
+    feed->stats(*out);
+  return ENGINE_OK;
 }
 
-void set_cooldown(int seconds) { engine.set_cooldown(seconds); }
+const char *feed_last_error() {
+  string &out = thread_results().next();
+  std::lock_guard<std::mutex> lock(feed_lock);
+  if (feed)
+    out = feed->last_error();
+  return out.c_str();
+}
+#else
+int32_t feed_start(const char *, const char *, int32_t) {
+  return ENGINE_ERR_UNSUPPORTED;
+}
+
+void feed_stop() {}
+
+int64_t feed_poll(EngineTickResult *, size_t) { return 0; }
+
+int32_t feed_stats(EngineFeedStats *out) {
+  if (!out)
+    return ENGINE_ERR_NULL_ARG;
+  *out = EngineFeedStats{};
+  return ENGINE_OK;
+}
+
+const char *feed_last_error() { return ""; }
+#endif
+
+void set_cooldown(int seconds) { engine.set_cooldown(seconds * NS_PER_SECOND); }
 
 void set_bot_state(bool state) { engine.set_bot_state(state); }
 
-char *get_bot_state() {
-  string result = engine.get_bot_state();
-  char *cstr = (char *)malloc(result.length() + 1);
-  if (cstr) {
-    std::strcpy(cstr, result.c_str());
-  }
-  return cstr;
+const char *get_bot_state() {
+  string &out = thread_results().next();
+  engine.get_bot_state(out);
+  return out.c_str();
 }
 
-void free_result(char *ptr) {
-  if (ptr) {
-    free(ptr);
-  }
+const char *get_metrics() {
+  string &out = thread_results().next();
+  engine.get_metrics(out);
+  return out.c_str();
 }
+
+void reset_metrics() { engine.reset_metrics(); }
+
+int32_t journal_start(const char *path) {
+  if (!path)
+    return ENGINE_ERR_NULL_ARG;
+  return engine.journal_start(path);
+}
+
+int64_t journal_stop() { return engine.journal_stop(); }
+
+int32_t journal_replay(const char *path, EngineReplayStats *out) {
+  if (!path || !out)
+    return ENGINE_ERR_NULL_ARG;
+  return TradingEngine::journal_replay(path, *out);
+}
+
+// Results live in the calling thread's ring; nothing to release
+void free_result(const char *) {}
 }
@@ -3,40 +3,1010 @@
  *
  * The Python side talks to these functions via ctypes. All complex
  * data structures are passed as JSON strings to keep the ABI simple.
+ * Returned JSON strings are owned by the engine: they live in a small
+ * per-thread ring of reusable buffers and stay valid until the calling
+ * thread has made 8 more string-returning calls. Copy them out right away.
+ *
+ * The tick hot path additionally has a binary ABI built on the
+ * fixed-layout structs below. They are mirrored field-for-field by
+ * ctypes.Structure classes in app/core/engine_wrapper.py, so any change
+ * here must be made there too.
  */
 
 #ifndef ENGINE_HPP
 #define ENGINE_HPP
 
+#include <cstddef>
+#include <cstdint>
+
 extern "C" {
 
+// --- Binary ABI structs ---
+// Every member is naturally aligned so there is no implicit padding;
+// sizes are checked with static_assert in engine.cpp.
+
+// Status codes returned by the binary entry points
+enum EngineStatus {
+  ENGINE_OK = 0,
+  ENGINE_ERR_NULL_ARG = -1,
+  ENGINE_ERR_UNKNOWN_SYMBOL = -2,
+  ENGINE_ERR_BAD_TIMEFRAME = -3,
+  ENGINE_ERR_BAD_ARG = -4,
+  ENGINE_ERR_IO = -5,
+  ENGINE_ERR_UNSUPPORTED = -6, // feature not compiled into this build
+  ENGINE_ERR_UNKNOWN_ACCOUNT = -7,
+};
+
+// Candle timeframes aggregated natively from ticks
+enum EngineTimeframe {
+  ENGINE_TF_1M = 0,
+  ENGINE_TF_5M = 1,
+  ENGINE_TF_15M = 2,
+  ENGINE_TF_1H = 3,
+  ENGINE_TF_COUNT = 4,
+};
+
+// History store series: a candle EngineTimeframe, or raw ticks
+enum EngineStoreSeries {
+  ENGINE_SERIES_TICKS = ENGINE_TF_COUNT,
+};
+
+// Bits of EngineIndicators.ready: indicator has finished its warm-up
+enum EngineIndicatorFlags {
+  ENGINE_IND_RSI = 1 << 0,
+  ENGINE_IND_EMA_FAST = 1 << 1,
+  ENGINE_IND_EMA_SLOW = 1 << 2,
+  ENGINE_IND_ATR = 1 << 3,
+  ENGINE_IND_ADX = 1 << 4,
+  ENGINE_IND_MACD = 1 << 5,
+};
+
+// Outcome of a trade check; ENGINE_TRADE_APPROVED or why it was rejected.
+// trade_reason_string() gives the text for each code.
+enum EngineTradeReason {
+  ENGINE_TRADE_APPROVED = 0,
+  ENGINE_REJECT_NOT_INITIALIZED = 1,
+  ENGINE_REJECT_BOT_STOPPED = 2,
+  ENGINE_REJECT_UNKNOWN_SYMBOL = 3, // no such context (JSON: empty symbol)
+  ENGINE_REJECT_STAKE_BELOW_MIN = 4, // limit = minimum stake
+  ENGINE_REJECT_STAKE_ABOVE_MAX = 5, // limit = maximum stake
+  ENGINE_REJECT_INSUFFICIENT_MARGIN = 6, // limit = free margin
+  ENGINE_REJECT_MAX_ACTIVE_TRADES = 7,   // limit = max active trades
+  ENGINE_REJECT_DAILY_LOSS = 8,  // detail = loss today, limit = max loss
+  ENGINE_REJECT_MAX_SL_HITS = 9, // detail = SL hits today
+  ENGINE_REJECT_LOSS_STREAK = 10, // detail = consecutive losses
+  ENGINE_REJECT_COOLDOWN = 11,    // detail = seconds remaining
+  ENGINE_REJECT_UNKNOWN_ACCOUNT = 12, // execute_trade_accounts only
+  ENGINE_REJECT_CORRELATED = 13, // detail = correlation with open exposure
+  ENGINE_REJECT_VOLATILITY = 14, // detail = volatility / its baseline
+  ENGINE_TRADE_REASON_COUNT = 15,
+};
+
+// One market tick. symbol_id comes from create_symbol_context().
+struct EngineTick {
+  int32_t symbol_id;
+  int32_t flags; // reserved, must be 0
+  int64_t epoch; // seconds since Unix epoch
+  double quote;
+};
+
+// Caller-owned result of processing one tick.
+struct EngineTickResult {
+  int32_t symbol_id;
+  int32_t status; // EngineStatus
+  int64_t epoch;
+  double price;
+  double signal;      // directional bias in [0, 1]; 0.5 = neutral
+  int32_t closed_mask; // bit n set: timeframe n closed a candle on this tick
+  int32_t exit_updates; // open positions with undrained exit changes
+                        // (see poll_position_updates)
+  int32_t spike;        // 1 up, -1 down if this tick is a spike, else 0
+                        // (see update_config "spike_threshold")
+  int32_t ticks_since_spike; // ticks since the symbol's last spike, -1
+                             // before its first
+  double spike_score;        // this tick's move in standard deviations of
+                             // the symbol's recent moves (0 warming up)
+};
+
+// One OHLC candle; epoch is the candle open time, volume the tick count.
+struct EngineCandle {
+  int64_t epoch;
+  double open;
+  double high;
+  double low;
+  double close;
+  double volume;
+};
+
+// Zero-copy view of one symbol/timeframe candle ring. Each column points
+// at `count` contiguous closed candles, oldest first, owned by the engine.
+// The view stays valid until that timeframe next closes a candle; while
+// another thread applies the symbol's ticks (the native feed) that can
+// happen mid-read, so read through copy_candles instead.
+struct EngineCandleView {
+  const int64_t *epoch;
+  const double *open;
+  const double *high;
+  const double *low;
+  const double *close;
+  const double *volume;
+  int64_t count;
+  int64_t capacity;
+  int64_t total_closed; // candles closed since start; grows past capacity
+  int32_t has_current;  // 1 if `current` holds a forming candle
+  int32_t reserved;
+  EngineCandle current;
+};
+
+// Trade check input for execute_trade_bin
+struct EngineTradeRequest {
+  int32_t symbol_id;
+  int32_t active_trades;
+  double stake; // <= 0: size from the symbol's risk policy
+};
+
+// One account of an execute_trade_accounts fan-out
+struct EngineAccountTrade {
+  int32_t account_id; // from create_account_context()
+  int32_t active_trades;
+  double stake; // <= 0: size from the symbol's policy and this balance
+};
+
+// Caller-owned trade decision. `stake` is the stake that was checked.
+struct EngineTradeDecision {
+  int32_t reason; // EngineTradeReason
+  int32_t reserved;
+  double stake;
+  double detail;
+  double limit;
+};
+
+// --- Entry filters ---
+// Outcome of filter_entry: ENGINE_FILTER_PASSED, or the kind of the stage
+// that rejected the entry. Stage kinds are listed with their config name
+// and the `value` they report in EngineFilterResult.
+// filter_reason_string() gives the text for each code.
+enum EngineFilterReason {
+  ENGINE_FILTER_PASSED = 0,
+  ENGINE_FILTER_NO_CANDLE = 1,   // the timeframe has no closed candle yet
+  ENGINE_FILTER_FLAT_CANDLE = 2, // high <= low; value = range
+  // Candle stages, on the last closed candle
+  ENGINE_FILTER_BODY_TOO_SMALL = 3,   // min_body: body / range < limit
+  ENGINE_FILTER_BODY_TOO_LARGE = 4,   // max_body: body / range > limit
+  ENGINE_FILTER_LOW_SPREAD = 5,       // min_spread: body / range < limit
+  ENGINE_FILTER_CANDLE_DIRECTION = 6, // candle_direction: close - open
+  ENGINE_FILTER_RSI_MOMENTUM = 7,     // rsi_momentum: request's momentum
+  ENGINE_FILTER_OPPOSITE_WICK = 8,    // max_opposite_wick: wick / body
+  // Indicator and structure stages; indicators pass until warmed up
+  ENGINE_FILTER_RSI_BAND = 9,           // rsi_band: rsi_live, BUY below
+                                        // limit, SELL above 100 - limit
+  ENGINE_FILTER_EMA_TREND = 10,         // ema_trend: ema_fast - ema_slow
+  ENGINE_FILTER_ADX_TOO_LOW = 11,       // min_adx: adx < limit
+  ENGINE_FILTER_STRUCTURE_AGAINST = 12, // structure_trend: structure trend
+  ENGINE_FILTER_WEAK_SIGNAL = 13,       // min_signal: signal, BUY at least
+                                        // limit, SELL at most 1 - limit
+  ENGINE_FILTER_REASON_COUNT = 14,
+};
+
+// --- Open positions ---
+// How an open position's stop loss trails (see position_book.hpp)
+enum EngineTrailRule {
+  ENGINE_TRAIL_NONE = 0,
+  ENGINE_TRAIL_BREAK_EVEN = 1, // to entry past 0.25x the entry-stop distance
+  ENGINE_TRAIL_V10 = 2,        // to entry at +6 points, trails 5 from +9
+  ENGINE_TRAIL_BOOM300 = 3,    // to entry at +7 points, trails 5 from +10
+  ENGINE_TRAIL_CRASH300 = 4,   // as Boom 300
+};
+
+// Bits of EnginePositionUpdate.events
+enum EnginePositionEvent {
+  ENGINE_POSITION_STOP_MOVED = 1 << 0,      // the trailing rule moved the SL
+  ENGINE_POSITION_STOP_HIT = 1 << 1,        // price reached the stop loss
+  ENGINE_POSITION_TAKE_PROFIT_HIT = 1 << 2, // price reached the take profit
+};
+
+// An open position tracked by the engine; levels are prices, 0 = none
+struct EnginePosition {
+  int64_t contract_id;
+  int32_t symbol_id;
+  int32_t side;       // 1 = BUY, -1 = SELL
+  int32_t trail_rule; // EngineTrailRule
+  int32_t reserved;
+  double entry_price;
+  double stop_loss;
+  double take_profit;
+};
+
+// A position whose exits changed since it was last drained
+struct EnginePositionUpdate {
+  int64_t contract_id;
+  int64_t epoch;  // tick of the latest change
+  int32_t events; // EnginePositionEvent bits since the last drain
+  int32_t reserved;
+  double price; // price of that tick
+  double stop_loss;
+  double take_profit;
+};
+
+// Entry filter input for filter_entry
+struct EngineFilterRequest {
+  int32_t symbol_id;
+  int32_t timeframe;    // EngineTimeframe the stages read
+  int32_t direction;    // 1 = BUY, -1 = SELL
+  int32_t rsi_momentum; // 1 rising, -1 falling, 0 unknown (stage passes)
+};
+
+// Caller-owned filter outcome
+struct EngineFilterResult {
+  int32_t reason; // EngineFilterReason
+  int32_t stage;  // index of the rejecting stage, -1 if passed
+  double value;   // what the stage measured
+  double limit;   // what it was held against
+};
+
+// --- Strategies ---
+// Native entry strategy of a symbol context (see strategy.hpp), picked
+// from the symbol name at creation as the Python STRATEGY_MAP does;
+// set_symbol_strategy changes it
+enum EngineStrategyKind {
+  ENGINE_STRATEGY_NONE = 0,
+  ENGINE_STRATEGY_V10_SUPER_SAFE = 1, // R_10, R_25, R_100, forex, gold
+  ENGINE_STRATEGY_BOOM300_SAFE = 2,   // Boom indices, SELL only
+  ENGINE_STRATEGY_CRASH300_SAFE = 3,  // Crash indices and R_50, BUY only
+  ENGINE_STRATEGY_KIND_COUNT = 4,
+};
+
+// The market mode the strategy read from the 1m candles
+enum EngineMarketMode {
+  ENGINE_MARKET_RANGE = 0,
+  ENGINE_MARKET_TREND = 1,
+  ENGINE_MARKET_STRONG_TREND = 2,
+  ENGINE_MARKET_COMPRESSION = 3, // ATR well below its recent mean
+  ENGINE_MARKET_CHAOTIC = 4,     // ATR spike with noise
+};
+
+// Outcome of one strategy evaluation: an entry, or the check that held it
+// back with the `value` / `limit` it reports. strategy_reason_string()
+// gives the text for each code.
+enum EngineStrategyReason {
+  ENGINE_STRATEGY_ENTRY = 0,      // direction, sl, tp and confidence set
+  ENGINE_STRATEGY_OFF = 1,        // the symbol has no strategy
+  ENGINE_STRATEGY_WARMING_UP = 2, // value = 1m bars (Boom/Crash: ticks)
+                                  // held, limit = needed
+  ENGINE_STRATEGY_NOISE = 3,      // wick-heavy candle, ATR spike or whipsaw
+  ENGINE_STRATEGY_CHAOTIC = 4,
+  ENGINE_STRATEGY_SIDEWAYS = 5,   // value = MA20 slope, |value| < limit
+  ENGINE_STRATEGY_WEAK_TREND = 6, // value = ADX < limit
+  ENGINE_STRATEGY_FLAT_SLOPE = 7, // value = MA20 slope
+  ENGINE_STRATEGY_NO_SETUP = 8,   // trend and RSI do not line up; V10:
+                                  // value = RSI, limit = MA trend (1, -1,
+                                  // 0); Boom/Crash: value = MA trend
+  ENGINE_STRATEGY_RSI_MISMATCH = 9, // multi-timeframe RSI blocks it; value
+                                    // = RSI(1m) live, limit = its slope
+  ENGINE_STRATEGY_ENTRY_FILTER = 10, // filter = EngineFilterReason, value
+                                     // and limit as in EngineFilterResult
+  ENGINE_STRATEGY_EXTREME_VOLATILITY = 11, // value = ATR over its mean
+  ENGINE_STRATEGY_RECENT_SPIKE = 12, // value = largest tick move
+  ENGINE_STRATEGY_LOW_CONFIDENCE = 13, // value = confidence < limit
+  ENGINE_STRATEGY_REASON_COUNT = 14,
+};
+
+// Caller-owned strategy outcome (process_tick_strategy,
+// get_strategy_signal). SL/TP are price distances from the entry.
+struct EngineStrategySignal {
+  int32_t strategy;    // EngineStrategyKind
+  int32_t reason;      // EngineStrategyReason
+  int32_t direction;   // 1 = BUY, -1 = SELL, 0 = no entry
+  int32_t filter;      // EngineFilterReason for ENGINE_STRATEGY_ENTRY_FILTER
+  int32_t market_mode; // EngineMarketMode
+  int32_t reserved;
+  int64_t epoch;     // of the tick it was evaluated on
+  double confidence; // 0-100, for an entry
+  double value;
+  double limit;
+  double sl;
+  double tp;
+};
+
+// --- Engine events ---
+// What an EngineEvent reports, and what its code / value / limit hold
+enum EngineEventType {
+  ENGINE_EVENT_SIGNAL = 0,         // a 1m candle closed: code = timeframe,
+                                   // value = signal, limit = price
+  ENGINE_EVENT_ENTRY_SKIPPED = 1,  // filter_entry rejected: code, value and
+                                   // limit as in EngineFilterResult
+  ENGINE_EVENT_TRADE_APPROVED = 2, // value = stake
+  ENGINE_EVENT_TRADE_REJECTED = 3, // code = EngineTradeReason, value =
+                                   // detail, limit as in the decision
+  ENGINE_EVENT_STRATEGY_ENTRY = 4, // code = EngineStrategyKind, value =
+                                   // confidence, limit = stop distance
+  ENGINE_EVENT_SPIKE = 5,          // a tick spiked: direction, code = ticks
+                                   // since the previous spike (-1 if none),
+                                   // value = z-score, limit = price move
+  ENGINE_EVENT_TYPE_COUNT = 6,
+};
+
+// One record of the engine's event ring (see drain_events)
+struct EngineEvent {
+  int64_t seq;     // post number, from 1; dropped events leave gaps
+  int64_t time_ms; // wall clock when posted, ms since the Unix epoch
+  int32_t type;    // EngineEventType
+  int32_t symbol_id; // -1 if the symbol is unknown
+  int32_t code;
+  int32_t direction; // 1 = BUY, -1 = SELL, 0 = not known
+  int32_t account_id; // trade events: -1 = the engine's own account
+  int32_t reserved;
+  double value;
+  double limit;
+};
+
+// --- Backtest ---
+// How a simulated trade was closed
+enum EngineExitReason {
+  ENGINE_EXIT_TAKE_PROFIT = 0,
+  ENGINE_EXIT_STOP_LOSS = 1,
+  ENGINE_EXIT_MAX_HOLD = 2,
+  ENGINE_EXIT_END_OF_DATA = 3,
+};
+
+// Sizing, exit rules and entry threshold of a backtest run. Entries use the
+// live signal (see process_tick) and must pass the live trade checks.
+struct EngineBacktestParams {
+  double initial_balance;
+  double stake_fraction;   // of equity per trade; <= 0 uses the risk policy
+  double leverage;         // P&L multiplier on the price change
+  double take_profit_pct;  // price move that closes in profit, percent
+  double stop_loss_pct;    // adverse move that closes at a loss, percent
+  double signal_threshold; // BUY when signal >= t, SELL when <= 1 - t
+  double rsi_oversold;     // SELL only while live RSI > this (0 = off)
+  double rsi_overbought;   // BUY only while live RSI < this (100 = off)
+  int64_t max_hold_seconds; // 0 = no time exit
+  int32_t timeframe;        // EngineTimeframe whose indicators drive signals
+  int32_t cooldown_seconds; // < 0 = live cooldown
+  int32_t equity_every;     // equity point every N bars/ticks (<= 1: all)
+  int32_t reserved;
+};
+
+struct EngineBacktestTrade {
+  int64_t entry_epoch;
+  int64_t exit_epoch;
+  int32_t side;        // 1 = BUY, -1 = SELL
+  int32_t exit_reason; // EngineExitReason
+  double entry_price;
+  double exit_price;
+  double stake;
+  double pnl;
+  double pnl_pct; // of stake, leverage included
+};
+
+struct EngineEquityPoint {
+  int64_t epoch;
+  double equity;
+  double drawdown_pct; // below the running peak
+};
+
+struct EngineBacktestStats {
+  int64_t bars; // candles or ticks replayed
+  int64_t trades;
+  int64_t wins;
+  int64_t losses;
+  int64_t rejected; // signals blocked by the trade checks
+  double final_equity;
+  double total_pnl;
+  double max_drawdown; // currency
+  double max_drawdown_pct;
+  double win_rate;      // percent
+  double profit_factor; // gross win / gross loss (999 if no losses)
+  double avg_win;
+  double avg_loss; // positive
+  double largest_win;
+  double largest_loss; // most negative trade
+  double sharpe;       // per-trade mean / stdev of P&L, not annualised
+  double avg_hold_seconds;
+  double expectancy; // mean P&L per trade
+};
+
+// Sweep ranking keys (higher is better)
+enum EngineSweepRank {
+  ENGINE_RANK_TOTAL_PNL = 0,
+  ENGINE_RANK_PROFIT_FACTOR = 1,
+  ENGINE_RANK_SHARPE = 2,
+  ENGINE_RANK_WIN_RATE = 3,
+  ENGINE_RANK_RETURN_OVER_DRAWDOWN = 4, // total_pnl / max_drawdown
+  ENGINE_RANK_COUNT = 5,
+};
+
+// One row of a ranked sweep; `index` is the parameter set's grid position
+struct EngineSweepResult {
+  int64_t index;
+  double score;
+  EngineBacktestStats stats;
+};
+
+// Caller-owned output buffers. Counts are totals and may exceed the
+// capacities; only the first `*_capacity` entries are written.
+struct EngineBacktestOutput {
+  EngineBacktestTrade *trades;
+  int64_t trades_capacity;
+  int64_t trades_count;
+  EngineEquityPoint *equity;
+  int64_t equity_capacity;
+  int64_t equity_count;
+  EngineBacktestStats stats;
+};
+
+// Counters of the native market-data feed (feed_stats)
+struct EngineFeedStats {
+  int64_t frames;          // WebSocket messages received
+  int64_t ticks;           // ticks applied to the engine
+  int64_t candles;         // OHLC updates applied
+  int64_t dropped;         // ticks lost to a full per-symbol ring
+  int64_t results_dropped; // tick results lost because feed_poll lagged
+  int64_t parse_errors;
+  int64_t api_errors; // error responses from the API (see feed_last_error)
+  int64_t connects;   // successful connections; reconnects = connects - 1
+  int32_t connected;  // 1 while the socket is up
+  int32_t symbols;
+};
+
+// Outcome of journal_replay
+struct EngineReplayStats {
+  int64_t records;        // journal records applied
+  int64_t ticks;          // of which ticks and quotes
+  int64_t decisions;      // trade decisions re-made (one per account)
+  int64_t approved;       // of which approved in the replay
+  int64_t mismatches;     // decisions that differ from the recorded ones
+  int64_t first_mismatch; // record index of the first, -1 if none
+  int64_t bytes;          // journal bytes read (less than the file if it
+                          // ends in a partial record)
+  int64_t elapsed_ns;     // wall time the replay took
+};
+
+// O(1) snapshot of one symbol's streaming indicators for a timeframe.
+// RSI(14) and ATR/ADX(14) use Wilder smoothing, EMAs are 20/50 and MACD is
+// 12/26/9, all folded in on candle close. rsi_live treats the live price as
+// the next close.
+struct EngineIndicators {
+  double rsi;
+  double rsi_live;
+  double ema_fast;
+  double ema_fast_prev;
+  double ema_slow;
+  double atr;
+  double adx;
+  double plus_di;
+  double minus_di;
+  double macd;
+  double macd_signal;
+  double macd_hist;
+  int64_t samples; // bars folded in so far
+  int32_t ready;   // EngineIndicatorFlags
+  int32_t reserved;
+};
+
+// Market structure of one timeframe, folded in on candle close (see
+// market_structure.hpp). Swings are pivots with 5 closed bars either side;
+// a break of structure (BOS) is the first close beyond the latest swing,
+// and a BOS against the trend is also a change of character (CHoCH).
+// Fair value gaps are open three-bar imbalances. Prices are 0 until formed.
+struct EngineStructure {
+  double swing_high; // latest confirmed swing high
+  double swing_low;
+  double prev_swing_high; // the one before it (higher/lower highs)
+  double prev_swing_low;
+  int64_t swing_high_epoch;
+  int64_t swing_low_epoch;
+  double bos_level;       // swing level the last BOS closed beyond
+  int64_t bos_epoch;      // candle that broke it
+  int32_t bos_direction;  // 1 bullish, -1 bearish, 0 none yet
+  int32_t trend;          // direction of the last BOS
+  int32_t choch;          // 1 if the last BOS reversed the trend
+  int32_t bars_since_bos; // 0 = broken by the newest closed candle, -1 none
+  double bull_fvg_top;    // newest open bullish gap (below price)
+  double bull_fvg_bottom;
+  double bear_fvg_top; // newest open bearish gap (above price)
+  double bear_fvg_bottom;
+  int32_t open_bull_fvgs;
+  int32_t open_bear_fvgs;
+  int64_t bars; // closed candles folded in
+};
+
+// Volatility regime of a symbol (see get_regime)
+enum EngineRegimeKind {
+  ENGINE_REGIME_UNKNOWN = 0, // too few 1m returns yet
+  ENGINE_REGIME_CALM = 1,    // ratio < 0.75
+  ENGINE_REGIME_NORMAL = 2,
+  ENGINE_REGIME_VOLATILE = 3, // ratio >= 1.5
+};
+
+// Realised volatility of a symbol's 1m log returns (RMS per bar)
+struct EngineRegime {
+  double volatility; // over the last 64 closed bars
+  double baseline;   // long-run level (EWMA over ~1024 bars)
+  double ratio;      // volatility / baseline, 0 while unknown
+  int32_t regime;    // EngineRegimeKind
+  int32_t returns;   // returns in the window
+};
+
 // Initialize / reset the engine with JSON configuration
 // Example: {"cooldown_seconds": 60, ...}
+// Takes the update_config keys, plus the memory budget: "memory"
+// {max_symbols (1-256, default 256), max_accounts (0-32, default 32),
+// max_positions per symbol (default 32), candles: {"1m", "5m", "15m",
+// "1h"} closed candles kept (default 200, 200, 200, 100)}. One arena is
+// reserved for that budget and every symbol and account context, with its
+// candles and positions, is built in it, so the engine's footprint is
+// bounded and the tick and trade paths never allocate. The budget is fixed
+// once the first context exists (a context created before init_engine
+// fixes the default); a later init_engine keeps it. A budget out of range
+// rejects the whole config. get_metrics "memory" reports the usage.
+// Re-initialising resets every other key to its default, including those
+// only set through update_config (e.g. entry_filters); per-symbol cooldowns
+// are only reset when the config sets cooldown_seconds or cooldown_ms. To
+// re-apply settings to a running engine (e.g. on reconnect), use
+// update_config.
 void init_engine(const char *config_json);
 
-// Hot‑reload configuration while running
+// Hot‑reload configuration while running. Keys present override the live
+// values, absent keys keep theirs: cooldown_seconds (fractional) or
+// cooldown_ms, max_active_trades (alias max_open_trades), min_stake,
+// max_stake, max_daily_loss (percent of the day's starting balance),
+// max_sl_hits, max_correlation (reject a trade whose symbol's returns
+// correlate at least this much with a symbol holding open positions,
+// counting a position against the trade's direction as a hedge; 0 = off),
+// max_volatility_ratio (reject while the symbol's volatility is at least
+// this multiple of its baseline; 0 = off), spike_threshold (a tick whose
+// move is at least this many standard deviations from the symbol's last 256
+// moves is a spike; 0 = off) and entry_filters, the ordered filter_entry
+// stages: a list of config names (see EngineFilterReason) or {"stage": name,
+// "limit": x} objects, e.g. [{"stage": "min_body", "limit": 0.15},
+// "candle_direction"]. The default is min_body 0.15, max_body 0.85,
+// min_spread 0.2, candle_direction, rsi_momentum, max_opposite_wick 2. An
+// unknown stage rejects the update.
+// The new configuration is published atomically; in-flight ticks and trade
+// validations finish against the snapshot they started with.
 void update_config(const char *config_json);
 
 // Update account information used internally for risk metrics
-// (balance, equity, margin_free)
+// (balance, equity, margin_free). Once set, trades whose stake exceeds
+// margin_free are rejected.
 void update_account(double balance, double equity, double margin_free);
 
+// --- Accounts ---
+// Accounts mirrored alongside the engine's own (update_account). Each has
+// its own balance, free margin and daily loss / stop-loss counters; the
+// symbol's risk policy, losing streak and cooldown are shared.
+
+// Create (or look up) an account context, e.g. by Deriv login id.
+// Idempotent; returns -1 for an empty/null name or a full table (the
+// budget's max_accounts, see init_engine).
+int32_t create_account_context(const char *account);
+
+// Balance figures of one account, as update_account for the engine's own
+int32_t set_account_state(int32_t account_id, double balance, double equity,
+                          double margin_free);
+
+// Feed a settled contract's profit into the account's daily counters. The
+// symbol's losing streak is fed once per signal, by record_trade_result.
+int32_t record_account_result(int32_t account_id, double profit);
+
+// --- Symbol contexts ---
+// Create (or look up) the engine context for a Deriv symbol, e.g. "R_100".
+// The returned handle is the symbol_id used by every binary entry point.
+// Each context owns its own price, candles, indicators, trade cooldown and
+// strategy instance (see set_symbol_strategy).
+// Every export is safe to call from multiple threads; calls for different
+// contexts never contend, calls for the same context are serialised.
+// Idempotent; returns -1 for an empty/null symbol or a full table (the
+// budget's max_symbols, see init_engine).
+int32_t create_symbol_context(const char *symbol);
+
+// Override the trade cooldown of one symbol context; the _ms variant sets
+// sub-second cooldowns. Cooldowns run on the engine clock at ns resolution.
+// -4 (BAD_ARG) for a negative cooldown.
+int32_t set_symbol_cooldown(int32_t symbol_id, int seconds);
+int32_t set_symbol_cooldown_ms(int32_t symbol_id, int64_t ms);
+
+// Lock-free read of a symbol's last price and tick epoch
+int32_t get_last_quote(int32_t symbol_id, double *price, int64_t *epoch);
+
+// --- Risk policies ---
+// Every context carries the risk policy of its symbol class (V10, V75,
+// Boom300, Crash300 or generic), chosen from the name at creation.
+// execute_trade enforces its stake floor and losing-streak limit plus the
+// account-wide daily loss and stop-loss counts; without a "stake" it sizes
+// the trade from the policy's balance tiers.
+
+// Feed a settled contract's profit (negative = loss) into the risk counters
+int32_t record_trade_result(int32_t symbol_id, double profit);
+
+// Policy stake for `balance` on this symbol
+int32_t get_recommended_stake(int32_t symbol_id, double balance,
+                              double *stake);
+// Policy stake for `balance` on a symbol by name, without creating its
+// context (the symbol need not have one)
+int32_t get_policy_stake(const char *symbol, double balance, double *stake);
+
 // Process a tick (JSON in, JSON out)
 // Example tick: {"symbol":"R_100","quote":123.45}
+// The symbol must already have a context (create_symbol_context or
+// seed_history); otherwise {"symbol", "error": "Unknown symbol"}.
 const char *process_tick(const char *tick_json);
 
+// Process a tick (binary in, binary out). No allocation, no JSON.
+// Returns an EngineStatus, also stored in out->status.
+int32_t process_tick_bin(const EngineTick *tick, EngineTickResult *out);
+
+// Process a contiguous batch of ticks in one call (e.g. a NumPy structured
+// array passed zero-copy). out must hold n results; ticks are applied in
+// order, exactly as n process_tick_bin calls would be.
+// Returns the number of ticks processed with ENGINE_OK, or
+// ENGINE_ERR_NULL_ARG.
+int64_t process_ticks(const EngineTick *ticks, size_t n,
+                      EngineTickResult *out);
+
+// --- Candles ---
+// Fill `out` with a view of a symbol's closed candles for one timeframe.
+int32_t get_candles(int32_t symbol_id, int32_t timeframe,
+                    EngineCandleView *out);
+
+// Copy a symbol's closed candles for one timeframe into `out` (room for
+// `max`; the newest are kept), oldest first, under the context's lock.
+// Unlike a view, the copy stays consistent while another thread (the
+// native feed) closes or revises candles. `total_closed` (may be null)
+// receives the ring's total. Returns the number copied or an EngineStatus.
+int64_t copy_candles(int32_t symbol_id, int32_t timeframe, EngineCandle *out,
+                     size_t max, int64_t *total_closed);
+
+// Replace a symbol's closed candles for one timeframe with `candles`
+// (oldest first), e.g. history fetched from the API. Only the newest
+// `capacity` candles are kept; indicators are re-seeded from all of them.
+// The forming candle is left untouched.
+int32_t load_candles(int32_t symbol_id, int32_t timeframe,
+                     const EngineCandle *candles, size_t n);
+
+// Warm start in one call: create (or look up) the context for `symbol`
+// and seed one timeframe from closed history, oldest first, exactly as
+// load_candles does. Feed the still-forming bar through upsert_candle.
+// Returns the symbol_id, or an EngineStatus (< 0).
+int32_t seed_history(const char *symbol, int32_t timeframe,
+                     const EngineCandle *candles, size_t n);
+
+// Apply one streaming OHLC update (e.g. a Deriv "ohlc" message) in place.
+// A candle for the forming bucket overwrites it; a newer bucket closes the
+// forming candle into the ring and indicators and starts a new one; the
+// newest closed candle may be corrected (its indicators are re-folded in
+// O(1)). Returns 1 if a candle closed, 0 if updated in place, or an
+// EngineStatus (< 0; ENGINE_ERR_BAD_ARG for anything older).
+int32_t upsert_candle(int32_t symbol_id, int32_t timeframe,
+                      const EngineCandle *candle);
+
+// Drop all candles (closed and forming) and indicators for a symbol
+int32_t reset_candles(int32_t symbol_id);
+
+// --- Indicators ---
+// Candle indicators for one timeframe. load_candles re-seeds them from the
+// loaded history, so warm-up costs one pass instead of a stream of ticks.
+int32_t get_indicators(int32_t symbol_id, int32_t timeframe,
+                       EngineIndicators *out);
+
+// The same indicators folded in on every tick (tick price as a bar)
+int32_t get_tick_indicators(int32_t symbol_id, EngineIndicators *out);
+
+// Swings, break of structure and fair value gaps of one timeframe, kept
+// current as its candles close (O(1); also seeded by load_candles)
+int32_t get_structure(int32_t symbol_id, int32_t timeframe,
+                      EngineStructure *out);
+
+// --- Correlation and regimes ---
+// Every symbol's 1m log returns are kept over the last 64 closed bars,
+// updated in O(1) per close (and seeded by load_candles), aligned by bar
+// across symbols. The trade checks read them for max_correlation and
+// max_volatility_ratio (see update_config).
+
+int32_t get_regime(int32_t symbol_id, EngineRegime *out);
+
+// Pearson correlation of two symbols' returns over the bars both have in
+// the window; *returns (may be null) receives how many. 0 with fewer than
+// 16 common returns.
+int32_t get_correlation(int32_t symbol_a, int32_t symbol_b, double *corr,
+                        int32_t *returns);
+
+// All symbols at once: {"symbols": [...], "correlation": [[...]] (row and
+// column order as "symbols"), "regimes": [{symbol, regime, volatility,
+// baseline, ratio, returns}], "min_returns": 16}. The diagonal is always
+// 1; a symbol whose regime holds fewer than min_returns returns has no
+// data, and its off-diagonal entries are 0.
+const char *get_correlations();
+
+// --- Bulk series kernels ---
+// Stateless kernels over contiguous arrays of n doubles (history windows,
+// backtest columns), vectorised with AVX2 or NEON when the CPU has it; see
+// series_kernels.hpp. Outputs hold n values and must not alias the inputs.
+// Rolling windows start partial (out[i] covers x[max(0, i-window+1)..i]).
+// Return ENGINE_ERR_BAD_ARG for a window or period < 1.
+
+// Instruction set in use: "avx2", "neon" or "scalar"
+const char *series_backend();
+
+// True range; out[0] = high[0] - low[0]
+int32_t series_true_range(const double *high, const double *low,
+                          const double *close, size_t n, double *out);
+int32_t series_rolling_min(const double *x, size_t n, int32_t window,
+                           double *out);
+int32_t series_rolling_max(const double *x, size_t n, int32_t window,
+                           double *out);
+
+// Rolling mean and population standard deviation; either output may be null
+int32_t series_rolling_mean_std(const double *x, size_t n, int32_t window,
+                                double *mean, double *stddev);
+
+// flags[i]: 1 if high[i] is the highest of high[i-k..i+k] (ties count),
+// 2 if low[i] is the lowest of low[i-k..i+k]; 0 for the first/last k bars
+int32_t series_swings(const double *high, const double *low, size_t n,
+                      int32_t k, uint8_t *flags);
+
+// Wilder ATR (zeros up to `period`) and an EMA seeded with x[0] (all zeros
+// if n < period), matching the Python strategies' array helpers
+int32_t series_atr(const double *high, const double *low, const double *close,
+                   size_t n, int32_t period, double *out);
+int32_t series_ema(const double *x, size_t n, int32_t period, double *out);
+
 // Unified trade execution + safety layer
 // Params JSON example:
-// {"symbol":"R_100","action":"BUY","stake":5.0,"active_trades":2,
-//  "symbol_available":true,"api_latency_ms":120.5,
-//  "rate_limit_warning":false,"api_error":""}
+// {"symbol":"R_100","action":"BUY","stake":5.0,"active_trades":2}
+// Without a stake, it is sized from the symbol's risk policy. A symbol
+// without a context is rejected (ENGINE_REJECT_UNKNOWN_SYMBOL).
 const char *execute_trade(const char *params_json);
 
+// Allocation-free variant of execute_trade: the same checks and cooldown
+// claim, with the outcome written to `out`. Returns out->reason, or an
+// EngineStatus (< 0) for a null argument. A request has no direction, so
+// max_correlation holds its size against any open exposure.
+int32_t execute_trade_bin(const EngineTradeRequest *req,
+                          EngineTradeDecision *out);
+
+// Check one signal on `symbol_id` against n accounts in one pass, writing
+// n decisions to `out`. The symbol's inputs and the config snapshot are
+// read once; each account is then sized and checked against its own
+// balance, margin, active trades and daily limits, exactly as
+// execute_trade_bin checks the engine's own account. The cooldown is
+// claimed once for the signal: if another caller claims it first, every
+// approval becomes ENGINE_REJECT_COOLDOWN. `direction` (1 = BUY, -1 =
+// SELL) is only reported in the decisions' events, one per account.
+// Returns the number approved, or an EngineStatus (< 0).
+int64_t execute_trade_accounts(int32_t symbol_id, int32_t direction,
+                               const EngineAccountTrade *accounts, size_t n,
+                               EngineTradeDecision *out);
+
+// Static text for an EngineTradeReason (never freed; "" if out of range)
+const char *trade_reason_string(int32_t reason);
+
+// Track an open position. Every tick of its symbol (process_tick*, the
+// native feed) then applies the trailing rule and checks the stop loss and
+// take profit; EngineTickResult.exit_updates counts positions with changes
+// waiting in poll_position_updates. Opening an open contract id replaces
+// its levels and re-arms its exits (e.g. after a failed sell).
+// ENGINE_ERR_BAD_ARG for a side other than 1 or -1, an unknown
+// trail rule, no entry price or a full book (the budget's max_positions
+// per symbol, see init_engine).
+int32_t open_position(const EnginePosition *pos);
+int32_t close_position(int32_t symbol_id, int64_t contract_id);
+// Current levels of an open position; ENGINE_ERR_BAD_ARG if not open
+int32_t get_position(int32_t symbol_id, int64_t contract_id,
+                     EnginePosition *out);
+// Drain up to `max` positions of the symbol whose exits changed; returns
+// the number written or an EngineStatus (< 0). A position that hit its stop
+// or target is reported once and stays open (unevaluated) until closed or
+// opened again.
+int64_t poll_position_updates(int32_t symbol_id, EnginePositionUpdate *out,
+                              size_t max);
+
+// Run the configured entry filter pipeline ("entry_filters" in the config)
+// over the request's timeframe, stopping at the first stage that fails.
+// Returns out->reason, or an EngineStatus (< 0): ENGINE_ERR_BAD_ARG for a
+// direction other than 1 or -1. Rejections are counted in get_metrics.
+int32_t filter_entry(const EngineFilterRequest *req, EngineFilterResult *out);
+
+// Static text for an EngineFilterReason (never freed; "" if out of range)
+const char *filter_reason_string(int32_t reason);
+
+// --- Strategies ---
+// Each symbol context runs its own strategy instance (EngineStrategyKind;
+// default from the symbol name, see create_symbol_context). Ticks keep it
+// current on every path; an evaluation reads the context's candles,
+// indicators and the entry filter pipeline without leaving native code.
+
+// Replace the symbol's strategy with a fresh instance of `kind` (its tick
+// window starts empty). ENGINE_ERR_BAD_ARG for an unknown kind.
+int32_t set_symbol_strategy(int32_t symbol_id, int32_t kind);
+
+// Tick -> indicators -> strategy -> risk decision in one call: applies the
+// tick exactly as process_tick_bin, evaluates the symbol's strategy at its
+// price into `signal`, and for an entry posts ENGINE_EVENT_STRATEGY_ENTRY
+// and runs the execute_trade_bin checks for that direction (stake from the
+// symbol's risk policy, `active_trades` open), claiming the cooldown if
+// approved. `decision` is written only when signal->direction != 0.
+// Returns an EngineStatus, also stored in out->status.
+int32_t process_tick_strategy(const EngineTick *tick, int32_t active_trades,
+                              EngineTickResult *out,
+                              EngineStrategySignal *signal,
+                              EngineTradeDecision *decision);
+
+// The symbol's last evaluation (reason ENGINE_STRATEGY_OFF with epoch 0
+// before the first)
+int32_t get_strategy_signal(int32_t symbol_id, EngineStrategySignal *out);
+
+// Static text for an EngineStrategyReason (never freed; "" if out of range)
+const char *strategy_reason_string(int32_t reason);
+
+// Drain up to `max` engine events, oldest first; returns the number
+// written. Signals, skipped entries and trade decisions are posted to a
+// bounded lock-free ring (4096 events) from whichever thread produced
+// them, without waiting on the consumer: when it is full, new events are
+// dropped and counted (get_metrics "events"). Calls are serialised, so
+// one consumer, e.g. the UI fan-out task, sees every event once.
+int64_t drain_events(EngineEvent *out, size_t max);
+
+// Replay history through a private copy of the live pipeline: the same
+// indicators and signal, risk policy, trade checks and cooldown, against a
+// simulated account and the replayed epochs instead of the wall clock.
+// Engine state (contexts, counters, config) is not modified.
+// `candles` are closed bars of params->timeframe; ticks feed every
+// timeframe as in process_tick (their symbol_id is ignored).
+int32_t backtest_run(const char *symbol, const EngineCandle *candles, size_t n,
+                     const EngineBacktestParams *params,
+                     EngineBacktestOutput *out);
+int32_t backtest_run_ticks(const char *symbol, const EngineTick *ticks,
+                           size_t n, const EngineBacktestParams *params,
+                           EngineBacktestOutput *out);
+
+// Run one backtest per parameter set in `grid` across `threads` workers
+// (0 = all cores) on a work-stealing pool, all reading the same candles,
+// and write the stats to `out` (n_params rows) best first by `rank_by`.
+// Every run sees the same live config snapshot.
+int32_t backtest_sweep(const char *symbol, const EngineCandle *candles,
+                       size_t n, const EngineBacktestParams *grid,
+                       size_t n_params, int32_t threads, int32_t rank_by,
+                       EngineSweepResult *out);
+
+// Same, over a file of raw EngineCandle records mapped read-only, so the
+// workers share the page cache's single copy of the data
+int32_t backtest_sweep_file(const char *symbol, const char *path,
+                            const EngineBacktestParams *grid, size_t n_params,
+                            int32_t threads, int32_t rank_by,
+                            EngineSweepResult *out);
+
+// --- History store ---
+// Columnar, append-only files per symbol under one root directory (see
+// column_store.hpp). Once opened, every context persists each tick and
+// each closed candle as it happens, plus the candles given to load_candles
+// except the newest (API history ends with the still-forming bar). Rows
+// not newer than the series' last stored epoch are skipped, so re-loading
+// the same history is harmless. Returns ENGINE_ERR_IO if the root or a
+// context's files cannot be created.
+int32_t store_open(const char *root_dir);
+
+// Stop persisting and unmap every writer
+void store_close();
+
+// Ask the OS to write dirty store pages back (rows are already visible to
+// readers and survive a process crash without this)
+int32_t store_flush();
+
+// Warm a context from the store instead of the API: the newest stored
+// candles of every timeframe are loaded as by load_candles (indicators
+// folded over up to 1000 bars), and the last stored ticks seed the tick
+// indicators and the last quote. Both seeds are journaled while a journal
+// records, so journal_replay reproduces a warm-started session. Returns
+// the number of candles loaded, or an EngineStatus (< 0).
+int64_t store_warm_start(int32_t symbol_id);
+
+// Copy stored rows with from_epoch <= epoch <= to_epoch (to_epoch <= 0:
+// no upper bound) into `out`, oldest first. Returns the number of rows in
+// the range, which may exceed `max` (pass max = 0 to size a buffer), or an
+// EngineStatus (< 0). Tick symbol_ids are set to -1.
+int64_t store_read_candles(const char *symbol, int32_t timeframe,
+                           int64_t from_epoch, int64_t to_epoch,
+                           EngineCandle *out, size_t max);
+int64_t store_read_ticks(const char *symbol, int64_t from_epoch,
+                         int64_t to_epoch, EngineTick *out, size_t max);
+
+// backtest_run / backtest_run_ticks reading straight from the store's
+// mapped columns, with no copy of the history. `series` is
+// ENGINE_SERIES_TICKS or params->timeframe.
+int32_t backtest_run_store(const char *symbol, int32_t series,
+                           int64_t from_epoch, int64_t to_epoch,
+                           const EngineBacktestParams *params,
+                           EngineBacktestOutput *out);
+
+// --- Journal ---
+// Record every engine input to `path` (see journal.hpp) until
+// journal_stop: ticks (from any path, the native feed included), candle
+// loads and updates, config and cooldown changes, account states and
+// results, positions and every trade request with the decision made. The
+// journal opens with a snapshot of the current state (config, bot state,
+// accounts and their day's results, symbols with their cooldowns, losing
+// streaks, candles and open positions), so recording can start at any
+// time; tick indicators and other derived state are rebuilt from the
+// candles instead, and may take a few bars to match. Costs one load per
+// input while off. Restarting replaces the running journal. Returns
+// ENGINE_ERR_IO if the file cannot be created.
+int32_t journal_start(const char *path);
+
+// Stop recording; returns the records written, or ENGINE_ERR_IO if a write
+// failed (0 when no journal was running)
+int64_t journal_stop();
+
+// Replay a journal through a private engine, as fast as it reads, with its
+// clock pinned to the recorded times: every input is applied in recorded
+// order and every trade decision is made again and compared with the one
+// recorded. The live engine is not touched. Inputs that raced on different
+// threads while recording are replayed in the order they were written.
+// Returns ENGINE_ERR_IO for a missing or foreign file.
+int32_t journal_replay(const char *path, EngineReplayStats *out);
+
+// --- Native market-data feed ---
+// Optional: compiled in with `make FEED=1` (links OpenSSL); otherwise
+// feed_start returns ENGINE_ERR_UNSUPPORTED. The feed owns the tick (and
+// OHLC) subscription socket at `url` (ws:// or wss://, e.g.
+// "wss://ws.derivws.com/websockets/v3?app_id=1089") for the
+// comma-separated `symbols`, and applies every tick to the engine as
+// process_tick_bin would, off the calling thread. ohlc_granularity (in
+// seconds, one of the EngineTimeframe periods) also subscribes to candles
+// of that timeframe, seeded from the subscription's history and then kept
+// current with upsert_candle; 0 subscribes to ticks only. Restarting
+// replaces a running feed. Reconnects with backoff until feed_stop.
+int32_t feed_start(const char *url, const char *symbols,
+                   int32_t ohlc_granularity);
+void feed_stop();
+
+// Drain up to `max` results of ticks the feed has applied, oldest first.
+// Returns the number written (0 when idle or no feed is running).
+int64_t feed_poll(EngineTickResult *out, size_t max);
+
+int32_t feed_stats(EngineFeedStats *out);
+
+// Last connection or API error text ("" if none)
+const char *feed_last_error();
+
 // Runtime controls
+// set_cooldown applies to every symbol context and is the default for new ones
 void set_cooldown(int seconds);
 void set_bot_state(bool state);
+// JSON: is_running, uptime_seconds, clock (the engine clock's source:
+// "cycles", the calibrated CPU counter, or "system"), config_version,
+// entry_filters
 const char *get_bot_state();
 
+// --- Metrics ---
+// Always-on hot-path instrumentation, cheap enough to poll every second.
+// JSON: uptime_seconds; counters ticks, unknown_symbol_ticks, parse_errors
+// (malformed process_tick / execute_trade JSON and feed frames) and
+// approved; "rejects" [{reason, text, count}] per EngineTradeReason seen;
+// "filters" {passed, rejects: [{reason, text, count}]} per
+// EngineFilterReason seen by filter_entry;
+// "events" {posted, dropped} of the event ring (see drain_events);
+// "memory" {budget (as in init_engine), arena_bytes reserved, arena_used,
+// symbols, accounts, symbol_bytes and account_bytes each context takes,
+// engine_bytes and event_ring_bytes of the fixed tables};
+// latency summaries {count, mean_us, p50_us, p99_us, p999_us, max_us} per
+// pipeline stage ("stages": parse, tick, decision and the native feed's
+// feed_wire, feed_queue, feed_tick_to_signal), per export ("exports":
+// process_tick, process_tick_bin, process_ticks, execute_trade,
+// execute_trade_bin, execute_trade_accounts, filter_entry,
+// process_tick_strategy) and per symbol
+// ("symbols": {name: {tick, decision}}).
+// "tick" runs from a tick's arrival at the engine to its signal (candles,
+// indicators and the context lock). Latencies come from a monotonic clock
+// and log-linear histograms (~3% resolution); counts since start or the
+// last reset_metrics.
+const char *get_metrics();
+void reset_metrics();
+
+// No-op, kept for ABI compatibility: returned strings are engine-owned
+void free_result(const char *ptr);
+
 } // extern "C"
 
 #endif // ENGINE_HPP
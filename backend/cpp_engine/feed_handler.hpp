@@ -0,0 +1,318 @@
+/**
+ * Native Deriv market-data feed.
+ *
+ * A network thread owns the WebSocket: it subscribes to ticks (and
+ * optionally OHLC candles) for a fixed set of symbols, parses each frame
+ * with the SAX extractor in feed_parser.hpp and pushes ticks and candle
+ * updates into one SPSC ring per symbol. An apply thread drains the rings
+ * into the engine (process_tick / upsert_candle) and queues every tick
+ * result on an SPSC results ring that Python drains in batches with
+ * feed_poll, so Python only sees finished signals and the event loop and
+ * GIL are off the tick-to-signal path.
+ *
+ * The candle history that answers an OHLC subscription seeds the engine
+ * directly from the network thread (seed_history); the connection is
+ * re-established with backoff whenever it drops.
+ *
+ * Every event carries the monotonic time its frame arrived, so the
+ * wire, queueing and tick-to-signal stages land in the engine's metrics.
+ *
+ * `Engine` provides create_symbol_context, process_tick(EngineTick,
+ * EngineTickResult, int64_t &clock_ns), upsert_candle, seed_history and
+ * an EngineMetrics member `metrics` (TradingEngine).
+ */
+
+#ifndef FEED_HANDLER_HPP
+#define FEED_HANDLER_HPP
+
+#include "engine.hpp"
+#include "feed_parser.hpp"
+#include "metrics.hpp"
+#include "spsc_ring.hpp"
+#include "ws_client.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Per-symbol backlog between the network and apply threads
+constexpr size_t FEED_LANE_CAPACITY = 4096;
+// Results waiting for feed_poll
+constexpr size_t FEED_RESULT_CAPACITY = 1 << 14;
+// Closed candles requested with an OHLC subscription
+constexpr int FEED_HISTORY_COUNT = 200;
+// Keep-alive ping when no frame arrived for this long
+constexpr int64_t FEED_PING_SECONDS = 30;
+
+struct FeedEvent {
+  int32_t symbol_id;
+  int32_t is_candle; // 0: tick (candle.epoch, candle.close), 1: OHLC update
+  EngineCandle candle;
+  int64_t received_ns; // steady_now_ns() when its frame was read
+};
+
+template <typename Engine> class FeedHandler {
+public:
+  // `timeframe` is the EngineTimeframe of the OHLC stream, -1 for ticks only
+  FeedHandler(Engine &engine, const std::string &url,
+              const std::vector<std::string> &symbols, int32_t timeframe,
+              int64_t granularity)
+      : engine(engine), url(url), timeframe(timeframe),
+        granularity(granularity), results(FEED_RESULT_CAPACITY) {
+    for (const std::string &s : symbols) {
+      std::unique_ptr<Lane> lane(new Lane());
+      lane->symbol = s;
+      lane->id = engine.create_symbol_context(s);
+      if (lane->id >= 0)
+        lanes.push_back(std::move(lane));
+    }
+  }
+
+  ~FeedHandler() { stop(); }
+
+  size_t symbols() const { return lanes.size(); }
+
+  void start() {
+    running = true;
+    apply_thread = std::thread([this] { apply_loop(); });
+    net_thread = std::thread([this] { network_loop(); });
+  }
+
+  void stop() {
+    if (!running.exchange(false))
+      return;
+    ws.interrupt();
+    if (net_thread.joinable())
+      net_thread.join();
+    if (apply_thread.joinable())
+      apply_thread.join();
+  }
+
+  // Move up to `max` queued tick results into `out`; any thread
+  size_t poll(EngineTickResult *out, size_t max) {
+    std::lock_guard<std::mutex> lock(poll_lock);
+    size_t n = 0;
+    while (n < max && results.pop(out[n]))
+      ++n;
+    return n;
+  }
+
+  void stats(EngineFeedStats &out) const {
+    out.frames = frames.load(std::memory_order_relaxed);
+    out.ticks = ticks.load(std::memory_order_relaxed);
+    out.candles = candles.load(std::memory_order_relaxed);
+    out.dropped = dropped.load(std::memory_order_relaxed);
+    out.results_dropped = results_dropped.load(std::memory_order_relaxed);
+    out.parse_errors = parse_errors.load(std::memory_order_relaxed);
+    out.api_errors = api_errors.load(std::memory_order_relaxed);
+    out.connects = connects.load(std::memory_order_relaxed);
+    out.connected = connected.load(std::memory_order_relaxed) ? 1 : 0;
+    out.symbols = static_cast<int32_t>(lanes.size());
+  }
+
+  std::string last_error() const {
+    std::lock_guard<std::mutex> lock(error_lock);
+    return error;
+  }
+
+private:
+  struct Lane {
+    std::string symbol;
+    int32_t id = -1;
+    SpscRing<FeedEvent> ring{FEED_LANE_CAPACITY};
+  };
+
+  Lane *find_lane(const char *symbol) {
+    for (auto &lane : lanes)
+      if (std::strcmp(lane->symbol.c_str(), symbol) == 0)
+        return lane.get();
+    return nullptr;
+  }
+
+  void set_error(const std::string &text) {
+    std::lock_guard<std::mutex> lock(error_lock);
+    error = text;
+  }
+
+  // Sleep in short steps so stop() is not held up by the backoff
+  void pause(int seconds) {
+    for (int i = 0; i < seconds * 10 && running; ++i)
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+
+  bool subscribe() {
+    char req[256];
+    for (auto &lane : lanes) {
+      std::snprintf(req, sizeof(req), "{\"ticks\":\"%s\",\"subscribe\":1}",
+                    lane->symbol.c_str());
+      if (!ws.send_text(req, std::strlen(req)))
+        return false;
+      if (timeframe < 0)
+        continue;
+      std::snprintf(req, sizeof(req),
+                    "{\"ticks_history\":\"%s\",\"style\":\"candles\","
+                    "\"granularity\":%lld,\"end\":\"latest\",\"count\":%d,"
+                    "\"subscribe\":1}",
+                    lane->symbol.c_str(), static_cast<long long>(granularity),
+                    FEED_HISTORY_COUNT);
+      if (!ws.send_text(req, std::strlen(req)))
+        return false;
+    }
+    return true;
+  }
+
+  void network_loop() {
+    int backoff = 1;
+    std::string frame;
+    FeedMessage msg;
+    while (running) {
+      std::string err;
+      if (!ws.connect(url, err)) {
+        set_error(err);
+        pause(backoff);
+        backoff = std::min(backoff * 2, 30);
+        continue;
+      }
+      if (!subscribe()) {
+        set_error("subscribe failed");
+        ws.close();
+        continue;
+      }
+      backoff = 1;
+      connects.fetch_add(1, std::memory_order_relaxed);
+      connected = true;
+
+      auto last_frame = std::chrono::steady_clock::now();
+      while (running) {
+        int rc = ws.read_message(frame, 1000);
+        if (rc < 0)
+          break;
+        auto now = std::chrono::steady_clock::now();
+        if (rc == 0) {
+          if (now - last_frame >= std::chrono::seconds(FEED_PING_SECONDS)) {
+            ws.send_text("{\"ping\":1}");
+            last_frame = now;
+          }
+          continue;
+        }
+        last_frame = now;
+        int64_t received = steady_now_ns();
+        frames.fetch_add(1, std::memory_order_relaxed);
+        if (!parse_feed_message(frame.data(), frame.size(), msg)) {
+          parse_errors.fetch_add(1, std::memory_order_relaxed);
+          engine.metrics.count(engine.metrics.parse_errors);
+          continue;
+        }
+        engine.metrics.stages[STAGE_FEED_WIRE].record(steady_now_ns() -
+                                                      received);
+        dispatch(msg, received);
+      }
+      connected = false;
+      ws.close();
+      if (running)
+        set_error("connection lost");
+    }
+  }
+
+  void dispatch(const FeedMessage &msg, int64_t received) {
+    switch (msg.kind) {
+    case FeedKind::TICK:
+      enqueue(msg.symbol, 0,
+              {msg.epoch, msg.quote, msg.quote, msg.quote, msg.quote, 1.0},
+              received);
+      break;
+    case FeedKind::OHLC:
+      if (timeframe >= 0 && msg.granularity == granularity)
+        enqueue(msg.symbol, 1, msg.candle, received);
+      break;
+    case FeedKind::CANDLES:
+      // Closed history seeds the timeframe; the last bar is still forming
+      if (timeframe >= 0 && !msg.history.empty() && find_lane(msg.symbol)) {
+        engine.seed_history(msg.symbol, timeframe, msg.history.data(),
+                            msg.history.size() - 1);
+        enqueue(msg.symbol, 1, msg.history.back(), received);
+      }
+      break;
+    case FeedKind::ERROR:
+      api_errors.fetch_add(1, std::memory_order_relaxed);
+      set_error(msg.error);
+      break;
+    default:
+      break;
+    }
+  }
+
+  void enqueue(const char *symbol, int32_t is_candle, const EngineCandle &c,
+               int64_t received) {
+    Lane *lane = find_lane(symbol);
+    if (!lane)
+      return;
+    if (!lane->ring.push({lane->id, is_candle, c, received}))
+      dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void apply_loop() {
+    int idle = 0;
+    FeedEvent ev;
+    EngineTickResult res;
+    while (running) {
+      bool busy = false;
+      for (auto &lane : lanes) {
+        // Bounded burst per symbol so one busy stream cannot starve others
+        for (int burst = 0; burst < 64 && lane->ring.pop(ev); ++burst) {
+          busy = true;
+          apply(ev, res);
+        }
+      }
+      if (busy) {
+        idle = 0;
+      } else if (++idle < 64) {
+        std::this_thread::yield();
+      } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+      }
+    }
+  }
+
+  void apply(const FeedEvent &ev, EngineTickResult &res) {
+    EngineMetrics &m = engine.metrics;
+    int64_t clock_ns = steady_now_ns();
+    m.stages[STAGE_FEED_QUEUE].record(clock_ns - ev.received_ns);
+    if (ev.is_candle) {
+      engine.upsert_candle(ev.symbol_id, timeframe, ev.candle);
+      candles.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    EngineTick tick{ev.symbol_id, 0, ev.candle.epoch, ev.candle.close};
+    engine.process_tick(tick, res, clock_ns); // leaves the completion time
+    m.stages[STAGE_FEED_TICK_TO_SIGNAL].record(clock_ns - ev.received_ns);
+    ticks.fetch_add(1, std::memory_order_relaxed);
+    if (!results.push(res))
+      results_dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  Engine &engine;
+  std::string url;
+  int32_t timeframe;
+  int64_t granularity;
+  std::vector<std::unique_ptr<Lane>> lanes;
+  SpscRing<EngineTickResult> results;
+  std::mutex poll_lock; // feed_poll may be called from several threads
+
+  WsClient ws;
+  std::thread net_thread, apply_thread;
+  std::atomic<bool> running{false};
+  std::atomic<bool> connected{false};
+
+  std::atomic<int64_t> frames{0}, ticks{0}, candles{0}, dropped{0},
+      results_dropped{0}, parse_errors{0}, api_errors{0}, connects{0};
+  mutable std::mutex error_lock;
+  std::string error;
+};
+
+#endif // FEED_HANDLER_HPP
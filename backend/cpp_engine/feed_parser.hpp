@@ -0,0 +1,257 @@
+/**
+ * SAX extraction of the Deriv market-data messages the feed handler uses.
+ *
+ * nlohmann's sax_parse walks a frame token by token; this handler keeps
+ * only the fields it needs (msg_type, the tick/ohlc payload, the history
+ * array of a candle subscription, its symbol from echo_req and the error
+ * text) in fixed members, so no DOM is built and nothing is allocated per
+ * tick beyond the lexer's token buffer. Everything else is skipped.
+ *
+ * Deriv sends tick quotes as numbers and OHLC prices as strings; both are
+ * accepted for every price field.
+ */
+
+#ifndef FEED_PARSER_HPP
+#define FEED_PARSER_HPP
+
+#include "engine.hpp"
+#include "json.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+enum class FeedKind { OTHER, TICK, OHLC, CANDLES, ERROR };
+
+struct FeedMessage {
+  FeedKind kind = FeedKind::OTHER;
+  char symbol[32] = {};
+  int64_t epoch = 0; // tick epoch, or the OHLC bucket open time
+  double quote = 0.0;
+  int64_t granularity = 0;
+  EngineCandle candle{};              // OHLC update
+  std::vector<EngineCandle> history; // "candles" response, oldest first
+  std::string error;
+};
+
+class FeedSax {
+public:
+  using json = nlohmann::json;
+  using number_integer_t = json::number_integer_t;
+  using number_unsigned_t = json::number_unsigned_t;
+  using number_float_t = json::number_float_t;
+  using string_t = json::string_t;
+  using binary_t = json::binary_t;
+
+  explicit FeedSax(FeedMessage &msg) : msg(msg) {
+    msg.kind = FeedKind::OTHER;
+    msg.symbol[0] = '\0';
+    msg.epoch = 0;
+    msg.quote = 0.0;
+    msg.granularity = 0;
+    msg.candle = EngineCandle{};
+    msg.history.clear();
+    msg.error.clear();
+  }
+
+  bool null() { return true; }
+  bool boolean(bool) { return true; }
+  bool number_integer(number_integer_t v) { return number(double(v), v); }
+  bool number_unsigned(number_unsigned_t v) {
+    return number(double(v), int64_t(v));
+  }
+  bool number_float(number_float_t v, const string_t &) {
+    return number(v, int64_t(v));
+  }
+  bool binary(binary_t &) { return true; }
+
+  bool string(string_t &s) {
+    if (depth == 1 && field == Field::MSG_TYPE) {
+      msg_type = s == "tick"      ? FeedKind::TICK
+                 : s == "ohlc"    ? FeedKind::OHLC
+                 : s == "candles" ? FeedKind::CANDLES
+                                  : FeedKind::OTHER;
+      return true;
+    }
+    if (field == Field::SYMBOL && in_payload() &&
+        (section != Section::ECHO || msg.symbol[0] == '\0')) {
+      size_t n = std::min(s.size(), sizeof(msg.symbol) - 1);
+      std::memcpy(msg.symbol, s.data(), n);
+      msg.symbol[n] = '\0';
+      return true;
+    }
+    if (section == Section::ERROR && depth == 2 && field == Field::MESSAGE) {
+      msg.error = s;
+      return true;
+    }
+    // OHLC prices arrive as strings
+    if (is_price(field) && in_payload())
+      return number(std::strtod(s.c_str(), nullptr), 0);
+    return true;
+  }
+
+  bool start_object(std::size_t) {
+    ++depth;
+    if (depth == 2)
+      section = pending;
+    if (section == Section::CANDLES && depth == 3)
+      msg.history.push_back(EngineCandle{});
+    field = Field::NONE;
+    return true;
+  }
+
+  bool end_object() {
+    if (depth == 2)
+      section = Section::NONE;
+    --depth;
+    field = Field::NONE;
+    if (depth == 0)
+      finish();
+    return true;
+  }
+
+  bool start_array(std::size_t) {
+    ++depth;
+    if (depth == 2)
+      section = pending;
+    return true;
+  }
+
+  bool end_array() {
+    if (depth == 2)
+      section = Section::NONE;
+    --depth;
+    field = Field::NONE;
+    return true;
+  }
+
+  bool key(string_t &k) {
+    if (depth == 1) {
+      pending = k == "tick"       ? Section::TICK
+                : k == "ohlc"     ? Section::OHLC
+                : k == "candles"  ? Section::CANDLES
+                : k == "error"    ? Section::ERROR
+                : k == "echo_req" ? Section::ECHO
+                                  : Section::NONE;
+      field = k == "msg_type" ? Field::MSG_TYPE : Field::NONE;
+      return true;
+    }
+    if (section == Section::ECHO) {
+      // A candle history response names its symbol only in the echo
+      field = k == "ticks_history" ? Field::SYMBOL
+              : k == "granularity" ? Field::GRANULARITY
+                                   : Field::NONE;
+      return true;
+    }
+    field = k == "symbol"        ? Field::SYMBOL
+            : k == "quote"       ? Field::QUOTE
+            : k == "epoch"       ? Field::EPOCH
+            : k == "open_time"   ? Field::OPEN_TIME
+            : k == "open"        ? Field::OPEN
+            : k == "high"        ? Field::HIGH
+            : k == "low"         ? Field::LOW
+            : k == "close"       ? Field::CLOSE
+            : k == "granularity" ? Field::GRANULARITY
+            : k == "message"     ? Field::MESSAGE
+                                 : Field::NONE;
+    return true;
+  }
+
+  bool parse_error(std::size_t, const std::string &,
+                   const nlohmann::detail::exception &) {
+    return false;
+  }
+
+private:
+  enum class Section { NONE, TICK, OHLC, CANDLES, ERROR, ECHO };
+  enum class Field {
+    NONE,
+    MSG_TYPE,
+    SYMBOL,
+    QUOTE,
+    EPOCH,
+    OPEN_TIME,
+    OPEN,
+    HIGH,
+    LOW,
+    CLOSE,
+    GRANULARITY,
+    MESSAGE
+  };
+
+  static bool is_price(Field f) {
+    return f == Field::QUOTE || f == Field::OPEN || f == Field::HIGH ||
+           f == Field::LOW || f == Field::CLOSE;
+  }
+
+  // Inside tick/ohlc/echo_req, or inside one element of the candles array
+  bool in_payload() const {
+    return ((section == Section::TICK || section == Section::OHLC ||
+             section == Section::ECHO) &&
+            depth == 2) ||
+           (section == Section::CANDLES && depth == 3);
+  }
+
+  bool number(double v, int64_t i) {
+    if (!in_payload())
+      return true;
+    EngineCandle &c = section == Section::CANDLES ? msg.history.back()
+                                                  : msg.candle;
+    switch (field) {
+    case Field::QUOTE:
+      msg.quote = v;
+      break;
+    case Field::EPOCH:
+      if (section == Section::CANDLES)
+        c.epoch = i;
+      else
+        msg.epoch = i;
+      break;
+    case Field::OPEN_TIME:
+      c.epoch = i;
+      break;
+    case Field::OPEN:
+      c.open = v;
+      break;
+    case Field::HIGH:
+      c.high = v;
+      break;
+    case Field::LOW:
+      c.low = v;
+      break;
+    case Field::CLOSE:
+      c.close = v;
+      break;
+    case Field::GRANULARITY:
+      msg.granularity = i;
+      break;
+    default:
+      break;
+    }
+    return true;
+  }
+
+  void finish() {
+    if (!msg.error.empty())
+      msg.kind = FeedKind::ERROR;
+    else
+      msg.kind = msg_type;
+  }
+
+  FeedMessage &msg;
+  int depth = 0;
+  Section pending = Section::NONE;
+  Section section = Section::NONE;
+  Field field = Field::NONE;
+  FeedKind msg_type = FeedKind::OTHER;
+};
+
+// Parse one frame into `msg`; false if it is not valid JSON
+inline bool parse_feed_message(const char *data, size_t len,
+                               FeedMessage &msg) {
+  FeedSax sax(msg);
+  return nlohmann::json::sax_parse(data, data + len, &sax);
+}
+
+#endif // FEED_PARSER_HPP
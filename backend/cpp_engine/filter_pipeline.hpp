@@ -0,0 +1,217 @@
+/**
+ * Entry filter pipeline: the pre-entry checks a strategy runs on a signal
+ * before asking for a trade.
+ *
+ * A pipeline is an ordered list of up to MAX_FILTER_STAGES predicate
+ * stages over one timeframe of a symbol: its last closed candle, its
+ * indicators and its market structure. It is built once from the config
+ * ("entry_filters", see update_config in engine.hpp) and stored in the
+ * EngineConfig snapshot, so evaluating it is a walk over a fixed array
+ * with no parsing, allocation or Python. The first stage that fails ends
+ * the walk, and its kind is the EngineFilterReason the entry is rejected
+ * with.
+ *
+ * The default pipeline is the scalping filter the strategies used to run
+ * in Python (UltraFastEntryFilter), with the same thresholds and order.
+ */
+
+#ifndef FILTER_PIPELINE_HPP
+#define FILTER_PIPELINE_HPP
+
+#include "engine.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+constexpr int MAX_FILTER_STAGES = 16;
+
+// Config name of each stage kind, indexed by EngineFilterReason (null for
+// the codes that are outcomes rather than stages)
+static const char *const FILTER_STAGE_NAMES[ENGINE_FILTER_REASON_COUNT] = {
+    nullptr,           nullptr,           nullptr,
+    "min_body",        "max_body",        "min_spread",
+    "candle_direction", "rsi_momentum",   "max_opposite_wick",
+    "rsi_band",        "ema_trend",       "min_adx",
+    "structure_trend", "min_signal",
+};
+
+static const char *const FILTER_REASON_TEXT[ENGINE_FILTER_REASON_COUNT] = {
+    "All entry filter checks passed",
+    "No closed candle",
+    "Invalid candle range (zero or negative)",
+    "Indecision candle: body too small",
+    "Overextended candle: body too large",
+    "Low spread",
+    "Candle closed against the direction",
+    "RSI momentum against the direction",
+    "Opposite wick too large",
+    "RSI outside the entry band",
+    "EMA trend against the direction",
+    "ADX below minimum",
+    "Market structure against the direction",
+    "Signal too weak",
+};
+
+inline const char *filter_reason_text(int32_t reason) {
+  if (reason < 0 || reason >= ENGINE_FILTER_REASON_COUNT)
+    return "";
+  return FILTER_REASON_TEXT[reason];
+}
+
+struct FilterStage {
+  int32_t kind; // the EngineFilterReason it rejects with
+  double limit; // threshold; see EngineFilterReason for its unit
+};
+
+struct FilterPipeline {
+  FilterStage stages[MAX_FILTER_STAGES] = {};
+  int32_t count = 0;
+
+  void add(int32_t kind, double limit = 0.0) {
+    if (count == MAX_FILTER_STAGES)
+      throw std::length_error("too many entry filter stages");
+    stages[count++] = {kind, limit};
+  }
+
+  // Whether any stage reads the given inputs, so callers only gather what
+  // the configured stages use
+  bool reads_indicators() const {
+    return has(ENGINE_FILTER_RSI_BAND) || has(ENGINE_FILTER_EMA_TREND) ||
+           has(ENGINE_FILTER_ADX_TOO_LOW);
+  }
+  bool reads_structure() const { return has(ENGINE_FILTER_STRUCTURE_AGAINST); }
+  bool reads_signal() const { return has(ENGINE_FILTER_WEAK_SIGNAL); }
+
+  bool has(int32_t kind) const {
+    for (int i = 0; i < count; ++i)
+      if (stages[i].kind == kind)
+        return true;
+    return false;
+  }
+};
+
+// UltraFastEntryFilter's rules 1-5
+inline FilterPipeline default_entry_filters() {
+  FilterPipeline p;
+  p.add(ENGINE_FILTER_BODY_TOO_SMALL, 0.15);
+  p.add(ENGINE_FILTER_BODY_TOO_LARGE, 0.85);
+  p.add(ENGINE_FILTER_LOW_SPREAD, 0.20);
+  p.add(ENGINE_FILTER_CANDLE_DIRECTION);
+  p.add(ENGINE_FILTER_RSI_MOMENTUM);
+  p.add(ENGINE_FILTER_OPPOSITE_WICK, 2.0);
+  return p;
+}
+
+// Stage kind for a config name; throws std::invalid_argument if unknown
+inline int32_t filter_stage_kind(const std::string &name) {
+  for (int32_t k = 0; k < ENGINE_FILTER_REASON_COUNT; ++k)
+    if (FILTER_STAGE_NAMES[k] && name == FILTER_STAGE_NAMES[k])
+      return k;
+  throw std::invalid_argument("unknown entry filter stage: " + name);
+}
+
+// What one evaluation reads, gathered by the caller (under the symbol's
+// state lock) before the pipeline runs
+struct FilterInputs {
+  int32_t direction;    // 1 = BUY, -1 = SELL
+  int32_t rsi_momentum; // 1 rising, -1 falling, 0 unknown
+  bool has_candle;
+  EngineCandle candle; // last closed candle of the timeframe
+  EngineIndicators indicators; // if reads_indicators()
+  EngineStructure structure;   // if reads_structure()
+  double signal;               // if reads_signal()
+};
+
+inline int32_t set_filter(EngineFilterResult &out, int32_t reason,
+                          int32_t stage, double value = 0.0,
+                          double limit = 0.0) {
+  out.reason = reason;
+  out.stage = stage;
+  out.value = value;
+  out.limit = limit;
+  return reason;
+}
+
+// Run the stages in order and stop at the first that fails. Indicator
+// stages pass while their indicator is still warming up.
+inline int32_t run_filters(const FilterPipeline &p, const FilterInputs &in,
+                           EngineFilterResult &out) {
+  const EngineCandle &c = in.candle;
+  const EngineIndicators &ind = in.indicators;
+  bool buy = in.direction > 0;
+  double range = c.high - c.low;
+  double body = std::fabs(c.close - c.open);
+
+  for (int32_t i = 0; i < p.count; ++i) {
+    const FilterStage &s = p.stages[i];
+    if (s.kind <= ENGINE_FILTER_OPPOSITE_WICK) { // candle stages
+      if (!in.has_candle)
+        return set_filter(out, ENGINE_FILTER_NO_CANDLE, i);
+      if (range <= 0.0)
+        return set_filter(out, ENGINE_FILTER_FLAT_CANDLE, i, range);
+    }
+
+    switch (s.kind) {
+    case ENGINE_FILTER_BODY_TOO_SMALL:
+    case ENGINE_FILTER_LOW_SPREAD: // |close - open| too, as in Python
+      if (body / range < s.limit)
+        return set_filter(out, s.kind, i, body / range, s.limit);
+      break;
+    case ENGINE_FILTER_BODY_TOO_LARGE:
+      if (body / range > s.limit)
+        return set_filter(out, s.kind, i, body / range, s.limit);
+      break;
+    case ENGINE_FILTER_CANDLE_DIRECTION:
+      if (buy ? c.close <= c.open : c.close >= c.open)
+        return set_filter(out, s.kind, i, c.close - c.open);
+      break;
+    case ENGINE_FILTER_RSI_MOMENTUM:
+      if (in.rsi_momentum != 0 && in.rsi_momentum != in.direction)
+        return set_filter(out, s.kind, i, in.rsi_momentum, in.direction);
+      break;
+    case ENGINE_FILTER_OPPOSITE_WICK: {
+      double wick = buy ? std::min(c.open, c.close) - c.low
+                        : c.high - std::max(c.open, c.close);
+      if (body > 0.0 && wick > s.limit * body)
+        return set_filter(out, s.kind, i, wick / body, s.limit);
+      break;
+    }
+    case ENGINE_FILTER_RSI_BAND: {
+      double bound = buy ? s.limit : 100.0 - s.limit;
+      if ((ind.ready & ENGINE_IND_RSI) &&
+          (buy ? ind.rsi_live >= bound : ind.rsi_live <= bound))
+        return set_filter(out, s.kind, i, ind.rsi_live, bound);
+      break;
+    }
+    case ENGINE_FILTER_EMA_TREND: {
+      double spread = ind.ema_fast - ind.ema_slow;
+      int32_t both = ENGINE_IND_EMA_FAST | ENGINE_IND_EMA_SLOW;
+      if ((ind.ready & both) == both &&
+          (buy ? spread <= 0.0 : spread >= 0.0))
+        return set_filter(out, s.kind, i, spread);
+      break;
+    }
+    case ENGINE_FILTER_ADX_TOO_LOW:
+      if ((ind.ready & ENGINE_IND_ADX) && ind.adx < s.limit)
+        return set_filter(out, s.kind, i, ind.adx, s.limit);
+      break;
+    case ENGINE_FILTER_STRUCTURE_AGAINST:
+      if (in.structure.trend == -in.direction)
+        return set_filter(out, s.kind, i, in.structure.trend);
+      break;
+    case ENGINE_FILTER_WEAK_SIGNAL: {
+      double bound = buy ? s.limit : 1.0 - s.limit;
+      if (buy ? in.signal < bound : in.signal > bound)
+        return set_filter(out, s.kind, i, in.signal, bound);
+      break;
+    }
+    default:
+      break;
+    }
+  }
+  return set_filter(out, ENGINE_FILTER_PASSED, -1);
+}
+
+#endif // FILTER_PIPELINE_HPP
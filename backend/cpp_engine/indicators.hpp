@@ -0,0 +1,314 @@
+/**
+ * Streaming technical indicators.
+ *
+ * Each kernel keeps only its recurrence state, so folding in a new bar is
+ * O(1) and reading the current value is O(1). Warm-up matches the Python
+ * implementations they replace (MasterEngine._ema/_rsi/_atr and
+ * IndicatorLayer._calculate_macd/_calculate_adx): EMAs start from the first
+ * value, Wilder averages start from the simple mean of the first `period`
+ * samples.
+ *
+ * RSI follows IndicatorLayer._wilder_rsi: 50 while warming up or over a
+ * flat window, 100 over a window without losses. MasterEngine._rsi used
+ * to read 0 on both (an uptrend looked oversold); it now uses the same
+ * convention.
+ */
+
+#ifndef INDICATORS_HPP
+#define INDICATORS_HPP
+
+#include "engine.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+class Ema {
+public:
+  explicit Ema(int period = 20) : alpha(2.0 / (period + 1)), period(period) {}
+
+  void reset() {
+    value_ = 0.0;
+    prev_ = 0.0;
+    count = 0;
+  }
+
+  void update(double x) {
+    prev_ = value_;
+    value_ = count == 0 ? x : alpha * x + (1.0 - alpha) * value_;
+    ++count;
+    if (count == 1)
+      prev_ = value_;
+  }
+
+  // Value if x were the next sample, without committing it
+  double peek(double x) const {
+    return count == 0 ? x : alpha * x + (1.0 - alpha) * value_;
+  }
+
+  double value() const { return value_; }
+  double previous() const { return prev_; }
+  bool ready() const { return count >= period; }
+
+private:
+  double alpha;
+  int period;
+  double value_ = 0.0;
+  double prev_ = 0.0;
+  int64_t count = 0;
+};
+
+// Wilder's moving average (RMA), seeded with the SMA of the first samples
+class WilderAverage {
+public:
+  explicit WilderAverage(int period = 14) : period(period) {}
+
+  void reset() {
+    value_ = 0.0;
+    sum = 0.0;
+    count = 0;
+  }
+
+  void update(double x) {
+    if (count < period) {
+      sum += x;
+      ++count;
+      if (count == period)
+        value_ = sum / period;
+      return;
+    }
+    value_ = (value_ * (period - 1) + x) / period;
+    ++count;
+  }
+
+  double peek(double x) const {
+    if (count < period)
+      return count + 1 == period ? (sum + x) / period : 0.0;
+    return (value_ * (period - 1) + x) / period;
+  }
+
+  double value() const { return value_; }
+  bool ready() const { return count >= period; }
+
+private:
+  int period;
+  double value_ = 0.0;
+  double sum = 0.0;
+  int64_t count = 0;
+};
+
+class Rsi {
+public:
+  explicit Rsi(int period = 14) : gain(period), loss(period) {}
+
+  void reset() {
+    gain.reset();
+    loss.reset();
+    has_prev = false;
+  }
+
+  void update(double close) {
+    if (has_prev) {
+      double d = close - prev_close;
+      gain.update(d > 0 ? d : 0.0);
+      loss.update(d < 0 ? -d : 0.0);
+    }
+    prev_close = close;
+    has_prev = true;
+  }
+
+  double value() const {
+    return ready() ? from_averages(gain.value(), loss.value()) : 50.0;
+  }
+
+  // RSI with `close` as a hypothetical next bar (e.g. the live price)
+  double peek(double close) const {
+    if (!has_prev)
+      return 50.0;
+    double d = close - prev_close;
+    double g = gain.peek(d > 0 ? d : 0.0);
+    double l = loss.peek(d < 0 ? -d : 0.0);
+    if (!gain.ready() && g == 0.0 && l == 0.0)
+      return 50.0;
+    return from_averages(g, l);
+  }
+
+  bool ready() const { return gain.ready(); }
+
+private:
+  static double from_averages(double g, double l) {
+    if (l == 0.0)
+      return g > 0.0 ? 100.0 : 50.0;
+    return 100.0 - 100.0 / (1.0 + g / l);
+  }
+
+  WilderAverage gain, loss;
+  double prev_close = 0.0;
+  bool has_prev = false;
+};
+
+// ATR and ADX/DMI share the true-range and directional-movement inputs
+class Dmi {
+public:
+  explicit Dmi(int period = 14)
+      : tr(period), plus_dm(period), minus_dm(period), adx_(period) {}
+
+  void reset() {
+    tr.reset();
+    plus_dm.reset();
+    minus_dm.reset();
+    adx_.reset();
+    has_prev = false;
+  }
+
+  void update(double high, double low, double close) {
+    if (has_prev) {
+      double range =
+          std::max(high - low, std::max(std::fabs(high - prev_close),
+                                        std::fabs(low - prev_close)));
+      double up = high - prev_high;
+      double down = prev_low - low;
+      tr.update(range);
+      plus_dm.update(up > down && up > 0 ? up : 0.0);
+      minus_dm.update(down > up && down > 0 ? down : 0.0);
+      if (tr.ready())
+        adx_.update(dx());
+    }
+    prev_high = high;
+    prev_low = low;
+    prev_close = close;
+    has_prev = true;
+  }
+
+  double atr() const { return tr.value(); }
+  double plus_di() const {
+    return 100.0 * plus_dm.value() / (tr.value() + 1e-10);
+  }
+  double minus_di() const {
+    return 100.0 * minus_dm.value() / (tr.value() + 1e-10);
+  }
+  double adx() const { return adx_.value(); }
+
+  bool atr_ready() const { return tr.ready(); }
+  bool adx_ready() const { return adx_.ready(); }
+
+private:
+  double dx() const {
+    double p = plus_di(), m = minus_di();
+    return 100.0 * std::fabs(p - m) / (p + m + 1e-10);
+  }
+
+  WilderAverage tr, plus_dm, minus_dm, adx_;
+  double prev_high = 0.0, prev_low = 0.0, prev_close = 0.0;
+  bool has_prev = false;
+};
+
+class Macd {
+public:
+  Macd(int fast_period = 12, int slow_period = 26, int signal_period = 9)
+      : fast(fast_period), slow(slow_period), signal(signal_period),
+        warmup(slow_period + signal_period) {}
+
+  void reset() {
+    fast.reset();
+    slow.reset();
+    signal.reset();
+    count = 0;
+  }
+
+  void update(double close) {
+    fast.update(close);
+    slow.update(close);
+    signal.update(fast.value() - slow.value());
+    ++count;
+  }
+
+  double line() const { return fast.value() - slow.value(); }
+  double signal_line() const { return signal.value(); }
+  double histogram() const { return line() - signal_line(); }
+  bool ready() const { return count >= warmup; }
+
+private:
+  Ema fast, slow, signal;
+  int64_t warmup;
+  int64_t count = 0;
+};
+
+// The indicator set kept per symbol and timeframe
+class IndicatorSet {
+public:
+  IndicatorSet() : ema_fast(20), ema_slow(50) {}
+
+  void reset() {
+    rsi.reset();
+    ema_fast.reset();
+    ema_slow.reset();
+    dmi.reset();
+    macd.reset();
+    samples = 0;
+  }
+
+  void update(double high, double low, double close) {
+    rsi.update(close);
+    ema_fast.update(close);
+    ema_slow.update(close);
+    dmi.update(high, low, close);
+    macd.update(close);
+    last_close = close;
+    ++samples;
+  }
+
+  void update(const EngineCandle &c) { update(c.high, c.low, c.close); }
+
+  // Snapshot for the C ABI; `live_price` feeds rsi_live (0 = last close)
+  void snapshot(double live_price, EngineIndicators &out) const {
+    out.rsi = rsi.value();
+    out.rsi_live = rsi.peek(live_price != 0.0 ? live_price : last_close);
+    out.ema_fast = ema_fast.value();
+    out.ema_fast_prev = ema_fast.previous();
+    out.ema_slow = ema_slow.value();
+    out.atr = dmi.atr();
+    out.adx = dmi.adx();
+    out.plus_di = dmi.plus_di();
+    out.minus_di = dmi.minus_di();
+    out.macd = macd.line();
+    out.macd_signal = macd.signal_line();
+    out.macd_hist = macd.histogram();
+    out.samples = samples;
+    out.ready = (rsi.ready() ? ENGINE_IND_RSI : 0) |
+                (ema_fast.ready() ? ENGINE_IND_EMA_FAST : 0) |
+                (ema_slow.ready() ? ENGINE_IND_EMA_SLOW : 0) |
+                (dmi.atr_ready() ? ENGINE_IND_ATR : 0) |
+                (dmi.adx_ready() ? ENGINE_IND_ADX : 0) |
+                (macd.ready() ? ENGINE_IND_MACD : 0);
+    out.reserved = 0;
+  }
+
+  // Directional bias in [0, 1]: 0.5 is neutral, above favours BUY.
+  // Blends MACD histogram (in ATR units, weighted by ADX trend strength)
+  // with RSI momentum around 50 evaluated at the live price.
+  double signal(double live_price) const {
+    if (!rsi.ready() || !macd.ready() || !dmi.atr_ready() || dmi.atr() <= 0.0)
+      return 0.5;
+    double trend = std::clamp(macd.histogram() / dmi.atr(), -1.0, 1.0);
+    if (dmi.adx_ready())
+      trend *= std::min(dmi.adx() / 25.0, 1.0);
+    double momentum = (rsi.peek(live_price) - 50.0) / 50.0;
+    double score = 0.6 * trend + 0.4 * momentum;
+    return std::clamp(0.5 + 0.5 * score, 0.0, 1.0);
+  }
+
+  // RSI with the live price as the next close
+  double rsi_live(double live_price) const { return rsi.peek(live_price); }
+
+  bool empty() const { return samples == 0; }
+
+private:
+  Rsi rsi;
+  Ema ema_fast, ema_slow;
+  Dmi dmi;
+  Macd macd;
+  double last_close = 0.0;
+  int64_t samples = 0;
+};
+
+#endif // INDICATORS_HPP
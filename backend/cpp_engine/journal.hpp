@@ -0,0 +1,255 @@
+/**
+ * Binary journal of the engine's inputs, for deterministic replay.
+ *
+ * While recording (journal_start), every input that can change a trade
+ * decision or a signal is appended as one record: ticks, candle loads and
+ * updates, config reloads, account and risk updates, position changes and
+ * the trade requests themselves together with the decision that was made.
+ * Each record carries the engine clock (clock.hpp) as it was read for that
+ * input, so a replay pinned to the recorded times re-makes every decision,
+ * cooldowns and daily limits included.
+ *
+ * Layout: an 8-byte magic, then records of a JournalHeader followed by
+ * `size` payload bytes, in the order they were written. A journal begins
+ * with a snapshot of the engine's state at the time recording started.
+ * Payloads are the engine's own structs in native byte order, so a journal
+ * is read back by the same build on the same platform.
+ */
+
+#ifndef JOURNAL_HPP
+#define JOURNAL_HPP
+
+#include "clock.hpp"
+#include "config.hpp"
+#include "engine.hpp"
+#include "mapped_file.hpp"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+
+constexpr char JOURNAL_MAGIC[8] = {'E', 'N', 'G', 'J', 'R', 'N', 'L', '2'};
+
+// Buffer of the journal file; records reach the OS when it fills or on stop
+constexpr size_t JOURNAL_BUFFER_BYTES = 1 << 20;
+
+// What a record holds (payload in brackets)
+enum JournalRecordType : uint32_t {
+  JOURNAL_INIT = 1,            // init_engine [JournalIdValue, config JSON]
+  JOURNAL_CONFIG = 2,          // update_config [JournalIdValue, config JSON]
+  JOURNAL_COOLDOWN = 3,        // set_cooldown [JournalIdNs, id unused]
+  JOURNAL_BOT_STATE = 4,       // set_bot_state [JournalIdValue, id unused]
+  JOURNAL_ACCOUNT_CREATE = 5,  // [JournalIdValue id, name]
+  JOURNAL_ACCOUNT_STATE = 6,   // [JournalAccountState], id -1 = own account
+  JOURNAL_ACCOUNT_RESULT = 7,  // record_account_result [JournalIdAmount]
+  JOURNAL_LEDGER = 8,          // snapshot of a day's results [JournalLedger]
+  JOURNAL_SYMBOL_CREATE = 9,   // [JournalIdValue id, name]
+  JOURNAL_SYMBOL_COOLDOWN = 10, // set_symbol_cooldown [JournalIdNs]
+  JOURNAL_SYMBOL_RISK = 11,    // streak, cooldown slot [JournalSymbolRisk]
+  JOURNAL_TRADE_RESULT = 12,   // record_trade_result [JournalIdAmount]
+  JOURNAL_TICK = 13,           // a tick with an epoch [EngineTick]
+  JOURNAL_QUOTE = 14,          // a price without an epoch [EngineTick]
+  JOURNAL_CANDLES_LOAD = 15,   // [JournalIdValue id/tf, EngineCandle...]
+  JOURNAL_CANDLES_RESET = 16,  // reset_candles [JournalIdValue]
+  JOURNAL_CANDLE_UPSERT = 17,  // upsert_candle [JournalCandle]
+  JOURNAL_POSITION_OPEN = 18,  // open_position [EnginePosition]
+  JOURNAL_POSITION_CLOSE = 19, // close_position [JournalPositionClose]
+  JOURNAL_TRADE = 20,          // one trade decision [JournalTrade]
+  JOURNAL_TRADE_ACCOUNTS = 21, // [JournalTradeAccounts, EngineAccountTrade
+                               //  x n, EngineTradeDecision x n]
+  JOURNAL_RETURNS = 22,        // a returns row [JournalIdValue, ReturnSeries]
+  JOURNAL_SYMBOL_STRATEGY = 23, // set_symbol_strategy [JournalIdValue kind]
+  JOURNAL_TICKS_SEED = 24,     // store_warm_start [JournalIdValue, EngineTick
+                               //  x n]
+};
+
+struct JournalHeader {
+  uint32_t type; // JournalRecordType
+  uint32_t size; // payload bytes that follow
+  int64_t mono_ns;
+  int64_t wall_ns;
+};
+
+struct JournalIdValue {
+  int32_t id;
+  int32_t value;
+};
+
+struct JournalIdNs {
+  int32_t id;
+  int32_t reserved;
+  int64_t ns;
+};
+
+struct JournalIdAmount {
+  int32_t id;
+  int32_t reserved;
+  double amount;
+};
+
+struct JournalAccountState {
+  int32_t id;
+  int32_t reserved;
+  AccountState state;
+};
+
+struct JournalLedger {
+  int32_t account_id; // -1 = the engine's own account
+  int32_t sl_hits;
+  int64_t day;
+  double day_start_balance;
+  double realised_pnl;
+};
+
+struct JournalSymbolRisk {
+  int32_t id;
+  int32_t loss_streak;
+  int64_t loss_streak_day;
+  int64_t last_trade_ns;
+};
+
+struct JournalCandle {
+  int32_t id;
+  int32_t tf;
+  EngineCandle candle;
+};
+
+struct JournalPositionClose {
+  int32_t id;
+  int32_t reserved;
+  int64_t contract_id;
+};
+
+struct JournalTrade {
+  EngineTradeRequest request; // symbol_id -1: unknown symbol
+  int32_t direction;
+  int32_t reserved;
+  EngineTradeDecision decision; // as made live
+};
+
+struct JournalTradeAccounts {
+  int32_t symbol_id;
+  int32_t direction;
+  int64_t n;
+};
+
+struct JournalPart {
+  const void *data;
+  size_t size;
+};
+
+// Appends records from any thread; writes are serialised by a mutex.
+// Inputs are only recorded while active, so the snapshot that opens a
+// journal is written before activate().
+class JournalWriter {
+public:
+  ~JournalWriter() { close(); }
+
+  // Create (truncate) `path` and write the magic; not active yet
+  bool open(const std::string &path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    close_locked();
+    file = std::fopen(path.c_str(), "wb");
+    if (!file)
+      return false;
+    std::setvbuf(file, nullptr, _IOFBF, JOURNAL_BUFFER_BYTES);
+    records = 0;
+    failed = std::fwrite(JOURNAL_MAGIC, sizeof JOURNAL_MAGIC, 1, file) != 1;
+    return !failed;
+  }
+
+  void activate() { on.store(true, std::memory_order_release); }
+
+  // One relaxed load: the whole cost of journaling while it is off
+  bool active() const { return on.load(std::memory_order_relaxed); }
+
+  // Stop recording and close the file. Returns the records written, or -1
+  // if any write failed.
+  int64_t close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return close_locked();
+  }
+
+  void record(uint32_t type, const ClockReading &at,
+              std::initializer_list<JournalPart> parts) {
+    if (active())
+      write(type, at, parts);
+  }
+
+  void write(uint32_t type, const ClockReading &at,
+             std::initializer_list<JournalPart> parts) {
+    JournalHeader h = {type, 0, at.mono_ns, at.wall_ns};
+    for (const JournalPart &p : parts)
+      h.size += static_cast<uint32_t>(p.size);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file)
+      return;
+    bool ok = std::fwrite(&h, sizeof h, 1, file) == 1;
+    for (const JournalPart &p : parts)
+      if (p.size > 0)
+        ok = ok && std::fwrite(p.data, p.size, 1, file) == 1;
+    failed = failed || !ok;
+    ++records;
+  }
+
+private:
+  int64_t close_locked() {
+    on.store(false, std::memory_order_release);
+    if (!file)
+      return 0;
+    failed = std::fclose(file) != 0 || failed;
+    file = nullptr;
+    return failed ? -1 : records;
+  }
+
+  std::mutex mutex;
+  std::FILE *file = nullptr;
+  int64_t records = 0;
+  bool failed = false;
+  std::atomic<bool> on{false};
+};
+
+// Walks a journal mapped read-only. A trailing partial record (the process
+// died mid-write) ends the journal.
+class JournalReader {
+public:
+  explicit JournalReader(const char *path) : file(path) {}
+
+  bool ok() const {
+    return file.ok() && file.size() >= sizeof JOURNAL_MAGIC &&
+           std::memcmp(file.as<char>(), JOURNAL_MAGIC,
+                       sizeof JOURNAL_MAGIC) == 0;
+  }
+
+  bool next(JournalHeader &h, const char *&payload) {
+    if (pos + sizeof h > file.size())
+      return false;
+    std::memcpy(&h, file.as<char>() + pos, sizeof h);
+    if (pos + sizeof h + h.size > file.size())
+      return false;
+    payload = file.as<char>() + pos + sizeof h;
+    pos += sizeof h + h.size;
+    return true;
+  }
+
+  size_t consumed() const { return pos; }
+
+private:
+  MappedFile file;
+  size_t pos = sizeof JOURNAL_MAGIC;
+};
+
+// Copy a record's fixed-size payload out (it is unaligned in the mapping);
+// false if the record is too short to hold one
+template <typename T>
+bool journal_payload(const JournalHeader &h, const char *payload, T &out) {
+  if (h.size < sizeof out)
+    return false;
+  std::memcpy(&out, payload, sizeof out);
+  return true;
+}
+
+#endif // JOURNAL_HPP
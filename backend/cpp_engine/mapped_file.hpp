@@ -0,0 +1,59 @@
+/**
+ * Read-only memory mapping of a file of fixed-size records.
+ *
+ * The pages are shared with the OS page cache, so any number of threads
+ * (or processes) replaying the same market data read one physical copy
+ * and nothing is parsed or copied up front.
+ */
+
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+class MappedFile {
+public:
+  explicit MappedFile(const char *path) {
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+      return;
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+      void *p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ,
+                       MAP_SHARED, fd, 0);
+      if (p != MAP_FAILED) {
+        base = p;
+        length = static_cast<size_t>(st.st_size);
+        ::madvise(base, length, MADV_SEQUENTIAL);
+      }
+    }
+    ::close(fd); // the mapping keeps the file referenced
+  }
+
+  ~MappedFile() {
+    if (base)
+      ::munmap(base, length);
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  bool ok() const { return base != nullptr; }
+  size_t size() const { return length; }
+
+  // The file as an array of T; trailing partial records are ignored
+  template <typename T> const T *as() const {
+    return static_cast<const T *>(base);
+  }
+  template <typename T> size_t count() const { return length / sizeof(T); }
+
+private:
+  void *base = nullptr;
+  size_t length = 0;
+};
+
+#endif // MAPPED_FILE_HPP
@@ -0,0 +1,199 @@
+/**
+ * Incremental market structure of one candle timeframe.
+ *
+ * Folded in once per closed candle, next to the indicators, so nothing is
+ * rescanned and there is no work between closes:
+ *
+ * - Swings: a bar is a swing high (low) when its high (low) is the
+ *   highest (lowest) of the STRUCTURE_SWING_LOOKBACK bars either side, so
+ *   a swing is confirmed that many bars after it formed. Ties count.
+ * - Break of structure: the first close beyond the latest swing high
+ *   (low) breaks it; each swing breaks at most once. A break against the
+ *   current trend is also a change of character (CHoCH).
+ * - Fair value gaps: three-bar imbalances (bar 1's high below bar 3's low,
+ *   or bar 1's low above bar 3's high). Later bars trading into a gap
+ *   shrink it and a gap traded through is closed; the newest
+ *   STRUCTURE_MAX_GAPS stay tracked.
+ *
+ * The state is a few hundred bytes of fixed storage; snapshot() is O(1).
+ */
+
+#ifndef MARKET_STRUCTURE_HPP
+#define MARKET_STRUCTURE_HPP
+
+#include "engine.hpp"
+#include <cstdint>
+
+constexpr int STRUCTURE_SWING_LOOKBACK = 5;
+constexpr int STRUCTURE_MAX_GAPS = 16;
+
+class MarketStructure {
+public:
+  void reset() { *this = MarketStructure(); }
+
+  void update(const EngineCandle &bar) {
+    // Breaks first: a swing confirmed below is never above this close
+    if (swing_high.price > 0.0 && !swing_high.broken &&
+        bar.close > swing_high.price) {
+      swing_high.broken = true;
+      record_break(1, swing_high.price, bar.epoch);
+    }
+    if (swing_low.price > 0.0 && !swing_low.broken &&
+        bar.close < swing_low.price) {
+      swing_low.broken = true;
+      record_break(-1, swing_low.price, bar.epoch);
+    }
+
+    mitigate_gaps(bar);
+
+    window[head] = bar;
+    head = (head + 1) % WINDOW;
+    ++bars;
+
+    if (bars >= 3)
+      detect_gap(at(2), bar);
+    if (bars >= WINDOW)
+      confirm_swings();
+  }
+
+  void snapshot(EngineStructure &out) const {
+    out.swing_high = swing_high.price;
+    out.swing_low = swing_low.price;
+    out.prev_swing_high = prev_swing_high;
+    out.prev_swing_low = prev_swing_low;
+    out.swing_high_epoch = swing_high.epoch;
+    out.swing_low_epoch = swing_low.epoch;
+    out.bos_level = bos_level;
+    out.bos_epoch = bos_epoch;
+    out.bos_direction = bos_direction;
+    out.trend = trend;
+    out.choch = choch ? 1 : 0;
+    out.bars_since_bos =
+        bos_direction ? static_cast<int32_t>(bars - 1 - bos_bar) : -1;
+    const Gap *bull = newest_gap(1), *bear = newest_gap(-1);
+    out.bull_fvg_top = bull ? bull->top : 0.0;
+    out.bull_fvg_bottom = bull ? bull->bottom : 0.0;
+    out.bear_fvg_top = bear ? bear->top : 0.0;
+    out.bear_fvg_bottom = bear ? bear->bottom : 0.0;
+    out.open_bull_fvgs = open_gaps[0];
+    out.open_bear_fvgs = open_gaps[1];
+    out.bars = bars;
+  }
+
+private:
+  static constexpr int WINDOW = 2 * STRUCTURE_SWING_LOOKBACK + 1;
+
+  struct Swing {
+    double price = 0.0;
+    int64_t epoch = 0;
+    bool broken = false;
+  };
+
+  struct Gap {
+    double top;
+    double bottom;
+    int32_t direction; // 1 bullish (below price), -1 bearish
+  };
+
+  // The bar closed `age` bars before the newest (0 = newest)
+  const EngineCandle &at(int age) const {
+    return window[(head + WINDOW - 1 - age) % WINDOW];
+  }
+
+  void record_break(int32_t direction, double level, int64_t epoch) {
+    choch = trend != 0 && trend != direction;
+    trend = direction;
+    bos_direction = direction;
+    bos_level = level;
+    bos_epoch = epoch;
+    bos_bar = bars; // index of the bar being folded in
+  }
+
+  // The window is now centred on the bar STRUCTURE_SWING_LOOKBACK back
+  void confirm_swings() {
+    const EngineCandle &pivot = at(STRUCTURE_SWING_LOOKBACK);
+    bool is_high = true, is_low = true;
+    for (int age = 0; age < WINDOW; ++age) {
+      const EngineCandle &c = at(age);
+      is_high = is_high && c.high <= pivot.high;
+      is_low = is_low && c.low >= pivot.low;
+    }
+    if (is_high) {
+      prev_swing_high = swing_high.price;
+      swing_high = {pivot.high, pivot.epoch, false};
+    }
+    if (is_low) {
+      prev_swing_low = swing_low.price;
+      swing_low = {pivot.low, pivot.epoch, false};
+    }
+  }
+
+  void detect_gap(const EngineCandle &first, const EngineCandle &third) {
+    if (first.high < third.low)
+      add_gap({third.low, first.high, 1});
+    else if (first.low > third.high)
+      add_gap({first.low, third.high, -1});
+  }
+
+  void add_gap(const Gap &g) {
+    if (n_gaps == STRUCTURE_MAX_GAPS)
+      remove_gap(0); // the oldest
+    gaps[n_gaps++] = g;
+    ++open_gaps[g.direction > 0 ? 0 : 1];
+  }
+
+  void remove_gap(int i) {
+    --open_gaps[gaps[i].direction > 0 ? 0 : 1];
+    for (int j = i + 1; j < n_gaps; ++j)
+      gaps[j - 1] = gaps[j];
+    --n_gaps;
+  }
+
+  // Price trading into a gap fills it from the near side
+  void mitigate_gaps(const EngineCandle &bar) {
+    for (int i = n_gaps - 1; i >= 0; --i) {
+      Gap &g = gaps[i];
+      if (g.direction > 0) {
+        if (bar.low <= g.bottom)
+          remove_gap(i);
+        else if (bar.low < g.top)
+          g.top = bar.low;
+      } else {
+        if (bar.high >= g.top)
+          remove_gap(i);
+        else if (bar.high > g.bottom)
+          g.bottom = bar.high;
+      }
+    }
+  }
+
+  const Gap *newest_gap(int32_t direction) const {
+    if (open_gaps[direction > 0 ? 0 : 1] == 0)
+      return nullptr;
+    for (int i = n_gaps - 1; i >= 0; --i)
+      if (gaps[i].direction == direction)
+        return &gaps[i];
+    return nullptr;
+  }
+
+  // Last WINDOW closed bars, oldest overwritten first
+  EngineCandle window[WINDOW] = {};
+  int head = 0;
+  int64_t bars = 0;
+
+  Swing swing_high, swing_low;
+  double prev_swing_high = 0.0, prev_swing_low = 0.0;
+
+  int32_t trend = 0;
+  int32_t bos_direction = 0;
+  bool choch = false;
+  double bos_level = 0.0;
+  int64_t bos_epoch = 0;
+  int64_t bos_bar = 0;
+
+  Gap gaps[STRUCTURE_MAX_GAPS] = {};
+  int n_gaps = 0;
+  int32_t open_gaps[2] = {0, 0}; // bullish, bearish
+};
+
+#endif // MARKET_STRUCTURE_HPP
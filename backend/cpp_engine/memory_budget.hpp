@@ -0,0 +1,60 @@
+/**
+ * What the engine may hold: the memory budget fixed by init_engine.
+ *
+ * The budget bounds the symbol and account contexts, the closed candles
+ * kept per timeframe and the open positions per symbol. The engine sizes
+ * one Arena for all of it (see arena.hpp) before the first context is
+ * created: contexts, their candle columns and position slots are carved
+ * from it, so the footprint has a known ceiling and the tick and trade
+ * paths never allocate. The budget cannot change once a context exists;
+ * a later init_engine keeps it.
+ */
+
+#ifndef MEMORY_BUDGET_HPP
+#define MEMORY_BUDGET_HPP
+
+#include "candles.hpp"
+#include "engine.hpp"
+#include "position_book.hpp"
+#include <cstdint>
+
+// Hard limits of a budget. The symbol and account tables (and the return
+// matrix) are sized for these at compile time.
+constexpr int32_t MAX_SYMBOL_CONTEXTS = 256;
+constexpr int32_t MAX_ACCOUNT_CONTEXTS = 32;
+constexpr int32_t MAX_CANDLE_CAPACITY = 1 << 20;
+constexpr int32_t MAX_POSITIONS_PER_SYMBOL = 4096;
+
+struct MemoryBudget {
+  int32_t max_symbols = MAX_SYMBOL_CONTEXTS;
+  int32_t max_accounts = MAX_ACCOUNT_CONTEXTS;
+  int32_t max_positions = DEFAULT_SYMBOL_POSITIONS; // per symbol
+  int32_t candles[ENGINE_TF_COUNT];                 // closed, per timeframe
+
+  MemoryBudget() {
+    for (int tf = 0; tf < ENGINE_TF_COUNT; ++tf)
+      candles[tf] = static_cast<int32_t>(DEFAULT_CANDLE_CAPACITY[tf]);
+  }
+
+  bool valid() const {
+    if (max_symbols < 1 || max_symbols > MAX_SYMBOL_CONTEXTS ||
+        max_accounts < 0 || max_accounts > MAX_ACCOUNT_CONTEXTS ||
+        max_positions < 1 || max_positions > MAX_POSITIONS_PER_SYMBOL)
+      return false;
+    for (int tf = 0; tf < ENGINE_TF_COUNT; ++tf)
+      if (candles[tf] < 1 || candles[tf] > MAX_CANDLE_CAPACITY)
+        return false;
+    return true;
+  }
+
+  bool operator==(const MemoryBudget &o) const {
+    for (int tf = 0; tf < ENGINE_TF_COUNT; ++tf)
+      if (candles[tf] != o.candles[tf])
+        return false;
+    return max_symbols == o.max_symbols && max_accounts == o.max_accounts &&
+           max_positions == o.max_positions;
+  }
+  bool operator!=(const MemoryBudget &o) const { return !(*this == o); }
+};
+
+#endif // MEMORY_BUDGET_HPP
@@ -0,0 +1,259 @@
+/**
+ * Hot-path latency instrumentation.
+ *
+ * LatencyHistogram is an HDR-style log-linear histogram of nanosecond
+ * durations: every power of two is split into 32 linear sub-buckets, so
+ * any recorded value is reported within ~3% from 1 ns up to ~18 minutes.
+ * Recording is a handful of relaxed atomic adds on fixed storage, safe
+ * from any number of threads with no lock and no allocation; readers
+ * take an approximate (non-atomic across buckets) snapshot that is good
+ * enough for percentiles on a dashboard.
+ *
+ * SymbolMetrics holds the tick-path stages of one symbol context;
+ * EngineMetrics the engine-wide histograms (request parsing, the native
+ * feed stages, one per C export) with the reject, entry filter and
+ * parse-error counters.
+ */
+
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include "engine.hpp"
+#include "json.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Monotonic clock in nanoseconds, the unit of all engine timestamps
+inline int64_t steady_now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+constexpr int64_t NS_PER_SECOND = 1000000000;
+
+class LatencyHistogram {
+public:
+  static constexpr int SUB_BITS = 5;
+  static constexpr int SUB_BUCKETS = 1 << SUB_BITS;
+  static constexpr int MAX_EXPONENT = 40; // 2^40 ns ~ 18 minutes
+  static constexpr int BUCKETS = (MAX_EXPONENT - SUB_BITS + 1) * SUB_BUCKETS;
+
+  // Summed copy of one or more histograms, for reporting
+  struct Snapshot {
+    std::vector<uint64_t> counts = std::vector<uint64_t>(BUCKETS);
+    uint64_t sum = 0;
+    uint64_t peak = 0;
+
+    void add(const LatencyHistogram &h) {
+      for (int i = 0; i < BUCKETS; ++i)
+        counts[i] += h.counts[i].load(std::memory_order_relaxed);
+      sum += h.sum.load(std::memory_order_relaxed);
+      peak = std::max(peak, h.peak.load(std::memory_order_relaxed));
+    }
+
+    // {"count", "mean_us", "p50_us", "p99_us", "p999_us", "max_us"}
+    nlohmann::json summary() const {
+      static constexpr double QUANTILES[] = {0.50, 0.99, 0.999};
+      static const char *const KEYS[] = {"p50_us", "p99_us", "p999_us"};
+      uint64_t n = 0;
+      for (uint64_t c : counts)
+        n += c;
+      nlohmann::json out;
+      out["count"] = n;
+      out["mean_us"] = n ? sum / 1e3 / n : 0.0;
+      // One walk over the buckets answers every quantile
+      uint64_t seen = 0;
+      int q = 0;
+      for (int i = 0; i < BUCKETS && q < 3 && n > 0; ++i) {
+        seen += counts[i];
+        while (q < 3 && double(seen) >= QUANTILES[q] * double(n)) {
+          // The top bucket's midpoint may lie above the exact maximum
+          out[KEYS[q]] = std::min(midpoint_of(i), double(peak)) / 1e3;
+          ++q;
+        }
+      }
+      for (; q < 3; ++q)
+        out[KEYS[q]] = 0.0;
+      out["max_us"] = peak / 1e3;
+      return out;
+    }
+  };
+
+  // Two relaxed adds, plus a CAS only when a new maximum is seen
+  void record(int64_t ns) {
+    uint64_t v = ns > 0 ? static_cast<uint64_t>(ns) : 0;
+    counts[index_of(v)].fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(v, std::memory_order_relaxed);
+    uint64_t seen = peak.load(std::memory_order_relaxed);
+    while (v > seen &&
+           !peak.compare_exchange_weak(seen, v, std::memory_order_relaxed)) {
+    }
+  }
+
+  // Same for writers that are already serialised (e.g. under a context's
+  // state_lock): plain loads and stores, no locked instructions. Readers
+  // never see torn values, only possibly stale ones.
+  void record_serialised(int64_t ns) {
+    uint64_t v = ns > 0 ? static_cast<uint64_t>(ns) : 0;
+    std::atomic<uint64_t> &c = counts[index_of(v)];
+    c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    sum.store(sum.load(std::memory_order_relaxed) + v,
+              std::memory_order_relaxed);
+    if (v > peak.load(std::memory_order_relaxed))
+      peak.store(v, std::memory_order_relaxed);
+  }
+
+  void reset() {
+    for (auto &c : counts)
+      c.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    peak.store(0, std::memory_order_relaxed);
+  }
+
+  nlohmann::json summary() const {
+    Snapshot snap;
+    snap.add(*this);
+    return snap.summary();
+  }
+
+private:
+  static int index_of(uint64_t v) {
+    if (v < SUB_BUCKETS)
+      return static_cast<int>(v);
+    int exponent = 63 - __builtin_clzll(v); // >= SUB_BITS
+    if (exponent > MAX_EXPONENT)
+      return BUCKETS - 1;
+    int sub = static_cast<int>(v >> (exponent - SUB_BITS)) & (SUB_BUCKETS - 1);
+    return (exponent - SUB_BITS + 1) * SUB_BUCKETS + sub;
+  }
+
+  // Middle of the value range a bucket covers
+  static double midpoint_of(int index) {
+    if (index < SUB_BUCKETS)
+      return index;
+    int exponent = index / SUB_BUCKETS - 1 + SUB_BITS;
+    int sub = index % SUB_BUCKETS;
+    double width = static_cast<double>(uint64_t(1) << (exponent - SUB_BITS));
+    return (SUB_BUCKETS + sub) * width + width / 2;
+  }
+
+  std::atomic<uint64_t> counts[BUCKETS] = {};
+  std::atomic<uint64_t> sum{0};
+  std::atomic<uint64_t> peak{0};
+};
+
+// Stages timed on every tick and trade decision. They are recorded per
+// symbol (SymbolMetrics), so tick paths for different symbols never write
+// a shared cache line, and summed across symbols when reported.
+enum SymbolStage {
+  STAGE_TICK,     // arrival at the engine to signal: context lock, candle
+                  // aggregation, indicator updates and signal evaluation
+  STAGE_DECISION, // trade sizing, safety checks and cooldown claim
+  SYMBOL_STAGE_COUNT
+};
+
+static const char *const SYMBOL_STAGE_NAMES[SYMBOL_STAGE_COUNT] = {
+    "tick", "decision"};
+
+// Tick is written under the context's state_lock (record_serialised);
+// decision is lock-free and uses record.
+struct SymbolMetrics {
+  LatencyHistogram stages[SYMBOL_STAGE_COUNT];
+
+  void reset() {
+    for (auto &h : stages)
+      h.reset();
+  }
+};
+
+// Engine-wide stages (each feed stage has a single writer thread)
+enum EngineStage {
+  STAGE_PARSE,      // JSON request parsing (process_tick / execute_trade)
+  STAGE_FEED_WIRE,  // native feed: frame received to parsed
+  STAGE_FEED_QUEUE, // native feed: frame received to apply thread pickup
+  STAGE_FEED_TICK_TO_SIGNAL, // native feed: frame received to tick result
+  ENGINE_STAGE_COUNT
+};
+
+static const char *const ENGINE_STAGE_NAMES[ENGINE_STAGE_COUNT] = {
+    "parse", "feed_wire", "feed_queue", "feed_tick_to_signal"};
+
+// C exports with their own call latency histogram
+enum MetricsExport {
+  EXPORT_PROCESS_TICK,
+  EXPORT_PROCESS_TICK_BIN,
+  EXPORT_PROCESS_TICKS,
+  EXPORT_EXECUTE_TRADE,
+  EXPORT_EXECUTE_TRADE_BIN,
+  EXPORT_EXECUTE_TRADE_ACCOUNTS,
+  EXPORT_FILTER_ENTRY,
+  EXPORT_PROCESS_TICK_STRATEGY,
+  EXPORT_COUNT
+};
+
+static const char *const EXPORT_NAMES[EXPORT_COUNT] = {
+    "process_tick",      "process_tick_bin",       "process_ticks",
+    "execute_trade",     "execute_trade_bin",      "execute_trade_accounts",
+    "filter_entry",      "process_tick_strategy",
+};
+
+struct EngineMetrics {
+  LatencyHistogram stages[ENGINE_STAGE_COUNT];
+  LatencyHistogram exports[EXPORT_COUNT];
+  std::atomic<uint64_t> unknown_symbol_ticks{0};
+  std::atomic<uint64_t> parse_errors{0};
+  // Trade decisions by EngineTradeReason (index 0 = approved)
+  std::atomic<uint64_t> decisions[ENGINE_TRADE_REASON_COUNT] = {};
+  // Entry filter outcomes by EngineFilterReason (index 0 = passed)
+  std::atomic<uint64_t> filters[ENGINE_FILTER_REASON_COUNT] = {};
+  // Event ring posts, and those dropped because the ring was full
+  std::atomic<uint64_t> events_posted{0};
+  std::atomic<uint64_t> events_dropped{0};
+
+  void count(std::atomic<uint64_t> &counter) {
+    counter.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void count_decision(int32_t reason) {
+    if (reason >= 0 && reason < ENGINE_TRADE_REASON_COUNT)
+      count(decisions[reason]);
+  }
+
+  void count_filter(int32_t reason) {
+    if (reason >= 0 && reason < ENGINE_FILTER_REASON_COUNT)
+      count(filters[reason]);
+  }
+
+  void reset() {
+    for (auto &h : stages)
+      h.reset();
+    for (auto &h : exports)
+      h.reset();
+    unknown_symbol_ticks.store(0, std::memory_order_relaxed);
+    parse_errors.store(0, std::memory_order_relaxed);
+    events_posted.store(0, std::memory_order_relaxed);
+    events_dropped.store(0, std::memory_order_relaxed);
+    for (auto &d : decisions)
+      d.store(0, std::memory_order_relaxed);
+    for (auto &f : filters)
+      f.store(0, std::memory_order_relaxed);
+  }
+};
+
+// Times one export call into its histogram
+class ExportTimer {
+public:
+  ExportTimer(EngineMetrics &metrics, MetricsExport which)
+      : hist(metrics.exports[which]), start(steady_now_ns()) {}
+  ~ExportTimer() { hist.record(steady_now_ns() - start); }
+
+private:
+  LatencyHistogram &hist;
+  int64_t start;
+};
+
+#endif // METRICS_HPP
@@ -0,0 +1,91 @@
+/**
+ * Bounded lock-free multi-producer/single-consumer ring.
+ *
+ * Any number of threads push; one thread at a time pops. Each slot carries
+ * a sequence number (Vyukov's bounded queue): a producer claims the next
+ * position with one compare-and-swap on the tail, writes its item and
+ * publishes it by advancing the slot's sequence, so producers never wait
+ * on each other or on the consumer and never allocate. A full ring drops
+ * the item instead of blocking.
+ *
+ * A pop stops at the first position whose producer has claimed it but not
+ * yet published it; that item and any behind it are returned by the next
+ * pop.
+ */
+
+#ifndef MPSC_RING_HPP
+#define MPSC_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+template <typename T> class MpscRing {
+public:
+  // `capacity` is rounded up to a power of two
+  explicit MpscRing(size_t capacity) {
+    size_t n = 2;
+    while (n < capacity)
+      n <<= 1;
+    mask = n - 1;
+    cells.reset(new Cell[n]);
+    for (size_t i = 0; i < n; ++i)
+      cells[i].seq.store(i, std::memory_order_relaxed);
+  }
+
+  MpscRing(const MpscRing &) = delete;
+  MpscRing &operator=(const MpscRing &) = delete;
+
+  // Heap bytes of the slots
+  size_t bytes() const { return (mask + 1) * sizeof(Cell); }
+
+  // Any thread. False (item dropped) when the ring is full.
+  bool push(const T &item) {
+    size_t pos = tail.load(std::memory_order_relaxed);
+    Cell *c;
+    for (;;) {
+      c = &cells[pos & mask];
+      size_t seq = c->seq.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq - pos);
+      if (diff == 0) {
+        if (tail.compare_exchange_weak(pos, pos + 1,
+                                       std::memory_order_relaxed))
+          break;
+      } else if (diff < 0) {
+        return false; // the consumer has not freed this lap's slot yet
+      } else {
+        pos = tail.load(std::memory_order_relaxed);
+      }
+    }
+    c->item = item;
+    c->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side (callers serialise). False when nothing is published.
+  bool pop(T &item) {
+    Cell &c = cells[head & mask];
+    if (c.seq.load(std::memory_order_acquire) != head + 1)
+      return false;
+    item = c.item;
+    c.seq.store(head + mask + 1, std::memory_order_release);
+    ++head;
+    return true;
+  }
+
+  size_t capacity() const { return mask + 1; }
+
+private:
+  struct Cell {
+    std::atomic<size_t> seq;
+    T item;
+  };
+
+  size_t mask;
+  std::unique_ptr<Cell[]> cells;
+  alignas(64) std::atomic<size_t> tail{0}; // claimed by producers
+  alignas(64) size_t head = 0;             // consumer only
+};
+
+#endif // MPSC_RING_HPP
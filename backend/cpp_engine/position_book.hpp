@@ -0,0 +1,230 @@
+/**
+ * Open positions of one symbol context, with their exit rules.
+ *
+ * A flat array of up to the budget's max_positions (contract id,
+ * side, entry, stop loss, take profit, trailing rule), re-evaluated on
+ * every tick of the symbol inside the tick call:
+ *
+ * - Trailing: the position's EngineTrailRule may move the stop loss.
+ *   BREAK_EVEN moves it to entry once the profit exceeds 0.25x the
+ *   distance from entry to stop (DynamicTakeProfit.check_trailing_update);
+ *   the V10, Boom 300 and Crash 300 rules move it to entry at a fixed
+ *   profit in points and then trail it a fixed distance behind price
+ *   (check_*_trailing_update).
+ *   A stop only ever moves in the position's favour.
+ * - Exits: price through the stop loss or take profit (0 = none) marks
+ *   the position exited; it is reported once and no longer evaluated
+ *   until it is closed, or opened again to re-arm its exits.
+ *
+ * Changes are flagged on the position rather than queued, so the book is
+ * bounded and a position changed on several ticks is reported once with
+ * its latest levels. With no open positions a tick costs one comparison.
+ */
+
+#ifndef POSITION_BOOK_HPP
+#define POSITION_BOOK_HPP
+
+#include "arena.hpp"
+#include "engine.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// Positions per symbol context (well above the account's trade limit),
+// unless the memory budget sets another limit
+constexpr int DEFAULT_SYMBOL_POSITIONS = 32;
+
+// Points-based trailing of the V10 / Boom 300 / Crash 300 rules
+struct TrailSteps {
+  double point;          // price of one point
+  double break_even_at;  // profit (points) that moves the stop to entry
+  double trail_from;     // profit (points) from which the stop trails
+  double trail_distance; // points the trailing stop keeps behind price
+};
+
+inline const TrailSteps *trail_steps(int32_t rule) {
+  static const TrailSteps V10 = {0.0001, 6.0, 9.0, 5.0};
+  static const TrailSteps BOOM_CRASH_300 = {0.0001, 7.0, 10.0, 5.0};
+  switch (rule) {
+  case ENGINE_TRAIL_V10:
+    return &V10;
+  case ENGINE_TRAIL_BOOM300:
+  case ENGINE_TRAIL_CRASH300:
+    return &BOOM_CRASH_300;
+  default:
+    return nullptr;
+  }
+}
+
+// New stop loss for `p` at `price` under its trailing rule, or p.stop_loss
+inline double trailed_stop(const EnginePosition &p, double price) {
+  double sl = p.stop_loss;
+  double profit = p.side > 0 ? price - p.entry_price : p.entry_price - price;
+  // Whether `level` is a tighter stop than the current one
+  auto tighter = [&](double level) {
+    return p.side > 0 ? level > sl : level < sl;
+  };
+
+  if (p.trail_rule == ENGINE_TRAIL_BREAK_EVEN) {
+    double risk = p.entry_price - sl;
+    if (risk < 0.0)
+      risk = -risk;
+    if (risk > 0.0 && profit > 0.25 * risk && tighter(p.entry_price))
+      return p.entry_price;
+    return sl;
+  }
+
+  const TrailSteps *steps = trail_steps(p.trail_rule);
+  if (!steps)
+    return sl;
+  double points = profit / steps->point;
+  if (points >= steps->trail_from) {
+    double level = price - p.side * steps->trail_distance * steps->point;
+    return tighter(level) ? level : sl;
+  }
+  if (points >= steps->break_even_at && tighter(p.entry_price))
+    return p.entry_price;
+  return sl;
+}
+
+class PositionBook {
+public:
+  static constexpr size_t bytes_for(int32_t capacity) {
+    return arena_bytes_for<Slot>(static_cast<size_t>(capacity));
+  }
+
+  // Take room for `capacity` positions from `arena`; a book is sized once.
+  // False (and a book that holds none) if the arena cannot hold them.
+  bool reset(Arena &arena, int32_t capacity) {
+    count = 0;
+    slots = arena.take<Slot>(static_cast<size_t>(capacity));
+    cap = slots ? capacity : 0;
+    return slots != nullptr;
+  }
+
+  int32_t capacity() const { return cap; }
+  bool empty() const { return count == 0; }
+  int32_t size() const { return count; }
+  // Sum of the open positions' sides: > 0 net long, < 0 net short
+  int32_t net_side() const {
+    int32_t net = 0;
+    for (int32_t i = 0; i < count; ++i)
+      net += slots[i].pos.side;
+    return net;
+  }
+
+  // The i-th open position (i < size()), in no particular order
+  const EnginePosition &at(int32_t i) const { return slots[i].pos; }
+
+  // Add a position, or replace the levels of an open one with the same
+  // contract id. False if the book is full.
+  bool open(const EnginePosition &p) {
+    Slot *s = find(p.contract_id);
+    if (!s) {
+      if (count == cap)
+        return false;
+      s = &slots[count++];
+    }
+    *s = {p, 0, false, 0.0, 0};
+    return true;
+  }
+
+  bool close(int64_t contract_id) {
+    Slot *s = find(contract_id);
+    if (!s)
+      return false;
+    *s = slots[--count]; // order is not significant
+    return true;
+  }
+
+  bool get(int64_t contract_id, EnginePosition &out) const {
+    for (int32_t i = 0; i < count; ++i)
+      if (slots[i].pos.contract_id == contract_id) {
+        out = slots[i].pos;
+        return true;
+      }
+    return false;
+  }
+
+  // Trail and check exits at a new price; returns how many positions have
+  // unreported changes afterwards
+  int32_t on_price(double price, int64_t epoch) {
+    int32_t changed = 0;
+    for (int32_t i = 0; i < count; ++i) {
+      Slot &s = slots[i];
+      if (!s.exited)
+        evaluate(s, price, epoch);
+      if (s.events)
+        ++changed;
+    }
+    return changed;
+  }
+
+  // Copy out (and clear) up to `max` positions with unreported changes
+  size_t drain(EnginePositionUpdate *out, size_t max) {
+    size_t n = 0;
+    for (int32_t i = 0; i < count && n < max; ++i) {
+      Slot &s = slots[i];
+      if (!s.events)
+        continue;
+      EnginePositionUpdate &u = out[n++];
+      u.contract_id = s.pos.contract_id;
+      u.epoch = s.epoch;
+      u.events = s.events;
+      u.reserved = 0;
+      u.price = s.price;
+      u.stop_loss = s.pos.stop_loss;
+      u.take_profit = s.pos.take_profit;
+      s.events = 0;
+    }
+    return n;
+  }
+
+private:
+  struct Slot {
+    EnginePosition pos;
+    int32_t events; // EnginePositionEvent bits not yet drained
+    bool exited;    // stop or target hit; awaiting close
+    double price;   // price and epoch of the latest change
+    int64_t epoch;
+  };
+
+  Slot *find(int64_t contract_id) {
+    for (int32_t i = 0; i < count; ++i)
+      if (slots[i].pos.contract_id == contract_id)
+        return &slots[i];
+    return nullptr;
+  }
+
+  static void evaluate(Slot &s, double price, int64_t epoch) {
+    EnginePosition &p = s.pos;
+    int32_t events = 0;
+    bool buy = p.side > 0;
+    if (p.stop_loss > 0.0) { // trailing needs a stop to move
+      double sl = trailed_stop(p, price);
+      if (sl != p.stop_loss) {
+        p.stop_loss = sl;
+        events |= ENGINE_POSITION_STOP_MOVED;
+      }
+    }
+
+    if (p.stop_loss > 0.0 &&
+        (buy ? price <= p.stop_loss : price >= p.stop_loss))
+      events |= ENGINE_POSITION_STOP_HIT;
+    else if (p.take_profit > 0.0 &&
+             (buy ? price >= p.take_profit : price <= p.take_profit))
+      events |= ENGINE_POSITION_TAKE_PROFIT_HIT;
+
+    if (!events)
+      return;
+    s.exited = (events & ~ENGINE_POSITION_STOP_MOVED) != 0;
+    s.events |= events;
+    s.price = price;
+    s.epoch = epoch;
+  }
+
+  Slot *slots = nullptr;
+  int32_t cap = 0;
+  int32_t count = 0;
+};
+
+#endif // POSITION_BOOK_HPP
@@ -0,0 +1,58 @@
+/**
+ * Reusable output buffers for the JSON entry points.
+ *
+ * Each calling thread owns a small ring of strings. A JSON export
+ * serialises its answer straight into the next slot and returns the slot's
+ * c_str(), so nothing is malloc'ed per call and the caller has nothing to
+ * free. Slots keep their capacity, so after warm-up the only allocations
+ * left are the ones nlohmann makes while building the json value.
+ *
+ * A returned pointer stays valid until the same thread has made
+ * RESULT_RING_SLOTS further string-returning calls; callers copy it out
+ * immediately (ctypes does when restype is c_char_p).
+ */
+
+#ifndef RESULT_BUFFERS_HPP
+#define RESULT_BUFFERS_HPP
+
+#include "json.hpp"
+#include <cstddef>
+#include <string>
+
+constexpr size_t RESULT_RING_SLOTS = 8;
+constexpr size_t RESULT_SLOT_RESERVE = 256;
+
+class ResultRing {
+public:
+  ResultRing() {
+    for (auto &slot : slots)
+      slot.reserve(RESULT_SLOT_RESERVE);
+  }
+
+  // Next slot, emptied but with its capacity intact
+  std::string &next() {
+    std::string &slot = slots[pos];
+    pos = (pos + 1) % RESULT_RING_SLOTS;
+    slot.clear();
+    return slot;
+  }
+
+private:
+  std::string slots[RESULT_RING_SLOTS];
+  size_t pos = 0;
+};
+
+inline ResultRing &thread_results() {
+  thread_local ResultRing ring;
+  return ring;
+}
+
+// Serialise `j` into `out` in place (equivalent to out = j.dump(), without
+// the temporary string)
+inline void dump_into(const nlohmann::json &j, std::string &out) {
+  nlohmann::detail::serializer<nlohmann::json> s(
+      nlohmann::detail::output_adapter<char>(out), ' ');
+  s.dump(j, false, false, 0);
+}
+
+#endif // RESULT_BUFFERS_HPP
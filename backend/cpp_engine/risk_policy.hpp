@@ -0,0 +1,191 @@
+/**
+ * Per-symbol-class risk policies.
+ *
+ * Each instrument family Deriv offers gets a compile-time RiskPolicy
+ * specialisation (stake tiers by balance, minimum stake, losing-streak
+ * limit). The policies are flattened into a constexpr RISK_PROFILES table
+ * and a symbol context picks its entry once, at creation, from the symbol
+ * name, so the trade path only dereferences a pointer.
+ *
+ * The stake tiers are the ones RiskGuard.calculate_*_stake used; RiskGuard
+ * now asks the engine so the two can no longer diverge.
+ */
+
+#ifndef RISK_POLICY_HPP
+#define RISK_POLICY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+enum class SymbolClass : int32_t {
+  GENERIC = 0,
+  V10,
+  V75,
+  BOOM300,
+  CRASH300,
+  COUNT
+};
+
+// Balance tiers shared by every policy: <20, 20..50, >50 (account currency)
+constexpr double STAKE_TIER_SMALL = 20.0;
+constexpr double STAKE_TIER_MID = 50.0;
+
+template <SymbolClass C> struct RiskPolicy;
+
+template <> struct RiskPolicy<SymbolClass::GENERIC> {
+  static constexpr const char *name = "generic";
+  static constexpr double min_stake = 0.35;
+  static constexpr double stakes[3] = {0.35, 0.70, 1.0};
+  static constexpr int max_consecutive_losses = 2;
+};
+
+template <> struct RiskPolicy<SymbolClass::V10> {
+  static constexpr const char *name = "V10";
+  static constexpr double min_stake = 0.35;
+  static constexpr double stakes[3] = {0.5, 1.0, 1.5};
+  static constexpr int max_consecutive_losses = 2;
+};
+
+// V75 trades through the same scalper as V10 and uses its tiers
+template <> struct RiskPolicy<SymbolClass::V75> {
+  static constexpr const char *name = "V75";
+  static constexpr double min_stake = 0.35;
+  static constexpr double stakes[3] = {0.5, 1.0, 1.5};
+  static constexpr int max_consecutive_losses = 2;
+};
+
+template <> struct RiskPolicy<SymbolClass::BOOM300> {
+  static constexpr const char *name = "Boom300";
+  static constexpr double min_stake = 0.35;
+  static constexpr double stakes[3] = {0.35, 0.70, 1.2};
+  static constexpr int max_consecutive_losses = 2;
+};
+
+// Crash 300 mirrors Boom 300
+template <> struct RiskPolicy<SymbolClass::CRASH300> {
+  static constexpr const char *name = "Crash300";
+  using Boom = RiskPolicy<SymbolClass::BOOM300>;
+  static constexpr double min_stake = Boom::min_stake;
+  static constexpr double stakes[3] = {Boom::stakes[0], Boom::stakes[1],
+                                       Boom::stakes[2]};
+  static constexpr int max_consecutive_losses = 2;
+};
+
+// Runtime view of a policy, one per SymbolClass
+struct RiskProfile {
+  SymbolClass cls;
+  const char *name;
+  double min_stake;
+  double stakes[3];
+  int max_consecutive_losses;
+
+  // Recommended stake for an account balance
+  constexpr double stake_for(double balance) const {
+    return balance < STAKE_TIER_SMALL ? stakes[0]
+           : balance <= STAKE_TIER_MID ? stakes[1]
+                                       : stakes[2];
+  }
+};
+
+template <SymbolClass C> constexpr RiskProfile make_profile() {
+  using P = RiskPolicy<C>;
+  return {C,
+          P::name,
+          P::min_stake,
+          {P::stakes[0], P::stakes[1], P::stakes[2]},
+          P::max_consecutive_losses};
+}
+
+constexpr RiskProfile RISK_PROFILES[] = {
+    make_profile<SymbolClass::GENERIC>(), make_profile<SymbolClass::V10>(),
+    make_profile<SymbolClass::V75>(), make_profile<SymbolClass::BOOM300>(),
+    make_profile<SymbolClass::CRASH300>()};
+
+static_assert(sizeof(RISK_PROFILES) / sizeof(RISK_PROFILES[0]) ==
+                  static_cast<size_t>(SymbolClass::COUNT),
+              "RISK_PROFILES must cover every SymbolClass");
+static_assert(RISK_PROFILES[static_cast<int>(SymbolClass::V10)].stake_for(
+                  30.0) == 1.0,
+              "V10 mid tier");
+
+// Deriv symbol name -> class: R_10/1HZ10V, R_75/1HZ75V, BOOM300(N),
+// CRASH300(N); anything else is generic
+inline SymbolClass classify_symbol(const std::string &symbol) {
+  if (symbol == "R_10" || symbol == "1HZ10V")
+    return SymbolClass::V10;
+  if (symbol == "R_75" || symbol == "1HZ75V")
+    return SymbolClass::V75;
+  if (symbol.rfind("BOOM300", 0) == 0 || symbol == "BOOM_300")
+    return SymbolClass::BOOM300;
+  if (symbol.rfind("CRASH300", 0) == 0 || symbol == "CRASH_300")
+    return SymbolClass::CRASH300;
+  return SymbolClass::GENERIC;
+}
+
+inline const RiskProfile &risk_profile_for(const std::string &symbol) {
+  return RISK_PROFILES[static_cast<int>(classify_symbol(symbol))];
+}
+
+// Account-wide realised results for the current UTC day. Updated when a
+// contract settles and read once per trade decision, so a mutex is fine.
+class RiskLedger {
+public:
+  struct Snapshot {
+    double day_start_balance;
+    double realised_pnl;
+    int sl_hits;
+  };
+
+  void record(int64_t day, double balance, double profit) {
+    std::lock_guard<std::mutex> lock(mutex);
+    roll_locked(day, balance);
+    realised_pnl += profit;
+    if (profit < 0)
+      ++sl_hits;
+  }
+
+  Snapshot snapshot(int64_t day, double balance) {
+    std::lock_guard<std::mutex> lock(mutex);
+    roll_locked(day, balance);
+    return {day_start_balance, realised_pnl, sl_hits};
+  }
+
+  // The counters as they stand, without rolling the day (journal snapshot)
+  Snapshot peek(int64_t &day) {
+    std::lock_guard<std::mutex> lock(mutex);
+    day = current_day;
+    return {day_start_balance, realised_pnl, sl_hits};
+  }
+
+  void restore(int64_t day, const Snapshot &s) {
+    std::lock_guard<std::mutex> lock(mutex);
+    current_day = day;
+    day_start_balance = s.day_start_balance;
+    realised_pnl = s.realised_pnl;
+    sl_hits = s.sl_hits;
+  }
+
+private:
+  // Start a new day (resetting the counters) if `day` moved on
+  void roll_locked(int64_t day, double balance) {
+    // The balance may arrive after the first check of the day
+    if (day == current_day && day_start_balance <= 0.0)
+      day_start_balance = balance;
+    if (day == current_day)
+      return;
+    current_day = day;
+    day_start_balance = balance;
+    realised_pnl = 0.0;
+    sl_hits = 0;
+  }
+
+  std::mutex mutex;
+  int64_t current_day = -1;
+  double day_start_balance = 0.0;
+  double realised_pnl = 0.0;
+  int sl_hits = 0;
+};
+
+#endif // RISK_POLICY_HPP
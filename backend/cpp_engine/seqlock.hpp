@@ -0,0 +1,59 @@
+/**
+ * Single-writer sequence lock for small trivially-copyable values.
+ *
+ * Readers never block the writer and never take a lock: they retry if a
+ * write overlapped their copy. The payload is held in relaxed atomic words
+ * so concurrent reads are well-defined, not just benign races. Writers must
+ * be serialised by the caller (the engine does this per symbol context).
+ */
+
+#ifndef SEQLOCK_HPP
+#define SEQLOCK_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+template <typename T> class SeqLock {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "SeqLock payload must be trivially copyable");
+  static_assert(sizeof(T) % sizeof(uint64_t) == 0,
+                "SeqLock payload must be a whole number of 64-bit words");
+
+public:
+  SeqLock() { store(T{}); }
+
+  void store(const T &value) {
+    uint64_t buf[WORDS];
+    std::memcpy(buf, &value, sizeof(T));
+    uint32_t s = seq.load(std::memory_order_relaxed);
+    seq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < WORDS; ++i)
+      words[i].store(buf[i], std::memory_order_relaxed);
+    seq.store(s + 2, std::memory_order_release);
+  }
+
+  T load() const {
+    uint64_t buf[WORDS];
+    uint32_t before, after;
+    do {
+      before = seq.load(std::memory_order_acquire);
+      for (size_t i = 0; i < WORDS; ++i)
+        buf[i] = words[i].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      after = seq.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+    T value;
+    std::memcpy(&value, buf, sizeof(T));
+    return value;
+  }
+
+private:
+  static constexpr size_t WORDS = sizeof(T) / sizeof(uint64_t);
+  std::atomic<uint32_t> seq{0};
+  std::atomic<uint64_t> words[WORDS];
+};
+
+#endif // SEQLOCK_HPP
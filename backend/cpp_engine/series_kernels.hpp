@@ -0,0 +1,434 @@
+/**
+ * Bulk indicator kernels over contiguous price arrays.
+ *
+ * For history windows and backtests that arrive as whole columns rather
+ * than one tick at a time: true range, rolling min/max, rolling mean and
+ * standard deviation, centred swing-high/low detection, and the ATR and
+ * EMA series the Python strategies compute over candle columns.
+ *
+ * Rolling windows use the van Herk/Gil-Werman scheme: per-block prefix
+ * and suffix scans (sequential, one pass each) and then one element-wise
+ * combine per output, so the cost is O(n) whatever the window length and
+ * the combine is a straight SIMD loop. The element-wise steps have AVX2
+ * (x86-64, picked at runtime from CPUID) and NEON (AArch64, always
+ * present) versions next to a scalar fallback that defines the results;
+ * the SIMD versions use the same operation order and no fused
+ * multiply-add, so outputs are identical as long as the compiler does not
+ * contract the scalar code into FMAs either. GCC does by default on
+ * targets that have them, AArch64 among them, so the Makefile builds with
+ * -ffp-contract=off. Inputs are expected to be finite.
+ *
+ * Windows shorter than `window` at the start of a series cover what is
+ * there (out[i] summarises x[0..i]).
+ */
+
+#ifndef SERIES_KERNELS_HPP
+#define SERIES_KERNELS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SERIES_HAVE_AVX2 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define SERIES_HAVE_NEON 1
+#endif
+
+// Flags written by compute_swings
+constexpr uint8_t SERIES_SWING_HIGH = 1;
+constexpr uint8_t SERIES_SWING_LOW = 2;
+
+// Element-wise steps, one table per instruction set
+struct SeriesOps {
+  const char *name;
+  // out[i] = max(h[i] - l[i], |h[i] - c[i-1]|, |l[i] - c[i-1]|), 1 <= i < n
+  void (*true_range)(const double *h, const double *l, const double *c,
+                     double *out, size_t n);
+  void (*max)(const double *a, const double *b, double *out, size_t n);
+  void (*min)(const double *a, const double *b, double *out, size_t n);
+  void (*add)(const double *a, const double *b, double *out, size_t n);
+  // flags[i] |= bit where a[i] == b[i]
+  void (*mark_equal)(const double *a, const double *b, uint8_t *flags,
+                     uint8_t bit, size_t n);
+  // Window sums of (x - shift) and (x - shift)^2 over `count` values to
+  // mean and population standard deviation
+  void (*mean_std)(const double *sum, const double *sq, double count,
+                   double shift, double *mean, double *stddev, size_t n);
+};
+
+// --- Scalar ---
+
+inline void scalar_true_range(const double *h, const double *l,
+                              const double *c, double *out, size_t n) {
+  for (size_t i = 1; i < n; ++i) {
+    double hl = h[i] - l[i];
+    double hc = std::fabs(h[i] - c[i - 1]);
+    double lc = std::fabs(l[i] - c[i - 1]);
+    out[i] = std::max(hl, std::max(hc, lc));
+  }
+}
+
+inline void scalar_max(const double *a, const double *b, double *out,
+                       size_t n) {
+  for (size_t i = 0; i < n; ++i)
+    out[i] = std::max(a[i], b[i]);
+}
+
+inline void scalar_min(const double *a, const double *b, double *out,
+                       size_t n) {
+  for (size_t i = 0; i < n; ++i)
+    out[i] = std::min(a[i], b[i]);
+}
+
+inline void scalar_add(const double *a, const double *b, double *out,
+                       size_t n) {
+  for (size_t i = 0; i < n; ++i)
+    out[i] = a[i] + b[i];
+}
+
+inline void scalar_mark_equal(const double *a, const double *b, uint8_t *flags,
+                              uint8_t bit, size_t n) {
+  for (size_t i = 0; i < n; ++i)
+    if (a[i] == b[i])
+      flags[i] |= bit;
+}
+
+inline void scalar_mean_std(const double *sum, const double *sq, double count,
+                            double shift, double *mean, double *stddev,
+                            size_t n) {
+  double inv = 1.0 / count;
+  for (size_t i = 0; i < n; ++i) {
+    double m = sum[i] * inv;
+    double var = sq[i] * inv - m * m;
+    mean[i] = m + shift;
+    stddev[i] = std::sqrt(std::max(var, 0.0));
+  }
+}
+
+static const SeriesOps SCALAR_OPS = {
+    "scalar",   scalar_true_range, scalar_max,     scalar_min,
+    scalar_add, scalar_mark_equal, scalar_mean_std};
+
+// --- AVX2 ---
+#ifdef SERIES_HAVE_AVX2
+
+#define SERIES_AVX2 __attribute__((target("avx2")))
+
+SERIES_AVX2 inline __m256d avx2_abs(__m256d v) {
+  return _mm256_andnot_pd(_mm256_set1_pd(-0.0), v);
+}
+
+SERIES_AVX2 inline void avx2_true_range(const double *h, const double *l,
+                                        const double *c, double *out,
+                                        size_t n) {
+  size_t i = 1;
+  for (; i + 4 <= n; i += 4) {
+    __m256d hi = _mm256_loadu_pd(h + i);
+    __m256d lo = _mm256_loadu_pd(l + i);
+    __m256d pc = _mm256_loadu_pd(c + i - 1);
+    __m256d hl = _mm256_sub_pd(hi, lo);
+    __m256d hc = avx2_abs(_mm256_sub_pd(hi, pc));
+    __m256d lc = avx2_abs(_mm256_sub_pd(lo, pc));
+    _mm256_storeu_pd(out + i, _mm256_max_pd(hl, _mm256_max_pd(hc, lc)));
+  }
+  if (i < n)
+    scalar_true_range(h + i - 1, l + i - 1, c + i - 1, out + i - 1, n - i + 1);
+}
+
+#define SERIES_AVX2_BINARY(NAME, OP)                                           \
+  SERIES_AVX2 inline void avx2_##NAME(const double *a, const double *b,        \
+                                      double *out, size_t n) {                 \
+    size_t i = 0;                                                              \
+    for (; i + 4 <= n; i += 4)                                                 \
+      _mm256_storeu_pd(out + i,                                                \
+                       OP(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));    \
+    scalar_##NAME(a + i, b + i, out + i, n - i);                               \
+  }
+
+SERIES_AVX2_BINARY(max, _mm256_max_pd)
+SERIES_AVX2_BINARY(min, _mm256_min_pd)
+SERIES_AVX2_BINARY(add, _mm256_add_pd)
+#undef SERIES_AVX2_BINARY
+
+SERIES_AVX2 inline void avx2_mark_equal(const double *a, const double *b,
+                                        uint8_t *flags, uint8_t bit,
+                                        size_t n) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256d eq = _mm256_cmp_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i),
+                               _CMP_EQ_OQ);
+    int mask = _mm256_movemask_pd(eq);
+    for (int k = 0; k < 4; ++k)
+      if (mask & (1 << k))
+        flags[i + k] |= bit;
+  }
+  scalar_mark_equal(a + i, b + i, flags + i, bit, n - i);
+}
+
+SERIES_AVX2 inline void avx2_mean_std(const double *sum, const double *sq,
+                                      double count, double shift, double *mean,
+                                      double *stddev, size_t n) {
+  double inv = 1.0 / count;
+  __m256d vinv = _mm256_set1_pd(inv);
+  __m256d vshift = _mm256_set1_pd(shift);
+  __m256d zero = _mm256_setzero_pd();
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256d m = _mm256_mul_pd(_mm256_loadu_pd(sum + i), vinv);
+    __m256d var = _mm256_sub_pd(_mm256_mul_pd(_mm256_loadu_pd(sq + i), vinv),
+                                _mm256_mul_pd(m, m));
+    _mm256_storeu_pd(mean + i, _mm256_add_pd(m, vshift));
+    _mm256_storeu_pd(stddev + i, _mm256_sqrt_pd(_mm256_max_pd(var, zero)));
+  }
+  scalar_mean_std(sum + i, sq + i, count, shift, mean + i, stddev + i, n - i);
+}
+
+#undef SERIES_AVX2
+
+static const SeriesOps AVX2_OPS = {
+    "avx2",   avx2_true_range, avx2_max,     avx2_min,
+    avx2_add, avx2_mark_equal, avx2_mean_std};
+
+#endif // SERIES_HAVE_AVX2
+
+// --- NEON ---
+#ifdef SERIES_HAVE_NEON
+
+inline void neon_true_range(const double *h, const double *l, const double *c,
+                            double *out, size_t n) {
+  size_t i = 1;
+  for (; i + 2 <= n; i += 2) {
+    float64x2_t hi = vld1q_f64(h + i);
+    float64x2_t lo = vld1q_f64(l + i);
+    float64x2_t pc = vld1q_f64(c + i - 1);
+    float64x2_t hl = vsubq_f64(hi, lo);
+    float64x2_t hc = vabsq_f64(vsubq_f64(hi, pc));
+    float64x2_t lc = vabsq_f64(vsubq_f64(lo, pc));
+    vst1q_f64(out + i, vmaxq_f64(hl, vmaxq_f64(hc, lc)));
+  }
+  if (i < n)
+    scalar_true_range(h + i - 1, l + i - 1, c + i - 1, out + i - 1, n - i + 1);
+}
+
+#define SERIES_NEON_BINARY(NAME, OP)                                           \
+  inline void neon_##NAME(const double *a, const double *b, double *out,       \
+                          size_t n) {                                          \
+    size_t i = 0;                                                              \
+    for (; i + 2 <= n; i += 2)                                                 \
+      vst1q_f64(out + i, OP(vld1q_f64(a + i), vld1q_f64(b + i)));              \
+    scalar_##NAME(a + i, b + i, out + i, n - i);                               \
+  }
+
+SERIES_NEON_BINARY(max, vmaxq_f64)
+SERIES_NEON_BINARY(min, vminq_f64)
+SERIES_NEON_BINARY(add, vaddq_f64)
+#undef SERIES_NEON_BINARY
+
+inline void neon_mark_equal(const double *a, const double *b, uint8_t *flags,
+                            uint8_t bit, size_t n) {
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    uint64x2_t eq = vceqq_f64(vld1q_f64(a + i), vld1q_f64(b + i));
+    if (vgetq_lane_u64(eq, 0))
+      flags[i] |= bit;
+    if (vgetq_lane_u64(eq, 1))
+      flags[i + 1] |= bit;
+  }
+  scalar_mark_equal(a + i, b + i, flags + i, bit, n - i);
+}
+
+inline void neon_mean_std(const double *sum, const double *sq, double count,
+                          double shift, double *mean, double *stddev,
+                          size_t n) {
+  double inv = 1.0 / count;
+  float64x2_t vinv = vdupq_n_f64(inv);
+  float64x2_t vshift = vdupq_n_f64(shift);
+  float64x2_t zero = vdupq_n_f64(0.0);
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    float64x2_t m = vmulq_f64(vld1q_f64(sum + i), vinv);
+    float64x2_t var =
+        vsubq_f64(vmulq_f64(vld1q_f64(sq + i), vinv), vmulq_f64(m, m));
+    vst1q_f64(mean + i, vaddq_f64(m, vshift));
+    vst1q_f64(stddev + i, vsqrtq_f64(vmaxq_f64(var, zero)));
+  }
+  scalar_mean_std(sum + i, sq + i, count, shift, mean + i, stddev + i, n - i);
+}
+
+static const SeriesOps NEON_OPS = {
+    "neon",   neon_true_range, neon_max,     neon_min,
+    neon_add, neon_mark_equal, neon_mean_std};
+
+#endif // SERIES_HAVE_NEON
+
+// --- Dispatch ---
+
+// Best instruction set of this CPU, resolved once
+inline const SeriesOps &series_ops() {
+  static const SeriesOps &ops = []() -> const SeriesOps & {
+#if defined(SERIES_HAVE_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+      return AVX2_OPS;
+#elif defined(SERIES_HAVE_NEON)
+    return NEON_OPS;
+#endif
+    return SCALAR_OPS;
+  }();
+  return ops;
+}
+
+// --- Kernels ---
+
+// Van Herk/Gil-Werman window reduction of x[0..n) with an associative
+// `op` whose element-wise form is `combine`; `out` receives one value per
+// index and `scratch` holds the block suffixes (n values).
+template <typename Op>
+void compute_window_reduce(const double *x, size_t n, size_t window, Op op,
+                          void (*combine)(const double *, const double *,
+                                          double *, size_t),
+                          double *out, double *scratch) {
+  size_t w = std::max<size_t>(window, 1);
+  // Prefixes run forward within each block of w, suffixes backward
+  for (size_t b = 0; b < n; b += w) {
+    size_t end = std::min(b + w, n);
+    out[b] = x[b];
+    for (size_t i = b + 1; i < end; ++i)
+      out[i] = op(out[i - 1], x[i]);
+    scratch[end - 1] = x[end - 1];
+    for (size_t i = end - 1; i-- > b;)
+      scratch[i] = op(x[i], scratch[i + 1]);
+  }
+
+  // The first block is a run of partial windows, already its own prefix.
+  // Window [i-w+1, i] of a later block starting at b is the suffix of
+  // x[i-w+1] in the previous block plus the prefix of x[i]; the block's
+  // last index (a window aligned with a whole block) is the prefix alone.
+  for (size_t b = w; b < n; b += w) {
+    size_t span = std::min(w - 1, n - b);
+    combine(scratch + b - w + 1, out + b, out + b, span);
+  }
+}
+
+// True range; out[0] is the first bar's high - low (no previous close)
+inline void compute_true_range(const double *high, const double *low,
+                              const double *close, size_t n, double *out) {
+  if (n == 0)
+    return;
+  out[0] = high[0] - low[0];
+  series_ops().true_range(high, low, close, out, n);
+}
+
+inline void compute_rolling_max(const double *x, size_t n, size_t window,
+                               double *out) {
+  std::vector<double> scratch(n);
+  compute_window_reduce(
+      x, n, window, [](double a, double b) { return std::max(a, b); },
+      series_ops().max, out, scratch.data());
+}
+
+inline void compute_rolling_min(const double *x, size_t n, size_t window,
+                               double *out) {
+  std::vector<double> scratch(n);
+  compute_window_reduce(
+      x, n, window, [](double a, double b) { return std::min(a, b); },
+      series_ops().min, out, scratch.data());
+}
+
+// Rolling mean and population standard deviation (either output may be
+// null). Values are shifted by x[0] before summing so the squares keep
+// their precision at price magnitudes.
+inline void compute_rolling_mean_std(const double *x, size_t n, size_t window,
+                                    double *mean, double *stddev) {
+  if (n == 0)
+    return;
+  size_t w = std::max<size_t>(window, 1);
+  const SeriesOps &ops = series_ops();
+  double shift = x[0];
+  // d, d^2, their window sums and one suffix scratch column
+  std::vector<double> buf(5 * n);
+  double *d = buf.data(), *d2 = d + n, *sum = d2 + n, *sq = sum + n,
+         *scratch = sq + n;
+  for (size_t i = 0; i < n; ++i) {
+    d[i] = x[i] - shift;
+    d2[i] = d[i] * d[i];
+  }
+  auto plus = [](double a, double b) { return a + b; };
+  compute_window_reduce(d, n, w, plus, ops.add, sum, scratch);
+  compute_window_reduce(d2, n, w, plus, ops.add, sq, scratch);
+
+  std::vector<double> mean_buf, std_buf;
+  if (!mean) {
+    mean_buf.resize(n);
+    mean = mean_buf.data();
+  }
+  if (!stddev) {
+    std_buf.resize(n);
+    stddev = std_buf.data();
+  }
+  size_t head = std::min(w - 1, n);
+  for (size_t i = 0; i < head; ++i)
+    scalar_mean_std(sum + i, sq + i, double(i + 1), shift, mean + i, stddev + i,
+                    1);
+  ops.mean_std(sum + head, sq + head, double(w), shift, mean + head,
+               stddev + head, n - head);
+}
+
+// Swing points with `k` bars either side: a swing high where high[i] is
+// the maximum of high[i-k..i+k] (ties included), a swing low likewise on
+// `low`. flags[i] gets SERIES_SWING_HIGH / SERIES_SWING_LOW; the first
+// and last k bars are never swings.
+inline void compute_swings(const double *high, const double *low, size_t n,
+                          size_t k, uint8_t *flags) {
+  std::fill(flags, flags + n, uint8_t(0));
+  size_t w = 2 * k + 1;
+  if (n < w)
+    return;
+  const SeriesOps &ops = series_ops();
+  std::vector<double> extreme(n);
+  // The window ending at i + k is centred on i
+  compute_rolling_max(high, n, w, extreme.data());
+  ops.mark_equal(high + k, extreme.data() + 2 * k, flags + k, SERIES_SWING_HIGH,
+                 n - 2 * k);
+  compute_rolling_min(low, n, w, extreme.data());
+  ops.mark_equal(low + k, extreme.data() + 2 * k, flags + k, SERIES_SWING_LOW,
+                 n - 2 * k);
+}
+
+// Wilder ATR as MasterEngine._atr: zeros up to `period`, then the mean of
+// the first `period` true ranges (from bar 1) and Wilder smoothing
+inline void compute_atr(const double *high, const double *low,
+                       const double *close, size_t n, size_t period,
+                       double *out) {
+  std::fill(out, out + n, 0.0);
+  if (n < 2 || period == 0 || n <= period)
+    return;
+  std::vector<double> tr(n);
+  compute_true_range(high, low, close, n, tr.data());
+  double first = 0.0;
+  for (size_t i = 1; i <= period; ++i)
+    first += tr[i];
+  double p = static_cast<double>(period);
+  out[period] = first / p;
+  for (size_t i = period + 1; i < n; ++i)
+    out[i] = (out[i - 1] * (p - 1) + tr[i]) / p;
+}
+
+// EMA as MasterEngine._ema: seeded with x[0]; all zeros if n < period
+inline void compute_ema(const double *x, size_t n, size_t period, double *out) {
+  if (n == 0 || n < period) {
+    std::fill(out, out + n, 0.0);
+    return;
+  }
+  double alpha = 2.0 / (static_cast<double>(period) + 1.0);
+  out[0] = x[0];
+  for (size_t i = 1; i < n; ++i)
+    out[i] = alpha * x[i] + (1 - alpha) * out[i - 1];
+}
+
+#endif // SERIES_KERNELS_HPP
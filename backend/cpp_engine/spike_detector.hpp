@@ -0,0 +1,111 @@
+/**
+ * Streaming spike detection on the raw tick stream.
+ *
+ * Boom and Crash indices drift in small steps and jump every few hundred
+ * ticks. A spike is a tick-to-tick move that is an outlier against the
+ * symbol's recent moves: its distance from their mean, in standard
+ * deviations (the z-score), at or above the configured threshold.
+ *
+ * The baseline is the last SPIKE_WINDOW moves in a ring, with running
+ * sums, so a tick costs O(1); the sums are re-added exactly once per
+ * window so rounding cannot build up. A spike enters the baseline
+ * winsorised, clipped to the threshold, so one spike does not hide the
+ * next, while a lasting rise in volatility still widens the baseline
+ * within a window.
+ *
+ * The caller holds the symbol's state_lock.
+ */
+
+#ifndef SPIKE_DETECTOR_HPP
+#define SPIKE_DETECTOR_HPP
+
+#include <cmath>
+#include <cstdint>
+
+// Tick moves in the baseline
+constexpr int32_t SPIKE_WINDOW = 256;
+
+// Moves in the baseline before any tick is scored
+constexpr int32_t SPIKE_MIN_MOVES = 32;
+
+// One tick's reading
+struct SpikeReading {
+  int32_t direction;   // 1 up, -1 down on a spike, else 0
+  int32_t ticks_since; // ticks since the last spike, -1 before one
+  double score;        // the move's z-score, 0 while warming up
+  double move;         // price change from the previous tick
+};
+
+class SpikeDetector {
+public:
+  // `threshold` in standard deviations; <= 0 scores without detecting
+  SpikeReading on_tick(double price, double threshold) {
+    SpikeReading r = {0, since, 0.0, 0.0};
+    if (!primed) {
+      primed = true;
+      last = price;
+      return r;
+    }
+    r.move = price - last;
+    last = price;
+    if (since >= 0)
+      r.ticks_since = ++since;
+
+    double folded = r.move;
+    if (n >= SPIKE_MIN_MOVES) {
+      double mean = sum / n;
+      double var = sum_sq / n - mean * mean;
+      double sd = var > 0.0 ? std::sqrt(var) : 0.0;
+      // A baseline without variance scores nothing
+      if (sd > 0.0)
+        r.score = (r.move - mean) / sd;
+      if (threshold > 0.0 && std::fabs(r.score) >= threshold) {
+        r.direction = r.score > 0.0 ? 1 : -1;
+        r.ticks_since = since = 0;
+        folded = mean + r.direction * threshold * sd;
+      }
+    }
+    push(folded);
+    return r;
+  }
+
+  // Ticks since the last spike, -1 before one
+  int32_t ticks_since() const { return since; }
+
+private:
+  void push(double move) {
+    if (n == SPIKE_WINDOW) {
+      double old = moves[head];
+      sum -= old;
+      sum_sq -= old * old;
+    } else {
+      ++n;
+    }
+    moves[head] = move;
+    sum += move;
+    sum_sq += move * move;
+    if (++head == SPIKE_WINDOW) {
+      head = 0;
+      resum();
+    }
+  }
+
+  void resum() {
+    sum = sum_sq = 0.0;
+    for (int32_t i = 0; i < n; ++i) {
+      sum += moves[i];
+      sum_sq += moves[i] * moves[i];
+    }
+  }
+
+  double moves[SPIKE_WINDOW] = {};
+  int32_t head = 0;
+  int32_t n = 0;
+  double sum = 0.0;
+  double sum_sq = 0.0;
+  double last = 0.0;
+  bool primed = false;
+  int32_t since = -1;
+};
+
+#endif // SPIKE_DETECTOR_HPP
@@ -0,0 +1,68 @@
+/**
+ * Bounded lock-free single-producer/single-consumer ring.
+ *
+ * One thread pushes, one thread pops; neither ever blocks or allocates.
+ * The head and tail counters live on separate cache lines and each side
+ * keeps a cached copy of the other's counter, so in steady state a push or
+ * pop touches only its own line plus the slot.
+ */
+
+#ifndef SPSC_RING_HPP
+#define SPSC_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+template <typename T> class SpscRing {
+public:
+  // `capacity` is rounded up to a power of two
+  explicit SpscRing(size_t capacity) {
+    size_t n = 2;
+    while (n < capacity)
+      n <<= 1;
+    mask = n - 1;
+    slots.reset(new T[n]);
+  }
+
+  SpscRing(const SpscRing &) = delete;
+  SpscRing &operator=(const SpscRing &) = delete;
+
+  // Producer side. False (item dropped) when the ring is full.
+  bool push(const T &item) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (t - head_cache > mask) {
+      head_cache = head.load(std::memory_order_acquire);
+      if (t - head_cache > mask)
+        return false;
+    }
+    slots[t & mask] = item;
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side. False when the ring is empty.
+  bool pop(T &item) {
+    size_t h = head.load(std::memory_order_relaxed);
+    if (h == tail_cache) {
+      tail_cache = tail.load(std::memory_order_acquire);
+      if (h == tail_cache)
+        return false;
+    }
+    item = slots[h & mask];
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  size_t capacity() const { return mask + 1; }
+
+private:
+  size_t mask;
+  std::unique_ptr<T[]> slots;
+  alignas(64) std::atomic<size_t> tail{0}; // written by the producer
+  size_t head_cache = 0;                   // producer's view of head
+  alignas(64) std::atomic<size_t> head{0}; // written by the consumer
+  size_t tail_cache = 0;                   // consumer's view of tail
+};
+
+#endif // SPSC_RING_HPP
@@ -0,0 +1,796 @@
+/**
+ * Native entry strategies, one instance per symbol context.
+ *
+ * A strategy derives from Strategy<Derived> and supplies decide(); the base
+ * holds what every strategy shares (the MasterEngine analysis of the 1m
+ * candles, the multi-timeframe RSI confirmation, the entry filter pipeline,
+ * confidence scoring and ATR-based SL/TP) and calls into the derived class
+ * statically, so nothing on the path is virtual. A context's StrategySlot
+ * holds one strategy by value in a std::variant; visiting it resolves to a
+ * direct call per alternative.
+ *
+ * Ported from the Python strategies STRATEGY_MAP picked per symbol:
+ * V10SuperSafeStrategy, Boom300SafeStrategy and Crash300SafeStrategy, with
+ * the same thresholds and order of checks. The analysis the Python code got
+ * from MasterEngine (detect_noise, detect_market_mode, get_volatility,
+ * detect_patterns, calculate_confidence, _analyze_mtf_trend) and
+ * IndicatorLayer (_check_ma_trend, get_multi_rsi_confirmation) reads the
+ * context's candles and streaming indicators instead. MasterEngine's
+ * win/loss memory has no native counterpart and does not score.
+ *
+ * The tick path keeps a strategy's inputs current: each tick is pushed to
+ * the strategy (O(1); Boom/Crash keep a window for spike checks), and the
+ * candle-derived analysis is redone once per change of the 1m ring, not
+ * per tick. Evaluating on a tick then reads it plus O(1) indicator
+ * snapshots. Caller holds the context's state_lock throughout.
+ */
+
+#ifndef STRATEGY_HPP
+#define STRATEGY_HPP
+
+#include "candles.hpp"
+#include "engine.hpp"
+#include "filter_pipeline.hpp"
+#include "indicators.hpp"
+#include "market_structure.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <variant>
+
+// --- Market profiles ---
+// SymbolIntelligence.get_market_profile: how noisy, trending and spiky a
+// symbol family is, for the shared analysis
+
+struct MarketProfile {
+  const char *name;
+  double atr_multiplier;   // scales the noise ATR spike threshold
+  double noise_threshold;  // ATR spike over its mean that counts as noise
+  double trend_threshold;  // EMA20/50 separation (of price) for a trend
+  double trend_weight[ENGINE_TF_COUNT]; // MTF trend weights, 1m..1h
+  bool spike_protection;   // confidence penalty (Boom/Crash)
+};
+
+enum class MarketType : int32_t { FOREX = 0, VOLATILITY, BOOM_CRASH, COUNT };
+
+constexpr MarketProfile MARKET_PROFILES[] = {
+    {"forex", 1.0, 3.5, 0.0005, {0.10, 0.20, 0.30, 0.40}, false},
+    {"volatility", 5.0, 5.0, 0.0002, {0.15, 0.25, 0.25, 0.35}, false},
+    {"boomcrash", 0.6, 5.0, 0.0003, {0.10, 0.20, 0.25, 0.45}, true},
+};
+
+static_assert(sizeof(MARKET_PROFILES) / sizeof(MARKET_PROFILES[0]) ==
+                  static_cast<size_t>(MarketType::COUNT),
+              "MARKET_PROFILES must cover every MarketType");
+
+inline std::string upper_symbol(const std::string &s) {
+  std::string u = s;
+  for (char &c : u)
+    if (c >= 'a' && c <= 'z')
+      c = static_cast<char>(c - 'a' + 'A');
+  return u;
+}
+
+// BOOM/CRASH anywhere; volatility for R_*, 1HZ* or any name with a V in
+// it; everything else trades like forex
+inline MarketType classify_market(const std::string &symbol) {
+  std::string s = upper_symbol(symbol);
+  if (s.find("BOOM") != std::string::npos ||
+      s.find("CRASH") != std::string::npos)
+    return MarketType::BOOM_CRASH;
+  bool deriv = symbol.rfind("R_", 0) == 0 || symbol.rfind("1HZ", 0) == 0;
+  if (s.find('V') != std::string::npos || deriv)
+    return MarketType::VOLATILITY;
+  return MarketType::FOREX;
+}
+
+inline const MarketProfile &market_profile_for(const std::string &symbol) {
+  return MARKET_PROFILES[static_cast<int>(classify_market(symbol))];
+}
+
+// The strategy STRATEGY_MAP assigns a symbol (upper-cased), or none for
+// the ones whose strategy has no native port (V75, spike bot)
+inline int32_t default_strategy_for(const std::string &symbol) {
+  static const char *const V10[] = {
+      "R_10",      "R10",       "R_25",      "R25",       "R_100",
+      "R100",      "1HZ10V",    "1HZ25V",    "FRXEURUSD", "FRXGBPUSD",
+      "FRXUSDJPY", "FRXAUDUSD", "WLDXAU",    "FRXXAUUSD", "FRXAUUSD",
+      "VOLATILITY_10", "V10"};
+  static const char *const BOOM[] = {"BOOM300",  "BOOM300N", "BOOM_500",
+                                     "BOOM500",  "BOOM1000",
+                                     "BOOM_300_SAFE"};
+  static const char *const CRASH[] = {"R_50",      "R50",       "1HZ50V",
+                                      "CRASH_300", "CRASH300",  "CRASH300N",
+                                      "CRASH1000", "CRASH_300_SAFE"};
+  std::string s = upper_symbol(symbol);
+  for (const char *name : V10)
+    if (s == name)
+      return ENGINE_STRATEGY_V10_SUPER_SAFE;
+  for (const char *name : BOOM)
+    if (s == name)
+      return ENGINE_STRATEGY_BOOM300_SAFE;
+  for (const char *name : CRASH)
+    if (s == name)
+      return ENGINE_STRATEGY_CRASH300_SAFE;
+  return ENGINE_STRATEGY_NONE;
+}
+
+static const char *const STRATEGY_NAMES[ENGINE_STRATEGY_KIND_COUNT] = {
+    "none", "v10_super_safe", "boom_300_safe", "crash_300_safe"};
+
+static const char *const STRATEGY_REASON_TEXT[ENGINE_STRATEGY_REASON_COUNT] =
+    {
+        "Entry signal",
+        "No strategy on this symbol",
+        "Not enough history",
+        "Noise peaks detected",
+        "Market chaos detected",
+        "Sideways market",
+        "Weak trend (ADX)",
+        "Flat MA slope",
+        "No trend and RSI setup",
+        "Multi-timeframe RSI against the direction",
+        "Entry filter rejected",
+        "Extreme volatility",
+        "Recent spike",
+        "Low confidence",
+};
+
+inline const char *strategy_name(int32_t kind) {
+  if (kind < 0 || kind >= ENGINE_STRATEGY_KIND_COUNT)
+    return "";
+  return STRATEGY_NAMES[kind];
+}
+
+inline const char *strategy_reason_text(int32_t reason) {
+  if (reason < 0 || reason >= ENGINE_STRATEGY_REASON_COUNT)
+    return "";
+  return STRATEGY_REASON_TEXT[reason];
+}
+
+// --- Series helpers ---
+// MasterEngine._atr (series_atr) over n bars in one pass: its last value,
+// the mean of the whole series (leading zeros included, as np.mean saw
+// them) and of its last `tail` values
+struct AtrSummary {
+  double last = 0.0;
+  double mean = 0.0;
+  double tail_mean = 0.0;
+};
+
+inline AtrSummary atr_summary(const double *high, const double *low,
+                              const double *close, size_t n, size_t period,
+                              size_t tail) {
+  AtrSummary s;
+  if (n == 0)
+    return s;
+  double p = static_cast<double>(period);
+  double atr = 0.0, sum = 0.0, tail_sum = 0.0, first = 0.0;
+  size_t tail_from = n > tail ? n - tail : 0;
+  for (size_t i = 1; n > period && i < n; ++i) {
+    double tr = std::max(high[i] - low[i],
+                         std::max(std::fabs(high[i] - close[i - 1]),
+                                  std::fabs(low[i] - close[i - 1])));
+    if (i < period) {
+      first += tr;
+      continue;
+    }
+    atr = i == period ? (first + tr) / p : (atr * (p - 1) + tr) / p;
+    sum += atr;
+    if (i >= tail_from)
+      tail_sum += atr;
+  }
+  s.last = atr;
+  s.mean = sum / static_cast<double>(n);
+  s.tail_mean = tail_sum / static_cast<double>(std::min(n, tail));
+  return s;
+}
+
+// The last EMA_TAIL values of MasterEngine._ema (series_ema) over x[0..n),
+// newest last; zeros if n < period
+constexpr size_t EMA_TAIL = 6;
+
+inline void ema_tail(const double *x, size_t n, size_t period,
+                     double (&out)[EMA_TAIL]) {
+  std::fill(out, out + EMA_TAIL, 0.0);
+  if (n == 0 || n < period)
+    return;
+  double alpha = 2.0 / (static_cast<double>(period) + 1.0);
+  double e = x[0];
+  for (size_t i = 0; i < n; ++i) {
+    if (i > 0)
+      e = alpha * x[i] + (1 - alpha) * e;
+    if (i + EMA_TAIL >= n)
+      out[i + EMA_TAIL - n] = e;
+  }
+}
+
+// --- Strategy inputs ---
+// What one evaluation reads, all owned by the symbol context
+struct StrategyInputs {
+  const CandleRing &bars;            // closed 1m candles
+  const IndicatorSet *indicators;    // per EngineTimeframe, on closed bars
+  const IndicatorSet &tick_indicators;
+  const MarketStructure &structure;  // 1m
+  const MarketProfile &profile;
+  const FilterPipeline &filters;     // the config's entry_filters
+  double price;
+  int64_t epoch;
+};
+
+enum class Volatility : int32_t { LOW = 0, NORMAL, HIGH, EXTREME };
+
+// MasterEngine's verdicts on the closed 1m candles, redone when the ring
+// changes (a close, a correction, a reload)
+struct BarView {
+  uint64_t total = ~uint64_t(0); // ring state it was built from
+  EngineCandle back{};
+
+  size_t bars = 0;
+  bool noise = false;
+  int32_t mode = ENGINE_MARKET_RANGE;
+  double atr_tail_mean = 0.0; // mean of the last 20 ATR(14) values
+  bool bullish_engulfing = false;
+  bool bearish_engulfing = false;
+  bool compression = false;
+  // IndicatorLayer._check_ma_trend over closes plus the live price
+  double sum19 = 0.0;     // of the last 19 closes
+  double sum49 = 0.0;     // of the last 49
+  double ma20_prev = 0.0; // SMA20 five bars back
+  double atr_simple = 0.0; // mean of the last 14 true ranges (SL/TP)
+
+  bool stale(const CandleRing &ring) const {
+    if (ring.total() != total)
+      return true;
+    EngineCandle b = ring.size() ? ring.back() : EngineCandle{};
+    return std::memcmp(&b, &back, sizeof b) != 0;
+  }
+
+  void build(const CandleRing &ring, const MarketProfile &profile) {
+    *this = BarView();
+    total = ring.total();
+    bars = ring.size();
+    if (bars > 0)
+      back = ring.back();
+    size_t n = bars;
+    const double *o = ring.opens(), *h = ring.highs(), *l = ring.lows(),
+                 *c = ring.closes();
+
+    AtrSummary atr = atr_summary(h, l, c, n, 14, 20);
+    atr_tail_mean = atr.tail_mean;
+    double ema20[EMA_TAIL], ema50[EMA_TAIL];
+    ema_tail(c, n, 20, ema20);
+    ema_tail(c, n, 50, ema50);
+
+    // detect_noise: wick-heavy last candle, an ATR spike or EMA20 whipsaw
+    if (n >= 20) {
+      double body = std::fabs(c[n - 1] - o[n - 1]);
+      if (body == 0.0)
+        body = 0.00001;
+      double wicks = (h[n - 1] - std::max(c[n - 1], o[n - 1])) +
+                     (std::min(c[n - 1], o[n - 1]) - l[n - 1]);
+      int crosses = 0;
+      for (size_t i = 1; i < EMA_TAIL; ++i) {
+        size_t now = n - i, prev = n - i - 1;
+        bool above_now = c[now] > ema20[EMA_TAIL - i];
+        bool above_prev = c[prev] > ema20[EMA_TAIL - i - 1];
+        if (above_now != above_prev)
+          ++crosses;
+      }
+      noise = wicks / body > 6.0 ||
+              atr.last > atr.mean * profile.noise_threshold *
+                             profile.atr_multiplier ||
+              crosses >= 3;
+    }
+
+    // detect_market_mode
+    if (n >= 50) {
+      double avg_price = 0.0;
+      for (size_t i = 0; i < n; ++i)
+        avg_price += c[i];
+      avg_price /= static_cast<double>(n);
+      double th = avg_price * profile.trend_threshold;
+      double sep = std::fabs(ema20[EMA_TAIL - 1] - ema50[EMA_TAIL - 1]);
+      if (atr.last > atr.tail_mean * 3.0 && noise)
+        mode = ENGINE_MARKET_CHAOTIC;
+      else if (atr.last < atr.tail_mean * 0.6)
+        mode = ENGINE_MARKET_COMPRESSION;
+      else if (sep > th)
+        mode = std::fabs(ema20[EMA_TAIL - 1] - ema20[EMA_TAIL - 5]) > 2 * th
+                   ? ENGINE_MARKET_STRONG_TREND
+                   : ENGINE_MARKET_TREND;
+    }
+
+    // detect_patterns: engulfing on the last two bars, ATR compression
+    if (n >= 20) {
+      bool prev_down = c[n - 2] < o[n - 2], prev_up = c[n - 2] > o[n - 2];
+      bool up = c[n - 1] > o[n - 1], down = c[n - 1] < o[n - 1];
+      bullish_engulfing =
+          prev_down && up && c[n - 1] > o[n - 2] && o[n - 1] < c[n - 2];
+      bearish_engulfing = !bullish_engulfing && prev_up && down &&
+                          c[n - 1] < o[n - 2] && o[n - 1] > c[n - 2];
+      double recent =
+          atr_summary(h + n - 10, l + n - 10, c + n - 10, 10, 5, 10).last;
+      double average =
+          atr_summary(h + n - 20, l + n - 20, c + n - 20, 20, 14, 20).mean;
+      compression = recent < average * 0.7;
+    }
+
+    if (n >= 49) {
+      for (size_t i = n - 49; i < n; ++i) {
+        sum49 += c[i];
+        if (i >= n - 19)
+          sum19 += c[i];
+      }
+      double prev = 0.0;
+      for (size_t i = n - 24; i <= n - 5; ++i)
+        prev += c[i];
+      ma20_prev = prev / 20.0;
+    }
+
+    if (n > 15) {
+      double sum = 0.0;
+      for (size_t i = n - 14; i < n; ++i)
+        sum += std::max(h[i] - l[i], std::max(std::fabs(h[i] - c[i - 1]),
+                                              std::fabs(l[i] - c[i - 1])));
+      atr_simple = sum / 14.0;
+    }
+  }
+};
+
+// IndicatorLayer.get_multi_rsi_confirmation: RSI(1m) at the live price
+// against the last close, with RSI(5m) flow as a hard filter and RSI(15m)
+// and RSI(1h) as confidence biases
+struct RsiConfirmation {
+  double rsi_now;
+  double slope;       // against RSI(1m) at the last close
+  int32_t momentum;   // 1 rising, -1 falling, 0 flat (|slope| <= 0.1)
+  bool allow_buy;
+  bool allow_sell;
+  double confidence_modifier;
+};
+
+// --- Strategy base ---
+template <typename Derived> class Strategy {
+public:
+  // A tick was applied to the context; strategies that watch ticks hide
+  // this
+  void on_tick(double) {}
+
+  // Evaluate at the live price. Fills `out` and returns out.reason.
+  int32_t evaluate(const StrategyInputs &in, EngineStrategySignal &out) {
+    out = EngineStrategySignal{};
+    out.strategy = Derived::kind;
+    out.epoch = in.epoch;
+    if constexpr (Derived::kind != ENGINE_STRATEGY_NONE)
+      if (view.stale(in.bars))
+        view.build(in.bars, in.profile);
+    out.market_mode = view.mode;
+    return static_cast<Derived &>(*this).decide(in, view, out);
+  }
+
+protected:
+  static int32_t skip(EngineStrategySignal &out, int32_t reason,
+                      double value = 0.0, double limit = 0.0) {
+    out.reason = reason;
+    out.direction = 0;
+    out.value = value;
+    out.limit = limit;
+    return reason;
+  }
+
+  // Entry at `direction`: SL from twice the simple ATR (or twice min_sl
+  // without history) clamped to [min_sl, max_sl], TP at `rr` times it, in
+  // price distance rounded to cents (BaseStrategy.calculate_sl_tp)
+  static int32_t enter(EngineStrategySignal &out, int32_t direction,
+                       double confidence, const BarView &v, double min_sl,
+                       double max_sl, double rr) {
+    double sl = v.atr_simple > 0.0 ? v.atr_simple * 2.0 : min_sl * 2;
+    sl = std::max(min_sl, std::min(sl, max_sl));
+    out.reason = ENGINE_STRATEGY_ENTRY;
+    out.direction = direction;
+    out.confidence = confidence;
+    out.sl = std::round(sl * 100.0) / 100.0;
+    out.tp = std::round(sl * rr * 100.0) / 100.0;
+    return out.reason;
+  }
+
+  static EngineIndicators snapshot(const IndicatorSet &ind, double price) {
+    EngineIndicators s;
+    ind.snapshot(price, s);
+    return s;
+  }
+
+  // 1m RSI at the live price once 14 bars are in, as the Python
+  // indicator layer read it; 50 before
+  static double live_rsi(const StrategyInputs &in) {
+    EngineIndicators m1 = snapshot(in.indicators[ENGINE_TF_1M], in.price);
+    return m1.samples >= 14 ? m1.rsi_live : 50.0;
+  }
+
+  // 1 bullish, -1 bearish, 0 neutral, plus the MA20 slope; neutral
+  // before 50 bars
+  static int32_t ma_trend(const StrategyInputs &in, const BarView &v,
+                          double &slope) {
+    slope = 0.0;
+    if (v.bars < 50)
+      return 0;
+    double ma20 = (v.sum19 + in.price) / 20.0;
+    double ma50 = (v.sum49 + in.price) / 50.0;
+    slope = v.ma20_prev != 0.0 ? (ma20 - v.ma20_prev) / v.ma20_prev : 0.0;
+    if (in.price > ma20 && ma20 > ma50)
+      return 1;
+    if (in.price < ma20 && ma20 < ma50)
+      return -1;
+    return 0;
+  }
+
+  // get_volatility("1m"): live ATR(14) against the mean of its last 20
+  static Volatility volatility(const StrategyInputs &in, const BarView &v,
+                               double &ratio) {
+    EngineIndicators m1 = snapshot(in.indicators[ENGINE_TF_1M], in.price);
+    ratio = 0.0;
+    if (m1.samples < 20 || m1.atr == 0.0 || v.atr_tail_mean <= 0.0)
+      return Volatility::NORMAL;
+    ratio = m1.atr / v.atr_tail_mean;
+    if (ratio > 2.5)
+      return Volatility::EXTREME;
+    if (ratio > 1.5)
+      return Volatility::HIGH;
+    return ratio < 0.7 ? Volatility::LOW : Volatility::NORMAL;
+  }
+
+  static RsiConfirmation confirm_rsi(const StrategyInputs &in,
+                                     int32_t direction) {
+    RsiConfirmation r = {};
+    EngineIndicators m1 = snapshot(in.indicators[ENGINE_TF_1M], in.price);
+    r.rsi_now = m1.samples >= 14 ? m1.rsi_live : 50.0;
+    double prev = m1.samples >= 14 ? m1.rsi : 50.0;
+    bool history = m1.samples > 0;
+    r.slope = history ? r.rsi_now - prev : 0.0;
+    r.momentum = r.slope > 0.1 ? 1 : r.slope < -0.1 ? -1 : 0;
+    bool flat = !history || std::fabs(r.slope) < 0.5;
+    r.confidence_modifier = flat ? -0.1 : std::fabs(r.slope) > 5 ? 0.05 : 0.0;
+
+    int32_t flow5 = rsi_flow(in.indicators[ENGINE_TF_5M]);
+    int32_t flow15 = rsi_flow(in.indicators[ENGINE_TF_15M]);
+    int32_t flow1h = rsi_flow(in.indicators[ENGINE_TF_1H]);
+    r.confidence_modifier +=
+        direction * (0.1 * flow15 + 0.05 * flow1h); // 0 without direction
+    r.confidence_modifier = std::round(r.confidence_modifier * 100) / 100;
+
+    r.allow_buy = r.rsi_now > 50 && (r.momentum > 0 || r.rsi_now > 55) &&
+                  !flat && flow5 > 0;
+    r.allow_sell = r.rsi_now < 50 && (r.momentum < 0 || r.rsi_now < 45) &&
+                   !flat && flow5 < 0;
+    return r;
+  }
+
+  // The config's entry filter pipeline on the last closed 1m candle;
+  // ENGINE_FILTER_PASSED or the rejecting stage (also in out.filter)
+  static int32_t filter(const StrategyInputs &in, int32_t direction,
+                        int32_t rsi_momentum, EngineStrategySignal &out) {
+    if (in.bars.size() == 0)
+      return ENGINE_FILTER_PASSED; // the Python strategies skipped it
+    FilterInputs f = {};
+    f.direction = direction;
+    f.rsi_momentum = rsi_momentum;
+    f.has_candle = true;
+    f.candle = in.bars.back();
+    const IndicatorSet &ind = in.indicators[ENGINE_TF_1M];
+    if (in.filters.reads_indicators())
+      ind.snapshot(in.price, f.indicators);
+    if (in.filters.reads_signal())
+      f.signal = ind.signal(in.price);
+    if (in.filters.reads_structure())
+      in.structure.snapshot(f.structure);
+    EngineFilterResult r;
+    int32_t reason = run_filters(in.filters, f, r);
+    if (reason != ENGINE_FILTER_PASSED) {
+      skip(out, ENGINE_STRATEGY_ENTRY_FILTER, r.value, r.limit);
+      out.filter = reason;
+    }
+    return reason;
+  }
+
+  // MasterEngine.calculate_confidence (0-100) for an entry at `direction`
+  static double confidence(const StrategyInputs &in, const BarView &v,
+                           int32_t direction, double rsi) {
+    bool buy = direction > 0;
+    double score = 0;
+    static const int32_t MTF_POINTS[5] = {-20, 0, 10, 20, 30}; // against..with
+    score += MTF_POINTS[mtf_trend(in, direction) + 2];
+
+    if (buy ? v.bullish_engulfing : v.bearish_engulfing)
+      score += 15;
+    if (v.compression)
+      score += 10;
+
+    double ratio;
+    switch (volatility(in, v, ratio)) {
+    case Volatility::NORMAL:
+      score += 20;
+      break;
+    case Volatility::LOW:
+      score += 15;
+      break;
+    case Volatility::HIGH:
+      score += 10;
+      break;
+    case Volatility::EXTREME:
+      score -= 10;
+      break;
+    }
+
+    if (buy ? rsi >= 40 && rsi <= 70 : rsi >= 30 && rsi <= 60)
+      score += 10;
+
+    if (v.mode == ENGINE_MARKET_STRONG_TREND)
+      score += 20;
+    else if (v.mode == ENGINE_MARKET_CHAOTIC)
+      score -= 50;
+    else if (v.mode == ENGINE_MARKET_COMPRESSION)
+      score -= 10;
+
+    if (in.profile.spike_protection)
+      score -= 10;
+    return std::max(0.0, std::min(100.0, score));
+  }
+
+private:
+  // RSI of a closed-bar timeframe above / below 50: 1 / -1; 0 at 50 or
+  // before 14 bars
+  static int32_t rsi_flow(const IndicatorSet &ind) {
+    EngineIndicators s = snapshot(ind, 0.0);
+    double rsi = s.samples >= 14 ? s.rsi : 50.0;
+    return rsi > 50 ? 1 : rsi < 50 ? -1 : 0;
+  }
+
+  // MasterEngine.get_trend: -2 strong down .. 2 strong up from EMA20/50
+  static int32_t tf_trend(const IndicatorSet &ind) {
+    EngineIndicators s = snapshot(ind, 0.0);
+    if (s.samples < 20)
+      return 0;
+    double slope = s.ema_fast - s.ema_fast_prev;
+    bool wide = std::fabs(s.ema_fast - s.ema_slow) > s.ema_slow * 0.0002;
+    if (s.ema_fast > s.ema_slow)
+      return slope > 0 && wide ? 2 : 1;
+    if (s.ema_fast < s.ema_slow)
+      return slope < 0 && wide ? -2 : -1;
+    return 0;
+  }
+
+  // _analyze_mtf_trend, weighted by the profile, relative to `direction`:
+  // 2 strongly with it .. -2 strongly against
+  static int32_t mtf_trend(const StrategyInputs &in, int32_t direction) {
+    static const double POINTS[5] = {-100, -50, 0, 50, 100};
+    double score = 0.0;
+    for (int tf = 0; tf < ENGINE_TF_COUNT; ++tf)
+      score += POINTS[tf_trend(in.indicators[tf]) + 2] *
+               in.profile.trend_weight[tf];
+    int32_t trend = score > 60    ? 2
+                    : score > 20  ? 1
+                    : score < -60 ? -2
+                    : score < -20 ? -1
+                                  : 0;
+    return direction > 0 ? trend : -trend;
+  }
+
+  BarView view;
+};
+
+// --- Strategies ---
+// A symbol without a strategy
+class NoStrategy : public Strategy<NoStrategy> {
+public:
+  static constexpr int32_t kind = ENGINE_STRATEGY_NONE;
+
+  int32_t decide(const StrategyInputs &, const BarView &,
+                 EngineStrategySignal &out) {
+    return skip(out, ENGINE_STRATEGY_OFF);
+  }
+};
+
+// V10SuperSafeStrategy: with a sloped, ADX-confirmed 1m MA trend, BUY
+// with RSI in 50-68 (SELL in 32-50), bands and confidence threshold
+// adapted to the market mode. Its H1 hard block compared the MTF trend
+// with "bearish"/"bullish", which _analyze_mtf_trend never returns, so it
+// never fired; the MTF trend still scores in the confidence.
+class V10SuperSafe : public Strategy<V10SuperSafe> {
+public:
+  static constexpr int32_t kind = ENGINE_STRATEGY_V10_SUPER_SAFE;
+  static constexpr double sideways_slope = 0.00015;
+  static constexpr double min_adx = 18;
+  static constexpr double min_slope = 0.0004;
+  static constexpr double rsi_buy_min = 50, rsi_buy_max = 68;
+  static constexpr double rsi_sell_min = 32, rsi_sell_max = 50;
+  static constexpr double min_confidence = 60;
+  static constexpr double sl_min = 7, sl_max = 10, rr = 1.4;
+
+  int32_t decide(const StrategyInputs &in, const BarView &v,
+                 EngineStrategySignal &out) {
+    if (v.bars < 50)
+      return skip(out, ENGINE_STRATEGY_WARMING_UP, v.bars, 50);
+    if (v.noise)
+      return skip(out, ENGINE_STRATEGY_NOISE);
+    if (v.mode == ENGINE_MARKET_CHAOTIC)
+      return skip(out, ENGINE_STRATEGY_CHAOTIC);
+
+    // MasterEngine.adapt_thresholds
+    double buy_max = rsi_buy_max, sell_min = rsi_sell_min;
+    double threshold = min_confidence;
+    if (v.mode == ENGINE_MARKET_STRONG_TREND) {
+      buy_max = 82;
+      sell_min = 18;
+      threshold = 55;
+    } else if (v.mode == ENGINE_MARKET_RANGE) {
+      buy_max = 62;
+      sell_min = 38;
+      threshold = 70;
+    }
+
+    double slope;
+    int32_t trend = ma_trend(in, v, slope);
+    if (std::fabs(slope) < sideways_slope)
+      return skip(out, ENGINE_STRATEGY_SIDEWAYS, slope, sideways_slope);
+    EngineIndicators ticks = snapshot(in.tick_indicators, in.price);
+    double adx = (ticks.ready & ENGINE_IND_ADX) ? ticks.adx : 0.0;
+    if (adx < min_adx)
+      return skip(out, ENGINE_STRATEGY_WEAK_TREND, adx, min_adx);
+    if (std::fabs(slope) < min_slope)
+      return skip(out, ENGINE_STRATEGY_FLAT_SLOPE, slope, min_slope);
+
+    double rsi = live_rsi(in);
+    int32_t direction = 0;
+    if (trend > 0 && rsi >= rsi_buy_min && rsi <= buy_max)
+      direction = 1;
+    else if (trend < 0 && rsi >= sell_min && rsi <= rsi_sell_max)
+      direction = -1;
+    if (direction == 0)
+      return skip(out, ENGINE_STRATEGY_NO_SETUP, rsi, trend);
+
+    RsiConfirmation rc = confirm_rsi(in, direction);
+    if (direction > 0 ? !rc.allow_buy : !rc.allow_sell)
+      return skip(out, ENGINE_STRATEGY_RSI_MISMATCH, rc.rsi_now, rc.slope);
+    if (filter(in, direction, rc.momentum, out) != ENGINE_FILTER_PASSED)
+      return out.reason;
+
+    double conf =
+        confidence(in, v, direction, rsi) + rc.confidence_modifier * 100;
+    if (conf < threshold)
+      return skip(out, ENGINE_STRATEGY_LOW_CONFIDENCE, conf, threshold);
+    return enter(out, direction, conf, v, sl_min, sl_max, rr);
+  }
+};
+
+// Boom300SafeStrategy (Side -1) and Crash300SafeStrategy (Side 1): trade
+// only against the index's spikes, with the 1m MA trend sloped that way,
+// and stand aside for 20 ticks after a spike (a tick move of more than
+// 5 price units in the spike's direction)
+template <int32_t Side> class SpikeIndexSafe
+    : public Strategy<SpikeIndexSafe<Side>> {
+  using Base = Strategy<SpikeIndexSafe<Side>>;
+
+public:
+  static constexpr int32_t kind = Side < 0 ? ENGINE_STRATEGY_BOOM300_SAFE
+                                           : ENGINE_STRATEGY_CRASH300_SAFE;
+  static constexpr int32_t lookback_ticks = 20;
+  static constexpr double spike_threshold = 5.0;
+  static constexpr double min_slope = 0.0001; // in the trade's direction
+  static constexpr double min_confidence = 40;
+  static constexpr double sl_min = 5, sl_max = 50, rr = 1.5;
+
+  void on_tick(double quote) {
+    ticks[count % lookback_ticks] = quote;
+    ++count;
+  }
+
+  int32_t decide(const StrategyInputs &in, const BarView &v,
+                 EngineStrategySignal &out) {
+    if (count < lookback_ticks)
+      return Base::skip(out, ENGINE_STRATEGY_WARMING_UP,
+                        static_cast<double>(count), lookback_ticks);
+    if (v.noise)
+      return Base::skip(out, ENGINE_STRATEGY_NOISE);
+    if (v.mode == ENGINE_MARKET_CHAOTIC)
+      return Base::skip(out, ENGINE_STRATEGY_CHAOTIC);
+
+    double slope;
+    int32_t trend = Base::ma_trend(in, v, slope);
+    if (trend != Side)
+      return Base::skip(out, ENGINE_STRATEGY_NO_SETUP, trend, Side);
+    if (slope * Side <= min_slope)
+      return Base::skip(out, ENGINE_STRATEGY_FLAT_SLOPE, slope,
+                        Side * min_slope);
+
+    RsiConfirmation rc = Base::confirm_rsi(in, Side);
+    if (Side > 0 ? !rc.allow_buy : !rc.allow_sell)
+      return Base::skip(out, ENGINE_STRATEGY_RSI_MISMATCH, rc.rsi_now,
+                        rc.slope);
+    if (Base::filter(in, Side, rc.momentum, out) != ENGINE_FILTER_PASSED)
+      return out.reason;
+
+    double ratio;
+    if (Base::volatility(in, v, ratio) == Volatility::EXTREME)
+      return Base::skip(out, ENGINE_STRATEGY_EXTREME_VOLATILITY, ratio, 2.5);
+    double spike = largest_spike();
+    if (spike > spike_threshold)
+      return Base::skip(out, ENGINE_STRATEGY_RECENT_SPIKE, spike,
+                        spike_threshold);
+
+    double conf = Base::confidence(in, v, Side, Base::live_rsi(in)) +
+                  rc.confidence_modifier * 100;
+    if (conf < min_confidence)
+      return Base::skip(out, ENGINE_STRATEGY_LOW_CONFIDENCE, conf,
+                        min_confidence);
+    return Base::enter(out, Side, conf, v, sl_min, sl_max, rr);
+  }
+
+private:
+  // Largest move between consecutive ticks of the window in the spike's
+  // direction (up on Boom, down on Crash)
+  double largest_spike() const {
+    double largest = 0.0;
+    for (int64_t i = count - lookback_ticks + 1; i < count; ++i) {
+      double move = (ticks[i % lookback_ticks] -
+                     ticks[(i - 1) % lookback_ticks]) * -Side;
+      largest = std::max(largest, move);
+    }
+    return largest;
+  }
+
+  double ticks[lookback_ticks] = {};
+  int64_t count = 0;
+};
+
+using Boom300Safe = SpikeIndexSafe<-1>;
+using Crash300Safe = SpikeIndexSafe<1>;
+
+// --- Per-symbol slot ---
+// One strategy instance by value; the alternative's index is its
+// EngineStrategyKind
+class StrategySlot {
+public:
+  using Any = std::variant<NoStrategy, V10SuperSafe, Boom300Safe,
+                           Crash300Safe>;
+  static_assert(std::variant_size<Any>::value == ENGINE_STRATEGY_KIND_COUNT,
+                "StrategySlot must hold every EngineStrategyKind");
+
+  int32_t kind() const { return static_cast<int32_t>(active.index()); }
+
+  // A fresh instance (no tick window, no cached analysis); false for an
+  // unknown kind
+  bool set(int32_t kind) {
+    switch (kind) {
+    case ENGINE_STRATEGY_NONE:
+      active.emplace<NoStrategy>();
+      return true;
+    case ENGINE_STRATEGY_V10_SUPER_SAFE:
+      active.emplace<V10SuperSafe>();
+      return true;
+    case ENGINE_STRATEGY_BOOM300_SAFE:
+      active.emplace<Boom300Safe>();
+      return true;
+    case ENGINE_STRATEGY_CRASH300_SAFE:
+      active.emplace<Crash300Safe>();
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  void on_tick(double quote) {
+    std::visit([quote](auto &s) { s.on_tick(quote); }, active);
+  }
+
+  int32_t evaluate(const StrategyInputs &in, EngineStrategySignal &out) {
+    return std::visit([&](auto &s) { return s.evaluate(in, out); }, active);
+  }
+
+private:
+  Any active;
+};
+
+#endif // STRATEGY_HPP
@@ -0,0 +1,354 @@
+/**
+ * Per-symbol engine contexts.
+ *
+ * Everything the tick path touches for one symbol (price, candles,
+ * indicators, spike detector, its strategy instance) and the symbol's own
+ * trade cooldown lives in its SymbolContext. Contexts are addressed by a
+ * dense integer handle from create_symbol_context(), so different symbols
+ * never share mutable state and can be processed from different threads.
+ * Names are interned into handles once; resolving a name again (the JSON
+ * paths do, per call) is a lock-free probe of a flat index, without
+ * allocating.
+ *
+ * Contexts and their candle and position storage are carved from the
+ * engine's arena under its memory budget (memory_budget.hpp).
+ *
+ * Within a context, candle/indicator state and the history writers are
+ * guarded by `state_lock` (uncontended unless two threads feed the same
+ * symbol). The hot fields read from other threads are lock-free: the last
+ * quote sits behind a seqlock and the cooldown state is atomic.
+ */
+
+#ifndef SYMBOL_CONTEXT_HPP
+#define SYMBOL_CONTEXT_HPP
+
+#include "arena.hpp"
+#include "candles.hpp"
+#include "column_store.hpp"
+#include "engine.hpp"
+#include "indicators.hpp"
+#include "market_structure.hpp"
+#include "memory_budget.hpp"
+#include "metrics.hpp"
+#include "position_book.hpp"
+#include "risk_policy.hpp"
+#include "seqlock.hpp"
+#include "spike_detector.hpp"
+#include "strategy.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+
+// Slots of the name index: a power of two, at most half full
+constexpr uint32_t SYMBOL_INDEX_SLOTS = 2 * MAX_SYMBOL_CONTEXTS;
+static_assert((SYMBOL_INDEX_SLOTS & (SYMBOL_INDEX_SLOTS - 1)) == 0,
+              "SYMBOL_INDEX_SLOTS must be a power of two");
+
+// FNV-1a over the name's bytes
+inline uint32_t symbol_hash(std::string_view symbol) {
+  uint32_t h = 2166136261u;
+  for (char c : symbol)
+    h = (h ^ static_cast<unsigned char>(c)) * 16777619u;
+  return h;
+}
+
+struct Quote {
+  double price;
+  int64_t epoch;
+};
+
+struct SymbolContext {
+  int32_t id;
+  std::string name;
+
+  // Guards price, candles, indicators, structure, spikes, positions and
+  // strategy
+  std::mutex state_lock;
+  double price = 0.0;
+  CandleAggregator candles[ENGINE_TF_COUNT];
+  IndicatorSet indicators[ENGINE_TF_COUNT];
+  // Each timeframe's indicators before its newest closed candle was
+  // folded in, so a late correction of that candle costs O(1)
+  IndicatorSet indicators_prev[ENGINE_TF_COUNT];
+  // Swings, breaks and gaps per timeframe, with the same O(1) correction
+  MarketStructure structure[ENGINE_TF_COUNT];
+  MarketStructure structure_prev[ENGINE_TF_COUNT];
+  IndicatorSet tick_indicators;
+  // Tick-move baseline the spike readings are scored against
+  SpikeDetector spikes;
+  // Open positions, trailed and checked on every tick
+  PositionBook positions;
+  // positions.net_side(), readable without the lock (correlation checks)
+  std::atomic<int32_t> exposure{0};
+  // Entry strategy, fed every tick; its last evaluation
+  StrategySlot strategy;
+  EngineStrategySignal last_signal{};
+  // Store writers while persistence is on (store_open), else null
+  std::unique_ptr<SymbolHistory> history;
+
+  // Last quote, readable from any thread without the lock
+  SeqLock<Quote> last_quote;
+
+  // Trade cooldown, independent of every other symbol
+  std::atomic<int64_t> cooldown_ns;
+  std::atomic<int64_t> last_trade_ns;
+
+  // Risk policy of the symbol's class, fixed at creation
+  const RiskProfile *risk;
+  // Market profile the strategy analysis reads, fixed at creation
+  const MarketProfile *market;
+  // Losing streak and the UTC day it belongs to (a new day clears it)
+  std::atomic<int> loss_streak{0};
+  std::atomic<int64_t> loss_streak_day{-1};
+
+  // Tick and trade-decision stage latencies of this symbol
+  SymbolMetrics metrics;
+
+  // `now_ns` is the engine clock's monotonic reading (see clock.hpp).
+  // Candle and position storage is taken from `arena` (storage_bytes).
+  SymbolContext(int32_t id, const std::string &symbol, int64_t cooldown_ns,
+                int64_t now_ns, const MemoryBudget &budget, Arena &arena)
+      : id(id), name(symbol), cooldown_ns(cooldown_ns),
+        risk(&risk_profile_for(symbol)),
+        market(&market_profile_for(symbol)) {
+    for (int tf = 0; tf < ENGINE_TF_COUNT; ++tf)
+      candles[tf].reset(TIMEFRAME_SECONDS[tf], arena, budget.candles[tf]);
+    positions.reset(arena, budget.max_positions);
+    // Start in the past so the first trade is never blocked
+    last_trade_ns = now_ns - 2 * cooldown_ns;
+    strategy.set(default_strategy_for(symbol));
+    last_signal.reason = ENGINE_STRATEGY_OFF;
+    last_signal.strategy = strategy.kind();
+  }
+
+  // Arena bytes a context's candles and positions take under `budget`
+  static size_t storage_bytes(const MemoryBudget &budget) {
+    size_t bytes = PositionBook::bytes_for(budget.max_positions);
+    for (int tf = 0; tf < ENGINE_TF_COUNT; ++tf)
+      bytes += CandleRing::bytes_for(budget.candles[tf]);
+    return bytes;
+  }
+
+  // Atomically take the cooldown slot observed as `expected`. Fails if
+  // another thread approved a trade on this symbol in the meantime.
+  bool claim_trade(int64_t expected, int64_t now_ns) {
+    return last_trade_ns.compare_exchange_strong(expected, now_ns,
+                                                 std::memory_order_acq_rel);
+  }
+
+  // Record a settled contract; caller serialises per context
+  void record_result(int64_t day, double profit) {
+    int streak = loss_streak_day.load(std::memory_order_relaxed) == day
+                     ? loss_streak.load(std::memory_order_relaxed)
+                     : 0;
+    loss_streak.store(profit < 0 ? streak + 1 : 0, std::memory_order_relaxed);
+    loss_streak_day.store(day, std::memory_order_release);
+  }
+
+  int losing_streak(int64_t day) const {
+    if (loss_streak_day.load(std::memory_order_acquire) != day)
+      return 0;
+    return loss_streak.load(std::memory_order_relaxed);
+  }
+
+  // Caller must hold state_lock.
+  // Returns a mask of the timeframes that closed a candle on this tick.
+  int32_t on_tick(int64_t epoch, double quote) {
+    price = quote;
+    last_quote.store({quote, epoch});
+    tick_indicators.update(quote, quote, quote);
+    strategy.on_tick(quote);
+    if (history)
+      history->append_tick(epoch, quote);
+
+    int32_t closed = 0;
+    for (int tf = 0; tf < ENGINE_TF_COUNT; ++tf) {
+      if (candles[tf].on_tick(epoch, quote)) {
+        fold_closed(tf, candles[tf].ring().back());
+        closed |= 1 << tf;
+      }
+    }
+    return closed;
+  }
+
+  // Caller must hold state_lock.
+  // Streaming OHLC update for one timeframe (see upsert_candle in
+  // engine.hpp): 1 if it closed the forming candle, 0 if it updated a
+  // candle in place, ENGINE_ERR_BAD_ARG for a candle older than the newest
+  // closed one.
+  int32_t upsert_candle(int tf, const EngineCandle &c) {
+    CandleAggregator &agg = candles[tf];
+    CandleRing &ring = agg.ring();
+    int64_t start = bucket_start(c.epoch, agg.period_seconds());
+    bool before_forming = agg.forming() && start < agg.current().epoch;
+    bool before_ring = ring.size() > 0 && start <= ring.back().epoch;
+    if (before_forming || (!agg.forming() && before_ring)) {
+      // Correction of a closed candle: only the newest can be revised
+      // (the history store keeps the value it was closed with)
+      if (ring.size() == 0 || start != ring.back().epoch)
+        return ENGINE_ERR_BAD_ARG;
+      EngineCandle bar = c;
+      bar.epoch = start;
+      ring.replace_back(bar);
+      indicators[tf] = indicators_prev[tf];
+      indicators[tf].update(bar);
+      structure[tf] = structure_prev[tf];
+      structure[tf].update(bar);
+      return 0;
+    }
+    if (!agg.upsert(c))
+      return 0;
+    fold_closed(tf, ring.back());
+    return 1;
+  }
+
+  double signal() const { return indicators[ENGINE_TF_1M].signal(price); }
+
+  // Caller must hold state_lock.
+  // Evaluate the strategy at the current price; also kept in last_signal.
+  int32_t evaluate_strategy(const FilterPipeline &filters, int64_t epoch,
+                            EngineStrategySignal &out) {
+    StrategyInputs in = {candles[ENGINE_TF_1M].ring(),
+                         indicators,
+                         tick_indicators,
+                         structure[ENGINE_TF_1M],
+                         *market,
+                         filters,
+                         price,
+                         epoch};
+    strategy.evaluate(in, out);
+    last_signal = out;
+    return out.reason;
+  }
+
+private:
+  // A candle just closed into candles[tf]'s ring
+  void fold_closed(int tf, const EngineCandle &bar) {
+    indicators_prev[tf] = indicators[tf];
+    indicators[tf].update(bar);
+    structure_prev[tf] = structure[tf];
+    structure[tf].update(bar);
+    if (history)
+      history->append_candle(tf, bar);
+  }
+};
+
+// Fixed-capacity table of contexts, built in the arena it is attached to
+// (up to the budget's max_symbols). Creation is serialised by a mutex;
+// lookup by handle is a bounds check plus an acquire load, so tick paths
+// for different symbols never contend. Contexts are never moved or freed
+// while the engine is alive, so handles and pointers stay valid.
+//
+// Names resolve through an open-addressing index of (hash, handle) slots.
+// A slot is published with a release store after its context, so readers
+// probe it without the mutex; slots are never removed.
+class SymbolRegistry {
+public:
+  SymbolRegistry() = default;
+  SymbolRegistry(const SymbolRegistry &) = delete;
+  SymbolRegistry &operator=(const SymbolRegistry &) = delete;
+
+  ~SymbolRegistry() {
+    for (int32_t id = 0; id < count.load(std::memory_order_relaxed); ++id)
+      contexts[id]->~SymbolContext();
+  }
+
+  // Arena bytes of a full table under `budget`
+  static size_t bytes_for(const MemoryBudget &budget) {
+    return static_cast<size_t>(budget.max_symbols) *
+           (arena_bytes_for<SymbolContext>(1) +
+            SymbolContext::storage_bytes(budget));
+  }
+
+  // Where contexts are built, and under which budget; before the first
+  // create() (false after it)
+  bool attach(Arena &into, const MemoryBudget &budget) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (count.load(std::memory_order_relaxed) > 0)
+      return false;
+    arena = &into;
+    limits = budget;
+    return true;
+  }
+
+  // Returns the existing handle for `symbol` or creates a context.
+  // -1 for an empty symbol, without an arena or when the table is full.
+  int32_t create(std::string_view symbol, int64_t cooldown_ns,
+                 int64_t now_ns) {
+    if (symbol.empty())
+      return -1;
+    uint32_t hash = symbol_hash(symbol);
+    int32_t id = find(symbol, hash);
+    if (id >= 0)
+      return id;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    id = find(symbol, hash); // created while we waited
+    if (id >= 0)
+      return id;
+    id = count.load(std::memory_order_relaxed);
+    if (!arena || id >= limits.max_symbols)
+      return -1;
+    void *mem = arena->take<SymbolContext>(1);
+    if (!mem)
+      return -1;
+    contexts[id] = new (mem) SymbolContext(id, std::string(symbol),
+                                           cooldown_ns, now_ns, limits, *arena);
+    count.store(id + 1, std::memory_order_release);
+    uint32_t i = hash;
+    while (index[i & (SYMBOL_INDEX_SLOTS - 1)].load(
+               std::memory_order_relaxed) != 0)
+      ++i;
+    index[i & (SYMBOL_INDEX_SLOTS - 1)].store(slot(hash, id),
+                                              std::memory_order_release);
+    return id;
+  }
+
+  // Handle for a symbol name, or -1 if it has no context yet
+  int32_t find(std::string_view symbol) const {
+    return find(symbol, symbol_hash(symbol));
+  }
+
+  SymbolContext *get(int32_t id) const {
+    if (id < 0 || id >= count.load(std::memory_order_acquire))
+      return nullptr;
+    return contexts[id];
+  }
+
+  int32_t size() const { return count.load(std::memory_order_acquire); }
+  int32_t capacity() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return arena ? limits.max_symbols : 0;
+  }
+
+private:
+  // Hash in the high half, handle + 1 in the low (0 = empty slot)
+  static uint64_t slot(uint32_t hash, int32_t id) {
+    return uint64_t(hash) << 32 | uint32_t(id + 1);
+  }
+
+  int32_t find(std::string_view symbol, uint32_t hash) const {
+    for (uint32_t i = 0; i < SYMBOL_INDEX_SLOTS; ++i) {
+      uint64_t s = index[(hash + i) & (SYMBOL_INDEX_SLOTS - 1)].load(
+          std::memory_order_acquire);
+      if (s == 0)
+        return -1;
+      int32_t id = static_cast<int32_t>(uint32_t(s)) - 1;
+      if (uint32_t(s >> 32) == hash && contexts[id]->name == symbol)
+        return id;
+    }
+    return -1;
+  }
+
+  mutable std::mutex mutex;
+  Arena *arena = nullptr;
+  MemoryBudget limits;
+  SymbolContext *contexts[MAX_SYMBOL_CONTEXTS] = {};
+  std::atomic<int32_t> count{0};
+  std::atomic<uint64_t> index[SYMBOL_INDEX_SLOTS] = {};
+};
+
+#endif // SYMBOL_CONTEXT_HPP
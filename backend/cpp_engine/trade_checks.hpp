@@ -0,0 +1,102 @@
+/**
+ * The trade safety rules, independent of where their inputs come from.
+ *
+ * Live trading gathers TradeInputs from the symbol context, the account
+ * stream and the wall clock; the backtester gathers them from its
+ * simulated account and the replayed epochs. Both then apply exactly the
+ * same checks in the same order, so a backtest rejects what live would.
+ */
+
+#ifndef TRADE_CHECKS_HPP
+#define TRADE_CHECKS_HPP
+
+#include "clock.hpp"
+#include "config.hpp"
+#include "engine.hpp"
+#include "risk_policy.hpp"
+#include <algorithm>
+#include <cstdint>
+
+struct TradeInputs {
+  double stake;
+  int active_trades;
+  bool account_known;
+  AccountState account;
+  RiskLedger::Snapshot today;
+  int losing_streak;
+  double correlation;      // with open exposure, signed by direction
+  double volatility_ratio; // 0 = unknown
+  int64_t cooldown_elapsed_ns; // since the last approved trade
+  int64_t cooldown_ns;
+};
+
+inline int32_t set_decision(EngineTradeDecision &out, int32_t reason,
+                            double detail = 0.0, double limit = 0.0) {
+  out.reason = reason;
+  out.reserved = 0;
+  out.detail = detail;
+  out.limit = limit;
+  return reason;
+}
+
+// Stake, account, daily and cooldown limits. Writes the outcome (the
+// stake checked, reason and numeric detail) to `out` and returns the reason.
+inline int32_t check_trade_limits(const EngineConfig &cfg,
+                                  const RiskProfile &risk,
+                                  const TradeInputs &in,
+                                  EngineTradeDecision &out) {
+  out.stake = in.stake;
+
+  // Stake bounds: the tighter of the live config and the symbol policy
+  double min_stake = std::max(cfg.min_stake, risk.min_stake);
+  if (in.stake < min_stake)
+    return set_decision(out, ENGINE_REJECT_STAKE_BELOW_MIN, in.stake,
+                        min_stake);
+  if (in.stake > cfg.max_stake)
+    return set_decision(out, ENGINE_REJECT_STAKE_ABOVE_MAX, in.stake,
+                        cfg.max_stake);
+
+  if (in.account_known && in.stake > in.account.margin_free)
+    return set_decision(out, ENGINE_REJECT_INSUFFICIENT_MARGIN, in.stake,
+                        in.account.margin_free);
+
+  if (in.active_trades >= cfg.max_active_trades)
+    return set_decision(out, ENGINE_REJECT_MAX_ACTIVE_TRADES, in.active_trades,
+                        cfg.max_active_trades);
+
+  // Daily limits: realised losses or the balance drop since the
+  // day's first check, whichever is larger
+  double loss = -in.today.realised_pnl;
+  if (in.account_known)
+    loss = std::max(loss, in.today.day_start_balance - in.account.balance);
+  double max_loss =
+      in.today.day_start_balance * cfg.max_daily_loss_pct / 100.0;
+  if (in.today.day_start_balance > 0.0 && loss >= max_loss)
+    return set_decision(out, ENGINE_REJECT_DAILY_LOSS, loss, max_loss);
+  if (in.today.sl_hits >= cfg.max_sl_hits)
+    return set_decision(out, ENGINE_REJECT_MAX_SL_HITS, in.today.sl_hits,
+                        cfg.max_sl_hits);
+
+  if (in.losing_streak >= risk.max_consecutive_losses)
+    return set_decision(out, ENGINE_REJECT_LOSS_STREAK, in.losing_streak,
+                        risk.max_consecutive_losses);
+
+  // Portfolio and regime gates
+  if (cfg.max_correlation > 0.0 && in.correlation >= cfg.max_correlation)
+    return set_decision(out, ENGINE_REJECT_CORRELATED, in.correlation,
+                        cfg.max_correlation);
+  if (cfg.max_volatility_ratio > 0.0 &&
+      in.volatility_ratio >= cfg.max_volatility_ratio)
+    return set_decision(out, ENGINE_REJECT_VOLATILITY, in.volatility_ratio,
+                        cfg.max_volatility_ratio);
+
+  // Cooldown (per symbol), reported in seconds
+  if (in.cooldown_elapsed_ns < in.cooldown_ns)
+    return set_decision(out, ENGINE_REJECT_COOLDOWN,
+                        ns_to_seconds(in.cooldown_ns - in.cooldown_elapsed_ns),
+                        ns_to_seconds(in.cooldown_ns));
+
+  return set_decision(out, ENGINE_TRADE_APPROVED);
+}
+
+#endif // TRADE_CHECKS_HPP
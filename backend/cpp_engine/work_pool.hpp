@@ -0,0 +1,83 @@
+/**
+ * Work-stealing parallel loop for coarse, independent jobs (backtests).
+ *
+ * Job indices are dealt round-robin onto one deque per worker. A worker
+ * pops from the back of its own deque and, once that is empty, steals from
+ * the front of the others', so a few slow jobs (long or trade-heavy
+ * parameter sets) do not leave the remaining cores idle.
+ */
+
+#ifndef WORK_POOL_HPP
+#define WORK_POOL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 0 = one worker per hardware thread
+inline unsigned resolve_workers(int requested, size_t jobs) {
+  unsigned n = requested > 0 ? static_cast<unsigned>(requested)
+                             : std::thread::hardware_concurrency();
+  n = std::max(n, 1u);
+  return static_cast<unsigned>(std::min<size_t>(n, std::max<size_t>(jobs, 1)));
+}
+
+template <typename Fn>
+void parallel_for_stealing(size_t jobs, unsigned workers, Fn &&fn) {
+  if (workers <= 1 || jobs <= 1) {
+    for (size_t i = 0; i < jobs; ++i)
+      fn(i);
+    return;
+  }
+
+  struct Queue {
+    std::mutex lock;
+    std::deque<size_t> items;
+  };
+  std::vector<std::unique_ptr<Queue>> queues;
+  for (unsigned w = 0; w < workers; ++w)
+    queues.emplace_back(new Queue());
+  for (size_t i = 0; i < jobs; ++i)
+    queues[i % workers]->items.push_back(i);
+
+  auto take = [&](unsigned self, size_t &job) {
+    {
+      Queue &own = *queues[self];
+      std::lock_guard<std::mutex> guard(own.lock);
+      if (!own.items.empty()) {
+        job = own.items.back();
+        own.items.pop_back();
+        return true;
+      }
+    }
+    for (unsigned k = 1; k < workers; ++k) {
+      Queue &victim = *queues[(self + k) % workers];
+      std::lock_guard<std::mutex> guard(victim.lock);
+      if (!victim.items.empty()) {
+        job = victim.items.front();
+        victim.items.pop_front();
+        return true;
+      }
+    }
+    return false; // nothing is ever re-queued, so empty everywhere = done
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(workers - 1);
+  auto run = [&](unsigned self) {
+    size_t job;
+    while (take(self, job))
+      fn(job);
+  };
+  for (unsigned w = 1; w < workers; ++w)
+    threads.emplace_back(run, w);
+  run(0); // the calling thread is worker 0
+  for (auto &t : threads)
+    t.join();
+}
+
+#endif // WORK_POOL_HPP
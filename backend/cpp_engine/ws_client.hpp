@@ -0,0 +1,426 @@
+/**
+ * Minimal blocking WebSocket client (RFC 6455) over TCP, with TLS through
+ * OpenSSL for wss:// URLs.
+ *
+ * It covers what a market-data subscription needs: masked text frames out,
+ * text and continuation frames in, ping/pong and the close handshake. One
+ * thread owns a client; interrupt() is the only call safe from another
+ * thread (it shuts the socket down so a blocked read returns).
+ *
+ * Certificates are checked against the system trust store (SSL_CERT_FILE /
+ * SSL_CERT_DIR override it) and the URL's host name.
+ */
+
+#ifndef WS_CLIENT_HPP
+#define WS_CLIENT_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <openssl/sha.h>
+#include <openssl/ssl.h>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <vector>
+
+class WsClient {
+public:
+  WsClient() = default;
+  ~WsClient() { close(); }
+  WsClient(const WsClient &) = delete;
+  WsClient &operator=(const WsClient &) = delete;
+
+  // Connect and complete the upgrade handshake. On failure `error` says why.
+  bool connect(const std::string &url, std::string &error) {
+    close();
+    std::string host, port, path;
+    bool tls = false;
+    if (!parse_url(url, tls, host, port, path)) {
+      error = "bad url: " + url;
+      return false;
+    }
+    if (!open_socket(host, port, error))
+      return false;
+    if (tls && !start_tls(host, error)) {
+      close();
+      return false;
+    }
+    if (!handshake(host, port, path, tls, error)) {
+      close();
+      return false;
+    }
+    return true;
+  }
+
+  bool is_open() const { return fd >= 0; }
+
+  bool send_text(const char *data, size_t len) {
+    return send_frame(0x1, data, len);
+  }
+  bool send_text(const std::string &s) { return send_text(s.data(), s.size()); }
+
+  // Wait up to `timeout_ms` for the next complete text/binary message and
+  // store it in `out`. 1 = message, 0 = timed out, -1 = closed or failed.
+  // Control frames are answered internally.
+  int read_message(std::string &out, int timeout_ms) {
+    if (fd < 0)
+      return -1;
+    if (buffered() == 0 && !wait_readable(timeout_ms))
+      return fd < 0 ? -1 : 0;
+    out.clear();
+    for (;;) {
+      uint8_t op = 0;
+      bool fin = false;
+      size_t len = 0;
+      if (!read_frame_header(op, fin, len))
+        return fail();
+      const char *payload = take(len);
+      if (!payload)
+        return fail();
+      switch (op) {
+      case 0x0: // continuation
+      case 0x1: // text
+      case 0x2: // binary
+        out.append(payload, len);
+        if (fin)
+          return 1;
+        break;
+      case 0x8: // close: echo it and stop
+        send_frame(0x8, payload, std::min<size_t>(len, 2));
+        return fail();
+      case 0x9: // ping
+        if (!send_frame(0xA, payload, len))
+          return fail();
+        break;
+      default: // pong / reserved
+        break;
+      }
+    }
+  }
+
+  // Unblock a read in progress from another thread
+  void interrupt() {
+    int s = fd_shadow.load();
+    if (s >= 0)
+      ::shutdown(s, SHUT_RDWR);
+  }
+
+  void close() {
+    if (ssl) {
+      SSL_shutdown(ssl);
+      SSL_free(ssl);
+      ssl = nullptr;
+    }
+    if (ctx) {
+      SSL_CTX_free(ctx);
+      ctx = nullptr;
+    }
+    if (fd >= 0) {
+      fd_shadow = -1;
+      ::close(fd);
+      fd = -1;
+    }
+    rbuf.clear();
+    rpos = 0;
+  }
+
+private:
+  static constexpr size_t MAX_FRAME = 16 << 20;
+
+  static bool parse_url(const std::string &url, bool &tls, std::string &host,
+                        std::string &port, std::string &path) {
+    size_t scheme = url.find("://");
+    if (scheme == std::string::npos)
+      return false;
+    std::string proto = url.substr(0, scheme);
+    if (proto != "ws" && proto != "wss")
+      return false;
+    tls = proto == "wss";
+    size_t start = scheme + 3;
+    size_t slash = url.find('/', start);
+    std::string authority = url.substr(start, slash - start);
+    path = slash == std::string::npos ? "/" : url.substr(slash);
+    size_t colon = authority.rfind(':');
+    if (colon != std::string::npos) {
+      host = authority.substr(0, colon);
+      port = authority.substr(colon + 1);
+    } else {
+      host = authority;
+      port = tls ? "443" : "80";
+    }
+    return !host.empty() && !port.empty();
+  }
+
+  bool open_socket(const std::string &host, const std::string &port,
+                   std::string &error) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *res = nullptr;
+    int rc = ::getaddrinfo(host.c_str(), port.c_str(), &hints, &res);
+    if (rc != 0) {
+      error = std::string("resolve failed: ") + gai_strerror(rc);
+      return false;
+    }
+    for (addrinfo *a = res; a; a = a->ai_next) {
+      int s = ::socket(a->ai_family, a->ai_socktype | SOCK_CLOEXEC,
+                       a->ai_protocol);
+      if (s < 0)
+        continue;
+      // Bounds connect() and blocking writes (Linux honours it for both)
+      timeval tv{10, 0};
+      ::setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+      if (::connect(s, a->ai_addr, a->ai_addrlen) == 0) {
+        int one = 1;
+        ::setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        fd = s;
+        fd_shadow = s;
+        break;
+      }
+      ::close(s);
+    }
+    ::freeaddrinfo(res);
+    if (fd < 0)
+      error = "connect failed: " + host + ":" + port;
+    return fd >= 0;
+  }
+
+  bool start_tls(const std::string &host, std::string &error) {
+    ctx = SSL_CTX_new(TLS_client_method());
+    if (!ctx)
+      return ssl_error("SSL_CTX_new", error);
+    SSL_CTX_set_default_verify_paths(ctx);
+    SSL_CTX_set_verify(ctx, SSL_VERIFY_PEER, nullptr);
+    ssl = SSL_new(ctx);
+    if (!ssl)
+      return ssl_error("SSL_new", error);
+    SSL_set_fd(ssl, fd);
+    SSL_set_tlsext_host_name(ssl, host.c_str());
+    SSL_set1_host(ssl, host.c_str());
+    if (SSL_connect(ssl) != 1)
+      return ssl_error("TLS handshake", error);
+    return true;
+  }
+
+  static bool ssl_error(const char *what, std::string &error) {
+    char buf[256];
+    ERR_error_string_n(ERR_get_error(), buf, sizeof(buf));
+    error = std::string(what) + " failed: " + buf;
+    return false;
+  }
+
+  static std::string base64(const unsigned char *data, size_t n) {
+    std::string out(4 * ((n + 2) / 3), '\0');
+    int len = EVP_EncodeBlock(reinterpret_cast<unsigned char *>(&out[0]), data,
+                              static_cast<int>(n));
+    out.resize(len > 0 ? static_cast<size_t>(len) : 0);
+    return out;
+  }
+
+  bool handshake(const std::string &host, const std::string &port,
+                 const std::string &path, bool tls, std::string &error) {
+    unsigned char nonce[16];
+    RAND_bytes(nonce, sizeof(nonce));
+    std::string key = base64(nonce, sizeof(nonce));
+    bool default_port = port == (tls ? "443" : "80");
+    std::string req = "GET " + path + " HTTP/1.1\r\nHost: " + host +
+                      (default_port ? "" : ":" + port) +
+                      "\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                      "Sec-WebSocket-Key: " +
+                      key + "\r\nSec-WebSocket-Version: 13\r\n\r\n";
+    if (!write_all(req.data(), req.size())) {
+      error = "handshake write failed";
+      return false;
+    }
+
+    // Response headers; anything after them is already frame data
+    size_t end = std::string::npos;
+    while (end == std::string::npos) {
+      if (rbuf.size() > 16384 || !wait_readable(10000) || !fill_some()) {
+        error = "handshake response missing";
+        return false;
+      }
+      std::string seen(rbuf.begin(), rbuf.end());
+      end = seen.find("\r\n\r\n");
+    }
+    std::string head(rbuf.begin(), rbuf.begin() + end);
+    rpos = end + 4;
+    std::string lower = head;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    if (head.compare(0, 12, "HTTP/1.1 101") != 0) {
+      error = "upgrade refused: " + head.substr(0, head.find("\r\n"));
+      return false;
+    }
+
+    static const char *GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    std::string material = key + GUID;
+    unsigned char digest[SHA_DIGEST_LENGTH];
+    SHA1(reinterpret_cast<const unsigned char *>(material.data()),
+         material.size(), digest);
+    std::string expect = base64(digest, sizeof(digest));
+    size_t h = lower.find("\r\nsec-websocket-accept:");
+    if (h == std::string::npos) {
+      error = "missing Sec-WebSocket-Accept";
+      return false;
+    }
+    size_t v = head.find_first_not_of(" \t", h + 23);
+    size_t e = head.find("\r\n", v);
+    std::string accept = head.substr(v, e == std::string::npos ? e : e - v);
+    while (!accept.empty() && std::isspace((unsigned char)accept.back()))
+      accept.pop_back();
+    if (accept != expect) {
+      error = "bad Sec-WebSocket-Accept";
+      return false;
+    }
+    return true;
+  }
+
+  bool send_frame(uint8_t op, const char *data, size_t len) {
+    if (fd < 0)
+      return false;
+    unsigned char head[14];
+    size_t n = 0;
+    head[n++] = 0x80 | op; // FIN
+    if (len < 126) {
+      head[n++] = 0x80 | static_cast<unsigned char>(len);
+    } else if (len <= 0xFFFF) {
+      head[n++] = 0x80 | 126;
+      head[n++] = static_cast<unsigned char>(len >> 8);
+      head[n++] = static_cast<unsigned char>(len);
+    } else {
+      head[n++] = 0x80 | 127;
+      for (int i = 7; i >= 0; --i)
+        head[n++] = static_cast<unsigned char>(uint64_t(len) >> (8 * i));
+    }
+    unsigned char mask[4];
+    RAND_bytes(mask, sizeof(mask));
+    std::memcpy(head + n, mask, 4);
+    n += 4;
+
+    wbuf.assign(reinterpret_cast<char *>(head), n);
+    wbuf.append(data, len);
+    for (size_t i = 0; i < len; ++i)
+      wbuf[n + i] ^= mask[i & 3];
+    return write_all(wbuf.data(), wbuf.size());
+  }
+
+  bool read_frame_header(uint8_t &op, bool &fin, size_t &len) {
+    const char *h = take(2);
+    if (!h)
+      return false;
+    fin = (h[0] & 0x80) != 0;
+    op = h[0] & 0x0F;
+    bool masked = (h[1] & 0x80) != 0;
+    uint64_t n = h[1] & 0x7F;
+    if (n == 126 || n == 127) {
+      size_t bytes = n == 126 ? 2 : 8;
+      const char *ext = take(bytes);
+      if (!ext)
+        return false;
+      n = 0;
+      for (size_t i = 0; i < bytes; ++i)
+        n = (n << 8) | static_cast<unsigned char>(ext[i]);
+    }
+    if (n > MAX_FRAME)
+      return false;
+    len = static_cast<size_t>(n);
+    if (masked) { // servers must not mask, but tolerate it
+      const char *m = take(4);
+      if (!m)
+        return false;
+      unsigned char key[4];
+      std::memcpy(key, m, 4);
+      if (!ensure(len))
+        return false;
+      for (size_t i = 0; i < len; ++i)
+        rbuf[rpos + i] ^= key[i & 3];
+    }
+    return true;
+  }
+
+  size_t buffered() const {
+    return rbuf.size() - rpos + (ssl ? SSL_pending(ssl) : 0);
+  }
+
+  // Consume `n` buffered bytes (reading more as needed); null on failure
+  const char *take(size_t n) {
+    if (!ensure(n))
+      return nullptr;
+    const char *p = rbuf.data() + rpos;
+    rpos += n;
+    return p;
+  }
+
+  bool ensure(size_t n) {
+    while (rbuf.size() - rpos < n) {
+      if (rpos > 0 && rpos == rbuf.size()) {
+        rbuf.clear();
+        rpos = 0;
+      }
+      if (!wait_readable(30000) || !fill_some())
+        return false;
+    }
+    return true;
+  }
+
+  bool fill_some() {
+    // Keep the unread tail at the front so the buffer does not grow
+    if (rpos > 0 && rpos * 2 > rbuf.size()) {
+      rbuf.erase(rbuf.begin(), rbuf.begin() + rpos);
+      rpos = 0;
+    }
+    size_t old = rbuf.size();
+    rbuf.resize(old + 16384);
+    ssize_t got = ssl ? SSL_read(ssl, &rbuf[old], 16384)
+                      : ::recv(fd, &rbuf[old], 16384, 0);
+    rbuf.resize(old + (got > 0 ? static_cast<size_t>(got) : 0));
+    return got > 0;
+  }
+
+  bool wait_readable(int timeout_ms) {
+    if (ssl && SSL_pending(ssl) > 0)
+      return true;
+    pollfd p{fd, POLLIN, 0};
+    int rc = ::poll(&p, 1, timeout_ms);
+    return rc > 0;
+  }
+
+  bool write_all(const char *data, size_t len) {
+    while (len > 0) {
+      ssize_t n = ssl ? SSL_write(ssl, data, static_cast<int>(len))
+                      : ::send(fd, data, len, MSG_NOSIGNAL);
+      if (n <= 0)
+        return false;
+      data += n;
+      len -= static_cast<size_t>(n);
+    }
+    return true;
+  }
+
+  int fail() {
+    close();
+    return -1;
+  }
+
+  int fd = -1;
+  std::atomic<int> fd_shadow{-1}; // read by interrupt()
+  SSL_CTX *ctx = nullptr;
+  SSL *ssl = nullptr;
+  std::vector<char> rbuf;
+  size_t rpos = 0;
+  std::string wbuf;
+};
+
+#endif // WS_CLIENT_HPP
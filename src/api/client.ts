@@ -19,6 +19,11 @@ export const api = {
             if (!res.ok) throw new Error('Failed to toggle bot');
             return res.json();
         },
+        getMetrics: async () => {
+            const res = await fetch(`${API_BASE}/bot/metrics/`);
+            if (!res.ok) throw new Error('Failed to fetch engine metrics');
+            return res.json();
+        },
         downloadLogs: async () => {
             const res = await fetch(`${API_BASE}/bot/download-logs/`);
             if (!res.ok) throw new Error('Failed to download logs');
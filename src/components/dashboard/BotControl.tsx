@@ -17,6 +17,9 @@ const formatUptime = (seconds: number): string => {
   return `${hours}h ${minutes}m`;
 };
 
+const formatMicros = (us: number): string =>
+  us >= 1000 ? `${(us / 1000).toFixed(2)}ms` : `${us.toFixed(1)}µs`;
+
 export const BotControl = ({ status, onToggle }: BotControlProps) => {
   const { toast } = useToast();
 
@@ -114,6 +117,20 @@ export const BotControl = ({ status, onToggle }: BotControlProps) => {
             {status.profitToday >= 0 ? '+' : ''}${status.profitToday.toFixed(2)}
           </p>
         </div>
+        {status.latency && (
+          <div className="space-y-1 col-span-2">
+            <div className="flex items-center gap-2 text-muted-foreground text-xs">
+              <Activity className="w-3 h-3" />
+              Engine Latency (p50 / p99)
+            </div>
+            <p className="font-mono text-sm">
+              {formatMicros(status.latency.tickP50Us)} / {formatMicros(status.latency.tickP99Us)}
+              <span className="text-muted-foreground text-xs ml-2">
+                {status.latency.ticks} ticks, {status.latency.rejects} rejects
+              </span>
+            </p>
+          </div>
+        )}
       </div>
 
       <div className="flex flex-col gap-3">
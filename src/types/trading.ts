@@ -47,6 +47,17 @@ export interface BotStatus {
   tradesExecuted: number;
   profitToday: number;
   symbol: string;
+  latency?: EngineLatency;
+}
+
+// Engine hot-path summary from /api/bot (full detail: /api/bot/metrics/)
+export interface EngineLatency {
+  tickP50Us: number;
+  tickP99Us: number;
+  decisionP99Us: number;
+  ticks: number;
+  rejects: number;
+  parseErrors: number;
 }
 
 export interface StrategySettings {